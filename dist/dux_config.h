@@ -7,4 +7,22 @@
 #define DUX_PATH_DELIMITER      ':'
 #define DUX_PATH_SEPARATOR      '/'
 
+// #define DUX_WORK_THREADS        4
+// #define DUX_WORK_QUEUE_SIZE     64
+
+// #define DUX_PROMISE_TICK_MAX_JOBS   1000
+// #define DUX_PROMISE_TICK_MAX_TIME   0   // in milliseconds (0 means unlimited)
+
+// #define DUX_JSON_TYPED_ARRAY_MIN    0   // Load numeric arrays in .json modules as Float64Array (0 means never)
+// #define DUX_JSON_MAX_DEPTH          64
+
+// #define DUX_OPT_NO_LOOP_STATS   // Disable per tick handler statistics
+// #define DUX_OPT_NO_PERF_HOOKS   // Disable perf_hooks module
+// #define DUX_OPT_NO_WORKER_THREADS   // Disable worker_threads module and dux_channel_*()
+// #define DUX_OPT_NO_STREAM       // Disable stream module
+// #define DUX_OPT_NO_BYTECODE_CACHE   // Disable bytecode cache (.jsc) for modules
+// #define DUX_OPT_NO_HOT_RELOAD   // Disable dux_reload_module() and module.hot
+// #define DUX_ENABLE_LAZY_GLOBALS     // Initialize process and Promise on first access
+// #define DUX_OPT_NO_WAIT         // Disable dux_tick_wait/dux_run blocking (no pthread)
+
 #endif  /* !DUX_CONFIG_H_INCLUDED */
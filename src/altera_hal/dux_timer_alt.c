@@ -7,8 +7,8 @@
  * Tick counter can be shared with multiple Duktape heaps
  * because there is only one HAL tick in one system.
  */
-DUK_LOCAL duk_uint_t g_time_per_tick;
-DUK_LOCAL duk_uint_t g_last_time;
+DUK_LOCAL duk_uint64_t g_time_per_tick;
+DUK_LOCAL duk_uint64_t g_last_time;
 DUK_LOCAL alt_u32 g_last_tick;
 
 /*
@@ -16,13 +16,13 @@ DUK_LOCAL alt_u32 g_last_tick;
  */
 DUK_INTERNAL void dux_timer_arch_init(void)
 {
-	g_time_per_tick = alt_ticks_per_second() / 1000;
+	g_time_per_tick = 1000000000ULL / alt_ticks_per_second();
 }
 
 /*
- * Get current time (No Duktape dependent)
+ * Get current time in nanoseconds (No Duktape dependent)
  */
-DUK_INTERNAL duk_uint_t dux_timer_arch_current(void)
+DUK_INTERNAL duk_uint64_t dux_timer_arch_current_ns(void)
 {
 	alt_u32 new_tick = alt_nticks();
 	alt_u32 ticks = new_tick - g_last_tick;
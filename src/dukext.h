@@ -21,19 +21,85 @@ extern "C" {
  * Typedefs
  */
 typedef duk_ret_t (*dux_file_reader)(duk_context *ctx, const char *path);
+typedef duk_ret_t (*dux_file_writer)(duk_context *ctx, const char *path, const void *data, duk_size_t len);
+typedef duk_ret_t (*dux_file_mapper)(duk_context *ctx, const char *path, const void **data, duk_size_t *len, void **handle);
+typedef void (*dux_file_unmapper)(duk_context *ctx, const void *data, duk_size_t len, void *handle);
+typedef void *(*dux_file_opener)(duk_context *ctx, const char *path, duk_size_t *size);
+typedef duk_int_t (*dux_file_chunk_reader)(duk_context *ctx, void *handle, void *buf, duk_size_t len);
+typedef void (*dux_file_closer)(duk_context *ctx, void *handle);
 
 /*
  * Structures
  */
 typedef struct dux_file_accessor_s {
-    dux_file_reader reader;
+    dux_file_reader reader; /* Push whole file as a string (or buffer) */
+    dux_file_writer writer; /* Optional (Used to store bytecode cache) */
+    dux_file_mapper map;    /* Optional (Give region of file without copy. Tried first) */
+    dux_file_unmapper unmap;
+    dux_file_opener open;   /* Optional (Open file and get size. Tried before reader) */
+    dux_file_chunk_reader read; /* Returns bytes read (0: EOF, negative: error) */
+    dux_file_closer close;
 } dux_file_accessor;
 
+typedef struct dux_bundle_entry_s {
+    const char *path;       /* Absolute path (X.jsc for bytecode) */
+    const void *data;       /* Source or bytecode (duk_dump_function output) */
+    duk_size_t len;         /* Length of data in bytes */
+} dux_bundle_entry;         /* Generated by tools/bundle_modules.py */
+
+typedef struct dux_loop_stats_s {
+    const char *name;       /* Name of tick handler */
+    duk_uint_t calls;       /* Number of invocations */
+    duk_uint_t jobs;        /* Number of jobs (callbacks) run */
+    duk_double_t total_time;/* Cumulative time in milliseconds */
+    duk_double_t max_time;  /* Maximum time of single invocation in milliseconds */
+} dux_loop_stats;
+
+typedef struct dux_memory_usage_s {
+    duk_size_t current;     /* Bytes currently allocated */
+    duk_size_t peak;        /* Maximum of current */
+} dux_memory_usage;
+
+typedef struct dux_memory_stats_s {
+    const char *name;       /* Name of module or global */
+    duk_int_t bytes;        /* Heap bytes grown by its instantiation (including nested ones) */
+} dux_memory_stats;
+
+typedef struct dux_channel dux_channel;    /* Message channel between heaps */
+
 /*
  * Initialization
  */
 DUK_EXTERNAL_DECL duk_errcode_t dux_initialize(duk_context *ctx, const dux_file_accessor *file_accessor);
 
+/*
+ * Embedded modules (Looked up before file accessor. Entries must be sorted by path)
+ */
+DUK_EXTERNAL_DECL void dux_set_bundle(duk_context *ctx, const dux_bundle_entry *bundle);
+
+/*
+ * Compile module source at stack top into bytecode (Replaced by buffer)
+ * (Same format as X.jsc. Used by tools/dux_compile.c)
+ */
+DUK_EXTERNAL_DECL void dux_dump_module(duk_context *ctx, const char *filename);
+
+/*
+ * Forget files known to be missing (Call when files are added)
+ */
+DUK_EXTERNAL_DECL void dux_reset_module_lookup(duk_context *ctx);
+
+/*
+ * Reload changed file (Dependents are invalidated until modules accepted update by module.hot.accept())
+ * Returns DUK_EXEC_ERROR if update reached a module which did not accept it (Restart is needed)
+ */
+DUK_EXTERNAL_DECL duk_int_t dux_reload_module(duk_context *ctx, const char *filename);
+
+/*
+ * Read JSON file in chunks (Throws SyntaxError for invalid JSON)
+ * Numeric arrays with typed_array_min or more elements are loaded as Float64Array (0: never)
+ */
+DUK_EXTERNAL_DECL duk_int_t dux_read_json_file(duk_context *ctx, const char *path, duk_uint_t typed_array_min);
+
 /*
  * Evaluate file/source as a module
  */
@@ -63,11 +129,60 @@ DUK_EXTERNAL_DECL duk_ret_t dux_eval_module_raw(duk_context *ctx, const void *da
 #define dux_peval_module_lstring_noresult(ctx, data, len) \
     (dux_eval_module_raw((ctx), (data), (len), DUK_COMPILE_NORESULT | DUK_COMPILE_NOFILENAME | DUK_COMPILE_SAFE))
 
+/*
+ * Memory accounting
+ * (Pass dux_memory_alloc/realloc/free and dux_memory_usage to duk_create_heap)
+ */
+DUK_EXTERNAL_DECL void *dux_memory_alloc(void *udata, duk_size_t size);
+DUK_EXTERNAL_DECL void *dux_memory_realloc(void *udata, void *ptr, duk_size_t size);
+DUK_EXTERNAL_DECL void dux_memory_free(void *udata, void *ptr);
+DUK_EXTERNAL_DECL duk_uint_t dux_get_memory_stats(duk_context *ctx, dux_memory_stats *stats, duk_uint_t max);
+
 /*
  * Tick handling
  */
 DUK_EXTERNAL_DECL duk_bool_t dux_tick(duk_context *ctx);
 
+/*
+ * Wait for next event (timer expiration, work completion, queued callbacks)
+ * timeout is in milliseconds (negative value means infinite)
+ */
+DUK_EXTERNAL_DECL duk_bool_t dux_tick_wait(duk_context *ctx, duk_int_t timeout);
+
+/*
+ * Run event loop until all jobs are finished or timeout (in milliseconds) elapses
+ * Returns true if there are any incomplete jobs
+ */
+DUK_EXTERNAL_DECL duk_bool_t dux_run(duk_context *ctx, duk_int_t timeout);
+
+/*
+ * Limit promise jobs run by one tick
+ * (max_jobs: number of jobs, max_time: time in milliseconds, 0 means unlimited)
+ */
+DUK_EXTERNAL_DECL void dux_set_promise_budget(duk_context *ctx, duk_uint_t max_jobs, duk_uint_t max_time);
+
+/*
+ * Get number of promise jobs waiting in the queue
+ */
+DUK_EXTERNAL_DECL duk_uint_t dux_get_promise_queue_depth(duk_context *ctx);
+
+/*
+ * Event loop statistics per tick handler
+ * Returns number of handlers (stats are stored up to max entries)
+ */
+DUK_EXTERNAL_DECL duk_uint_t dux_get_loop_stats(duk_context *ctx, dux_loop_stats *stats, duk_uint_t max);
+DUK_EXTERNAL_DECL void dux_reset_loop_stats(duk_context *ctx);
+
+/*
+ * Message channel between heaps (Each heap must be driven by one thread)
+ * Attach side 0 and side 1 to heaps (in their threads), then release host's reference
+ * Attached ports are available as require("worker_threads").ports[name]
+ * ("parent" is also available as parentPort)
+ */
+DUK_EXTERNAL_DECL dux_channel *dux_channel_create(void);
+DUK_EXTERNAL_DECL duk_errcode_t dux_channel_attach(duk_context *ctx, dux_channel *channel, duk_uint_t side, const char *name);
+DUK_EXTERNAL_DECL void dux_channel_release(dux_channel *channel);
+
 #ifdef __cplusplus
 }   /* extern "C" */
 #endif
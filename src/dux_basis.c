@@ -1,6 +1,12 @@
 #include "dux_internal.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
+#if !defined(DUX_OPT_NO_WAIT)
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#endif  /* !DUX_OPT_NO_WAIT */
 
 // #define DEBUG
 
@@ -12,12 +18,102 @@ DUK_INTERNAL const char DUX_KEY_CONSTRUCTOR[] = "constructor";
 DUK_LOCAL const char DUX_IPK_TABLE[]        = DUX_IPK("bTable");
 DUK_LOCAL const char DUX_IPK_STORE[]        = DUX_IPK("bStore");
 DUK_LOCAL const char DUX_IPK_FILE_ACCESS[]  = DUX_IPK("bFile");
+DUK_LOCAL const char DUX_IPK_BUNDLE[]       = DUX_IPK("bBndl");
+
+#if !defined(DUX_OPT_NO_WAIT)
+DUK_LOCAL const char DUX_IPK_WAKEUP[]       = DUX_IPK("bWake");
+
+#if defined(__linux__)
+#define DUX_WAKEUP_CLOCK    CLOCK_MONOTONIC
+#else
+#define DUX_WAKEUP_CLOCK    CLOCK_REALTIME
+#endif
+
+/*
+ * Wakeup object for dux_tick_wait
+ * (posted is set by any event which requires next tick)
+ */
+struct dux_wakeup
+{
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	duk_uint_t refs;
+	duk_bool_t posted;
+};
+#endif  /* !DUX_OPT_NO_WAIT */
+
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+DUK_LOCAL const char DUX_IPK_LOOP_STATS[]   = DUX_IPK("bStat");
+
+/*
+ * Statistics of tick handlers
+ * (Stored in a plain buffer in heap stash)
+ */
+typedef struct dux_loop_stats_entry
+{
+	const char *name;
+	duk_uint_t calls;
+	duk_uint_t jobs;
+	duk_uint64_t total_time;
+	duk_uint64_t max_time;
+}
+dux_loop_stats_entry;
+
+typedef struct dux_loop_stats_table
+{
+	duk_uint_t count;
+	duk_int_t current;
+	dux_loop_stats_entry entries[DUX_LOOP_STATS_MAX];
+}
+dux_loop_stats_table;
+#endif  /* !DUX_OPT_NO_LOOP_STATS */
+
+DUK_LOCAL const char DUX_IPK_MEMORY_STATS[] = DUX_IPK("bMem");
+
+/*
+ * Header of memory block allocated by dux_memory_alloc
+ * (Aligned for any type)
+ */
+typedef union dux_memory_header
+{
+	duk_size_t size;
+	duk_double_t align_d;
+	duk_uint64_t align_u;
+	void *align_p;
+}
+dux_memory_header;
+
+/*
+ * Memory usage per module
+ * (Stored in a plain buffer in heap stash)
+ */
+typedef struct dux_memory_entry
+{
+	char name[24];
+	duk_int_t bytes;
+}
+dux_memory_entry;
+
+typedef struct dux_memory_table
+{
+	duk_uint_t count;
+	dux_memory_entry entries[DUX_MEMORY_STATS_MAX];
+}
+dux_memory_table;
+
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+DUK_LOCAL const char DUX_IPK_LAZY_INIT[]    = DUX_IPK("bLzI");
+DUK_LOCAL const char DUX_IPK_LAZY_NAME[]    = DUX_IPK("bLzN");
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
 
 /*
  * Initialize Duktape extension modules
  */
 DUK_EXTERNAL duk_errcode_t dux_initialize(duk_context *ctx, const dux_file_accessor *file_accessor)
 {
+	duk_size_t before = dux_memory_current(ctx);
+	duk_errcode_t result;
+
 	if (file_accessor) {
 		/* [ ... ] */
 		duk_push_heap_stash(ctx);
@@ -29,7 +125,7 @@ DUK_EXTERNAL duk_errcode_t dux_initialize(duk_context *ctx, const dux_file_acces
 		duk_pop(ctx);
 		/* [ ... ] */
 	}
-	return dux_invoke_initializers(ctx,
+	result = dux_invoke_initializers(ctx,
 		DUX_INIT_MODULES
 		DUX_INIT_PROMISE
 		DUX_INIT_WORK
@@ -41,6 +137,8 @@ DUK_EXTERNAL duk_errcode_t dux_initialize(duk_context *ctx, const dux_file_acces
 		DUX_INIT_PACKAGE_SPRINTF
 		NULL
 	);
+	dux_memory_record(ctx, "(initialize)", before);
+	return result;
 }
 
 /*
@@ -49,6 +147,9 @@ DUK_EXTERNAL duk_errcode_t dux_initialize(duk_context *ctx, const dux_file_acces
 DUK_EXTERNAL duk_bool_t dux_tick(duk_context *ctx)
 {
 	duk_int_t result;
+	duk_uint64_t start;
+
+	start = dux_perf_tick_start(ctx);
 	result = dux_invoke_tick_handlers(ctx,
 		DUX_TICK_MODULES
 		DUX_TICK_PROMISE
@@ -59,8 +160,286 @@ DUK_EXTERNAL duk_bool_t dux_tick(duk_context *ctx)
 		DUX_TICK_IMMEDIATE	/* IMMEDIATE must be the last tick handler */
 		NULL
 	);
+	if (dux_perf_tick_end(ctx, start))
+	{
+		/* Long task callback may have queued new jobs */
+		result |= DUX_TICK_RET_CONTINUE;
+	}
+
+	if (!(result & DUX_TICK_RET_CONTINUE))
+	{
+		/* Nothing to wait for (Next dux_tick_wait must not block) */
+		dux_wakeup_signal(ctx);
+		return 0;
+	}
+	return 1;
+}
+
+#if !defined(DUX_OPT_NO_WAIT)
+/*
+ * Get current time for wakeup (in nanoseconds)
+ */
+DUK_LOCAL duk_uint64_t wakeup_current(void)
+{
+	struct timespec tp;
+	if (clock_gettime(DUX_WAKEUP_CLOCK, &tp) != 0)
+	{
+		return 0;
+	}
+	return ((duk_uint64_t)tp.tv_sec * 1000000000ULL) + (duk_uint64_t)tp.tv_nsec;
+}
+
+/*
+ * Wait until wakeup is posted or timeout (in nanoseconds) elapses
+ */
+DUK_LOCAL void wakeup_wait(dux_wakeup *wakeup, duk_int64_t timeout)
+{
+	struct timespec abstime;
+
+	pthread_mutex_lock(&wakeup->lock);
+	if ((!wakeup->posted) && (timeout < 0))
+	{
+		while (!wakeup->posted)
+		{
+			pthread_cond_wait(&wakeup->cond, &wakeup->lock);
+		}
+	}
+	else if ((!wakeup->posted) && (timeout > 0))
+	{
+		clock_gettime(DUX_WAKEUP_CLOCK, &abstime);
+		abstime.tv_sec += (time_t)(timeout / 1000000000LL);
+		abstime.tv_nsec += (long)(timeout % 1000000000LL);
+		if (abstime.tv_nsec >= 1000000000L)
+		{
+			++abstime.tv_sec;
+			abstime.tv_nsec -= 1000000000L;
+		}
+		while (!wakeup->posted)
+		{
+			if (pthread_cond_timedwait(&wakeup->cond, &wakeup->lock, &abstime) == ETIMEDOUT)
+			{
+				break;
+			}
+		}
+	}
+	wakeup->posted = 0;
+	pthread_mutex_unlock(&wakeup->lock);
+}
+
+/*
+ * Finalizer for wakeup holder
+ */
+DUK_LOCAL duk_ret_t wakeup_finalizer(duk_context *ctx)
+{
+	/* [ obj ] */
+	dux_wakeup *wakeup;
+
+	duk_get_prop_string(ctx, 0, DUX_IPK_WAKEUP);
+	/* [ obj ptr ] */
+	wakeup = (dux_wakeup *)duk_get_pointer(ctx, 1);
+	if (wakeup)
+	{
+		duk_del_prop_string(ctx, 0, DUX_IPK_WAKEUP);
+		dux_wakeup_release(ctx, wakeup);
+	}
+	return 0;
+}
+
+/*
+ * Get wakeup object of heap (Created at the first call)
+ */
+DUK_INTERNAL dux_wakeup *dux_get_wakeup(duk_context *ctx)
+{
+	dux_wakeup *wakeup;
+	pthread_condattr_t attr;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	if (duk_get_prop_string(ctx, -1, DUX_IPK_WAKEUP))
+	{
+		/* [ ... stash obj ] */
+		duk_get_prop_string(ctx, -1, DUX_IPK_WAKEUP);
+		/* [ ... stash obj ptr ] */
+		wakeup = (dux_wakeup *)duk_get_pointer(ctx, -1);
+		duk_pop_3(ctx);
+		/* [ ... ] */
+		return wakeup;
+	}
+	duk_pop(ctx);
+	/* [ ... stash ] */
+
+	wakeup = (dux_wakeup *)duk_alloc(ctx, sizeof(*wakeup));
+	if (!wakeup)
+	{
+		duk_pop(ctx);
+		/* [ ... ] */
+		return NULL;
+	}
+	pthread_mutex_init(&wakeup->lock, NULL);
+	pthread_condattr_init(&attr);
+#if defined(__linux__)
+	pthread_condattr_setclock(&attr, DUX_WAKEUP_CLOCK);
+#endif
+	pthread_cond_init(&wakeup->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	wakeup->refs = 1;
+	wakeup->posted = 1;
+
+	duk_push_object(ctx);
+	/* [ ... stash obj ] */
+	duk_push_pointer(ctx, wakeup);
+	duk_put_prop_string(ctx, -2, DUX_IPK_WAKEUP);
+	duk_push_c_function(ctx, wakeup_finalizer, 1);
+	duk_set_finalizer(ctx, -2);
+	/* [ ... stash obj ] */
+	duk_put_prop_string(ctx, -2, DUX_IPK_WAKEUP);
+	/* [ ... stash ] */
+	duk_pop(ctx);
+	/* [ ... ] */
+	return wakeup;
+}
+
+/*
+ * Add reference to wakeup object
+ * (Holders which may post from other threads must keep a reference)
+ */
+DUK_INTERNAL dux_wakeup *dux_wakeup_ref(dux_wakeup *wakeup)
+{
+	if (wakeup)
+	{
+		++wakeup->refs;
+	}
+	return wakeup;
+}
+
+/*
+ * Release reference to wakeup object
+ */
+DUK_INTERNAL void dux_wakeup_release(duk_context *ctx, dux_wakeup *wakeup)
+{
+	if ((!wakeup) || (--wakeup->refs > 0))
+	{
+		return;
+	}
+	pthread_cond_destroy(&wakeup->cond);
+	pthread_mutex_destroy(&wakeup->lock);
+	duk_free(ctx, wakeup);
+}
+
+/*
+ * Post wakeup (Thread-safe)
+ */
+DUK_INTERNAL void dux_wakeup_post(dux_wakeup *wakeup)
+{
+	if (!wakeup)
+	{
+		return;
+	}
+	pthread_mutex_lock(&wakeup->lock);
+	wakeup->posted = 1;
+	pthread_cond_signal(&wakeup->cond);
+	pthread_mutex_unlock(&wakeup->lock);
+}
+#endif  /* !DUX_OPT_NO_WAIT */
+
+/*
+ * Wait for next event and run tick handlers (timeout in nanoseconds)
+ */
+DUK_LOCAL duk_bool_t tick_wait_ns(duk_context *ctx, duk_int64_t timeout)
+{
+#if !defined(DUX_OPT_NO_WAIT)
+	dux_wakeup *wakeup;
+	duk_int64_t next;
 
-	return (result & DUX_TICK_RET_CONTINUE) ? 1 : 0;
+	wakeup = dux_get_wakeup(ctx);
+	next = dux_timer_next_expiry(ctx);
+	if ((next >= 0) && ((timeout < 0) || (next < timeout)))
+	{
+		timeout = next;
+	}
+	if (wakeup)
+	{
+		wakeup_wait(wakeup, timeout);
+	}
+#endif  /* !DUX_OPT_NO_WAIT */
+	return dux_tick(ctx);
+}
+
+/*
+ * Wait for next event and run tick handlers
+ */
+DUK_EXTERNAL duk_bool_t dux_tick_wait(duk_context *ctx, duk_int_t timeout)
+{
+	return tick_wait_ns(ctx, (timeout < 0) ? -1 : (duk_int64_t)timeout * 1000000LL);
+}
+
+/*
+ * Run event loop
+ */
+DUK_EXTERNAL duk_bool_t dux_run(duk_context *ctx, duk_int_t timeout)
+{
+#if !defined(DUX_OPT_NO_WAIT)
+	duk_uint64_t deadline;
+	duk_uint64_t now;
+
+	if (timeout < 0)
+	{
+		while (tick_wait_ns(ctx, -1))
+		{
+		}
+		return 0;
+	}
+	now = wakeup_current();
+	deadline = now + (duk_uint64_t)timeout * 1000000ULL;
+	do
+	{
+		if (!tick_wait_ns(ctx, (duk_int64_t)(deadline - now)))
+		{
+			return 0;
+		}
+		now = wakeup_current();
+	}
+	while (now < deadline);
+	return 1;
+#else   /* DUX_OPT_NO_WAIT */
+	/* Timeout is not supported without wait feature */
+	while (dux_tick(ctx))
+	{
+		if (timeout == 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+#endif  /* DUX_OPT_NO_WAIT */
+}
+
+/*
+ * Set budget of promise jobs per tick
+ */
+DUK_EXTERNAL void dux_set_promise_budget(duk_context *ctx, duk_uint_t max_jobs, duk_uint_t max_time)
+{
+#if !defined(DUX_OPT_NO_PROMISE) && !defined(DUX_OPT_STANDARD_PROMISE)
+	dux_promise_set_budget(ctx, max_jobs, max_time);
+#else
+	(void)ctx;
+	(void)max_jobs;
+	(void)max_time;
+#endif
+}
+
+/*
+ * Get number of promise jobs waiting in the queue
+ */
+DUK_EXTERNAL duk_uint_t dux_get_promise_queue_depth(duk_context *ctx)
+{
+#if !defined(DUX_OPT_NO_PROMISE) && !defined(DUX_OPT_STANDARD_PROMISE)
+	return dux_promise_queue_depth(ctx);
+#else
+	(void)ctx;
+	return 0;
+#endif
 }
 
 /*
@@ -92,8 +471,398 @@ DUK_INTERNAL duk_errcode_t dux_invoke_initializers(duk_context *ctx, ...)
 	return result;
 }
 
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+/*
+ * Get current time for loop statistics (in nanoseconds)
+ */
+DUK_LOCAL duk_uint64_t loop_stats_current(void)
+{
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_TIMER)
+	return dux_timer_arch_current_ns();
+#elif !defined(DUX_OPT_NO_WAIT)
+	return wakeup_current();
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Get statistics table of heap (Created at the first call)
+ */
+DUK_LOCAL dux_loop_stats_table *loop_stats_get_table(duk_context *ctx)
+{
+	dux_loop_stats_table *table;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_LOOP_STATS))
+	{
+		/* [ ... stash undefined ] */
+		duk_pop(ctx);
+		table = (dux_loop_stats_table *)duk_push_fixed_buffer(ctx, sizeof(*table));
+		memset(table, 0, sizeof(*table));
+		table->current = -1;
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, -3, DUX_IPK_LOOP_STATS);
+	}
+	/* [ ... stash buf ] */
+	table = (dux_loop_stats_table *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	return table;
+}
+
+/*
+ * Find (or add) statistics entry for tick handler
+ */
+DUK_LOCAL duk_int_t loop_stats_find(dux_loop_stats_table *table, const char *name)
+{
+	duk_uint_t index;
+
+	for (index = 0; index < table->count; ++index)
+	{
+		if ((table->entries[index].name == name) ||
+			(strcmp(table->entries[index].name, name) == 0))
+		{
+			return (duk_int_t)index;
+		}
+	}
+	if (table->count >= DUX_LOOP_STATS_MAX)
+	{
+		return -1;
+	}
+	table->entries[index].name = name;
+	return (duk_int_t)(table->count++);
+}
+
+/*
+ * Add number of jobs run by current tick handler
+ */
+DUK_INTERNAL void dux_loop_stats_add_jobs(duk_context *ctx, duk_uint_t jobs)
+{
+	dux_loop_stats_table *table;
+
+	if (jobs == 0)
+	{
+		return;
+	}
+	table = loop_stats_get_table(ctx);
+	if (table && (table->current >= 0))
+	{
+		table->entries[table->current].jobs += jobs;
+	}
+}
+#endif  /* !DUX_OPT_NO_LOOP_STATS */
+
+/*
+ * Get event loop statistics
+ */
+DUK_EXTERNAL duk_uint_t dux_get_loop_stats(duk_context *ctx, dux_loop_stats *stats, duk_uint_t max)
+{
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+	dux_loop_stats_table *table;
+	dux_loop_stats_entry *entry;
+	duk_uint_t index;
+
+	table = loop_stats_get_table(ctx);
+	if (!table)
+	{
+		return 0;
+	}
+	for (index = 0; (index < table->count) && (index < max); ++index)
+	{
+		entry = &table->entries[index];
+		stats[index].name = entry->name;
+		stats[index].calls = entry->calls;
+		stats[index].jobs = entry->jobs;
+		stats[index].total_time = (duk_double_t)entry->total_time / 1000000.0;
+		stats[index].max_time = (duk_double_t)entry->max_time / 1000000.0;
+	}
+	return table->count;
+#else   /* DUX_OPT_NO_LOOP_STATS */
+	(void)ctx;
+	(void)stats;
+	(void)max;
+	return 0;
+#endif  /* DUX_OPT_NO_LOOP_STATS */
+}
+
+/*
+ * Reset event loop statistics
+ */
+DUK_EXTERNAL void dux_reset_loop_stats(duk_context *ctx)
+{
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+	dux_loop_stats_table *table;
+	duk_uint_t index;
+
+	table = loop_stats_get_table(ctx);
+	if (!table)
+	{
+		return;
+	}
+	for (index = 0; index < table->count; ++index)
+	{
+		table->entries[index].calls = 0;
+		table->entries[index].jobs = 0;
+		table->entries[index].total_time = 0;
+		table->entries[index].max_time = 0;
+	}
+#else   /* DUX_OPT_NO_LOOP_STATS */
+	(void)ctx;
+#endif  /* DUX_OPT_NO_LOOP_STATS */
+}
+
+/*
+ * Allocator with usage tracking (for duk_create_heap with dux_memory_usage as udata)
+ */
+DUK_EXTERNAL void *dux_memory_alloc(void *udata, duk_size_t size)
+{
+	dux_memory_usage *usage = (dux_memory_usage *)udata;
+	dux_memory_header *header;
+
+	header = (dux_memory_header *)malloc(sizeof(*header) + size);
+	if (!header)
+	{
+		return NULL;
+	}
+	header->size = size;
+	usage->current += size;
+	if (usage->current > usage->peak)
+	{
+		usage->peak = usage->current;
+	}
+	return header + 1;
+}
+
+/*
+ * Reallocator with usage tracking
+ */
+DUK_EXTERNAL void *dux_memory_realloc(void *udata, void *ptr, duk_size_t size)
+{
+	dux_memory_usage *usage = (dux_memory_usage *)udata;
+	dux_memory_header *header;
+	duk_size_t old_size;
+
+	if (!ptr)
+	{
+		return dux_memory_alloc(udata, size);
+	}
+	if (size == 0)
+	{
+		dux_memory_free(udata, ptr);
+		return NULL;
+	}
+	header = ((dux_memory_header *)ptr) - 1;
+	old_size = header->size;
+	header = (dux_memory_header *)realloc(header, sizeof(*header) + size);
+	if (!header)
+	{
+		return NULL;
+	}
+	header->size = size;
+	usage->current = usage->current - old_size + size;
+	if (usage->current > usage->peak)
+	{
+		usage->peak = usage->current;
+	}
+	return header + 1;
+}
+
+/*
+ * Deallocator with usage tracking
+ */
+DUK_EXTERNAL void dux_memory_free(void *udata, void *ptr)
+{
+	dux_memory_usage *usage = (dux_memory_usage *)udata;
+	dux_memory_header *header;
+
+	if (!ptr)
+	{
+		return;
+	}
+	header = ((dux_memory_header *)ptr) - 1;
+	usage->current -= header->size;
+	free(header);
+}
+
+/*
+ * Get current heap usage (0 if heap is not created with dux_memory_alloc)
+ */
+DUK_INTERNAL duk_size_t dux_memory_current(duk_context *ctx)
+{
+	duk_memory_functions funcs;
+
+	duk_get_memory_functions(ctx, &funcs);
+	if ((funcs.alloc_func != dux_memory_alloc) || (!funcs.udata))
+	{
+		return 0;
+	}
+	return ((dux_memory_usage *)funcs.udata)->current;
+}
+
+/*
+ * Record heap usage grown from before
+ */
+DUK_INTERNAL void dux_memory_record(duk_context *ctx, const char *name, duk_size_t before)
+{
+	dux_memory_table *table;
+	duk_size_t after;
+	duk_uint_t index;
+
+	if (before == 0)
+	{
+		return;
+	}
+	after = dux_memory_current(ctx);
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_MEMORY_STATS))
+	{
+		/* [ ... stash undefined ] */
+		duk_pop(ctx);
+		table = (dux_memory_table *)duk_push_fixed_buffer(ctx, sizeof(*table));
+		memset(table, 0, sizeof(*table));
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, -3, DUX_IPK_MEMORY_STATS);
+	}
+	/* [ ... stash buf ] */
+	table = (dux_memory_table *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+
+	for (index = 0; index < table->count; ++index)
+	{
+		if (strncmp(table->entries[index].name, name, sizeof(table->entries[index].name) - 1) == 0)
+		{
+			break;
+		}
+	}
+	if (index >= DUX_MEMORY_STATS_MAX)
+	{
+		return;
+	}
+	if (index == table->count)
+	{
+		strncpy(table->entries[index].name, name, sizeof(table->entries[index].name) - 1);
+		table->entries[index].bytes = 0;
+		++table->count;
+	}
+	table->entries[index].bytes += (duk_int_t)(after - before);
+}
+
+/*
+ * Get heap usage per module
+ */
+DUK_EXTERNAL duk_uint_t dux_get_memory_stats(duk_context *ctx, dux_memory_stats *stats, duk_uint_t max)
+{
+	dux_memory_table *table;
+	duk_uint_t index;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_MEMORY_STATS);
+	/* [ ... stash buf/undefined ] */
+	table = (dux_memory_table *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	if (!table)
+	{
+		return 0;
+	}
+	for (index = 0; (index < table->count) && (index < max); ++index)
+	{
+		stats[index].name = table->entries[index].name;
+		stats[index].bytes = table->entries[index].bytes;
+	}
+	return table->count;
+}
+
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+/*
+ * Getter of lazy global (Runs initializer and replaces itself)
+ */
+DUK_LOCAL duk_ret_t lazy_global_getter(duk_context *ctx)
+{
+	dux_initializer init;
+	const char *name;
+	duk_size_t before;
+
+	/* [  ] */
+	duk_push_current_function(ctx);
+	duk_get_prop_string(ctx, 0, DUX_IPK_LAZY_INIT);
+	duk_get_prop_string(ctx, 0, DUX_IPK_LAZY_NAME);
+	/* [ func pointer name ] */
+	init = (dux_initializer)duk_get_pointer(ctx, 1);
+	name = duk_get_string(ctx, 2);
+	duk_push_global_object(ctx);
+	duk_dup(ctx, 2);
+	/* [ func pointer name global name ] */
+	duk_del_prop(ctx, 3);
+	/* [ func pointer name global ] */
+	before = dux_memory_current(ctx);
+	if ((*init)(ctx) != DUK_ERR_NONE)
+	{
+		return duk_generic_error(ctx, "Cannot initialize %s", name);
+	}
+	dux_memory_record(ctx, name, before);
+	duk_get_prop_string(ctx, 3, name);
+	/* [ func pointer name global value ] */
+	return 1; /* return value */
+}
+
+/*
+ * Setter of lazy global (Replaces itself without initialization)
+ */
+DUK_LOCAL duk_ret_t lazy_global_setter(duk_context *ctx)
+{
+	/* [ value ] */
+	duk_push_global_object(ctx);
+	duk_push_current_function(ctx);
+	duk_get_prop_string(ctx, 2, DUX_IPK_LAZY_NAME);
+	/* [ value global func name ] */
+	duk_dup(ctx, 0);
+	/* [ value global func name value ] */
+	duk_def_prop(ctx, 1, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_FORCE |
+			DUK_DEFPROP_SET_WRITABLE | DUK_DEFPROP_SET_CONFIGURABLE);
+	return 0; /* return undefined */
+}
+
+/*
+ * Define global which is initialized on first access
+ */
+DUK_INTERNAL duk_errcode_t dux_define_lazy_global(duk_context *ctx, const char *name, dux_initializer init)
+{
+	duk_int_t index;
+
+	/* [ ... ] */
+	duk_push_global_object(ctx);
+	duk_push_string(ctx, name);
+	duk_push_c_function(ctx, lazy_global_getter, 0);
+	duk_push_c_function(ctx, lazy_global_setter, 1);
+	/* [ ... global name getter setter ] */
+	for (index = -2; index <= -1; ++index)
+	{
+		duk_push_pointer(ctx, (void *)init);
+		duk_put_prop_string(ctx, index - 1, DUX_IPK_LAZY_INIT);
+		duk_push_string(ctx, name);
+		duk_put_prop_string(ctx, index - 1, DUX_IPK_LAZY_NAME);
+	}
+	duk_def_prop(ctx, -4, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_HAVE_SETTER |
+			DUK_DEFPROP_FORCE | DUK_DEFPROP_SET_CONFIGURABLE);
+	/* [ ... global ] */
+	duk_pop(ctx);
+	/* [ ... ] */
+	return DUK_ERR_NONE;
+}
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
+
 /*
  * Invoker for tick handlers
+ * (Arguments are pairs of handler and name, terminated by NULL)
  */
 DUK_INTERNAL duk_int_t dux_invoke_tick_handlers(duk_context *ctx, ...)
 {
@@ -102,17 +871,51 @@ DUK_INTERNAL duk_int_t dux_invoke_tick_handlers(duk_context *ctx, ...)
 #endif
 	duk_int_t result = 0;
 	dux_tick_handler tick;
+	const char *name;
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+	dux_loop_stats_table *table;
+	dux_loop_stats_entry *entry;
+	duk_int_t index;
+	duk_int_t prev = -1;
+	duk_uint64_t start = 0;
+	duk_uint64_t elapsed;
+#endif
 	va_list args;
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+	table = loop_stats_get_table(ctx);
+#endif
 	va_start(args, ctx);
 	while ((result & DUX_TICK_RET_ABORT) == 0) {
 		tick = va_arg(args, dux_tick_handler);
 		if (!tick) {
 			break;
 		}
+		name = va_arg(args, const char *);
 #ifdef DEBUG
-		printf("[%d] tick:%p (top:%d)\n", level++, tick, duk_get_top(ctx));
+		printf("[%d] tick:%s (top:%d)\n", level++, name, duk_get_top(ctx));
 #endif
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+		index = table ? loop_stats_find(table, name) : -1;
+		if (index >= 0) {
+			prev = table->current;
+			table->current = index;
+			start = loop_stats_current();
+		}
 		result |= (*tick)(ctx);
+		if (index >= 0) {
+			elapsed = loop_stats_current() - start;
+			table->current = prev;
+			entry = &table->entries[index];
+			++entry->calls;
+			entry->total_time += elapsed;
+			if (elapsed > entry->max_time) {
+				entry->max_time = elapsed;
+			}
+		}
+#else
+		(void)name;
+		result |= (*tick)(ctx);
+#endif
 #ifdef DEBUG
 		printf("[%d] => %d (top:%d)\n", --level, result, duk_get_top(ctx));
 #endif
@@ -305,7 +1108,7 @@ fail:
 	return 0;
 }
 
-DUK_INTERNAL duk_int_t dux_read_file(duk_context *ctx, const char *path)
+DUK_INTERNAL const dux_file_accessor *dux_get_file_accessor(duk_context *ctx)
 {
 	const dux_file_accessor *accessor;
 
@@ -316,10 +1119,323 @@ DUK_INTERNAL duk_int_t dux_read_file(duk_context *ctx, const char *path)
 	accessor = (const dux_file_accessor *)duk_get_pointer(ctx, -1);
 	duk_pop_2(ctx);
 	/* [ ... ] */
+	return accessor;
+}
+
+/*
+ * Embedded modules (Number of entries is counted once in dux_set_bundle)
+ */
+typedef struct dux_bundle_table
+{
+	const dux_bundle_entry *entries;
+	duk_size_t count;
+} dux_bundle_table;
+
+/*
+ * Set embedded modules
+ */
+DUK_EXTERNAL void dux_set_bundle(duk_context *ctx, const dux_bundle_entry *bundle)
+{
+	dux_bundle_table *table;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	if (bundle) {
+		table = (dux_bundle_table *)duk_push_fixed_buffer(ctx, sizeof(*table));
+		table->entries = bundle;
+		for (table->count = 0; bundle[table->count].path; ++table->count) {
+		}
+		/* [ ... stash buf ] */
+		duk_put_prop_string(ctx, -2, DUX_IPK_BUNDLE);
+	} else {
+		duk_del_prop_string(ctx, -1, DUX_IPK_BUNDLE);
+	}
+	/* [ ... stash ] */
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Find embedded module (binary search)
+ */
+DUK_LOCAL const dux_bundle_entry *bundle_find(duk_context *ctx, const char *path)
+{
+	const dux_bundle_table *table;
+	const dux_bundle_entry *bundle;
+	duk_size_t lower, upper, middle;
+	int diff;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	duk_get_prop_string(ctx, -1, DUX_IPK_BUNDLE);
+	table = (const dux_bundle_table *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	if (!table) {
+		return NULL;
+	}
+	bundle = table->entries;
+	upper = table->count;
+	lower = 0;
+	while (lower < upper) {
+		middle = (lower + upper) / 2;
+		diff = strcmp(path, bundle[middle].path);
+		if (diff == 0) {
+			return &bundle[middle];
+		} else if (diff < 0) {
+			upper = middle;
+		} else {
+			lower = middle + 1;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Get view of file from bundle or mapper (Returns false if not available)
+ */
+DUK_LOCAL duk_bool_t file_map(duk_context *ctx, const dux_file_accessor *accessor,
+		const char *path, dux_file_view *view)
+{
+	const dux_bundle_entry *entry;
+
+	entry = bundle_find(ctx, path);
+	if (entry) {
+		view->data = entry->data;
+		view->len = entry->len;
+		view->handle = NULL;
+		view->mapped = 0;
+		return 1;
+	}
+	if (accessor && accessor->map && accessor->unmap &&
+		((*accessor->map)(ctx, path, &view->data, &view->len, &view->handle) == DUK_EXEC_SUCCESS)) {
+		view->mapped = 1;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Release view of file
+ */
+DUK_LOCAL void file_unmap(duk_context *ctx, const dux_file_accessor *accessor, dux_file_view *view)
+{
+	if (view->mapped) {
+		(*accessor->unmap)(ctx, view->data, view->len, view->handle);
+	}
+}
+
+/*
+ * Read whole file by opener or reader into buffer with spaces reserved before
+ * and after its content (Pushes buffer or error)
+ */
+DUK_LOCAL duk_int_t file_read_all(duk_context *ctx, const dux_file_accessor *accessor, const char *path,
+		duk_size_t head, duk_size_t tail)
+{
+	void *handle;
+	duk_size_t size;
+	duk_size_t offset;
+	duk_int_t len = 0;
+	duk_uint8_t *buf;
+	const void *data;
+
+	if (accessor && accessor->open && accessor->read && accessor->close) {
+		handle = (*accessor->open)(ctx, path, &size);
+		if (handle) {
+			// Read chunks directly into the buffer
+			buf = (duk_uint8_t *)duk_push_dynamic_buffer(ctx, head + size + tail);
+			/* [ ... buf ] */
+			for (offset = 0; offset < size; offset += len) {
+				len = (*accessor->read)(ctx, handle, buf + head + offset, size - offset);
+				if (len <= 0) {
+					break;
+				}
+			}
+			(*accessor->close)(ctx, handle);
+			if (len < 0) {
+				duk_pop(ctx);
+				duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot read file: %s", path);
+				/* [ ... err ] */
+				return DUK_EXEC_ERROR;
+			}
+			if (offset < size) {
+				duk_resize_buffer(ctx, -1, head + offset + tail);
+			}
+			return DUK_EXEC_SUCCESS;
+		}
+	}
 	if ((!accessor) || (!accessor->reader)) {
 		duk_push_error_object(ctx, DUK_ERR_ERROR, "No file reader");
 		/* [ ... err ] */
 		return DUK_EXEC_ERROR;
 	}
-	return (*accessor->reader)(ctx, path);
+	if ((*accessor->reader)(ctx, path) != DUK_EXEC_SUCCESS) {
+		/* [ ... err ] */
+		return DUK_EXEC_ERROR;
+	}
+	/* [ ... buf|string ] */
+	if ((head == 0) && (tail == 0)) {
+		if (!duk_is_buffer_data(ctx, -1)) {
+			duk_to_buffer(ctx, -1, NULL);
+		}
+		/* [ ... buf ] */
+		return DUK_EXEC_SUCCESS;
+	}
+	// Data given by reader must be copied to make spaces
+	if (duk_is_buffer_data(ctx, -1)) {
+		data = duk_get_buffer_data(ctx, -1, &size);
+	} else {
+		data = duk_to_lstring(ctx, -1, &size);
+	}
+	buf = (duk_uint8_t *)duk_push_fixed_buffer(ctx, head + size + tail);
+	memcpy(buf + head, data, size);
+	/* [ ... buf|string buf ] */
+	duk_remove(ctx, -2);
+	/* [ ... buf ] */
+	return DUK_EXEC_SUCCESS;
+}
+
+/*
+ * Open file for sequential reading
+ * (Pushes data or undefined on success, or pushes error)
+ */
+DUK_INTERNAL duk_int_t dux_open_file_stream(duk_context *ctx, const char *path, dux_file_stream *stream)
+{
+	const dux_file_accessor *accessor = dux_get_file_accessor(ctx);
+	duk_size_t size;
+
+	stream->accessor = accessor;
+	stream->handle = NULL;
+	stream->offset = 0;
+	stream->view.mapped = 0;
+	if (file_map(ctx, accessor, path, &stream->view)) {
+		stream->data = (const duk_uint8_t *)stream->view.data;
+		stream->len = stream->view.len;
+		duk_push_undefined(ctx);
+		/* [ ... undefined ] */
+		return DUK_EXEC_SUCCESS;
+	}
+	if (accessor && accessor->open && accessor->read && accessor->close) {
+		stream->handle = (*accessor->open)(ctx, path, &size);
+		if (stream->handle) {
+			// Chunks are read into stream->chunk
+			stream->data = NULL;
+			stream->len = size;
+			duk_push_undefined(ctx);
+			/* [ ... undefined ] */
+			return DUK_EXEC_SUCCESS;
+		}
+	}
+	if ((!accessor) || (!accessor->reader)) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "No file reader");
+		/* [ ... err ] */
+		return DUK_EXEC_ERROR;
+	}
+	if ((*accessor->reader)(ctx, path) != DUK_EXEC_SUCCESS) {
+		/* [ ... err ] */
+		return DUK_EXEC_ERROR;
+	}
+	/* [ ... buf|string ] */
+	if (duk_is_buffer_data(ctx, -1)) {
+		stream->data = (const duk_uint8_t *)duk_get_buffer_data(ctx, -1, &stream->len);
+	} else {
+		stream->data = (const duk_uint8_t *)duk_to_lstring(ctx, -1, &stream->len);
+	}
+	return DUK_EXEC_SUCCESS;
+}
+
+/*
+ * Get next chunk of file (Returns its length, 0 at EOF or negative value on error)
+ */
+DUK_INTERNAL duk_int_t dux_read_file_stream(duk_context *ctx, dux_file_stream *stream, const duk_uint8_t **data)
+{
+	duk_size_t len;
+
+	if (stream->handle) {
+		*data = stream->chunk;
+		return (*stream->accessor->read)(ctx, stream->handle, stream->chunk, sizeof(stream->chunk));
+	}
+
+	// Whole data is given at once
+	len = stream->len - stream->offset;
+	*data = stream->data + stream->offset;
+	stream->offset = stream->len;
+	return (duk_int_t)len;
+}
+
+/*
+ * Close file opened by dux_open_file_stream (Data pushed by open is left)
+ */
+DUK_INTERNAL void dux_close_file_stream(duk_context *ctx, dux_file_stream *stream)
+{
+	if (stream->handle) {
+		(*stream->accessor->close)(ctx, stream->handle);
+		stream->handle = NULL;
+	} else {
+		file_unmap(ctx, stream->accessor, &stream->view);
+		stream->view.mapped = 0;
+	}
+}
+
+/*
+ * Safe call wrapper for duk_load_function()
+ */
+DUK_LOCAL duk_ret_t file_load_function(duk_context *ctx, void *udata)
+{
+	/* [ ... data ] */
+	duk_to_buffer(ctx, -1, NULL);
+	/* [ ... buf ] */
+	duk_load_function(ctx);
+	/* [ ... func ] */
+	return 1;
+}
+
+/*
+ * Read file into buffer with spaces reserved before and after its content
+ * (Used to wrap source without concatenating strings)
+ */
+DUK_INTERNAL duk_int_t dux_read_file(duk_context *ctx, const char *path, duk_size_t head, duk_size_t tail)
+{
+	const dux_file_accessor *accessor = dux_get_file_accessor(ctx);
+	dux_file_view view;
+	duk_uint8_t *buf;
+
+	if (file_map(ctx, accessor, path, &view)) {
+		// Only one copy (to buffer)
+		buf = (duk_uint8_t *)duk_push_fixed_buffer(ctx, head + view.len + tail);
+		memcpy(buf + head, view.data, view.len);
+		file_unmap(ctx, accessor, &view);
+		/* [ ... buf ] */
+		return DUK_EXEC_SUCCESS;
+	}
+	return file_read_all(ctx, accessor, path, head, tail);
+}
+
+/*
+ * Load function from bytecode file (duk_dump_function output)
+ */
+DUK_INTERNAL duk_int_t dux_load_file_function(duk_context *ctx, const char *path)
+{
+	const dux_file_accessor *accessor = dux_get_file_accessor(ctx);
+	dux_file_view view;
+	duk_int_t result;
+
+	if (file_map(ctx, accessor, path, &view)) {
+		// Bytecode is referenced without copy
+		duk_push_external_buffer(ctx);
+		duk_config_buffer(ctx, -1, (void *)view.data, view.len);
+		/* [ ... buf ] */
+		result = duk_safe_call(ctx, file_load_function, NULL, 1, 1);
+		/* [ ... func|err ] */
+		file_unmap(ctx, accessor, &view);
+		return result;
+	}
+	if (file_read_all(ctx, accessor, path, 0, 0) != DUK_EXEC_SUCCESS) {
+		/* [ ... err ] */
+		return DUK_EXEC_ERROR;
+	}
+	/* [ ... buf ] */
+	return duk_safe_call(ctx, file_load_function, NULL, 1, 1);
 }
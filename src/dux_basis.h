@@ -23,10 +23,54 @@ DUK_INTERNAL_DECL const char DUX_KEY_NAME[];
 DUK_INTERNAL_DECL const char DUX_KEY_PROTOTYPE[];
 DUK_INTERNAL_DECL const char DUX_KEY_CONSTRUCTOR[];
 
+/*
+ * Entry of tick handler list (with name for loop statistics)
+ */
+#define DUX_TICK_HANDLER(func, name)    (func), (name),
+
+#if !defined(DUX_LOOP_STATS_MAX)
+#define DUX_LOOP_STATS_MAX  16
+#endif
+
+#if !defined(DUX_MEMORY_STATS_MAX)
+#define DUX_MEMORY_STATS_MAX    32
+#endif
+
+#if !defined(DUX_FILE_STREAM_CHUNK)
+#define DUX_FILE_STREAM_CHUNK   256
+#endif
+
 /*
  * Structures
  */
 
+/*
+ * Region of file which is accessible without copy
+ */
+typedef struct dux_file_view
+{
+	const void *data;
+	duk_size_t len;
+	void *handle;
+	duk_bool_t mapped;
+}
+dux_file_view;
+
+/*
+ * Sequential reader of file (Used to parse file without whole copy)
+ */
+typedef struct dux_file_stream
+{
+	const dux_file_accessor *accessor;
+	dux_file_view view;
+	const duk_uint8_t *data;
+	duk_size_t len;
+	duk_size_t offset;
+	void *handle;
+	duk_uint8_t chunk[DUX_FILE_STREAM_CHUNK];
+}
+dux_file_stream;
+
 typedef struct dux_property_list_entry
 {
 	const char *key;
@@ -40,6 +84,7 @@ dux_property_list_entry;
  */
 typedef duk_errcode_t (*dux_initializer)(duk_context *ctx);
 typedef duk_int_t (*dux_tick_handler)(duk_context *ctx);
+typedef struct dux_wakeup dux_wakeup;
 
 /*
  * Functions
@@ -54,7 +99,51 @@ DUK_INTERNAL_DECL void *dux_convert_to_byte_buffer(duk_context *ctx, duk_idx_t i
 DUK_INTERNAL_DECL duk_int_t dux_require_int_range(duk_context *ctx, duk_idx_t index,
 		duk_int_t minimum, duk_int_t maximum);
 DUK_INTERNAL_DECL duk_bool_t dux_get_array_index(duk_context *ctx, duk_idx_t key_idx, duk_uarridx_t *result);
-DUK_INTERNAL_DECL duk_ret_t dux_read_file(duk_context *ctx, const char *path);
+DUK_INTERNAL_DECL const dux_file_accessor *dux_get_file_accessor(duk_context *ctx);
+DUK_INTERNAL_DECL duk_int_t dux_read_file(duk_context *ctx, const char *path, duk_size_t head, duk_size_t tail);
+DUK_INTERNAL_DECL duk_int_t dux_load_file_function(duk_context *ctx, const char *path);
+DUK_INTERNAL_DECL duk_int_t dux_open_file_stream(duk_context *ctx, const char *path, dux_file_stream *stream);
+DUK_INTERNAL_DECL duk_int_t dux_read_file_stream(duk_context *ctx, dux_file_stream *stream, const duk_uint8_t **data);
+DUK_INTERNAL_DECL void dux_close_file_stream(duk_context *ctx, dux_file_stream *stream);
+
+/*
+ * Wakeup of dux_tick_wait (dux_wakeup_post is thread-safe)
+ */
+#if !defined(DUX_OPT_NO_WAIT)
+DUK_INTERNAL_DECL dux_wakeup *dux_get_wakeup(duk_context *ctx);
+DUK_INTERNAL_DECL dux_wakeup *dux_wakeup_ref(dux_wakeup *wakeup);
+DUK_INTERNAL_DECL void dux_wakeup_release(duk_context *ctx, dux_wakeup *wakeup);
+DUK_INTERNAL_DECL void dux_wakeup_post(dux_wakeup *wakeup);
+#else   /* DUX_OPT_NO_WAIT */
+#define dux_get_wakeup(ctx)                 ((dux_wakeup *)NULL)
+#define dux_wakeup_ref(wakeup)              (wakeup)
+#define dux_wakeup_release(ctx, wakeup)     ((void)(wakeup))
+#define dux_wakeup_post(wakeup)             ((void)0)
+#endif  /* DUX_OPT_NO_WAIT */
+#define dux_wakeup_signal(ctx) \
+	dux_wakeup_post(dux_get_wakeup(ctx))
+
+/*
+ * Loop statistics (Jobs are counted for the running tick handler)
+ */
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+DUK_INTERNAL_DECL void dux_loop_stats_add_jobs(duk_context *ctx, duk_uint_t jobs);
+#else   /* DUX_OPT_NO_LOOP_STATS */
+#define dux_loop_stats_add_jobs(ctx, jobs)  ((void)(jobs))
+#endif  /* DUX_OPT_NO_LOOP_STATS */
+
+/*
+ * Memory usage per module (Only when heap is created with dux_memory_alloc)
+ */
+DUK_INTERNAL_DECL duk_size_t dux_memory_current(duk_context *ctx);
+DUK_INTERNAL_DECL void dux_memory_record(duk_context *ctx, const char *name, duk_size_t before);
+
+/*
+ * Globals initialized on first access
+ */
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+DUK_INTERNAL_DECL duk_errcode_t dux_define_lazy_global(duk_context *ctx, const char *name, dux_initializer init);
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
 
 #define dux_to_byte_buffer(ctx, idx, out_size) \
 	dux_convert_to_byte_buffer((ctx), (idx), (out_size), 0)
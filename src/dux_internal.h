@@ -23,6 +23,7 @@ extern "C" {
 #include "dukext.h"
 #include "dux_basis.h"
 #include "dux_modules.h"
+#include "dux_json.h"
 #include "dux_promise.h"
 #include "dux_work.h"
 #include "node/dux_node.h"
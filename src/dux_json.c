@@ -0,0 +1,514 @@
+/*
+ * Streaming JSON loader
+ *
+ * Unlike duk_json_decode(), the source text is never held as a whole.
+ * Chunks from file accessor are parsed directly into the object graph.
+ */
+#include "dux_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Parser state
+ */
+typedef struct json_parser
+{
+	dux_file_stream stream;
+	const char *path;
+	duk_uint_t typed_array_min;
+	const duk_uint8_t *ptr;
+	const duk_uint8_t *end;
+	duk_size_t offset;      /* File offset of end */
+	duk_bool_t eof;
+	duk_idx_t buf_idx;      /* Work buffer for strings and numbers */
+	duk_uint8_t *buf;
+	duk_size_t buf_size;
+	duk_size_t buf_len;
+}
+json_parser;
+
+DUK_LOCAL void json_parse_value(duk_context *ctx, json_parser *parser, duk_int_t depth);
+
+/*
+ * Raise SyntaxError with current position
+ */
+DUK_LOCAL duk_ret_t json_syntax_error(duk_context *ctx, json_parser *parser)
+{
+	return duk_error(ctx, DUK_ERR_SYNTAX_ERROR, "Invalid JSON (%s:%lu)",
+		parser->path, (unsigned long)(parser->offset - (parser->end - parser->ptr)));
+}
+
+/*
+ * Peek next byte (Returns -1 at EOF)
+ */
+DUK_LOCAL duk_int_t json_peek(duk_context *ctx, json_parser *parser)
+{
+	const duk_uint8_t *data;
+	duk_int_t len;
+
+	while (parser->ptr == parser->end) {
+		if (parser->eof) {
+			return -1;
+		}
+		len = dux_read_file_stream(ctx, &parser->stream, &data);
+		if (len < 0) {
+			return duk_error(ctx, DUK_ERR_ERROR, "Cannot read file: %s", parser->path);
+		}
+		if (len == 0) {
+			parser->eof = 1;
+			return -1;
+		}
+		parser->ptr = data;
+		parser->end = data + len;
+		parser->offset += len;
+	}
+	return *parser->ptr;
+}
+
+/*
+ * Get next byte (Returns -1 at EOF)
+ */
+DUK_LOCAL duk_int_t json_next(duk_context *ctx, json_parser *parser)
+{
+	duk_int_t ch = json_peek(ctx, parser);
+
+	if (ch >= 0) {
+		++parser->ptr;
+	}
+	return ch;
+}
+
+/*
+ * Skip white spaces and peek next byte
+ */
+DUK_LOCAL duk_int_t json_skip_space(duk_context *ctx, json_parser *parser)
+{
+	duk_int_t ch;
+
+	for (;;) {
+		ch = json_peek(ctx, parser);
+		if ((ch != ' ') && (ch != '\t') && (ch != '\n') && (ch != '\r')) {
+			return ch;
+		}
+		++parser->ptr;
+	}
+}
+
+/*
+ * Consume literal (true/false/null)
+ */
+DUK_LOCAL void json_expect(duk_context *ctx, json_parser *parser, const char *literal)
+{
+	for (; *literal; ++literal) {
+		if (json_next(ctx, parser) != (duk_uint8_t)*literal) {
+			json_syntax_error(ctx, parser);
+		}
+	}
+}
+
+/*
+ * Append bytes to work buffer
+ */
+DUK_LOCAL void json_append(duk_context *ctx, json_parser *parser, const void *data, duk_size_t len)
+{
+	duk_size_t size;
+
+	if ((parser->buf_len + len) > parser->buf_size) {
+		for (size = parser->buf_size * 2; size < (parser->buf_len + len); size *= 2);
+		parser->buf = (duk_uint8_t *)duk_resize_buffer(ctx, parser->buf_idx, size);
+		parser->buf_size = size;
+	}
+	memcpy(parser->buf + parser->buf_len, data, len);
+	parser->buf_len += len;
+}
+
+/*
+ * Read string (after '"') into work buffer
+ */
+DUK_LOCAL void json_read_string(duk_context *ctx, json_parser *parser)
+{
+	const duk_uint8_t *start;
+	duk_uint8_t utf8[3];
+	duk_size_t len;
+	duk_uint_t cp;
+	duk_int_t ch;
+	int i;
+
+	parser->buf_len = 0;
+	for (;;) {
+		if (json_peek(ctx, parser) < 0) {
+			json_syntax_error(ctx, parser);
+		}
+
+		// Copy plain characters in bulk
+		start = parser->ptr;
+		while ((parser->ptr < parser->end) && (*parser->ptr != '"') &&
+				(*parser->ptr != '\\') && (*parser->ptr >= 0x20)) {
+			++parser->ptr;
+		}
+		if (parser->ptr > start) {
+			json_append(ctx, parser, start, parser->ptr - start);
+		}
+		if (parser->ptr == parser->end) {
+			continue;
+		}
+
+		ch = *parser->ptr++;
+		if (ch == '"') {
+			return;
+		}
+		if (ch != '\\') {
+			// Control character
+			json_syntax_error(ctx, parser);
+		}
+		len = 1;
+		switch (ch = json_next(ctx, parser)) {
+		case '"':
+		case '\\':
+		case '/':
+			utf8[0] = (duk_uint8_t)ch;
+			break;
+		case 'b':
+			utf8[0] = '\b';
+			break;
+		case 'f':
+			utf8[0] = '\f';
+			break;
+		case 'n':
+			utf8[0] = '\n';
+			break;
+		case 'r':
+			utf8[0] = '\r';
+			break;
+		case 't':
+			utf8[0] = '\t';
+			break;
+		case 'u':
+			cp = 0;
+			for (i = 0; i < 4; ++i) {
+				ch = json_next(ctx, parser);
+				if ((ch >= '0') && (ch <= '9')) {
+					ch -= '0';
+				} else if ((ch >= 'a') && (ch <= 'f')) {
+					ch -= ('a' - 10);
+				} else if ((ch >= 'A') && (ch <= 'F')) {
+					ch -= ('A' - 10);
+				} else {
+					json_syntax_error(ctx, parser);
+				}
+				cp = (cp << 4) | ch;
+			}
+			// Surrogates are encoded one by one (same as duk_json_decode)
+			if (cp < 0x80) {
+				utf8[0] = (duk_uint8_t)cp;
+			} else if (cp < 0x800) {
+				utf8[0] = (duk_uint8_t)(0xc0 | (cp >> 6));
+				utf8[1] = (duk_uint8_t)(0x80 | (cp & 0x3f));
+				len = 2;
+			} else {
+				utf8[0] = (duk_uint8_t)(0xe0 | (cp >> 12));
+				utf8[1] = (duk_uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+				utf8[2] = (duk_uint8_t)(0x80 | (cp & 0x3f));
+				len = 3;
+			}
+			break;
+		default:
+			json_syntax_error(ctx, parser);
+			break;
+		}
+		json_append(ctx, parser, utf8, len);
+	}
+}
+
+/*
+ * Read digits into work buffer (Returns number of digits)
+ */
+DUK_LOCAL duk_size_t json_read_digits(duk_context *ctx, json_parser *parser)
+{
+	duk_size_t count = 0;
+	duk_int_t ch;
+	duk_uint8_t digit;
+
+	while (((ch = json_peek(ctx, parser)) >= '0') && (ch <= '9')) {
+		digit = (duk_uint8_t)ch;
+		json_append(ctx, parser, &digit, 1);
+		++parser->ptr;
+		++count;
+	}
+	return count;
+}
+
+/*
+ * Read number
+ */
+DUK_LOCAL duk_double_t json_read_number(duk_context *ctx, json_parser *parser)
+{
+	duk_int_t ch;
+	duk_uint8_t sign;
+
+	parser->buf_len = 0;
+	if (json_peek(ctx, parser) == '-') {
+		json_append(ctx, parser, "-", 1);
+		++parser->ptr;
+	}
+	if (json_peek(ctx, parser) == '0') {
+		json_append(ctx, parser, "0", 1);
+		++parser->ptr;
+	} else if (json_read_digits(ctx, parser) == 0) {
+		json_syntax_error(ctx, parser);
+	}
+	if (json_peek(ctx, parser) == '.') {
+		json_append(ctx, parser, ".", 1);
+		++parser->ptr;
+		if (json_read_digits(ctx, parser) == 0) {
+			json_syntax_error(ctx, parser);
+		}
+	}
+	ch = json_peek(ctx, parser);
+	if ((ch == 'e') || (ch == 'E')) {
+		json_append(ctx, parser, "e", 1);
+		++parser->ptr;
+		ch = json_peek(ctx, parser);
+		if ((ch == '+') || (ch == '-')) {
+			sign = (duk_uint8_t)ch;
+			json_append(ctx, parser, &sign, 1);
+			++parser->ptr;
+		}
+		if (json_read_digits(ctx, parser) == 0) {
+			json_syntax_error(ctx, parser);
+		}
+	}
+	json_append(ctx, parser, "", 1);
+	return strtod((const char *)parser->buf, NULL);
+}
+
+/*
+ * Parse object (at '{')
+ */
+DUK_LOCAL void json_parse_object(duk_context *ctx, json_parser *parser, duk_int_t depth)
+{
+	duk_idx_t obj_idx;
+	duk_int_t ch;
+
+	++parser->ptr;
+	duk_require_stack(ctx, 3);
+	obj_idx = duk_push_object(ctx);
+	/* [ ... obj ] */
+	ch = json_skip_space(ctx, parser);
+	if (ch == '}') {
+		++parser->ptr;
+		return;
+	}
+	for (;;) {
+		if (ch != '"') {
+			json_syntax_error(ctx, parser);
+		}
+		++parser->ptr;
+		json_read_string(ctx, parser);
+		duk_push_lstring(ctx, (const char *)parser->buf, parser->buf_len);
+		/* [ ... obj key ] */
+		if (json_skip_space(ctx, parser) != ':') {
+			json_syntax_error(ctx, parser);
+		}
+		++parser->ptr;
+		json_parse_value(ctx, parser, depth + 1);
+		/* [ ... obj key value ] */
+		// Defined as own property even if key is "__proto__"
+		duk_def_prop(ctx, obj_idx, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_SET_WEC);
+		/* [ ... obj ] */
+		json_skip_space(ctx, parser);
+		ch = json_next(ctx, parser);
+		if (ch == '}') {
+			break;
+		}
+		if (ch != ',') {
+			json_syntax_error(ctx, parser);
+		}
+		ch = json_skip_space(ctx, parser);
+	}
+	duk_compact(ctx, obj_idx);
+}
+
+/*
+ * Replace buffered numbers with array
+ */
+DUK_LOCAL void json_numbers_to_array(duk_context *ctx, duk_idx_t idx,
+		const duk_double_t *numbers, duk_uarridx_t count)
+{
+	duk_uarridx_t index;
+
+	/* [ ... buf ... ] */
+	duk_push_array(ctx);
+	/* [ ... buf ... arr ] */
+	for (index = 0; index < count; ++index) {
+		duk_push_number(ctx, numbers[index]);
+		duk_put_prop_index(ctx, -2, index);
+	}
+	duk_replace(ctx, idx);
+	/* [ ... arr ... ] */
+}
+
+/*
+ * Parse array (at '[')
+ */
+DUK_LOCAL void json_parse_array(duk_context *ctx, json_parser *parser, duk_int_t depth)
+{
+	duk_double_t *numbers = NULL;
+	duk_uarridx_t capacity = 16;
+	duk_uarridx_t index = 0;
+	duk_idx_t arr_idx;
+	duk_int_t ch;
+
+	++parser->ptr;
+	duk_require_stack(ctx, 3);
+	if (parser->typed_array_min > 0) {
+		// Numbers are stored in a buffer until non-number element appears
+		numbers = (duk_double_t *)duk_push_dynamic_buffer(ctx, capacity * sizeof(duk_double_t));
+	} else {
+		duk_push_array(ctx);
+	}
+	arr_idx = duk_get_top_index(ctx);
+	/* [ ... buf|arr ] */
+	ch = json_skip_space(ctx, parser);
+	if (ch == ']') {
+		++parser->ptr;
+	} else {
+		for (;;) {
+			if (numbers && ((ch == '-') || ((ch >= '0') && (ch <= '9')))) {
+				if (index >= capacity) {
+					capacity *= 2;
+					numbers = (duk_double_t *)duk_resize_buffer(ctx, arr_idx, capacity * sizeof(duk_double_t));
+				}
+				numbers[index] = json_read_number(ctx, parser);
+			} else {
+				if (numbers) {
+					json_numbers_to_array(ctx, arr_idx, numbers, index);
+					numbers = NULL;
+				}
+				json_parse_value(ctx, parser, depth + 1);
+				/* [ ... arr value ] */
+				duk_put_prop_index(ctx, arr_idx, index);
+			}
+			++index;
+			json_skip_space(ctx, parser);
+			ch = json_next(ctx, parser);
+			if (ch == ']') {
+				break;
+			}
+			if (ch != ',') {
+				json_syntax_error(ctx, parser);
+			}
+			ch = json_skip_space(ctx, parser);
+		}
+	}
+	if (numbers) {
+		/* [ ... buf ] */
+		if ((index > 0) && (index >= parser->typed_array_min)) {
+			duk_resize_buffer(ctx, arr_idx, index * sizeof(duk_double_t));
+			duk_push_buffer_object(ctx, arr_idx, 0, index * sizeof(duk_double_t), DUK_BUFOBJ_FLOAT64ARRAY);
+			duk_replace(ctx, arr_idx);
+			/* [ ... f64arr ] */
+			return;
+		}
+		json_numbers_to_array(ctx, arr_idx, numbers, index);
+	}
+	/* [ ... arr ] */
+	duk_compact(ctx, arr_idx);
+}
+
+/*
+ * Parse any value
+ */
+DUK_LOCAL void json_parse_value(duk_context *ctx, json_parser *parser, duk_int_t depth)
+{
+	duk_int_t ch;
+
+	if (depth > DUX_JSON_MAX_DEPTH) {
+		duk_error(ctx, DUK_ERR_RANGE_ERROR, "JSON nesting too deep (%s)", parser->path);
+	}
+	ch = json_skip_space(ctx, parser);
+	switch (ch) {
+	case '{':
+		json_parse_object(ctx, parser, depth);
+		break;
+	case '[':
+		json_parse_array(ctx, parser, depth);
+		break;
+	case '"':
+		++parser->ptr;
+		json_read_string(ctx, parser);
+		duk_push_lstring(ctx, (const char *)parser->buf, parser->buf_len);
+		break;
+	case 't':
+		json_expect(ctx, parser, "true");
+		duk_push_true(ctx);
+		break;
+	case 'f':
+		json_expect(ctx, parser, "false");
+		duk_push_false(ctx);
+		break;
+	case 'n':
+		json_expect(ctx, parser, "null");
+		duk_push_null(ctx);
+		break;
+	default:
+		if ((ch == '-') || ((ch >= '0') && (ch <= '9'))) {
+			duk_push_number(ctx, json_read_number(ctx, parser));
+			break;
+		}
+		json_syntax_error(ctx, parser);
+		break;
+	}
+}
+
+/*
+ * Safe call entry of parser
+ */
+DUK_LOCAL duk_ret_t json_parse(duk_context *ctx, void *udata)
+{
+	json_parser *parser = (json_parser *)udata;
+
+	/* [ ... ] */
+	parser->buf_size = 64;
+	parser->buf = (duk_uint8_t *)duk_push_dynamic_buffer(ctx, parser->buf_size);
+	parser->buf_idx = duk_get_top_index(ctx);
+	/* [ ... buf ] */
+	json_parse_value(ctx, parser, 0);
+	/* [ ... buf value ] */
+	if (json_skip_space(ctx, parser) >= 0) {
+		json_syntax_error(ctx, parser);
+	}
+	return 1;
+}
+
+/*
+ * Read JSON file (Pushes value or error. Throws SyntaxError for invalid JSON)
+ * Numeric arrays with typed_array_min or more elements are loaded as Float64Array
+ * (0 means never)
+ */
+DUK_EXTERNAL duk_int_t dux_read_json_file(duk_context *ctx, const char *path, duk_uint_t typed_array_min)
+{
+	json_parser parser;
+	duk_int_t result;
+
+	/* [ ... ] */
+	if (dux_open_file_stream(ctx, path, &parser.stream) != DUK_EXEC_SUCCESS) {
+		/* [ ... err ] */
+		return DUK_EXEC_ERROR;
+	}
+	/* [ ... data|undefined ] */
+	parser.path = path;
+	parser.typed_array_min = typed_array_min;
+	parser.ptr = parser.end = NULL;
+	parser.offset = 0;
+	parser.eof = 0;
+	result = duk_safe_call(ctx, json_parse, &parser, 0, 1);
+	/* [ ... data|undefined value|err ] */
+	dux_close_file_stream(ctx, &parser.stream);
+	duk_remove(ctx, -2);
+	/* [ ... value|err ] */
+	if (result != DUK_EXEC_SUCCESS) {
+		return duk_throw(ctx);
+	}
+	return DUK_EXEC_SUCCESS;
+}
@@ -0,0 +1,16 @@
+#ifndef DUX_JSON_H_INCLUDED
+#define DUX_JSON_H_INCLUDED
+
+/*
+ * Constants
+ */
+
+#if !defined(DUX_JSON_MAX_DEPTH)
+#define DUX_JSON_MAX_DEPTH          64
+#endif
+
+#if !defined(DUX_JSON_TYPED_ARRAY_MIN)
+#define DUX_JSON_TYPED_ARRAY_MIN    0   /* Numeric arrays in .json modules (0: Keep as Array) */
+#endif
+
+#endif  /* !DUX_JSON_H_INCLUDED */
@@ -1,6 +1,9 @@
 #include "dux_internal.h"
+#include <string.h>
 
 DUK_LOCAL const char DUX_IPK_MODULES[]          = DUX_IPK("Modules");
+DUK_LOCAL const char DUX_IPK_MODULES_MISSING[]  = DUX_IPK("mMiss");
+DUK_LOCAL const char DUX_IPK_MODULES_RESOLVED[] = DUX_IPK("mRes");
 DUK_LOCAL const char DUX_KEY_MODULES_CACHE[]    = "cache";
 DUK_LOCAL const char DUX_KEY_MODULES_ID[]       = "id";
 DUK_LOCAL const char DUX_KEY_MODULES_PARENT[]   = "parent";
@@ -8,6 +11,245 @@ DUK_LOCAL const char DUX_KEY_MODULES_EXPORTS[]  = "exports";
 DUK_LOCAL const char DUX_KEY_MODULES_FILENAME[] = "filename";
 DUK_LOCAL const char DUX_KEY_MODULES_REQUIRE[]  = "require";
 DUK_LOCAL const char DUX_KEY_MODULES_MODULE[]   = "module";
+#if !defined(DUX_OPT_NO_HOT_RELOAD)
+DUK_LOCAL const char DUX_IPK_MODULES_HOT[]      = DUX_IPK("mHot");
+DUK_LOCAL const char DUX_IPK_MODULES_HOT_DATA[] = DUX_IPK("mHotD");
+DUK_LOCAL const char DUX_IPK_MODULES_STALE[]    = DUX_IPK("mStale");
+DUK_LOCAL const char DUX_IPK_HOT_ACCEPT[]       = DUX_IPK("hAcc");
+DUK_LOCAL const char DUX_IPK_HOT_DISPOSE[]      = DUX_IPK("hDisp");
+DUK_LOCAL const char DUX_KEY_MODULES_HOT[]      = "hot";
+DUK_LOCAL const char DUX_KEY_HOT_DATA[]         = "data";
+#endif  /* !DUX_OPT_NO_HOT_RELOAD */
+
+DUK_LOCAL const char DUX_MODULES_PROLOGUE[] = "function(__filename,__dirname,require,module,exports){";
+DUK_LOCAL const char DUX_MODULES_EPILOGUE[] = "\n}";
+#define MODULES_PROLOGUE_LEN    (sizeof(DUX_MODULES_PROLOGUE) - 1)
+#define MODULES_EPILOGUE_LEN    (sizeof(DUX_MODULES_EPILOGUE) - 1)
+
+enum
+{
+	MODULES_READ_SOURCE   = 0,
+	MODULES_READ_BYTECODE = 1,
+	MODULES_READ_JSON     = 2,
+};
+
+/**
+ * @func modules_read_file
+ * @brief Read file (or load bytecode / JSON) with negative lookup cache
+ */
+DUK_LOCAL duk_int_t modules_read_file(duk_context *ctx, const char *path, duk_int_t kind)
+{
+	duk_int_t result;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_MODULES_MISSING);
+	/* [ ... stash missing ] */
+	if (duk_get_prop_string(ctx, -1, path)) {
+		// Known to be missing (No error object is created)
+		/* [ ... stash missing true ] */
+		duk_pop_3(ctx);
+		duk_push_undefined(ctx);
+		/* [ ... undefined ] */
+		return DUK_EXEC_ERROR;
+	}
+	duk_pop(ctx);
+	/* [ ... stash missing ] */
+	switch (kind) {
+	case MODULES_READ_BYTECODE:
+		result = dux_load_file_function(ctx, path);
+		break;
+	case MODULES_READ_JSON:
+		// Parsed while reading (Throws SyntaxError)
+		result = dux_read_json_file(ctx, path, DUX_JSON_TYPED_ARRAY_MIN);
+		break;
+	default:
+		// Read into buffer with spaces for module wrapper
+		result = dux_read_file(ctx, path, MODULES_PROLOGUE_LEN, MODULES_EPILOGUE_LEN);
+		break;
+	}
+	if (result == DUK_EXEC_SUCCESS) {
+		/* [ ... stash missing buf|func|object ] */
+		duk_replace(ctx, -3);
+		duk_pop(ctx);
+		/* [ ... data ] */
+		return DUK_EXEC_SUCCESS;
+	}
+	/* [ ... stash missing err ] */
+	duk_push_true(ctx);
+	duk_put_prop_string(ctx, -3, path);
+	duk_replace(ctx, -3);
+	duk_pop(ctx);
+	/* [ ... err ] */
+	return DUK_EXEC_ERROR;
+}
+
+#if !defined(DUX_OPT_NO_HOT_RELOAD) && !defined(DUX_OPT_NO_BYTECODE_CACHE)
+/**
+ * @func modules_is_stale
+ * @brief Check if file has been changed after its bytecode cache was made
+ */
+DUK_LOCAL duk_bool_t modules_is_stale(duk_context *ctx, const char *filename)
+{
+	duk_bool_t result;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_MODULES_STALE);
+	result = duk_get_prop_string(ctx, -1, filename);
+	duk_pop_3(ctx);
+	/* [ ... ] */
+	return result;
+}
+#else   /* DUX_OPT_NO_HOT_RELOAD || DUX_OPT_NO_BYTECODE_CACHE */
+#define modules_is_stale(ctx, filename) (0)
+#endif  /* DUX_OPT_NO_HOT_RELOAD || DUX_OPT_NO_BYTECODE_CACHE */
+
+#if !defined(DUX_OPT_NO_BYTECODE_CACHE)
+/**
+ * @func modules_push_bytecode_path
+ * @brief Push path of bytecode cache (Returns NULL without push if not cacheable)
+ */
+DUK_LOCAL const char *modules_push_bytecode_path(duk_context *ctx, const char *filename)
+{
+	duk_size_t len;
+
+	if (!filename) {
+		return NULL;
+	}
+	len = strlen(filename);
+	if ((len < 3) || (strcmp(filename + len - 3, ".js") != 0)) {
+		return NULL;
+	}
+	/* [ ... ] */
+	duk_push_string(ctx, filename);
+	duk_push_string(ctx, "c");
+	duk_concat(ctx, 2);
+	/* [ ... path ] */
+	return duk_get_string(ctx, -1);
+}
+
+/**
+ * @func modules_write_bytecode
+ * @brief Store bytecode cache of compiled module
+ */
+DUK_LOCAL void modules_write_bytecode(duk_context *ctx, const char *filename)
+{
+	const dux_file_accessor *accessor;
+	const char *path;
+	duk_idx_t top = duk_get_top(ctx);
+	void *data;
+	duk_size_t len;
+
+	accessor = dux_get_file_accessor(ctx);
+	if ((!accessor) || (!accessor->writer)) {
+		return;
+	}
+	/* [ ... func ] */
+	path = modules_push_bytecode_path(ctx, filename);
+	if (!path) {
+		return;
+	}
+	/* [ ... func path ] */
+	duk_dup(ctx, -2);
+	duk_dump_function(ctx);
+	/* [ ... func path buf ] */
+	data = duk_get_buffer(ctx, -1, &len);
+
+	// Cache is optional. Errors are ignored
+	if ((*accessor->writer)(ctx, path, data, len) == DUK_EXEC_SUCCESS) {
+		duk_set_top(ctx, top + 1);
+		/* [ ... func path ] */
+		duk_push_heap_stash(ctx);
+		duk_get_prop_string(ctx, -1, DUX_IPK_MODULES_MISSING);
+		/* [ ... func path stash missing ] */
+		duk_del_prop_string(ctx, -1, path);
+#if !defined(DUX_OPT_NO_HOT_RELOAD)
+		duk_get_prop_string(ctx, -2, DUX_IPK_MODULES_STALE);
+		/* [ ... func path stash missing stale ] */
+		duk_del_prop_string(ctx, -1, filename);
+#endif  /* !DUX_OPT_NO_HOT_RELOAD */
+	}
+	duk_set_top(ctx, top);
+	/* [ ... func ] */
+}
+#endif  /* !DUX_OPT_NO_BYTECODE_CACHE */
+
+/**
+ * @func modules_read_javascript
+ * @brief Read JavaScript source (or function from its bytecode cache)
+ */
+DUK_LOCAL duk_int_t modules_read_javascript(duk_context *ctx, const char *filename)
+{
+#if !defined(DUX_OPT_NO_BYTECODE_CACHE)
+	const char *path;
+
+	/* [ ... ] */
+	// Stale cache is skipped (New bytecode is written after compilation)
+	path = modules_is_stale(ctx, filename) ? NULL : modules_push_bytecode_path(ctx, filename);
+	if (path) {
+		/* [ ... path ] */
+		if (modules_read_file(ctx, path, MODULES_READ_BYTECODE) == DUK_EXEC_SUCCESS) {
+			/* [ ... path func ] */
+			duk_remove(ctx, -2);
+			/* [ ... func ] */
+			return DUK_EXEC_SUCCESS;
+		}
+		/* [ ... path err ] (No cache or invalid cache) */
+		duk_pop_2(ctx);
+		/* [ ... ] */
+	}
+#endif  /* !DUX_OPT_NO_BYTECODE_CACHE */
+	return modules_read_file(ctx, filename, MODULES_READ_SOURCE);
+}
+
+/**
+ * @func modules_push_source
+ * @brief Push copy of source with spaces for module wrapper
+ */
+DUK_LOCAL void modules_push_source(duk_context *ctx, const void *data, duk_size_t len)
+{
+	duk_uint8_t *buf;
+
+	/* [ ... ] */
+	buf = (duk_uint8_t *)duk_push_fixed_buffer(ctx, MODULES_PROLOGUE_LEN + len + MODULES_EPILOGUE_LEN);
+	memcpy(buf + MODULES_PROLOGUE_LEN, data, len);
+	/* [ ... buf ] */
+}
+
+/**
+ * @func modules_compile
+ * @brief Compile module source with wrapper
+ */
+DUK_LOCAL void modules_compile(duk_context *ctx, const char *filename)
+{
+	const char *source;
+	duk_uint8_t *buf;
+	duk_size_t len;
+
+	/* [ ... source|buf ] */
+	if (!duk_is_buffer_data(ctx, -1)) {
+		source = duk_to_lstring(ctx, -1, &len);
+		modules_push_source(ctx, source, len);
+		duk_remove(ctx, -2);
+	}
+	/* [ ... buf ] */
+
+	// Fill spaces reserved before and after source
+	buf = (duk_uint8_t *)duk_get_buffer_data(ctx, -1, &len);
+	memcpy(buf, DUX_MODULES_PROLOGUE, MODULES_PROLOGUE_LEN);
+	memcpy(buf + len - MODULES_EPILOGUE_LEN, DUX_MODULES_EPILOGUE, MODULES_EPILOGUE_LEN);
+	if (filename) {
+		duk_push_string(ctx, filename);
+	} else {
+		duk_push_undefined(ctx);
+	}
+	/* [ ... buf filename ] */
+	duk_compile_lstring_filename(ctx, DUK_COMPILE_FUNCTION, (const char *)buf, len);
+	/* [ ... buf func ] */
+	duk_remove(ctx, -2);
+	/* [ ... func ] */
+}
 
 /**
  * @func modules_load_javascript
@@ -15,23 +257,16 @@ DUK_LOCAL const char DUX_KEY_MODULES_MODULE[]   = "module";
  */
 DUK_LOCAL duk_ret_t modules_load_javascript(duk_context *ctx)
 {
-	/* [ any parent_module require cache:3 filename:4 source:5 ] */
+	/* [ any parent_module require cache:3 filename:4 source|buf|func:5 ] */
 	const char *filename = duk_get_string(ctx, 4);
 
-	// Add wrapper
-	duk_push_string(ctx, "function(__filename,__dirname,require,module,exports){");
-	/* [ any parent_module require cache:3 filename:4 source:5 prologue:6 ] */
-	duk_swap(ctx, 5, 6);
-	/* [ any parent_module require cache:3 filename:4 prologue:5 source:6 ] */
-	duk_push_string(ctx, "\n}");
-	/* [ any parent_module require cache:3 filename:4 prologue:5 source:6 epilogue:7 ] */
-	duk_concat(ctx, 3);
-	/* [ any parent_module require cache:3 filename:4 wrapped:5 ] */
-	duk_dup(ctx, 4);
-	/* [ any parent_module require cache:3 filename:4 wrapped:5 filename:6 ] */
-
-	// Compile
-	duk_compile(ctx, DUK_COMPILE_FUNCTION);
+	if (!duk_is_function(ctx, 5)) {
+		modules_compile(ctx, filename);
+		/* [ any parent_module require cache:3 filename:4 func:5 ] */
+#if !defined(DUX_OPT_NO_BYTECODE_CACHE)
+		modules_write_bytecode(ctx, filename);
+#endif  /* !DUX_OPT_NO_BYTECODE_CACHE */
+	}
 	/* [ any parent_module require cache:3 filename:4 func:5 ] */
 
 	// Create module instance
@@ -115,6 +350,7 @@ DUK_LOCAL duk_ret_t modules_require_core(duk_context *ctx, const char *name)
 {
 	/* [ name parent_module require cache:3 ] */
 	dux_module_entry entry;
+	duk_size_t before;
 
 	if (!duk_get_prop_string(ctx, 3, name)) {
 		// Not found
@@ -166,8 +402,10 @@ DUK_LOCAL duk_ret_t modules_require_core(duk_context *ctx, const char *name)
 	/* [ name module require cache:3 func:4 bound_require:5 module:6 exports:7 ] */
 
 	// Load module
+	before = dux_memory_current(ctx);
 	duk_call(ctx, 3);
 	/* [ name module require cache:3 retval:4 ] */
+	dux_memory_record(ctx, name, before);
 
 	// Return exports with compaction
 	duk_compact(ctx, 1);
@@ -177,6 +415,75 @@ DUK_LOCAL duk_ret_t modules_require_core(duk_context *ctx, const char *name)
 	return 1;
 }
 
+/**
+ * @func modules_get_resolved
+ * @brief Lookup resolution cache of parent module (Pushes filename if found)
+ */
+DUK_LOCAL duk_bool_t modules_get_resolved(duk_context *ctx, const char *name)
+{
+	/* [ name parent_module require cache:3 ] */
+	if (!duk_is_object(ctx, 1)) {
+		return 0;
+	}
+	if (duk_get_prop_string(ctx, 1, DUX_IPK_MODULES_RESOLVED) &&
+		duk_get_prop_string(ctx, 4, name)) {
+		/* [ name parent_module require cache:3 resolved:4 filename:5 ] */
+		duk_remove(ctx, 4);
+		/* [ name parent_module require cache:3 filename:4 ] */
+		return 1;
+	}
+	duk_set_top(ctx, 4);
+	/* [ name parent_module require cache:3 ] */
+	return 0;
+}
+
+/**
+ * @func modules_store_resolved
+ * @brief Store resolved filename into resolution cache of parent module
+ */
+DUK_LOCAL void modules_store_resolved(duk_context *ctx, duk_idx_t filename_idx)
+{
+	/* [ name parent_module ... ] */
+	if (!duk_is_object(ctx, 1)) {
+		return;
+	}
+	if (!duk_get_prop_string(ctx, 1, DUX_IPK_MODULES_RESOLVED)) {
+		duk_pop(ctx);
+		duk_push_bare_object(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, 1, DUX_IPK_MODULES_RESOLVED);
+	}
+	/* [ name parent_module ... resolved ] */
+	duk_dup(ctx, filename_idx);
+	duk_put_prop_string(ctx, -2, duk_get_string(ctx, 0));
+	duk_pop(ctx);
+	/* [ name parent_module ... ] */
+}
+
+/**
+ * @func modules_load_json
+ * @brief JSON module loader (Parsed object is cached as exports)
+ */
+DUK_LOCAL duk_ret_t modules_load_json(duk_context *ctx, duk_idx_t filename_idx)
+{
+	/* [ name parent_module require cache:3 ... filename ... object ] */
+	modules_store_resolved(ctx, filename_idx);
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_MODULES);
+	duk_remove(ctx, -2);
+	/* [ name parent_module require cache:3 ... object Module ] */
+	duk_dup(ctx, filename_idx);
+	duk_dup(ctx, 1);
+	duk_dup(ctx, filename_idx);
+	duk_new(ctx, 3);
+	/* [ name parent_module require cache:3 ... object module ] */
+	duk_dup(ctx, -2);
+	duk_put_prop_string(ctx, -2, DUX_KEY_MODULES_EXPORTS);
+	duk_put_prop_string(ctx, 3, duk_get_string(ctx, filename_idx));
+	/* [ name parent_module require cache:3 ... object ] */
+	return 1;
+}
+
 /**
  * @func modules_require_file
  * @brief require() implementation for files
@@ -184,19 +491,23 @@ DUK_LOCAL duk_ret_t modules_require_core(duk_context *ctx, const char *name)
 DUK_LOCAL duk_ret_t modules_require_file(duk_context *ctx, const char *name, const char *filename)
 {
 	/* [ name parent_module require cache:3 filename:4 ] */
+	int path_len = strlen(filename);
+	duk_int_t result;
 
-	// Try X as JavaScript
-	if (dux_read_file(ctx, filename) == DUK_EXEC_SUCCESS) {
-		/* [ name parent_module require cache:3 filename:4 source:5 ] */
-		int path_len = strlen(filename);
-		if ((path_len >= 5) && (strcmp(filename + path_len - 5, ".json") == 0)) {
-			// Load JSON object
-			duk_json_decode(ctx, 5);
-			/* [ name parent_module require cache:3 filename:4 source:5 object:6 ] */
-			return 1;
+	if ((path_len >= 5) && (strcmp(filename + path_len - 5, ".json") == 0)) {
+		// Try X as JSON object
+		result = modules_read_file(ctx, filename, MODULES_READ_JSON);
+		if (result == DUK_EXEC_SUCCESS) {
+			/* [ name parent_module require cache:3 filename:4 object:5 ] */
+			return modules_load_json(ctx, 4);
 		}
 	} else {
-		/* [ name parent_module require cache:3 filename:4 undefined:5 ] */
+		// Try X as JavaScript
+		result = modules_read_javascript(ctx, filename);
+	}
+
+	if (result != DUK_EXEC_SUCCESS) {
+		/* [ name parent_module require cache:3 filename:4 undefined|err:5 ] */
 		duk_pop(ctx);
 		/* [ name parent_module require cache:3 filename:4 ] */
 		duk_dup(ctx, 4);
@@ -206,10 +517,10 @@ DUK_LOCAL duk_ret_t modules_require_file(duk_context *ctx, const char *name, con
 		filename = duk_get_string(ctx, 5);
 
 		// Try X.js as JavaScript
-		if (dux_read_file(ctx, filename) == DUK_EXEC_SUCCESS) {
-			/* [ name parent_module require cache:3 filename:4 filename.js:5 source:6 ] */
+		if (modules_read_javascript(ctx, filename) == DUK_EXEC_SUCCESS) {
+			/* [ name parent_module require cache:3 filename:4 filename.js:5 source|func:6 ] */
 			duk_remove(ctx, 4);
-			/* [ name parent_module require cache:3 filename.js:4 source:5 ] */
+			/* [ name parent_module require cache:3 filename.js:4 source|func:5 ] */
 		} else {
 			/* [ name parent_module require cache:3 filename:4 filename.js:5 undefined:6 ] */
 			duk_pop(ctx);
@@ -218,13 +529,20 @@ DUK_LOCAL duk_ret_t modules_require_file(duk_context *ctx, const char *name, con
 			/* [ name parent_module require cache:3 filename:4 filename.json:5 ] */
 			filename = duk_get_string(ctx, 5);
 
-			// Try X.json as JSON object
-			if (dux_read_file(ctx, filename) == DUK_EXEC_SUCCESS) {
-				/* [ name parent_module require cache:3 filename:4 filename.json:5 source:6 ] */
-				// Load JSON object
-				duk_json_decode(ctx, 6);
-				/* [ name parent_module require cache:3 filename:4 filename.json:5 source:6 object:7 ] */
+			if (duk_get_prop_string(ctx, 3, filename)) {
+				// Already loaded with .json extension
+				/* [ name parent_module require cache:3 filename:4 filename.json:5 module:6 ] */
+				modules_store_resolved(ctx, 5);
+				duk_get_prop_string(ctx, 6, DUX_KEY_MODULES_EXPORTS);
+				/* [ name parent_module require cache:3 filename:4 filename.json:5 module:6 exports:7 ] */
 				return 1;
+			}
+			duk_pop(ctx);
+
+			// Try X.json as JSON object
+			if (modules_read_file(ctx, filename, MODULES_READ_JSON) == DUK_EXEC_SUCCESS) {
+				/* [ name parent_module require cache:3 filename:4 filename.json:5 object:6 ] */
+				return modules_load_json(ctx, 5);
 			} else {
 				/* [ name parent_module require cache:3 filename:4 filename.json:5 err:6 ] */
 				return modules_not_found(ctx, name);
@@ -232,7 +550,18 @@ DUK_LOCAL duk_ret_t modules_require_file(duk_context *ctx, const char *name, con
 		}
 	}
 
-	/* [ name parent_module require cache:3 filename:4 source:5 ] */
+	/* [ name parent_module require cache:3 filename:4 source|func:5 ] */
+
+	modules_store_resolved(ctx, 4);
+	if (duk_get_prop_string(ctx, 3, duk_get_string(ctx, 4))) {
+		// Already loaded via another path (e.g. without extension)
+		/* [ name parent_module require cache:3 filename:4 source|func:5 module:6 ] */
+		duk_get_prop_string(ctx, 6, DUX_KEY_MODULES_EXPORTS);
+		/* [ name parent_module require cache:3 filename:4 source|func:5 module:6 exports:7 ] */
+		return 1;
+	}
+	duk_pop(ctx);
+	/* [ name parent_module require cache:3 filename:4 source|func:5 ] */
 
 	// Load JavaScript
 	return modules_load_javascript(ctx);
@@ -250,6 +579,22 @@ DUK_LOCAL duk_ret_t modules_require(duk_context *ctx)
 	duk_get_prop_string(ctx, 2, DUX_KEY_MODULES_CACHE);
 	/* [ name parent_module require cache:3 ] */
 
+	if (((name[0] == '/') || (name[0] == '.')) && modules_get_resolved(ctx, name)) {
+		// Resolved before (No path normalization nor file lookup)
+		/* [ name parent_module require cache:3 filename:4 ] */
+		filename = duk_get_string(ctx, 4);
+		if (duk_get_prop_string(ctx, 3, filename)) {
+			/* [ name parent_module require cache:3 filename:4 module:5 ] */
+			duk_get_prop_string(ctx, 5, DUX_KEY_MODULES_EXPORTS);
+			/* [ name parent_module require cache:3 filename:4 module:5 exports:6 ] */
+			return 1;
+		}
+		/* [ name parent_module require cache:3 filename:4 undefined:5 ] */
+		duk_pop(ctx);
+		/* [ name parent_module require cache:3 filename:4 ] */
+		return modules_require_file(ctx, name, filename);
+	}
+
 	if (name[0] == '/') {
 		// Absolute path
 #if !defined(DUX_OPT_NO_PATH)
@@ -293,6 +638,7 @@ DUK_LOCAL duk_ret_t modules_require(duk_context *ctx)
 	if (duk_get_prop_string(ctx, 3, filename)) {
 		// Cached
 		/* [ name parent_module require cache:3 filename:4 module:5 ] */
+		modules_store_resolved(ctx, 4);
 		duk_get_prop_string(ctx, 5, DUX_KEY_MODULES_EXPORTS);
 		/* [ name parent_module require cache:3 filename:4 module:5 exports:6 ] */
 		return 1;
@@ -306,6 +652,91 @@ DUK_LOCAL duk_ret_t modules_require(duk_context *ctx)
 	return modules_require_file(ctx, name, filename);
 }
 
+#if !defined(DUX_OPT_NO_HOT_RELOAD)
+/**
+ * @func modules_hot_accept
+ * @brief module.hot.accept([errorHandler]) (Re-evaluate this module on update)
+ */
+DUK_LOCAL duk_ret_t modules_hot_accept(duk_context *ctx)
+{
+	/* [ errorHandler ] */
+	duk_push_this(ctx);
+	/* [ errorHandler hot ] */
+	if (duk_is_function(ctx, 0)) {
+		duk_dup(ctx, 0);
+	} else {
+		duk_push_true(ctx);
+	}
+	duk_put_prop_string(ctx, 1, DUX_IPK_HOT_ACCEPT);
+	return 0;
+}
+
+/**
+ * @func modules_hot_dispose
+ * @brief module.hot.dispose(callback) (Called with data object before update)
+ */
+DUK_LOCAL duk_ret_t modules_hot_dispose(duk_context *ctx)
+{
+	/* [ callback ] */
+	duk_require_function(ctx, 0);
+	duk_push_this(ctx);
+	/* [ callback hot ] */
+	duk_dup(ctx, 0);
+	duk_put_prop_string(ctx, 1, DUX_IPK_HOT_DISPOSE);
+	return 0;
+}
+
+DUK_LOCAL const duk_function_list_entry modules_hot_funcs[] = {
+	{ "accept", modules_hot_accept, 1 },
+	{ "dispose", modules_hot_dispose, 1 },
+	{ NULL, NULL, 0 }
+};
+
+/**
+ * @func modules_hot_getter
+ * @brief Getter for module.hot (Created on first access)
+ */
+DUK_LOCAL duk_ret_t modules_hot_getter(duk_context *ctx)
+{
+	/* [  ] */
+	duk_push_this(ctx);
+	/* [ module ] */
+	if (duk_get_prop_string(ctx, 0, DUX_IPK_MODULES_HOT)) {
+		/* [ module hot ] */
+		return 1;
+	}
+	duk_pop(ctx);
+	duk_push_object(ctx);
+	duk_put_function_list(ctx, 1, modules_hot_funcs);
+	/* [ module hot ] */
+
+	// Take over data from disposed module
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, 2, DUX_IPK_MODULES_HOT_DATA);
+	duk_get_prop_string(ctx, 0, DUX_KEY_MODULES_FILENAME);
+	/* [ module hot stash hot_data filename ] */
+	if (duk_is_string(ctx, 4)) {
+		duk_dup(ctx, 4);
+		duk_get_prop(ctx, 3);
+		/* [ module hot stash hot_data filename data ] */
+		duk_put_prop_string(ctx, 1, DUX_KEY_HOT_DATA);
+		duk_del_prop(ctx, 3);
+	}
+	duk_set_top(ctx, 2);
+	/* [ module hot ] */
+	duk_dup(ctx, 1);
+	duk_put_prop_string(ctx, 0, DUX_IPK_MODULES_HOT);
+	return 1;
+}
+
+DUK_LOCAL const dux_property_list_entry modules_proto_props[] = {
+	{ DUX_KEY_MODULES_HOT, modules_hot_getter, NULL },
+	{ NULL, NULL, NULL }
+};
+#else   /* DUX_OPT_NO_HOT_RELOAD */
+#define modules_proto_props NULL
+#endif  /* DUX_OPT_NO_HOT_RELOAD */
+
 /**
  * @func modules_constructor
  * @brief Constructor for Module object
@@ -350,7 +781,7 @@ DUK_INTERNAL duk_errcode_t dux_modules_init(duk_context *ctx)
 	/* [ ... ] */
 	duk_push_heap_stash(ctx);
 	/* [ ... stash ] */
-	dux_push_named_c_constructor(ctx, "Module", modules_constructor, 3, NULL, modules_proto_funcs, NULL, NULL);
+	dux_push_named_c_constructor(ctx, "Module", modules_constructor, 3, NULL, modules_proto_funcs, NULL, modules_proto_props);
 	/* [ ... stash Module ] */
 	duk_get_prop_string(ctx, -1, "prototype");
 	/* [ ... stash Module module_proto ] */
@@ -382,6 +813,14 @@ DUK_INTERNAL duk_errcode_t dux_modules_init(duk_context *ctx)
 	duk_pop(ctx);
 	/* [ ... stash Module ] */
 	duk_put_prop_string(ctx, -2, DUX_IPK_MODULES);
+	duk_push_bare_object(ctx);
+	duk_put_prop_string(ctx, -2, DUX_IPK_MODULES_MISSING);
+#if !defined(DUX_OPT_NO_HOT_RELOAD)
+	duk_push_bare_object(ctx);
+	duk_put_prop_string(ctx, -2, DUX_IPK_MODULES_HOT_DATA);
+	duk_push_bare_object(ctx);
+	duk_put_prop_string(ctx, -2, DUX_IPK_MODULES_STALE);
+#endif  /* !DUX_OPT_NO_HOT_RELOAD */
 	/* [ ... stash ] */
 	duk_pop(ctx);
 	/* [ ... ] */
@@ -408,6 +847,213 @@ DUK_INTERNAL duk_errcode_t dux_modules_register(duk_context *ctx, const char *na
 	return DUK_ERR_NONE;
 }
 
+/**
+ * @func dux_dump_module
+ * @brief Compile module source into bytecode (Used by module bundler)
+ */
+DUK_EXTERNAL void dux_dump_module(duk_context *ctx, const char *filename)
+{
+	/* [ ... source ] */
+	modules_compile(ctx, filename);
+	/* [ ... func ] */
+	duk_dump_function(ctx);
+	/* [ ... buf ] */
+}
+
+/**
+ * @func dux_reset_module_lookup
+ * @brief Forget files known to be missing
+ */
+DUK_EXTERNAL void dux_reset_module_lookup(duk_context *ctx)
+{
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_push_bare_object(ctx);
+	/* [ ... stash missing ] */
+	duk_put_prop_string(ctx, -2, DUX_IPK_MODULES_MISSING);
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+#if !defined(DUX_OPT_NO_HOT_RELOAD)
+/**
+ * @func modules_push_dependents
+ * @brief Append filenames of cached modules which required the file to queue
+ *        (Resolution caches are used as dependency graph)
+ */
+DUK_LOCAL duk_uarridx_t modules_push_dependents(duk_context *ctx, duk_idx_t cache_idx,
+		duk_idx_t queue_idx, const char *filename)
+{
+	duk_uarridx_t count = 0;
+	duk_uarridx_t length = (duk_uarridx_t)duk_get_length(ctx, queue_idx);
+
+	/* [ ... ] */
+	duk_enum(ctx, cache_idx, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	/* [ ... enum ] */
+	while (duk_next(ctx, -1, 1)) {
+		/* [ ... enum parent_filename module ] */
+		if (duk_is_object(ctx, -1) && duk_get_prop_string(ctx, -1, DUX_IPK_MODULES_RESOLVED)) {
+			/* [ ... enum parent_filename module resolved ] */
+			duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+			while (duk_next(ctx, -1, 1)) {
+				/* [ ... enum parent_filename module resolved enum2 name child_filename ] */
+				if (strcmp(duk_get_string(ctx, -1), filename) == 0) {
+					duk_dup(ctx, -6);
+					duk_put_prop_index(ctx, queue_idx, length + count++);
+					duk_pop_2(ctx);
+					break;
+				}
+				duk_pop_2(ctx);
+			}
+			/* [ ... enum parent_filename module resolved enum2 ] */
+			duk_pop(ctx);
+		}
+		/* [ ... enum parent_filename module (resolved|undefined) ] */
+		duk_pop_3(ctx);
+		/* [ ... enum ] */
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+	return count;
+}
+
+/**
+ * @func dux_reload_module
+ * @brief Invalidate changed file and its dependents, then re-evaluate accepting modules
+ */
+DUK_EXTERNAL duk_int_t dux_reload_module(duk_context *ctx, const char *filename)
+{
+	duk_idx_t top = duk_get_top(ctx);
+	duk_idx_t global_idx, cache_idx, stash_idx, queue_idx, visited_idx, accepted_idx;
+	duk_uarridx_t head = 0, tail = 1, accepted = 0, index;
+	duk_int_t result = DUK_EXEC_SUCCESS;
+	duk_bool_t accept;
+	const char *name;
+
+	/* [ ... ] */
+	global_idx = top;
+	duk_get_global_string(ctx, DUX_KEY_MODULES_MODULE);
+	duk_get_prop_string(ctx, global_idx, DUX_KEY_MODULES_REQUIRE);
+	cache_idx = duk_get_top(ctx);
+	duk_get_prop_string(ctx, -1, DUX_KEY_MODULES_CACHE);
+	stash_idx = duk_get_top(ctx);
+	duk_push_heap_stash(ctx);
+	queue_idx = duk_push_array(ctx);
+	visited_idx = duk_push_bare_object(ctx);
+	accepted_idx = duk_push_array(ctx);
+	/* [ ... global_module require cache stash queue visited accepted ] */
+#if !defined(DUX_OPT_NO_PATH)
+	dux_path_normalize(ctx, filename);
+#else   /* DUX_OPT_NO_PATH */
+	duk_push_string(ctx, filename);
+#endif  /* DUX_OPT_NO_PATH */
+	duk_put_prop_index(ctx, queue_idx, 0);
+
+	while (head < tail) {
+		duk_get_prop_index(ctx, queue_idx, head++);
+		name = duk_get_string(ctx, -1);
+		/* [ ... name ] */
+		if (duk_has_prop_string(ctx, visited_idx, name)) {
+			duk_pop(ctx);
+			continue;
+		}
+		duk_push_true(ctx);
+		duk_put_prop_string(ctx, visited_idx, name);
+
+		// Forget file lookups
+		duk_get_prop_string(ctx, stash_idx, DUX_IPK_MODULES_MISSING);
+		duk_del_prop_string(ctx, -1, name);
+		duk_get_prop_string(ctx, stash_idx, DUX_IPK_MODULES_STALE);
+		duk_push_true(ctx);
+		duk_put_prop_string(ctx, -2, name);
+		duk_pop_2(ctx);
+		/* [ ... name ] */
+
+		if ((!duk_get_prop_string(ctx, cache_idx, name)) || (!duk_is_object(ctx, -1))) {
+			// Not loaded
+			duk_pop_2(ctx);
+			continue;
+		}
+		/* [ ... name module ] */
+		accept = 0;
+		if (duk_get_prop_string(ctx, -1, DUX_IPK_MODULES_HOT)) {
+			/* [ ... name module hot ] */
+			if (duk_get_prop_string(ctx, -1, DUX_IPK_HOT_DISPOSE)) {
+				/* [ ... name module hot dispose ] */
+				duk_get_prop_string(ctx, stash_idx, DUX_IPK_MODULES_HOT_DATA);
+				duk_push_object(ctx);
+				duk_dup_top(ctx);
+				duk_put_prop_string(ctx, -3, name);
+				duk_remove(ctx, -2);
+				/* [ ... name module hot dispose data ] */
+				if (duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS) {
+					dux_report_error(ctx);
+				}
+			}
+			duk_pop(ctx);
+			/* [ ... name module hot ] */
+			accept = duk_has_prop_string(ctx, -1, DUX_IPK_HOT_ACCEPT);
+		}
+		duk_pop(ctx);
+		/* [ ... name module ] */
+		duk_del_prop_string(ctx, cache_idx, name);
+		if (accept) {
+			// Propagation stops at self-accepting module
+			duk_put_prop_index(ctx, accepted_idx, accepted++);
+			duk_pop(ctx);
+			continue;
+		}
+		duk_pop(ctx);
+		/* [ ... name ] */
+		index = modules_push_dependents(ctx, cache_idx, queue_idx, name);
+		if (index == 0) {
+			// Reached to the root which cannot accept update
+			result = DUK_EXEC_ERROR;
+		}
+		tail += index;
+		duk_pop(ctx);
+		/* [ ... ] */
+	}
+
+	// Re-evaluate accepting modules
+	for (index = 0; index < accepted; ++index) {
+		duk_get_prop_index(ctx, accepted_idx, index);
+		/* [ ... old_module ] */
+		duk_get_prop_string(ctx, -1, DUX_KEY_MODULES_PARENT);
+		if (!duk_is_object(ctx, -1)) {
+			duk_pop(ctx);
+			duk_dup(ctx, global_idx);
+		}
+		duk_push_string(ctx, DUX_KEY_MODULES_REQUIRE);
+		duk_get_prop_string(ctx, -3, DUX_KEY_MODULES_FILENAME);
+		/* [ ... old_module parent "require" filename ] */
+		if (duk_pcall_prop(ctx, -3, 1) != DUK_EXEC_SUCCESS) {
+			/* [ ... old_module parent err ] */
+			duk_get_prop_string(ctx, -3, DUX_IPK_MODULES_HOT);
+			duk_get_prop_string(ctx, -1, DUX_IPK_HOT_ACCEPT);
+			/* [ ... old_module parent err hot handler ] */
+			if (duk_is_function(ctx, -1)) {
+				duk_dup(ctx, -3);
+				if (duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS) {
+					dux_report_error(ctx);
+					result = DUK_EXEC_ERROR;
+				}
+			} else {
+				duk_dup(ctx, -3);
+				dux_report_error(ctx);
+				result = DUK_EXEC_ERROR;
+			}
+		}
+		duk_set_top(ctx, accepted_idx + 1);
+		/* [ ... global_module require cache stash queue visited accepted ] */
+	}
+
+	duk_set_top(ctx, top);
+	/* [ ... ] */
+	return result;
+}
+#endif  /* !DUX_OPT_NO_HOT_RELOAD */
+
 /**
  * @func dux_eval_module_raw
  * @brief Evaluate file/source as a module
@@ -425,7 +1071,13 @@ DUK_EXTERNAL duk_ret_t dux_eval_module_raw(duk_context *ctx, const void *data, d
 		// Load from file
 		const char *filename = dux_path_normalize(ctx, (const char *)data);
 		/* [ ... loader undefined global_module global_require cache filename ] */
-		if (dux_read_file(ctx, filename) != DUK_EXEC_SUCCESS) {
+		if (modules_read_javascript(ctx, filename) != DUK_EXEC_SUCCESS) {
+			/* [ ... loader undefined global_module global_require cache filename err|undefined ] */
+			if (!duk_is_error(ctx, -1)) {
+				// Known to be missing
+				duk_pop(ctx);
+				duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot find module '%s'", filename);
+			}
 			/* [ ... loader undefined global_module global_require cache filename err ] */
 			if (!(flags & DUK_COMPILE_SAFE)) {
 				return duk_throw(ctx);
@@ -440,19 +1092,18 @@ DUK_EXTERNAL duk_ret_t dux_eval_module_raw(duk_context *ctx, const void *data, d
 			}
 			return DUK_EXEC_ERROR;
 		}
-		/* [ ... loader undefined global_module global_require cache filename source ] */
+		/* [ ... loader undefined global_module global_require cache filename buf|func ] */
 	} else {
 		// Load from source
 		duk_push_undefined(ctx);
 		if (flags & DUK_COMPILE_STRLEN) {
-			duk_push_string(ctx, (const char *)data);
-		} else {
-			duk_push_lstring(ctx, (const char *)data, len);
+			len = strlen((const char *)data);
 		}
-		/* [ ... loader undefined global_module global_require cache undefined source ] */
+		modules_push_source(ctx, data, len);
+		/* [ ... loader undefined global_module global_require cache undefined buf ] */
 	}
 
-	/* [ ... loader any module require cache filename|undefined source ] */
+	/* [ ... loader any module require cache filename|undefined buf|func ] */
 	if (duk_pcall(ctx, 6) != DUK_EXEC_SUCCESS) {
 		/* [ ... err ] */
 		if (!(flags & DUK_COMPILE_SAFE)) {
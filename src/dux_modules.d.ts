@@ -4,11 +4,40 @@ declare namespace Dux {
          * Load dux internal module
          */
         (id: string): any;
+
+        /**
+         * Loaded modules (Delete entry to load the file again on next require)
+         */
+        cache: {[filename: string]: Module};
     }
     interface Module {
         id: string;
         parent: Module;
         filename: string;
+        exports: any;
+
+        /**
+         * Hot module reload (Triggered by dux_reload_module() in host)
+         */
+        hot: ModuleHot;
+    }
+    interface ModuleHot {
+        /**
+         * Re-evaluate this module when it or its dependencies are changed
+         * (Update is not propagated to modules which required this)
+         */
+        accept(errorHandler?: (err: Error) => void): void;
+
+        /**
+         * Register callback called before this module is replaced
+         * (Data object is passed to module.hot.data of the new module)
+         */
+        dispose(callback: (data: any) => void): void;
+
+        /**
+         * Data stored by dispose callback of the previous module
+         */
+        data?: any;
     }
 }
 declare const require: Dux.RequireFunction;
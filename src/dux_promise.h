@@ -3,16 +3,58 @@
 
 #if !defined(DUX_OPT_NO_PROMISE)
 
+/*
+ * Default budget of promise jobs per tick (0 means unlimited)
+ */
+#if !defined(DUX_PROMISE_TICK_MAX_JOBS)
+#define DUX_PROMISE_TICK_MAX_JOBS   1000
+#endif
+#if !defined(DUX_PROMISE_TICK_MAX_TIME)
+#define DUX_PROMISE_TICK_MAX_TIME   0   /* in milliseconds */
+#endif
+
+/*
+ * Structures
+ */
+
+typedef struct dux_promise_queue
+{
+	duk_context *job_context;
+	duk_uint_t head;
+	duk_uint_t count;
+	duk_uint_t size;
+	duk_uint_t max_jobs;
+	duk_uint64_t max_time;
+}
+dux_promise_queue;
+
+typedef struct dux_promise_data
+{
+	duk_uint8_t state;
+	duk_uint8_t reaction_kind;
+	duk_uint_t reactions;
+	duk_uint_t waiting;
+	duk_uint_t generation;
+}
+dux_promise_data;
+
 /*
  * Functions
  */
 DUK_INTERNAL_DECL duk_errcode_t dux_promise_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_promise_tick(duk_context *ctx);
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+DUK_INTERNAL_DECL duk_errcode_t dux_promise_init_lazy(duk_context *ctx);
+#define DUX_INIT_PROMISE    dux_promise_init_lazy,
+#else   /* !DUX_ENABLE_LAZY_GLOBALS */
 #define DUX_INIT_PROMISE    dux_promise_init,
-#define DUX_TICK_PROMISE    dux_promise_tick,
+#endif  /* !DUX_ENABLE_LAZY_GLOBALS */
+#define DUX_TICK_PROMISE    DUX_TICK_HANDLER(dux_promise_tick, "promise")
 
 DUK_INTERNAL_DECL void dux_promise_new(duk_context *ctx);
 DUK_INTERNAL_DECL void dux_promise_new_with_node_callback(duk_context *ctx, duk_idx_t func_idx);
+DUK_INTERNAL_DECL duk_uint_t dux_promise_queue_depth(duk_context *ctx);
+DUK_INTERNAL_DECL void dux_promise_set_budget(duk_context *ctx, duk_uint_t max_jobs, duk_uint_t max_time);
 
 #else   /* !DUX_OPT_NO_PROMISE */
 
@@ -31,40 +31,229 @@
  *
  *  Promise states:
  *    <Pending>:
+ *      dux_promise_data.state == DUX_PROMISE_STATE_PENDING
  *      Without [[Value]] property
- *      With [[FulfillReactions]] property (array)
- *      With [[RejectReactions]] property (array)
+ *      With [[Reaction]] property (target of the first reaction)
+ *      With [[Reactions]] property ([ kind, target, ... ] for 2nd and later)
  *
  *    <Resolved>:
+ *      dux_promise_data.state == DUX_PROMISE_STATE_FULFILLED
  *      With [[Value]] property (Value)
- *      With [[FulfillReactions]] property (undefined)
- *      Without [[RejectReactions]] property
  *
  *    <Rejected>:
+ *      dux_promise_data.state == DUX_PROMISE_STATE_REJECTED
  *      With [[Value]] property (Reason)
- *      Without [[FulfillReactions]] property
- *      With [[RejectReactions]] property (undefined)
+ *
+ *  Internal data structure:
+ *    promise[DUX_IPK_PROMISE_DATA] = new PlainBuffer(dux_promise_data);
+ *    promise[DUX_IPK_PROMISE_ON_FULFILLED] = onFulfilled;  (made by then())
+ *    promise[DUX_IPK_PROMISE_ON_REJECTED] = onRejected;    (made by then())
+ *    promise[DUX_IPK_PROMISE_CHILDREN] = children;         (made by all())
+ *    resolver[DUX_IPK_PROMISE_TARGET] = promise;
+ *    resolver[DUX_IPK_PROMISE_GENERATION] = uint;
+ *    heap_stash[DUX_IPK_PROMISE_QUEUE] = new PlainBuffer(dux_promise_queue);
+ *    heap_stash[DUX_IPK_PROMISE_THREAD] = new Duktape.Thread;
+ *      (Value stack of the thread is used as a ring buffer of job records:
+ *       [ kind, arg1, arg2, arg3 ])
+ *    heap_stash[DUX_IPK_PROMISE_JOB] = function(kind, arg1, arg2, arg3);
  */
 
 #if !defined(DUX_OPT_NO_PROMISE) && !defined(DUX_OPT_STANDARD_PROMISE)
 #include "dux_internal.h"
 
-DUK_LOCAL const char DUX_IPK_PROMISE[]                    = DUX_IPK("Promise");
-DUK_LOCAL const char DUX_IPK_PROMISE_CALLBACKS[]          = DUX_IPK("PromiseCb");
-DUK_LOCAL const char DUX_IPK_PROMISE_VALUE[]              = DUX_IPK("pmV");
-DUK_LOCAL const char DUX_IPK_PROMISE_FULFILL_REACTIONS[]  = DUX_IPK("pmF");
-DUK_LOCAL const char DUX_IPK_PROMISE_REJECT_REACTIONS[]   = DUX_IPK("pmR");
-DUK_LOCAL const char DUX_IPK_PROMISE_CHILDREN[]           = DUX_IPK("pmC");
-DUK_LOCAL const char DUX_IPK_PROMISE_WAITING_COUNT[]      = DUX_IPK("pmW");
+DUK_LOCAL const char DUX_IPK_PROMISE[]              = DUX_IPK("Promise");
+DUK_LOCAL const char DUX_IPK_PROMISE_QUEUE[]        = DUX_IPK("PromiseQ");
+DUK_LOCAL const char DUX_IPK_PROMISE_THREAD[]       = DUX_IPK("PromiseThr");
+DUK_LOCAL const char DUX_IPK_PROMISE_JOB[]          = DUX_IPK("PromiseJob");
+DUK_LOCAL const char DUX_IPK_PROMISE_DATA[]         = DUX_IPK("pmD");
+DUK_LOCAL const char DUX_IPK_PROMISE_VALUE[]        = DUX_IPK("pmV");
+DUK_LOCAL const char DUX_IPK_PROMISE_REACTION[]     = DUX_IPK("pmQ");
+DUK_LOCAL const char DUX_IPK_PROMISE_REACTIONS[]    = DUX_IPK("pmL");
+DUK_LOCAL const char DUX_IPK_PROMISE_ON_FULFILLED[] = DUX_IPK("pmF");
+DUK_LOCAL const char DUX_IPK_PROMISE_ON_REJECTED[]  = DUX_IPK("pmR");
+DUK_LOCAL const char DUX_IPK_PROMISE_CHILDREN[]     = DUX_IPK("pmC");
+DUK_LOCAL const char DUX_IPK_PROMISE_TARGET[]       = DUX_IPK("pmT");
+DUK_LOCAL const char DUX_IPK_PROMISE_GENERATION[]   = DUX_IPK("pmG");
+
+/*
+ * Promise states
+ */
+#define DUX_PROMISE_STATE_PENDING       0
+#define DUX_PROMISE_STATE_FULFILLED     1
+#define DUX_PROMISE_STATE_REJECTED      2
+
+/*
+ * Kinds of jobs (and reactions)
+ */
+#define DUX_PROMISE_JOB_THEN            0   /* [ parent child ] */
+#define DUX_PROMISE_JOB_ADOPT           1   /* [ parent child ] */
+#define DUX_PROMISE_JOB_ALL             2   /* [ child aggregate ] */
+#define DUX_PROMISE_JOB_RACE            3   /* [ child aggregate ] */
+#define DUX_PROMISE_JOB_THENABLE        4   /* [ promise thenable then ] */
+
+/*
+ * Magic numbers of resolver functions
+ */
+#define DUX_PROMISE_RESOLVER_RESOLVE    0
+#define DUX_PROMISE_RESOLVER_REJECT     1
+#define DUX_PROMISE_RESOLVER_NODE       2
+
+#define DUX_PROMISE_QUEUE_INITIAL_SIZE  16
+#define DUX_PROMISE_JOB_SLOTS           4
 
-DUK_LOCAL_DECL duk_ret_t promise_on_resolved(duk_context *ctx);
-DUK_LOCAL_DECL duk_ret_t promise_on_rejected(duk_context *ctx);
+DUK_LOCAL_DECL duk_ret_t promise_resolver(duk_context *ctx);
+DUK_LOCAL_DECL void promise_collect_values(duk_context *ctx, duk_idx_t idx);
+
+/*
+ * Get job queue
+ */
+DUK_LOCAL dux_promise_queue *promise_get_queue(duk_context *ctx)
+{
+	dux_promise_queue *queue;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE_QUEUE);
+	/* [ ... stash buf ] */
+	queue = (dux_promise_queue *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	return queue;
+}
+
+/*
+ * Extend ring buffer of job queue
+ * (One extra record is always reserved above the ring for moving jobs)
+ */
+DUK_LOCAL void promise_queue_grow(dux_promise_queue *queue)
+{
+	duk_context *jctx = queue->job_context;
+	duk_uint_t old_size = queue->size;
+	duk_uint_t new_size;
+	duk_uint_t wrapped;
+	duk_uint_t index;
+
+	new_size = (old_size > 0) ? (old_size * 2) : DUX_PROMISE_QUEUE_INITIAL_SIZE;
+	duk_require_stack(jctx, (duk_idx_t)((new_size - old_size + 1) * DUX_PROMISE_JOB_SLOTS));
+	duk_set_top(jctx, (duk_idx_t)(new_size * DUX_PROMISE_JOB_SLOTS));
+
+	/* Unwrap jobs which are wrapped around the end of old ring */
+	wrapped = (queue->head + queue->count > old_size) ?
+		(queue->head + queue->count - old_size) * DUX_PROMISE_JOB_SLOTS : 0;
+	for (index = 0; index < wrapped; ++index)
+	{
+		duk_copy(jctx, (duk_idx_t)index,
+				(duk_idx_t)(old_size * DUX_PROMISE_JOB_SLOTS + index));
+		duk_push_undefined(jctx);
+		duk_replace(jctx, (duk_idx_t)index);
+	}
+	queue->size = new_size;
+}
+
+/*
+ * Append a job to the tail of job queue
+ * Stack on entry:  [ ... arg1 arg2 arg3 ]
+ * Stack on return: [ ... ]
+ */
+DUK_LOCAL void promise_enqueue_job(duk_context *ctx, dux_promise_queue *queue, duk_uint_t kind)
+{
+	duk_context *jctx = queue->job_context;
+	duk_idx_t base;
+	duk_uint_t index;
+
+	if (queue->count == queue->size)
+	{
+		promise_queue_grow(queue);
+	}
+	index = queue->head + queue->count;
+	if (index >= queue->size)
+	{
+		index -= queue->size;
+	}
+	base = (duk_idx_t)(index * DUX_PROMISE_JOB_SLOTS);
+	/* [ ... arg1 arg2 arg3 ] */
+	duk_xmove_top(jctx, ctx, 3);
+	duk_replace(jctx, base + 3);
+	duk_replace(jctx, base + 2);
+	duk_replace(jctx, base + 1);
+	duk_push_uint(jctx, kind);
+	duk_replace(jctx, base);
+	/* [ ... ] */
+	if (queue->count++ == 0)
+	{
+		dux_wakeup_signal(ctx);
+	}
+}
+
+/*
+ * Take a job from the head of job queue
+ * Stack on entry:  [ ... ]
+ * Stack on return: [ ... kind arg1 arg2 arg3 ]
+ */
+DUK_LOCAL void promise_dequeue_job(duk_context *ctx, dux_promise_queue *queue)
+{
+	duk_context *jctx = queue->job_context;
+	duk_idx_t base;
+	duk_idx_t slot;
+
+	/* [ ... ] */
+	base = (duk_idx_t)(queue->head * DUX_PROMISE_JOB_SLOTS);
+	for (slot = 0; slot < DUX_PROMISE_JOB_SLOTS; ++slot)
+	{
+		duk_push_undefined(jctx);
+		duk_swap_top(jctx, base + slot);
+	}
+	duk_xmove_top(ctx, jctx, DUX_PROMISE_JOB_SLOTS);
+	/* [ ... kind arg1 arg2 arg3 ] */
+	if (--queue->count == 0)
+	{
+		queue->head = 0;
+	}
+	else if (++queue->head == queue->size)
+	{
+		queue->head = 0;
+	}
+}
+
+/*
+ * Get current time for job budget (in nanoseconds)
+ * (Time budget is not available without timer module)
+ */
+DUK_LOCAL duk_uint64_t promise_current_ns(void)
+{
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_TIMER)
+	return dux_timer_arch_current_ns();
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Get native state of promise (Returns NULL if obj is not a promise)
+ */
+DUK_LOCAL dux_promise_data *promise_get_data(duk_context *ctx, duk_idx_t idx)
+{
+	dux_promise_data *data = NULL;
+
+	/* [ ... obj ... ] */
+	if (duk_is_object(ctx, idx))
+	{
+		duk_get_prop_string(ctx, idx, DUX_IPK_PROMISE_DATA);
+		/* [ ... obj ... buf ] */
+		data = (dux_promise_data *)duk_get_buffer(ctx, -1, NULL);
+		duk_pop(ctx);
+		/* [ ... obj ... ] */
+	}
+	return data;
+}
 
 /*
  * Push new promise object
  */
-DUK_LOCAL void promise_push_new(duk_context *ctx, duk_bool_t has_this)
+DUK_LOCAL dux_promise_data *promise_push_new(duk_context *ctx, duk_bool_t has_this)
 {
+	dux_promise_data *data;
 	duk_idx_t idx;
 	/* [ ... ] */
 	duk_push_object(ctx);
@@ -73,7 +262,18 @@ DUK_LOCAL void promise_push_new(duk_context *ctx, duk_bool_t has_this)
 	if (!has_this) {
 		duk_push_heap_stash(ctx);
 		/* [ ... obj stash ] */
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+		if (!duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE)) {
+			// Created from C before first access to global.Promise
+			duk_size_t before = dux_memory_current(ctx);
+			duk_pop(ctx);
+			(void)dux_promise_init(ctx);
+			dux_memory_record(ctx, "Promise", before);
+			duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE);
+		}
+#else   /* !DUX_ENABLE_LAZY_GLOBALS */
 		duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE);
+#endif  /* !DUX_ENABLE_LAZY_GLOBALS */
 		/* [ ... obj stash constructor ] */
 	} else {
 		duk_push_this(ctx);
@@ -86,377 +286,485 @@ DUK_LOCAL void promise_push_new(duk_context *ctx, duk_bool_t has_this)
 	/* [ ... promise ... constructor ] */
 	duk_set_top(ctx, idx + 1);
 	/* [ ... promise ] */
-}
-
-/*
- * Set promise pending state
- */
-DUK_LOCAL void promise_set_pending(duk_context *ctx, duk_idx_t idx)
-{
-	/* [ ... promise ... ] */
-	idx = duk_normalize_index(ctx, idx);
-	duk_push_array(ctx);
-	duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-	duk_push_array(ctx);
-	duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_REJECT_REACTIONS);
+	data = (dux_promise_data *)duk_push_fixed_buffer(ctx, sizeof(dux_promise_data));
+	memset(data, 0, sizeof(dux_promise_data));
+	duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_DATA);
+	/* [ ... promise ] */
+	return data;
 }
 
 /*
  * Push new resolvers(resolve/reject) for promise object
  */
-DUK_LOCAL void promise_push_resolvers(duk_context *ctx, duk_idx_t idx)
+DUK_LOCAL void promise_push_resolvers(duk_context *ctx, duk_idx_t idx, dux_promise_data *data)
 {
+	duk_int_t magic;
+
 	/* [ ... promise ... ] */
 	/*       ^idx          */
 	idx = duk_normalize_index(ctx, idx);
-	duk_push_c_function(ctx, promise_on_resolved, 2);
-	/* [ ... promise ... func(resolver) ] */
-	duk_dup(ctx, idx);
-	dux_bind_arguments(ctx, 1);
-	/* [ ... promise ... bound_func(resolver) ] */
-	duk_push_c_function(ctx, promise_on_rejected, 2);
-	/* [ ... promise ... bound_func(resolver) func(rejector) ] */
-	duk_dup(ctx, idx);
-	dux_bind_arguments(ctx, 1);
-	/* [ ... promise ... bound_func(resolver) bound_func(rejector) ] */
-}
-
-/*
- * Construct a new Promise with resolvers
- * Stack on entry:  [ ... ]
- * Stack on return: [ ... promise resolve reject ]
- */
-DUK_INTERNAL void dux_promise_new(duk_context *ctx)
-{
-	/* [ ... ] */
-	promise_push_new(ctx, 0);
-	/* [ ... promise ] */
-	promise_set_pending(ctx, -1);
-	promise_push_resolvers(ctx, -1);
-	/* [ ... promise resolve reject ] */
+	for (magic = DUX_PROMISE_RESOLVER_RESOLVE; magic <= DUX_PROMISE_RESOLVER_REJECT; ++magic)
+	{
+		duk_push_c_function(ctx, promise_resolver, 1);
+		duk_set_magic(ctx, -1, magic);
+		/* [ ... promise ... func ] */
+		duk_dup(ctx, idx);
+		duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_TARGET);
+		duk_push_uint(ctx, data->generation);
+		duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_GENERATION);
+	}
+	/* [ ... promise ... func(resolver) func(rejector) ] */
 }
 
 /*
- * Invoke executor (function(resolve,reject){})
+ * Settle promise and queue its reactions
+ * Stack on entry:  [ ... promise:idx ... value/reason ]
+ * Stack on return: [ ... promise:idx ... ]
  */
-DUK_LOCAL duk_ret_t promise_invoke_executor(duk_context *ctx)
+DUK_LOCAL void promise_settle(duk_context *ctx, duk_idx_t idx, dux_promise_data *data, duk_uint8_t state)
 {
-	/* [ executor promise ] */
-	promise_push_resolvers(ctx, 1);
-	/* [ executor promise bound_func(resolver) bound_func(rejector):3 ] */
-	duk_swap(ctx, 0, 1);
-	/* [ promise executor bound_func(resolver) bound_func(rejector):3 ] */
+	dux_promise_queue *queue;
+	duk_uint_t reactions;
+	duk_uint_t kind;
+	duk_uarridx_t ridx;
 
-	if (duk_pcall(ctx, 2) != DUK_EXEC_SUCCESS)
+	idx = duk_normalize_index(ctx, idx);
+	if (data->state != DUX_PROMISE_STATE_PENDING)
 	{
-		/* [ promise err ] */
-		return promise_on_rejected(ctx);
+		/* This promise already settled */
+		duk_pop(ctx);
+		return;
 	}
-	else
+	/* [ ... promise ... value/reason ] */
+	duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_VALUE);
+	/* [ ... promise ... ] */
+	data->state = state;
+	reactions = data->reactions;
+	data->reactions = 0;
+	if (reactions == 0)
 	{
-		/* [ promise retval ] */
-		return 0; /* return undefined; */
+		/* No reactions to invoke */
+		return;
+	}
+
+	queue = promise_get_queue(ctx);
+	duk_dup(ctx, idx);
+	duk_get_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTION);
+	duk_push_undefined(ctx);
+	/* [ ... promise ... promise target undefined ] */
+	promise_enqueue_job(ctx, queue, data->reaction_kind);
+	/* [ ... promise ... ] */
+	duk_del_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTION);
+
+	if (reactions > 1)
+	{
+		duk_get_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTIONS);
+		/* [ ... promise ... arr ] */
+		for (ridx = 0; ridx < (reactions - 1) * 2; ridx += 2)
+		{
+			duk_get_prop_index(ctx, -1, ridx);
+			kind = duk_get_uint(ctx, -1);
+			duk_pop(ctx);
+			duk_dup(ctx, idx);
+			duk_get_prop_index(ctx, -2, ridx + 1);
+			duk_push_undefined(ctx);
+			/* [ ... promise ... arr promise target undefined ] */
+			promise_enqueue_job(ctx, queue, kind);
+			/* [ ... promise ... arr ] */
+		}
+		duk_pop(ctx);
+		/* [ ... promise ... ] */
+		duk_del_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTIONS);
 	}
 }
 
 /*
- * Make status transition (Trigger of reactions)
- * Note: The promise at stack[0] must be preserved for promise_resolve()/promise_reject()
+ * Add reaction to promise
+ * (Job is queued immediately if the promise already settled)
+ * Stack on entry:  [ ... promise:idx ... target ]
+ * Stack on return: [ ... promise:idx ... ]
  */
-DUK_LOCAL duk_ret_t promise_transition(duk_context *ctx, duk_bool_t resolved)
+DUK_LOCAL void promise_react(duk_context *ctx, duk_idx_t idx, dux_promise_data *data, duk_uint_t kind)
 {
-	duk_size_t reactions;
-	duk_uarridx_t ridx, cidx;
+	duk_uarridx_t ridx;
 
-	/* [ promise value/reason ] */
-	duk_put_prop_string(ctx, 0, DUX_IPK_PROMISE_VALUE);
-	/* [ promise ] */
-	if (resolved)
-	{
-		duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_REJECT_REACTIONS);
-		duk_get_prop_string(ctx, 0, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-		duk_push_undefined(ctx);
-		duk_put_prop_string(ctx, 0, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-	}
-	else
+	idx = duk_normalize_index(ctx, idx);
+	/* [ ... promise ... target ] */
+	if (data->state != DUX_PROMISE_STATE_PENDING)
 	{
-		duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-		duk_get_prop_string(ctx, 0, DUX_IPK_PROMISE_REJECT_REACTIONS);
+		duk_dup(ctx, idx);
+		duk_swap_top(ctx, -2);
 		duk_push_undefined(ctx);
-		duk_put_prop_string(ctx, 0, DUX_IPK_PROMISE_REJECT_REACTIONS);
+		/* [ ... promise ... promise target undefined ] */
+		promise_enqueue_job(ctx, promise_get_queue(ctx), kind);
+		/* [ ... promise ... ] */
+		return;
 	}
-	/* [ promise arr(reactions) ] */
-	reactions = duk_get_length(ctx, 1);
 
-	if (reactions == 0)
+	if (data->reactions == 0)
 	{
-		/* No reactions to invoke */
-		return 0; /* return undefined; */
+		/* Use inline slot */
+		data->reaction_kind = (duk_uint8_t)kind;
+		duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTION);
+		/* [ ... promise ... ] */
+		data->reactions = 1;
+		return;
 	}
 
-	duk_push_heap_stash(ctx);
-	/* [ promise arr(reactions) stash ] */
-	duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_CALLBACKS);
-	/* [ promise arr(reactions) stash arr(callbacks):3 ] */
-	cidx = duk_get_length(ctx, 3);
-
-	for (ridx = 0; ridx < reactions; ++ridx, ++cidx)
+	if (!duk_get_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTIONS))
 	{
-		duk_get_prop_index(ctx, 1, ridx);
-		duk_put_prop_index(ctx, 3, cidx);
+		duk_pop(ctx);
+		duk_push_array(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, idx, DUX_IPK_PROMISE_REACTIONS);
 	}
-	/* [ promise arr(reactions) stash arr(callbacks):3 ] */
-	return 0; /* return undefined; */
+	/* [ ... promise ... target arr ] */
+	ridx = (data->reactions - 1) * 2;
+	duk_push_uint(ctx, kind);
+	duk_put_prop_index(ctx, -2, ridx);
+	duk_swap_top(ctx, -2);
+	/* [ ... promise ... arr target ] */
+	duk_put_prop_index(ctx, -2, ridx + 1);
+	duk_pop(ctx);
+	/* [ ... promise ... ] */
+	++data->reactions;
 }
 
 /*
- * Handler for fulfillment
- * Note: The promise at stack[0] must be preserved for promise_resolve()
+ * Resolve promise with value (Promise Resolve Functions in ES2015)
+ * Stack on entry:  [ ... promise:idx ... value ]
+ * Stack on return: [ ... promise:idx ... ]
  */
-DUK_LOCAL duk_ret_t promise_on_resolved(duk_context *ctx)
+DUK_LOCAL void promise_resolve_value(duk_context *ctx, duk_idx_t idx, dux_promise_data *data)
 {
-	/* [ promise value ] */
-	if (duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_VALUE))
+	dux_promise_data *vdata;
+	duk_idx_t vidx;
+
+	idx = duk_normalize_index(ctx, idx);
+	vidx = duk_get_top(ctx) - 1;
+	/* [ ... promise ... value ] */
+
+	if (data->state != DUX_PROMISE_STATE_PENDING)
 	{
-		/*
-		 * This promise already settled
-		 */
-		return 0; /* return undefined; */
+		/* This promise already settled */
+		duk_pop(ctx);
+		return;
 	}
 
-	if (!duk_is_object(ctx, 1))
+	if (!duk_is_object(ctx, vidx))
 	{
 		goto resolve;
 	}
 
-	if (duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_VALUE))
+	if (duk_strict_equals(ctx, idx, vidx))
 	{
-		/* [ promise value value/reason ] */
+		duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Chaining cycle detected for promise");
+		duk_replace(ctx, vidx);
+		/* [ ... promise ... err ] */
+		promise_settle(ctx, idx, data, DUX_PROMISE_STATE_REJECTED);
+		return;
+	}
 
-		if (duk_has_prop_string(ctx, 1, DUX_IPK_PROMISE_REJECT_REACTIONS))
+	vdata = promise_get_data(ctx, vidx);
+	if (vdata)
+	{
+		if (vdata->state == DUX_PROMISE_STATE_PENDING)
 		{
 			/*
-			 * value is a Promise object which has been already rejected
+			 * value is a Promise object which is pending
 			 */
-			duk_remove(ctx, 1);
-			/* [ promise reason ] */
-			return promise_transition(ctx, 0);
+			duk_dup(ctx, idx);
+			/* [ ... promise ... value promise ] */
+			promise_react(ctx, vidx, vdata, DUX_PROMISE_JOB_ADOPT);
+			duk_pop(ctx);
+			/* [ ... promise ... ] */
+			return;
 		}
 
 		/*
-		 * value is a Promise object which has been already resolved
-		 */
-		duk_remove(ctx, 1);
-		/* [ promise value ] */
-		goto resolve;
-	}
-	duk_pop(ctx);
-	/* [ promise value ] */
-
-	if (duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_FULFILL_REACTIONS))
-	{
-		/* [ promise value arr(reactions) ] */
-
-		/*
-		 * value is a Promise object which is pending
+		 * value is a Promise object which has been already settled
 		 */
-		duk_push_c_function(ctx, promise_on_resolved, 2);
-		duk_dup(ctx, 0);
-		duk_dup(ctx, 1);
-		dux_bind_arguments(ctx, 2);
-		/* [ promise value arr(reactions) bound_func:3 ] */
-		duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_REJECT_REACTIONS);
-		/* [ promise value arr(reactions) bound_func:3 arr(rReactions):4 ] */
-		duk_dup(ctx, 3);
-		duk_put_prop_index(ctx, 4, duk_get_length(ctx, 4));
-		duk_pop(ctx);
-		/* [ promise value arr(reactions) bound_func:3 ] */
-		duk_put_prop_index(ctx, 2, duk_get_length(ctx, 2));
-		/* [ promise value ] */
-		return 0; /* return undefined; */
+		duk_get_prop_string(ctx, vidx, DUX_IPK_PROMISE_VALUE);
+		duk_replace(ctx, vidx);
+		/* [ ... promise ... value/reason ] */
+		promise_settle(ctx, idx, data, vdata->state);
+		return;
 	}
-	duk_pop(ctx);
-	/* [ promise value ] */
 
-	if (duk_get_prop_string(ctx, 1, "then") && duk_is_callable(ctx, 2))
+	if (duk_get_prop_string(ctx, vidx, "then") && duk_is_callable(ctx, -1))
 	{
-		/* [ promise value func(then) ] */
+		/* [ ... promise ... value func(then) ] */
 
 		/*
 		 * value is a Thenable object
 		 */
-		duk_swap(ctx, 1, 2);
-		/* [ promise func(then) value ] */
-		dux_bind_this_arguments(ctx, 0);
-		/* [ promise bound_func(then) ] */
-		duk_push_c_function(ctx, promise_invoke_executor, 2);
-		/* [ promise bound_func(then) func ] */
-		duk_dup(ctx, 0);
-		/* [ promise bound_func(then) func promise ] */
-		duk_swap(ctx, 1, 2);
-		/* [ promise func bound_func(then) promise ] */
-		dux_bind_arguments(ctx, 2);
-		/* [ promise bound_func ] */
-		duk_push_heap_stash(ctx);
-		/* [ promise bound_func stash ] */
-		duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_CALLBACKS);
-		/* [ promise bound_func stash arr(callbacks) ] */
-		duk_swap(ctx, 1, 3);
-		/* [ promise arr(callbacks) stash bound_func ] */
-		duk_put_prop_index(ctx, 1, duk_get_length(ctx, 1));
-		/* [ promise arr(callbacks) stash ] */
-		return 0; /* return undefined; */
+		duk_dup(ctx, idx);
+		duk_insert(ctx, vidx);
+		/* [ ... promise ... promise value func(then) ] */
+		promise_enqueue_job(ctx, promise_get_queue(ctx), DUX_PROMISE_JOB_THENABLE);
+		/* [ ... promise ... ] */
+		return;
 	}
 	duk_pop(ctx);
-	/* [ promise value ] */
+	/* [ ... promise ... value ] */
 
 resolve:
-	return promise_transition(ctx, 1);
+	promise_settle(ctx, idx, data, DUX_PROMISE_STATE_FULFILLED);
 }
 
 /*
- * Handler for rejection
- * Note: The promise at stack[0] must be preserved for promise_reject()
+ * Entry of resolver functions
  */
-DUK_LOCAL duk_ret_t promise_on_rejected(duk_context *ctx)
+DUK_LOCAL duk_ret_t promise_resolver(duk_context *ctx)
 {
-	/* [ promise reason ] */
-	if (duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_VALUE))
+	dux_promise_data *data;
+	duk_int_t magic = duk_get_current_magic(ctx);
+	duk_idx_t nargs = (magic == DUX_PROMISE_RESOLVER_NODE) ? 2 : 1;
+
+	duk_set_top(ctx, nargs);
+	/* [ value/reason ] (resolve/reject) */
+	/* [ error result ] (Node.js style callback) */
+	duk_push_current_function(ctx);
+	duk_get_prop_string(ctx, nargs, DUX_IPK_PROMISE_TARGET);
+	duk_get_prop_string(ctx, nargs, DUX_IPK_PROMISE_GENERATION);
+	/* [ ... func promise uint ] */
+	data = promise_get_data(ctx, nargs + 1);
+	if ((!data) || (data->generation != duk_get_uint(ctx, nargs + 2)))
 	{
 		/*
-		 * This promise already settled
+		 * This promise already resolved by another resolver
 		 */
 		return 0; /* return undefined; */
 	}
+	++data->generation;
+	duk_pop(ctx);
+	duk_replace(ctx, nargs);
+	/* [ ... promise ] */
+
+	switch (magic)
+	{
+	case DUX_PROMISE_RESOLVER_RESOLVE:
+		duk_dup(ctx, 0);
+		promise_resolve_value(ctx, 1, data);
+		break;
+	case DUX_PROMISE_RESOLVER_REJECT:
+		duk_dup(ctx, 0);
+		promise_settle(ctx, 1, data, DUX_PROMISE_STATE_REJECTED);
+		break;
+	default:
+		/* [ error result promise ] */
+		if (duk_is_null_or_undefined(ctx, 0))
+		{
+			duk_dup(ctx, 1);
+			promise_resolve_value(ctx, 2, data);
+		}
+		else
+		{
+			duk_dup(ctx, 0);
+			promise_settle(ctx, 2, data, DUX_PROMISE_STATE_REJECTED);
+		}
+		break;
+	}
+	return 0; /* return undefined; */
+}
 
-	return promise_transition(ctx, 0);
+/*
+ * Construct a new Promise with resolvers
+ * Stack on entry:  [ ... ]
+ * Stack on return: [ ... promise resolve reject ]
+ */
+DUK_INTERNAL void dux_promise_new(duk_context *ctx)
+{
+	dux_promise_data *data;
+
+	/* [ ... ] */
+	data = promise_push_new(ctx, 0);
+	/* [ ... promise ] */
+	promise_push_resolvers(ctx, -1, data);
+	/* [ ... promise resolve reject ] */
 }
 
 /*
- * Handler for chain resolving
+ * Invoke executor (function(resolve,reject){})
+ * Stack on entry:  [ ... promise:idx ... func this ]
+ * Stack on return: [ ... promise:idx ... ]
  */
-DUK_LOCAL duk_ret_t promise_chain_resolver(duk_context *ctx)
+DUK_LOCAL void promise_invoke_executor(duk_context *ctx, duk_idx_t idx, dux_promise_data *data)
 {
-	/* [ child onSettled parent ] */
-	duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-	/* [ child onSettled parent value/reason ] */
-	duk_replace(ctx, 2);
-	/* [ child onSettled value/reason ] */
-	if (duk_pcall(ctx, 1) == DUK_EXEC_SUCCESS)
-	{
-		/* [ child retval ] */
-		return promise_on_resolved(ctx);
-	}
-	else
+	duk_uint_t generation = data->generation;
+
+	idx = duk_normalize_index(ctx, idx);
+	/* [ ... promise ... func this ] */
+	promise_push_resolvers(ctx, idx, data);
+	/* [ ... promise ... func this resolve reject ] */
+	if (duk_pcall_method(ctx, 2) != DUK_EXEC_SUCCESS)
 	{
-		/* [ child err ] */
-		return promise_on_rejected(ctx);
+		/* [ ... promise ... err ] */
+		if (data->generation == generation)
+		{
+			++data->generation;
+			promise_settle(ctx, idx, data, DUX_PROMISE_STATE_REJECTED);
+			return;
+		}
 	}
+	/* [ ... promise ... retval/err ] */
+	duk_pop(ctx);
+	/* [ ... promise ... ] */
 }
 
 /*
- * Entry of Promise.prototype.then()
+ * Job runner
  */
-DUK_LOCAL duk_ret_t promise_proto_then(duk_context *ctx)
+DUK_LOCAL duk_ret_t promise_run_job(duk_context *ctx)
 {
-	/* [ onFulfilled onRejected ] */
-	duk_push_object(ctx);
-	duk_push_this(ctx);
-	/* [ onFulfilled onRejected obj this:3 ] */
-	duk_get_prototype(ctx, 3);
-	duk_set_prototype(ctx, 2);
-	/* [ onFulfilled onRejected new_promise this:3 ] */
-	promise_set_pending(ctx, 2);
+	dux_promise_data *data;
+	dux_promise_data *tdata;
+	duk_uint_t kind;
 
-	if (duk_has_prop_string(ctx, 3, DUX_IPK_PROMISE_VALUE))
+	/* [ kind arg1 arg2 arg3 ] */
+	kind = duk_get_uint(ctx, 0);
+	if (kind == DUX_PROMISE_JOB_THENABLE)
 	{
-		/* [ onFulfilled onRejected new_promise this:3 ] */
-
-		/*
-		 * This promise has been already settled
-		 */
-		duk_push_heap_stash(ctx);
-		/* [ onFulfilled onRejected new_promise this:3 stash:4 ] */
-		duk_get_prop_string(ctx, 4, DUX_IPK_PROMISE_CALLBACKS);
-		/* [ onFulfilled onRejected new_promise this:3 stash:4 arr:5 ] */
-		duk_push_c_function(ctx, promise_chain_resolver, 3);
-		duk_replace(ctx, 4);
-		/* [ onFulfilled onRejected new_promise this:3 func:4 arr:5 ] */
-
-		if (duk_has_prop_string(ctx, 3, DUX_IPK_PROMISE_FULFILL_REACTIONS))
+		/* [ kind promise thenable func(then) ] */
+		data = promise_get_data(ctx, 1);
+		if (!data)
 		{
-			/* Already resolved */
-			duk_swap(ctx, 0, 1);
-			/* [ onRejected onFulfilled new_promise this:3 func:4 arr:5 ] */
+			return DUK_RET_ERROR;
 		}
-		duk_replace(ctx, 0);
-		/* [ arr onSettled new_promise this:3 func:4 ] */
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 1);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 3);
-		/* [ arr onSettled new_promise this:3 bound_func ] */
-		duk_put_prop_index(ctx, 0, duk_get_length(ctx, 0));
-		/* [ arr onSettled new_promise this:3 ] */
-		duk_pop(ctx);
-		/* [ arr onSettled new_promise ] */
-		return 1; /* return new_promise; */
+		duk_swap(ctx, 2, 3);
+		/* [ kind promise func(then) thenable ] */
+		promise_invoke_executor(ctx, 1, data);
+		/* [ kind promise ] */
+		return 0; /* return undefined; */
 	}
-	/* [ onFulfilled onRejected new_promise this:3 ] */
 
-	duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-	/* [ onFulfilled onRejected new_promise this:3 arr:4 ] */
-	if (duk_is_null_or_undefined(ctx, 0))
+	/* [ kind parent target undefined ] */
+	data = promise_get_data(ctx, 1);
+	tdata = promise_get_data(ctx, 2);
+	if ((!data) || (!tdata) || (data->state == DUX_PROMISE_STATE_PENDING))
 	{
-		duk_push_c_function(ctx, promise_on_resolved, 2);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 func:5 ] */
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 2);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 bound_func:5 ] */
+		return DUK_RET_ERROR;
 	}
-	else
+	duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_VALUE);
+	/* [ kind parent target undefined value/reason:4 ] */
+
+	switch (kind)
 	{
-		duk_require_callable(ctx, 0);
-		duk_push_c_function(ctx, promise_chain_resolver, 3);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 func:5 ] */
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 0);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 3);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 bound_func:5 ] */
+	case DUX_PROMISE_JOB_THEN:
+		/* [ kind parent child undefined value/reason:4 ] */
+		duk_get_prop_string(ctx, 2,
+				(data->state == DUX_PROMISE_STATE_FULFILLED) ?
+				DUX_IPK_PROMISE_ON_FULFILLED : DUX_IPK_PROMISE_ON_REJECTED);
+		duk_del_prop_string(ctx, 2, DUX_IPK_PROMISE_ON_FULFILLED);
+		duk_del_prop_string(ctx, 2, DUX_IPK_PROMISE_ON_REJECTED);
+		/* [ kind parent child undefined value/reason:4 handler:5 ] */
+		if (!duk_is_callable(ctx, 5))
+		{
+			/* Pass through */
+			duk_pop(ctx);
+			goto adopt;
+		}
+		duk_swap(ctx, 4, 5);
+		/* [ kind parent child undefined handler:4 value/reason:5 ] */
+		if (duk_pcall(ctx, 1) == DUK_EXEC_SUCCESS)
+		{
+			/* [ kind parent child undefined retval:4 ] */
+			promise_resolve_value(ctx, 2, tdata);
+		}
+		else
+		{
+			/* [ kind parent child undefined err:4 ] */
+			promise_settle(ctx, 2, tdata, DUX_PROMISE_STATE_REJECTED);
+		}
+		break;
+	case DUX_PROMISE_JOB_ADOPT:
+	case DUX_PROMISE_JOB_RACE:
+	adopt:
+		/* [ kind parent target undefined value/reason:4 ] */
+		promise_settle(ctx, 2, tdata, data->state);
+		break;
+	case DUX_PROMISE_JOB_ALL:
+		/* [ kind child aggregate undefined value/reason:4 ] */
+		if (tdata->state != DUX_PROMISE_STATE_PENDING)
+		{
+			/*
+			 * This promise has been already rejected
+			 * by another child's rejection
+			 */
+			break;
+		}
+		if (data->state == DUX_PROMISE_STATE_REJECTED)
+		{
+			/*
+			 * Fail fast
+			 */
+			duk_del_prop_string(ctx, 2, DUX_IPK_PROMISE_CHILDREN);
+			promise_settle(ctx, 2, tdata, DUX_PROMISE_STATE_REJECTED);
+			break;
+		}
+		if ((tdata->waiting == 0) || (--tdata->waiting > 0))
+		{
+			/*
+			 * There are still waiting promises
+			 */
+			break;
+		}
+
+		/*
+		 * All promises have been resolved
+		 */
+		duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_CHILDREN);
+		duk_del_prop_string(ctx, 2, DUX_IPK_PROMISE_CHILDREN);
+		/* [ kind child aggregate undefined value:4 children:5 ] */
+		promise_collect_values(ctx, 5);
+		/* [ kind child aggregate undefined value:4 values:5 ] */
+		promise_settle(ctx, 2, tdata, DUX_PROMISE_STATE_FULFILLED);
+		break;
+	default:
+		return DUK_RET_ERROR;
 	}
-	duk_put_prop_index(ctx, 4, duk_get_length(ctx, 4));
-	/* [ onFulfilled onRejected new_promise this:3 arr:4 ] */
-	duk_pop(ctx);
-	/* [ onFulfilled onRejected new_promise this:3 ] */
+	return 0; /* return undefined; */
+}
+
+/*
+ * Entry of Promise.prototype.then()
+ */
+DUK_LOCAL duk_ret_t promise_proto_then(duk_context *ctx)
+{
+	dux_promise_data *data;
 
-	duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_REJECT_REACTIONS);
-	/* [ onFulfilled onRejected new_promise this:3 arr:4 ] */
-	if (duk_is_null_or_undefined(ctx, 1))
+	/* [ onFulfilled onRejected ] */
+	duk_push_this(ctx);
+	/* [ onFulfilled onRejected this ] */
+	data = promise_get_data(ctx, 2);
+	if (!data)
 	{
-		duk_push_c_function(ctx, promise_on_resolved, 2);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 func:5 ] */
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 2);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 bound_func:5 ] */
+		return DUK_RET_TYPE_ERROR;
 	}
-	else
+	duk_push_object(ctx);
+	duk_get_prototype(ctx, 2);
+	duk_set_prototype(ctx, 3);
+	/* [ onFulfilled onRejected this obj:3 ] */
+	memset(duk_push_fixed_buffer(ctx, sizeof(dux_promise_data)), 0, sizeof(dux_promise_data));
+	duk_put_prop_string(ctx, 3, DUX_IPK_PROMISE_DATA);
+	/* [ onFulfilled onRejected this new_promise:3 ] */
+
+	if (!duk_is_null_or_undefined(ctx, 0))
+	{
+		duk_require_callable(ctx, 0);
+		duk_dup(ctx, 0);
+		duk_put_prop_string(ctx, 3, DUX_IPK_PROMISE_ON_FULFILLED);
+	}
+	if (!duk_is_null_or_undefined(ctx, 1))
 	{
 		duk_require_callable(ctx, 1);
-		duk_push_c_function(ctx, promise_chain_resolver, 3);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 func:5 ] */
-		duk_dup(ctx, 2);
 		duk_dup(ctx, 1);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 3);
-		/* [ onFulfilled onRejected new_promise this:3 arr:4 bound_func:5 ] */
+		duk_put_prop_string(ctx, 3, DUX_IPK_PROMISE_ON_REJECTED);
 	}
-	duk_put_prop_index(ctx, 4, duk_get_length(ctx, 4));
-	/* [ onFulfilled onRejected new_promise this:3 arr:4 ] */
-	duk_pop_2(ctx);
-	/* [ onFulfilled onRejected new_promise ] */
+	duk_dup(ctx, 3);
+	/* [ onFulfilled onRejected this new_promise:3 new_promise ] */
+	promise_react(ctx, 2, data, DUX_PROMISE_JOB_THEN);
+	/* [ onFulfilled onRejected this new_promise:3 ] */
 	return 1; /* return new_promise; */
 }
 
@@ -473,34 +781,40 @@ DUK_LOCAL duk_ret_t promise_proto_catch(duk_context *ctx)
 }
 
 /*
- * Entry of Promise.resolve()
+ * Push a promise which is resolved with value
+ * Stack on entry:  [ ... value ]
+ * Stack on return: [ ... promise ]
  */
-DUK_LOCAL duk_ret_t promise_resolve(duk_context *ctx)
+DUK_LOCAL dux_promise_data *promise_push_resolved(duk_context *ctx)
 {
-	duk_ret_t result;
+	dux_promise_data *data;
 
-	/* [ value ] */
-	if ((duk_is_object(ctx, 0)) &&
-		(duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_FULFILL_REACTIONS) ||
-		 duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_REJECT_REACTIONS)))
+	/* [ ... value ] */
+	data = promise_get_data(ctx, -1);
+	if (data)
 	{
 		/*
 		 * value is a Promise object
 		 */
-		return 1; /* return value; */
+		return data;
 	}
 
-	promise_push_new(ctx, 1);
-	/* [ value promise ] */
-	duk_swap(ctx, 0, 1);
-	/* [ promise value ] */
-	result = promise_on_resolved(ctx);
-	if (result != 0)
-	{
-		return result;
-	}
-	/* [ promise ... ] */
-	duk_set_top(ctx, 1);
+	data = promise_push_new(ctx, 1);
+	/* [ ... value promise ] */
+	duk_swap_top(ctx, -2);
+	/* [ ... promise value ] */
+	promise_resolve_value(ctx, -2, data);
+	/* [ ... promise ] */
+	return data;
+}
+
+/*
+ * Entry of Promise.resolve()
+ */
+DUK_LOCAL duk_ret_t promise_resolve(duk_context *ctx)
+{
+	/* [ value ] */
+	promise_push_resolved(ctx);
 	/* [ promise ] */
 	return 1; /* return promise; */
 }
@@ -510,113 +824,38 @@ DUK_LOCAL duk_ret_t promise_resolve(duk_context *ctx)
  */
 DUK_LOCAL duk_ret_t promise_reject(duk_context *ctx)
 {
-	duk_ret_t result;
+	dux_promise_data *data;
 
 	/* [ reason ] */
-	promise_push_new(ctx, 1);
+	data = promise_push_new(ctx, 1);
 	/* [ reason promise ] */
 	duk_swap(ctx, 0, 1);
 	/* [ promise reason ] */
-	result = promise_on_rejected(ctx);
-	if (result != 0)
-	{
-		return result;
-	}
-	/* [ promise ... ] */
-	duk_set_top(ctx, 1);
+	promise_settle(ctx, 0, data, DUX_PROMISE_STATE_REJECTED);
 	/* [ promise ] */
 	return 1; /* return promise; */
 }
 
 /*
- * Handler for fulfillment in Promise.all()
+ * Replace each promise in array with its value
  */
-DUK_LOCAL duk_ret_t promise_all_resolver(duk_context *ctx)
+DUK_LOCAL void promise_collect_values(duk_context *ctx, duk_idx_t idx)
 {
-	duk_size_t len, waiting;
-	duk_uarridx_t idx;
-
-	/* [ promise ] */
-	if (!duk_get_prop_string(ctx, 0, DUX_IPK_PROMISE_WAITING_COUNT))
-	{
-		/*
-		 * This promise has been already rejected
-		 * by another child's rejection
-		 */
-		return 0; /* return undefined; */
-	}
-	/* [ promise uint ] */
-	waiting = duk_get_uint(ctx, 1);
-	if (waiting == 0)
-	{
-		return DUK_RET_ERROR;
-	}
-	if (--waiting > 0)
-	{
-		/*
-		 * There are still waiting promises
-		 */
-		duk_push_uint(ctx, waiting);
-		/* [ promise uint uint ] */
-		duk_put_prop_string(ctx, 0, DUX_IPK_PROMISE_WAITING_COUNT);
-		/* [ promise uint ] */
-		return 0; /* return undefined; */
-	}
-	duk_pop(ctx);
-	/* [ promise ] */
-
-	/*
-	 * All promises have been resolved
-	 */
-	duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_WAITING_COUNT);
-	duk_get_prop_string(ctx, 0, DUX_IPK_PROMISE_CHILDREN);
-	duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_CHILDREN);
-	/* [ promise children ] */
-	len = duk_get_length(ctx, 1);
+	duk_size_t len;
+	duk_uarridx_t aidx;
 
-	for (idx = 0; idx < len; ++idx)
+	/* [ ... arr ... ] */
+	len = duk_get_length(ctx, idx);
+	for (aidx = 0; aidx < len; ++aidx)
 	{
-		duk_get_prop_index(ctx, 1, idx);
-		/* [ promise children child ] */
-		duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-		duk_put_prop_index(ctx, 1, idx);
-		/* [ promise children child ] */
+		duk_get_prop_index(ctx, idx, aidx);
+		/* [ ... arr ... child ] */
+		duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE_VALUE);
+		duk_put_prop_index(ctx, idx, aidx);
+		/* [ ... arr ... child ] */
 		duk_pop(ctx);
-		/* [ promise children ] */
+		/* [ ... arr ... ] */
 	}
-	/* [ promise values ] */
-	return promise_transition(ctx, 1);
-}
-
-/*
- * Handler for rejection in Promise.all()/Promise.race()
- */
-DUK_LOCAL duk_ret_t promise_first_rejector(duk_context *ctx)
-{
-	/* [ promise child ] */
-	if (duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_VALUE))
-	{
-		/*
-		 * This promise has been already rejected
-		 * by another child's rejection
-		 */
-		return 0; /* return undefined; */
-	}
-
-	/*
-	 * Fail fast
-	 */
-	duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_WAITING_COUNT);
-	duk_del_prop_string(ctx, 0, DUX_IPK_PROMISE_CHILDREN);
-
-	if (!duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_VALUE))
-	{
-		return DUK_RET_ERROR;
-	}
-	/* [ promise child reason ] */
-	duk_replace(ctx, 1);
-	/* [ promise reason ] */
-	return promise_transition(ctx, 0);
 }
 
 /*
@@ -625,248 +864,119 @@ DUK_LOCAL duk_ret_t promise_first_rejector(duk_context *ctx)
  */
 DUK_LOCAL duk_ret_t promise_all(duk_context *ctx)
 {
-	duk_size_t len, waiting;
+	dux_promise_data *data;
+	dux_promise_data *cdata;
+	duk_size_t len;
+	duk_uint_t waiting;
 	duk_uarridx_t idx;
 
 	/* [ arr ] */
 	len = duk_get_length(ctx, 0);
-	duk_push_c_function(ctx, promise_resolve, 1);
-	/* [ arr func ] */
-	promise_push_new(ctx, 1);
-	/* [ arr func promise ] */
-	if (len == 0)
-	{
-		/*
-		 * No promises to wait
-		 * -> Return a promise which is resolved with empty array
-		 */
-		duk_push_array(ctx);
-		duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-		duk_push_undefined(ctx);
-		duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-		/* [ arr func promise ] */
-		return 1; /* return promise; */
-	}
-
+	data = promise_push_new(ctx, 1);
 	duk_push_array(ctx);
-	/* [ arr func promise children:3 ] */
+	/* [ arr promise children:2 ] */
 	waiting = 0;
 	for (idx = 0; idx < len; ++idx)
 	{
-		duk_dup(ctx, 1);
-		duk_push_this(ctx);
-		/* [ arr func promise children:3 func:4 constructor:5 ] */
 		duk_get_prop_index(ctx, 0, idx);
-		/* [ ... children:3 func:4 constructor:5 value:6 ] */
-		duk_call_method(ctx, 1);
-		/* [ ... children:3 child:4 ] */
+		cdata = promise_push_resolved(ctx);
+		/* [ arr promise children:2 child:3 ] */
 
-		if (duk_get_prop_string(ctx, 4, DUX_IPK_PROMISE_VALUE))
+		if (cdata->state == DUX_PROMISE_STATE_REJECTED)
 		{
-			/* [ ... children:3 child:4 value/reason:5 ] */
-
 			/*
-			 * Child promise has been already settled
+			 * Child promise has been already rejected
+			 * -> Fail fast
 			 */
-
-			if (duk_has_prop_string(ctx, 4, DUX_IPK_PROMISE_REJECT_REACTIONS))
-			{
-				/*
-				 * Child promise has been already rejected
-				 * -> Fail fast
-				 */
-				/* [ ... promise:2 children:3 child:4 reason:5 ] */
-				duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-				/* [ ... promise:2 children:3 child:4 ] */
-				duk_push_undefined(ctx);
-				duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_REJECT_REACTIONS);
-				duk_pop_2(ctx);
-				/* [ ... promise:2 ] */
-				return 1; /* return promise; */
-			}
+			duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_VALUE);
+			/* [ arr promise children:2 child:3 reason:4 ] */
+			promise_settle(ctx, 1, data, DUX_PROMISE_STATE_REJECTED);
+			duk_set_top(ctx, 2);
+			/* [ arr promise ] */
+			return 1; /* return promise; */
 		}
-		else
+
+		if (cdata->state == DUX_PROMISE_STATE_PENDING)
 		{
-			/*
-			 * Child promise is pending
-			 */
-			duk_pop(ctx);
-			/* [ ... children:3 child:4 ] */
 			++waiting;
-
-			duk_get_prop_string(ctx, 4, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-			/* [ ... children:3 child:4 arr(reactions):5 ] */
-			duk_push_c_function(ctx, promise_all_resolver, 1);
-			duk_dup(ctx, 2);
-			dux_bind_arguments(ctx, 1);
-			duk_put_prop_index(ctx, 5, duk_get_length(ctx, 5));
-			duk_pop(ctx);
-			/* [ ... children:3 child:4 ] */
-
-			duk_get_prop_string(ctx, 4, DUX_IPK_PROMISE_REJECT_REACTIONS);
-			/* [ ... promise:2 children:3 child:4 arr(reactions):5 ] */
-			duk_push_c_function(ctx, promise_first_rejector, 2);
-			duk_dup(ctx, 2);
-			duk_dup(ctx, 4);
-			dux_bind_arguments(ctx, 2);
-			duk_put_prop_index(ctx, 5, duk_get_length(ctx, 5));
+			duk_dup(ctx, 1);
+			/* [ arr promise children:2 child:3 promise ] */
+			promise_react(ctx, 3, cdata, DUX_PROMISE_JOB_ALL);
+			/* [ arr promise children:2 child:3 ] */
 		}
-		/* [ ... children:3 child:4 obj:5 ] */
-		duk_pop(ctx);
-		/* [ ... children:3 child:4 ] */
-		duk_put_prop_index(ctx, 3, idx);
-		/* [ ... children:3 ] */
+		duk_put_prop_index(ctx, 2, idx);
+		/* [ arr promise children:2 ] */
 	}
-	/* [ arr func promise children:3 ] */
 
 	if (waiting == 0)
 	{
 		/*
 		 * All children have been already resolved
+		 * (Also resolved with empty array if no promises to wait)
 		 */
-		for (idx = 0; idx < len; ++idx)
-		{
-			duk_get_prop_index(ctx, 3, idx);
-			/* [ ... children:3 child:4 ] */
-			duk_get_prop_string(ctx, 4, DUX_IPK_PROMISE_VALUE);
-			duk_put_prop_index(ctx, 3, idx);
-			/* [ ... children:3 child:4 ] */
-			duk_pop(ctx);
-			/* [ ... children:3 ] */
-		}
-		/* [ arr func promise values ] */
-		duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-		/* [ arr func promise ] */
-		duk_push_undefined(ctx);
-		duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-		/* [ arr func promise ] */
+		promise_collect_values(ctx, 2);
+		/* [ arr promise values:2 ] */
+		promise_settle(ctx, 1, data, DUX_PROMISE_STATE_FULFILLED);
+		/* [ arr promise ] */
 		return 1; /* return promise; */
 	}
 
-	/* [ arr func promise children:3 ] */
-	duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_CHILDREN);
-	/* [ arr func promise ] */
-	duk_push_uint(ctx, waiting);
-	duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_WAITING_COUNT);
-	promise_set_pending(ctx, 2);
-	/* [ arr func promise ] */
+	/* [ arr promise children:2 ] */
+	duk_put_prop_string(ctx, 1, DUX_IPK_PROMISE_CHILDREN);
+	/* [ arr promise ] */
+	data->waiting = waiting;
 	return 1; /* return promise; */
 }
 
-/*
- * Handler for fulfillment in Promise.race()
- */
-DUK_LOCAL duk_ret_t promise_race_resolver(duk_context *ctx)
-{
-	/* [ promise child ] */
-	if (duk_has_prop_string(ctx, 0, DUX_IPK_PROMISE_VALUE))
-	{
-		/*
-		 * This promise has been already resolved/rejected
-		 * by another child's fulfillment/rejection
-		 */
-		return 0; /* return undefined; */
-	}
-	/* [ promise child ] */
-	if (!duk_get_prop_string(ctx, 1, DUX_IPK_PROMISE_VALUE))
-	{
-		return DUK_RET_ERROR;
-	}
-	/* [ promise child value ] */
-	duk_replace(ctx, 1);
-	/* [ promise value ] */
-	return promise_transition(ctx, 1);
-}
-
 /*
  * Entry of Promise.race()
  * Note: Only arrays are acceptable for iterable object
  */
 DUK_LOCAL duk_ret_t promise_race(duk_context *ctx)
 {
+	dux_promise_data *data;
+	dux_promise_data *cdata;
 	duk_size_t len;
 	duk_uarridx_t idx;
 
 	/* [ arr ] */
 	len = duk_get_length(ctx, 0);
-	duk_push_c_function(ctx, promise_resolve, 1);
-	/* [ arr func ] */
-	promise_push_new(ctx, 1);
-	/* [ arr func promise ] */
-	if (len == 0)
-	{
-		/*
-		 * No promises to wait
-		 * -> Return a promise which never been settled
-		 */
-		goto pend;
-	}
+	data = promise_push_new(ctx, 1);
+	/* [ arr promise ] */
 
+	/*
+	 * If no promises to wait,
+	 * returns a promise which never been settled
+	 */
 	for (idx = 0; idx < len; ++idx)
 	{
-		duk_dup(ctx, 1);
-		duk_push_this(ctx);
-		/* [ arr func promise func:3 constructor:4 ] */
 		duk_get_prop_index(ctx, 0, idx);
-		/* [ ... func:3 constructor:4 value:5 ] */
-		duk_call_method(ctx, 1);
-		/* [ arr func promise child:3 ] */
+		cdata = promise_push_resolved(ctx);
+		/* [ arr promise child:2 ] */
 
-		if (duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_VALUE))
+		if (cdata->state != DUX_PROMISE_STATE_PENDING)
 		{
-			/* [ arr func promise child:3 value:4 ] */
-
 			/*
 			 * Child promise has been already settled
 			 */
-			duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
-			duk_push_undefined(ctx);
-			/* [ arr func promise child:3 undefined:4 ] */
-			if (duk_has_prop_string(ctx, 3, DUX_IPK_PROMISE_FULFILL_REACTIONS))
-			{
-				duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-			}
-			else
-			{
-				duk_put_prop_string(ctx, 2, DUX_IPK_PROMISE_REJECT_REACTIONS);
-			}
-			/* [ arr func promise child:3 ] */
+			duk_get_prop_string(ctx, 2, DUX_IPK_PROMISE_VALUE);
+			/* [ arr promise child:2 value/reason:3 ] */
+			promise_settle(ctx, 1, data, cdata->state);
 			duk_pop(ctx);
-			/* [ arr func promise ] */
+			/* [ arr promise ] */
 			return 1; /* return promise; */
 		}
-		duk_pop(ctx);
-		/* [ arr func promise child:3 ] */
 
 		/*
 		 * Child promise is pending
 		 */
-
-		duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_FULFILL_REACTIONS);
-		/* [ arr func promise child:3 arr(reactions):4 ] */
-		duk_push_c_function(ctx, promise_race_resolver, 2);
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 2);
-		duk_put_prop_index(ctx, 4, duk_get_length(ctx, 4));
+		duk_dup(ctx, 1);
+		/* [ arr promise child:2 promise ] */
+		promise_react(ctx, 2, cdata, DUX_PROMISE_JOB_RACE);
 		duk_pop(ctx);
-		/* [ arr func promise child:3 ] */
-
-		duk_get_prop_string(ctx, 3, DUX_IPK_PROMISE_REJECT_REACTIONS);
-		/* [ arr func promise child:3 arr(reactions):4 ] */
-		duk_push_c_function(ctx, promise_first_rejector, 2);
-		duk_dup(ctx, 2);
-		duk_dup(ctx, 3);
-		dux_bind_arguments(ctx, 2);
-		duk_put_prop_index(ctx, 4, duk_get_length(ctx, 4));
-		duk_pop_2(ctx);
-		/* [ arr func promise ] */
+		/* [ arr promise ] */
 	}
-	/* [ arr func promise ] */
-
-pend:
-	promise_set_pending(ctx, 2);
-	/* [ arr func promise ] */
+	/* [ arr promise ] */
 	return 1; /* return promise; */
 }
 
@@ -875,6 +985,8 @@ pend:
  */
 DUK_LOCAL duk_ret_t promise_constructor(duk_context *ctx)
 {
+	dux_promise_data *data;
+
 	/* [ executor ] */
 
 	if (!duk_is_constructor_call(ctx))
@@ -885,9 +997,16 @@ DUK_LOCAL duk_ret_t promise_constructor(duk_context *ctx)
 
 	duk_push_this(ctx);
 	/* [ executor this ] */
-	promise_set_pending(ctx, 1);
+	data = (dux_promise_data *)duk_push_fixed_buffer(ctx, sizeof(dux_promise_data));
+	memset(data, 0, sizeof(dux_promise_data));
+	duk_put_prop_string(ctx, 1, DUX_IPK_PROMISE_DATA);
 	/* [ executor this ] */
-	return promise_invoke_executor(ctx);
+	duk_swap(ctx, 0, 1);
+	duk_push_undefined(ctx);
+	/* [ this executor undefined ] */
+	promise_invoke_executor(ctx, 0, data);
+	/* [ this ] */
+	return 0; /* return undefined; */
 }
 
 /*
@@ -915,6 +1034,8 @@ DUK_LOCAL const duk_function_list_entry promise_proto_funcs[] = {
  */
 DUK_INTERNAL duk_errcode_t dux_promise_init(duk_context *ctx)
 {
+	dux_promise_queue *queue;
+
 	/* [ ... ] */
 	dux_push_named_c_constructor(
 			ctx, "Promise", promise_constructor, 1,
@@ -924,9 +1045,26 @@ DUK_INTERNAL duk_errcode_t dux_promise_init(duk_context *ctx)
 	/* [ ... constructor stash ] */
 	duk_dup(ctx, -2);
 	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE);
-	duk_push_array(ctx);
-	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_CALLBACKS);
+	duk_push_c_function(ctx, promise_run_job, DUX_PROMISE_JOB_SLOTS);
+	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_JOB);
+	duk_push_fixed_buffer(ctx, sizeof(dux_promise_queue));
+	/* [ ... constructor stash buf ] */
+	queue = (dux_promise_queue *)duk_get_buffer(ctx, -1, NULL);
+	if (!queue)
+	{
+		duk_pop_3(ctx);
+		return DUK_ERR_ERROR;
+	}
+	memset(queue, 0, sizeof(dux_promise_queue));
+	queue->max_jobs = DUX_PROMISE_TICK_MAX_JOBS;
+	queue->max_time = (duk_uint64_t)DUX_PROMISE_TICK_MAX_TIME * 1000000ULL;
+	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_QUEUE);
+	duk_push_thread(ctx);
+	/* [ ... constructor stash thr ] */
+	queue->job_context = duk_get_context(ctx, -1);
+	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_THREAD);
 	/* [ ... constructor stash ] */
+	promise_queue_grow(queue);
 	duk_pop(ctx);
 	/* [ ... constructor ] */
 	duk_put_global_string(ctx, "Promise");
@@ -934,62 +1072,113 @@ DUK_INTERNAL duk_errcode_t dux_promise_init(duk_context *ctx)
 	return DUK_ERR_NONE;
 }
 
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+/*
+ * Initialize simplified promise on first access to global.Promise
+ */
+DUK_INTERNAL duk_errcode_t dux_promise_init_lazy(duk_context *ctx)
+{
+	return dux_define_lazy_global(ctx, "Promise", dux_promise_init);
+}
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
+
 /*
  * Tick handler for promises
  */
 DUK_INTERNAL duk_int_t dux_promise_tick(duk_context *ctx)
 {
-	duk_int_t result = DUX_TICK_RET_JOBLESS;
-	duk_size_t len;
-	duk_uarridx_t idx;
+	dux_promise_queue *queue;
+	duk_uint_t jobs;
+	duk_uint64_t start;
 
 	/* [ ... ] */
+	queue = promise_get_queue(ctx);
+	if ((!queue) || (queue->count == 0))
+	{
+		return DUX_TICK_RET_JOBLESS;
+	}
+
 	duk_push_heap_stash(ctx);
-	/* [ ... stash ] */
+	duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE_JOB);
+	duk_remove(ctx, -2);
+	/* [ ... func ] */
 
-	if (duk_get_prop_string(ctx, -1, DUX_IPK_PROMISE_CALLBACKS) &&
-		((len = duk_get_length(ctx, -1)) > 0))
+	/*
+	 * Run jobs until the queue becomes empty
+	 * (including jobs queued by the jobs themselves)
+	 * or the budget is exhausted
+	 */
+	start = (queue->max_time > 0) ? promise_current_ns() : 0;
+	for (jobs = 0; queue->count > 0; )
 	{
-		/* [ ... stash arr ] */
-		duk_push_array(ctx);
-		duk_put_prop_string(ctx, -3, DUX_IPK_PROMISE_CALLBACKS);
-		/* [ ... stash arr ] */
+		duk_dup_top(ctx);
+		promise_dequeue_job(ctx, queue);
+		/* [ ... func func kind arg1 arg2 arg3 ] */
+		if (duk_pcall(ctx, DUX_PROMISE_JOB_SLOTS) != DUK_EXEC_SUCCESS)
+		{
+			/* [ ... func err ] */
+			// TODO: crash?
+			dux_report_error(ctx);
+		}
+		/* [ ... func retval/err ] */
+		duk_pop(ctx);
+		/* [ ... func ] */
 
-		result = DUX_TICK_RET_CONTINUE;
-		for (idx = 0; idx < len; ++idx)
+		if ((++jobs >= queue->max_jobs) && (queue->max_jobs > 0))
 		{
-			duk_get_prop_index(ctx, -1, idx);
-			/* [ ... stash arr func ] */
-			if (duk_pcall(ctx, 0) != DUK_EXEC_SUCCESS)
-			{
-				/* [ ... stash arr err ] */
-				// TODO: crash?
-				dux_report_error(ctx);
-			}
-			/* [ ... stash arr retval/err ] */
-			duk_pop(ctx);
-			/* [ ... stash arr ] */
+			break;
+		}
+		if ((queue->max_time > 0) && (promise_current_ns() - start >= queue->max_time))
+		{
+			break;
 		}
 	}
-	duk_pop_2(ctx);
+	duk_pop(ctx);
 	/* [ ... ] */
-	return result;
+	dux_loop_stats_add_jobs(ctx, jobs);
+
+	if (queue->count > 0)
+	{
+		/* Budget exhausted (Remaining jobs will be run in next tick) */
+		dux_wakeup_signal(ctx);
+	}
+	return DUX_TICK_RET_CONTINUE;
 }
 
 /*
- * Entry of Node.js style callback
+ * Get number of jobs waiting in the queue
  */
-DUK_LOCAL duk_ret_t promise_cb_node_style(duk_context *ctx)
+DUK_INTERNAL duk_uint_t dux_promise_queue_depth(duk_context *ctx)
 {
-	duk_bool_t resolved = 0;
+	dux_promise_queue *queue;
+
+	queue = promise_get_queue(ctx);
+	return queue ? queue->count : 0;
+}
 
-	/* [ promise error result ] */
-	if (duk_is_null_or_undefined(ctx, 1)) {
-		duk_remove(ctx, 1);
-		resolved = 1;
+/*
+ * Set budget of jobs per tick
+ * (max_jobs: number of jobs, max_time: time in milliseconds, 0 means unlimited)
+ */
+DUK_INTERNAL void dux_promise_set_budget(duk_context *ctx, duk_uint_t max_jobs, duk_uint_t max_time)
+{
+	dux_promise_queue *queue;
+
+	queue = promise_get_queue(ctx);
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+	if (!queue)
+	{
+		duk_size_t before = dux_memory_current(ctx);
+		(void)dux_promise_init(ctx);
+		dux_memory_record(ctx, "Promise", before);
+		queue = promise_get_queue(ctx);
+	}
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
+	if (queue)
+	{
+		queue->max_jobs = max_jobs;
+		queue->max_time = (duk_uint64_t)max_time * 1000000ULL;
 	}
-	/* [ promise result/reason ] */
-	return promise_transition(ctx, resolved);
 }
 
 /*
@@ -998,6 +1187,8 @@ DUK_LOCAL duk_ret_t promise_cb_node_style(duk_context *ctx)
  */
 DUK_INTERNAL void dux_promise_new_with_node_callback(duk_context *ctx, duk_idx_t func_idx)
 {
+	dux_promise_data *data;
+
 	/* [ ... func:func_idx ... ] */
 
 	func_idx = duk_normalize_index(ctx, func_idx);
@@ -1014,16 +1205,17 @@ DUK_INTERNAL void dux_promise_new_with_node_callback(duk_context *ctx, duk_idx_t
 	 * Create a promise which is converted to callback function
 	 * with (error, result)
 	 */
-	promise_push_new(ctx, 0);
-	/* [ ... undef:func_idx ... promise ] */
-	promise_set_pending(ctx, -1);
+	data = promise_push_new(ctx, 0);
 	/* [ ... undef:func_idx ... promise ] */
-	duk_push_c_function(ctx, promise_cb_node_style, 3);
+	duk_push_c_function(ctx, promise_resolver, 2);
+	duk_set_magic(ctx, -1, DUX_PROMISE_RESOLVER_NODE);
 	duk_dup(ctx, -2);
-	dux_bind_arguments(ctx, 1);
-	/* [ ... undef:func_idx ... promise bound_func ] */
+	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_TARGET);
+	duk_push_uint(ctx, data->generation);
+	duk_put_prop_string(ctx, -2, DUX_IPK_PROMISE_GENERATION);
+	/* [ ... undef:func_idx ... promise func ] */
 	duk_replace(ctx, func_idx);
-	/* [ ... bound_func:func_idx ... promise ] */
+	/* [ ... func:func_idx ... promise ] */
 }
 
 #endif  /* !DUX_OPT_NO_PROMISE && !DUX_OPT_STANDARD_PROMISE */
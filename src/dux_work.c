@@ -1,7 +1,9 @@
 #include "dux_internal.h"
 #include <pthread.h>
 #include <semaphore.h>
+#if defined(DUX_OPT_NO_WAIT)
 #include <sched.h>
+#endif
 #include <errno.h>
 
 typedef union
@@ -11,32 +13,228 @@ typedef union
     {
         duk_uint8_t queued;
         duk_uint8_t abort;
-        duk_uint8_t done;
         duk_uint8_t after_nargs;
         dux_work_finalizer finalizer;
         duk_int_t result;
-        pthread_t thread;
         dux_work_cb work_cb;
         dux_after_work_cb after_work_cb;
+        void *next;
     };
 }
 dux_work_priv_t;
 
+/*
+ * Worker thread pool (shared by all requests in one heap)
+ * Submission queue is a bounded ring buffer protected by lock.
+ * Finished requests are pushed to a lock-free list (completed)
+ * which is taken by dux_work_tick at once.
+ * Each completion posts wakeup to resume dux_tick_wait.
+ */
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    duk_uint_t head;
+    duk_uint_t count;
+    duk_uint_t nthreads;
+    duk_bool_t shutdown;
+    duk_uint_t pending;
+    dux_work_priv_t *completed;
+    dux_wakeup *wakeup;
+    pthread_t threads[DUX_WORK_THREADS];
+    dux_work_priv_t *queue[DUX_WORK_QUEUE_SIZE];
+}
+dux_work_pool_t;
+
 DUK_LOCAL const char DUX_IPK_WORK[] = DUX_IPK("Work");
+DUK_LOCAL const char DUX_IPK_WORK_POOL[] = DUX_IPK("wPool");
 DUK_LOCAL int DUX_IDX_WORK_THREAD  = 0;
 DUK_LOCAL int DUX_IDX_WORK_REQUEST = 1;
 
+/**
+ * @func work_push_completed
+ * @brief Push finished request to completion list (Multiple producers)
+ */
+DUK_LOCAL void work_push_completed(dux_work_pool_t *pool, dux_work_priv_t *req_priv)
+{
+    dux_work_priv_t *head = __atomic_load_n(&pool->completed, __ATOMIC_RELAXED);
+
+    do
+    {
+        req_priv->next = head;
+    }
+    while (!__atomic_compare_exchange_n(&pool->completed, &head, req_priv,
+                1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * @func work_take_completed
+ * @brief Take all finished requests in completion order (Single consumer)
+ */
+DUK_LOCAL dux_work_priv_t *work_take_completed(dux_work_pool_t *pool)
+{
+    dux_work_priv_t *list;
+    dux_work_priv_t *ordered = NULL;
+
+    if (!__atomic_load_n(&pool->completed, __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+    list = __atomic_exchange_n(&pool->completed, NULL, __ATOMIC_ACQUIRE);
+
+    // Reverse LIFO list into FIFO order
+    while (list)
+    {
+        dux_work_priv_t *next = (dux_work_priv_t *)list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
 /**
  * @func work_worker
  * @brief Worker thread entry (detached from Duktape contexts!)
  */
-DUK_LOCAL void *work_worker(dux_work_priv_t *req_priv)
+DUK_LOCAL void *work_worker(dux_work_pool_t *pool)
 {
-    req_priv->result = (*req_priv->work_cb)((dux_work_t *)(req_priv + 1));
-    req_priv->done = 1;
+    dux_work_priv_t *req_priv;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while ((pool->count == 0) && (!pool->shutdown))
+        {
+            pthread_cond_wait(&pool->not_empty, &pool->lock);
+        }
+        if (pool->shutdown)
+        {
+            break;
+        }
+        req_priv = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % DUX_WORK_QUEUE_SIZE;
+        --pool->count;
+        pthread_cond_signal(&pool->not_full);
+        pthread_mutex_unlock(&pool->lock);
+
+        req_priv->result = (*req_priv->work_cb)((dux_work_t *)(req_priv + 1));
+        work_push_completed(pool, req_priv);
+        dux_wakeup_post(pool->wakeup);
+
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
     return NULL;
 }
 
+/**
+ * @func work_pool_start
+ * @brief Start worker threads
+ */
+DUK_LOCAL dux_work_pool_t *work_pool_start(duk_context *ctx)
+{
+    dux_work_pool_t *pool;
+
+    pool = (dux_work_pool_t *)duk_alloc(ctx, sizeof(*pool));
+    if (!pool)
+    {
+        return NULL;
+    }
+    memset(pool, 0, sizeof(*pool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+    pthread_cond_init(&pool->not_full, NULL);
+    pool->wakeup = dux_wakeup_ref(dux_get_wakeup(ctx));
+
+    for (; pool->nthreads < DUX_WORK_THREADS; ++pool->nthreads)
+    {
+        if (pthread_create(&pool->threads[pool->nthreads], NULL,
+                (void *(*)(void *))work_worker, pool) != 0)
+        {
+            break;
+        }
+    }
+
+    if (pool->nthreads == 0)
+    {
+        // No worker available
+        dux_wakeup_release(ctx, pool->wakeup);
+        pthread_cond_destroy(&pool->not_full);
+        pthread_cond_destroy(&pool->not_empty);
+        pthread_mutex_destroy(&pool->lock);
+        duk_free(ctx, pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/**
+ * @func work_pool_stop
+ * @brief Stop and join all worker threads
+ */
+DUK_LOCAL void work_pool_stop(duk_context *ctx, dux_work_pool_t *pool)
+{
+    duk_uint_t index;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_cond_broadcast(&pool->not_full);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (index = 0; index < pool->nthreads; ++index)
+    {
+        pthread_join(pool->threads[index], NULL);
+    }
+    dux_wakeup_release(ctx, pool->wakeup);
+    pthread_cond_destroy(&pool->not_full);
+    pthread_cond_destroy(&pool->not_empty);
+    pthread_mutex_destroy(&pool->lock);
+    duk_free(ctx, pool);
+}
+
+/**
+ * @func work_pool_submit
+ * @brief Push request to submission queue (Waits while queue is full)
+ */
+DUK_LOCAL duk_bool_t work_pool_submit(dux_work_pool_t *pool, dux_work_priv_t *req_priv)
+{
+    pthread_mutex_lock(&pool->lock);
+    while ((pool->count >= DUX_WORK_QUEUE_SIZE) && (!pool->shutdown))
+    {
+        pthread_cond_wait(&pool->not_full, &pool->lock);
+    }
+    if (pool->shutdown)
+    {
+        pthread_mutex_unlock(&pool->lock);
+        return 0;
+    }
+    pool->queue[(pool->head + pool->count) % DUX_WORK_QUEUE_SIZE] = req_priv;
+    ++pool->count;
+    pthread_cond_signal(&pool->not_empty);
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+/**
+ * @func work_get_pool
+ * @brief Get worker thread pool
+ */
+DUK_LOCAL dux_work_pool_t *work_get_pool(duk_context *ctx, duk_idx_t obj_idx)
+{
+    /* [ ... obj ... ] */
+    dux_work_pool_t *pool;
+
+    duk_get_prop_string(ctx, obj_idx, DUX_IPK_WORK_POOL);
+    /* [ ... obj ... ptr ] */
+    pool = (dux_work_pool_t *)duk_get_pointer(ctx, -1);
+    duk_pop(ctx);
+    /* [ ... obj ... ] */
+    return pool;
+}
+
 /**
  * @func work_free
  * @brief Free memory for work request
@@ -58,6 +256,7 @@ DUK_LOCAL duk_ret_t work_finalizer(duk_context *ctx)
 {
     /* [ obj ] */
     dux_work_priv_t *req_priv;
+    dux_work_pool_t *pool;
 
     // Set abort flag of all workers
     duk_enum(ctx, 0, DUK_ENUM_OWN_PROPERTIES_ONLY);
@@ -79,7 +278,15 @@ DUK_LOCAL duk_ret_t work_finalizer(duk_context *ctx)
     duk_pop(ctx);
     /* [ obj ] */
 
-    // Join threads
+    // Join threads (Queued requests which have not been started are dropped)
+    pool = work_get_pool(ctx, 0);
+    if (pool)
+    {
+        duk_del_prop_string(ctx, 0, DUX_IPK_WORK_POOL);
+        work_pool_stop(ctx, pool);
+    }
+
+    // Free requests
     duk_enum(ctx, 0, DUK_ENUM_OWN_PROPERTIES_ONLY);
     /* [ obj enum ] */
     while (duk_next(ctx, 1, 1))
@@ -92,7 +299,6 @@ DUK_LOCAL duk_ret_t work_finalizer(duk_context *ctx)
         duk_del_prop_index(ctx, 3, DUX_IDX_WORK_REQUEST);
         if (req_priv && req_priv->work_cb)
         {
-            pthread_join(req_priv->thread, NULL);
             work_free(ctx, req_priv);
         }
         duk_pop_3(ctx);
@@ -125,11 +331,17 @@ DUK_LOCAL duk_ret_t queue_work_safe(duk_context *ctx, dux_work_priv_t *req_priv)
 {
     /* [ ... arg1 ... argN ] */
     duk_context *after_ctx;
+    dux_work_pool_t *pool;
 
     duk_push_heap_stash(ctx);
     /* [ ... arg1 ... argN stash ] */
     duk_get_prop_string(ctx, -1, DUX_IPK_WORK);
     /* [ ... arg1 ... argN stash obj ] */
+    pool = work_get_pool(ctx, -1);
+    if (!pool)
+    {
+        return duk_generic_error(ctx, "No worker thread available");
+    }
     duk_push_pointer(ctx, req_priv);
     /* [ ... arg1 ... argN stash obj ptr ] */
     duk_push_array(ctx);
@@ -142,7 +354,6 @@ DUK_LOCAL duk_ret_t queue_work_safe(duk_context *ctx, dux_work_priv_t *req_priv)
     duk_put_prop_index(ctx, -2, DUX_IDX_WORK_REQUEST);
     /* [ ... arg1 ... argN stash obj ptr arr ] */
     duk_put_prop(ctx, -3);
-    req_priv->queued = 1;
     /* [ ... arg1 ... argN stash obj ] */
     duk_pop_2(ctx);
     /* [ ... arg1 ... argN ] */
@@ -150,11 +361,18 @@ DUK_LOCAL duk_ret_t queue_work_safe(duk_context *ctx, dux_work_priv_t *req_priv)
     duk_xmove_top(after_ctx, ctx, req_priv->after_nargs);
     /* [ ... ] (ctx) */
     /* [ undefined arg1 ... argN ] (after_ctx) */
-    if (pthread_create(&req_priv->thread, NULL, (void *(*)(void *))work_worker, req_priv) != 0)
+    if (!work_pool_submit(pool, req_priv))
     {
-        req_priv->work_cb = NULL;
-        return duk_generic_error(ctx, "Cannot create worker thread (errno=%d)", errno);
+        duk_push_heap_stash(ctx);
+        duk_get_prop_string(ctx, -1, DUX_IPK_WORK);
+        /* [ ... stash obj ] */
+        duk_push_pointer(ctx, req_priv);
+        duk_del_prop(ctx, -2);
+        /* [ ... stash obj ] */
+        return duk_generic_error(ctx, "Work queue has been shut down");
     }
+    req_priv->queued = 1;
+    ++pool->pending;
     return 0;
 }
 
@@ -203,10 +421,20 @@ DUK_INTERNAL void dux_queue_work(duk_context *ctx, const dux_work_t *req, duk_si
 DUK_INTERNAL duk_errcode_t dux_work_init(duk_context *ctx)
 {
     /* [ ... ] */
+    dux_work_pool_t *pool;
+
+    pool = work_pool_start(ctx);
+    if (!pool)
+    {
+        return DUK_ERR_ERROR;
+    }
     duk_push_heap_stash(ctx);
     /* [ ... stash ] */
     duk_push_object(ctx);
     /* [ ... stash obj ] */
+    duk_push_pointer(ctx, pool);
+    duk_put_prop_string(ctx, -2, DUX_IPK_WORK_POOL);
+    /* [ ... stash obj ] */
     duk_push_c_function(ctx, work_finalizer, 1);
     duk_set_finalizer(ctx, -2);
     /* [ ... stash obj ] */
@@ -224,7 +452,9 @@ DUK_INTERNAL duk_errcode_t dux_work_init(duk_context *ctx)
 DUK_INTERNAL duk_int_t dux_work_tick(duk_context *ctx)
 {
     /* [ ... ] */
-    duk_int_t result;
+    dux_work_pool_t *pool;
+    dux_work_priv_t *req_priv, *next;
+    duk_uint_t jobs = 0;
 
     duk_push_heap_stash(ctx);
     /* [ ... stash ] */
@@ -237,39 +467,28 @@ DUK_INTERNAL duk_int_t dux_work_tick(duk_context *ctx)
     }
     /* [ ... stash obj ] */
 
-    result = DUX_TICK_RET_JOBLESS;
+    pool = work_get_pool(ctx, -1);
+    if (!pool)
+    {
+        duk_pop_2(ctx);
+        /* [ ... ] */
+        return DUX_TICK_RET_JOBLESS;
+    }
 
-    duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
-    /* [ ... stash obj enum ] */
-    while (duk_next(ctx, -1, 1))
+    // Process finished requests only
+    for (req_priv = work_take_completed(pool); req_priv; req_priv = next)
     {
-        /* [ ... stash obj enum key arr ] */
-        dux_work_priv_t *req_priv;
+        /* [ ... stash obj ] */
         duk_context *after_ctx;
 
-        duk_get_prop_index(ctx, -1, DUX_IDX_WORK_REQUEST);
-        /* [ ... stash obj enum key arr ptr ] */
-        req_priv = (dux_work_priv_t *)duk_get_pointer(ctx, -1);
-        if ((!req_priv) || (!req_priv->work_cb))
-        {
-            duk_pop_2(ctx);
-            /* [ ... stash obj enum key ] */
-            goto cleanup;
-        }
-
-        result = DUX_TICK_RET_CONTINUE;
-        if (!req_priv->done)
-        {
-            // Still running
-            duk_pop_3(ctx);
-            /* [ ... stash obj enum ] */
-            continue;
-        }
-
-        // Finished
-        pthread_join(req_priv->thread, NULL);
-        duk_get_prop_index(ctx, -2, DUX_IDX_WORK_THREAD);
-        /* [ ... stash obj enum key arr ptr thr ] */
+        next = (dux_work_priv_t *)req_priv->next;
+        --pool->pending;
+        ++jobs;
+        duk_push_pointer(ctx, req_priv);
+        duk_get_prop(ctx, -2);
+        /* [ ... stash obj arr ] */
+        duk_get_prop_index(ctx, -1, DUX_IDX_WORK_THREAD);
+        /* [ ... stash obj arr thr ] */
         after_ctx = duk_get_context(ctx, -1);
         if (after_ctx && req_priv->after_work_cb)
         {
@@ -287,20 +506,26 @@ DUK_INTERNAL duk_int_t dux_work_tick(duk_context *ctx)
             duk_set_top(after_ctx, 0);
             /* after_ctx: [  ] */
         }
-        duk_pop_3(ctx);
-        /* [ ... stash obj enum key ] */
-
-cleanup:
-        duk_del_prop(ctx, -3);
-        /* [ ... stash obj enum ] */
+        duk_pop_2(ctx);
+        /* [ ... stash obj ] */
+        duk_push_pointer(ctx, req_priv);
+        duk_del_prop(ctx, -2);
         work_free(ctx, req_priv);
     }
-    /* [ ... stash obj enum ] */
+    /* [ ... stash obj ] */
+
+    duk_pop_2(ctx);
+    /* [ ... ] */
+    dux_loop_stats_add_jobs(ctx, jobs);
 
+    if (pool->pending == 0)
+    {
+        return DUX_TICK_RET_JOBLESS;
+    }
+
+#if defined(DUX_OPT_NO_WAIT)
     // Give other threads the time to process queued work
     sched_yield();
-
-    duk_pop_3(ctx);
-    /* [ ... ] */
-    return result;
+#endif
+    return DUX_TICK_RET_CONTINUE;
 }
@@ -3,6 +3,18 @@
 
 #if !defined(DUX_OPT_NO_WORK)
 
+/*
+ * Constants
+ */
+
+#if !defined(DUX_WORK_THREADS)
+#define DUX_WORK_THREADS    4
+#endif
+
+#if !defined(DUX_WORK_QUEUE_SIZE)
+#define DUX_WORK_QUEUE_SIZE 64
+#endif
+
 /*
  * Type definitions
  */
@@ -26,7 +38,7 @@ DUK_INTERNAL_DECL void dux_queue_work(duk_context *ctx, const dux_work_t *req, d
 DUK_INTERNAL_DECL duk_errcode_t dux_work_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_work_tick(duk_context *ctx);
 #define DUX_INIT_WORK       dux_work_init,
-#define DUX_TICK_WORK       dux_work_tick,
+#define DUX_TICK_WORK       DUX_TICK_HANDLER(dux_work_tick, "work")
 
 #else   /* !DUX_OPT_NO_WORK */
 
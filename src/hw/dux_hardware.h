@@ -15,7 +15,7 @@
 DUK_INTERNAL_DECL duk_errcode_t dux_hardware_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_hardware_tick(duk_context *ctx);
 #define DUX_INIT_HARDWARE   dux_hardware_init,
-#define DUX_TICK_HARDWARE   dux_hardware_tick,
+#define DUX_TICK_HARDWARE   DUX_TICK_HANDLER(dux_hardware_tick, "hardware")
 
 #else   /* !DUX_OPT_NO_HARDWARE_MODULES */
 
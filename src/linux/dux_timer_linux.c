@@ -7,14 +7,14 @@ DUK_INTERNAL void dux_timer_arch_init(void)
 {
 }
 
-DUK_INTERNAL duk_uint_t dux_timer_arch_current(void)
+DUK_INTERNAL duk_uint64_t dux_timer_arch_current_ns(void)
 {
 	struct timespec tp;
 	if (clock_gettime(CLOCK_MONOTONIC, &tp) != 0)
 	{
 		return 0;
 	}
-	return (duk_uint_t)(tp.tv_sec * 1000 + tp.tv_nsec / 1000000);
+	return ((duk_uint64_t)tp.tv_sec * 1000000000ULL) + (duk_uint64_t)tp.tv_nsec;
 }
 
 #endif  /* !DUX_OPT_NO_TIMER && __linux__ */
@@ -1,23 +1,318 @@
 #if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_EVENTS)
 #include "../dux_internal.h"
 
-DUK_LOCAL const char DUX_KEY_EVENTS[] = "_events";
-DUK_LOCAL const char DUX_KEY_EVENTSCOUNT[] = "_eventsCount";
+/*
+ * Internal data structure:
+ *    emitter[DUX_IPK_EVENTS] = { <key>: list };
+ *    list = { 0: header, <ref>: listener, ... };
+ *    header = new PlainBuffer(events_header + events_slot[capacity] + once bits + dead bits);
+ *
+ * Listeners are called through heap pointers in the native slots, so emit()
+ * never reads them from the list object. The list object only keeps them
+ * reachable (each slot remembers its <ref> key).
+ * Slots are modified in place, except that prepending or removing while emit()
+ * is running on the list makes a new list (the running emit() keeps the old one).
+ * "once" listeners are taken at the beginning of emit() by moving their bits
+ * from once bits to dead bits. Dead slots are skipped by nested emit() and
+ * swept when the outermost emit() on the list returns.
+ *
+ * Coalescing (Enabled by setCoalescing()):
+ *    emitter[DUX_IPK_COALESCE] = { <key>: true or [ args1, ..., argsN ] };
+ *    stash[DUX_IPK_EVENTS_PENDING] = [ [ emitter, key, [ args1, ..., argsN ] ], ... ];
+ *
+ * Profiling (Enabled by setProfiling()):
+ *    emitter[DUX_IPK_EVENTS_STATS] = { <key>: new PlainBuffer(events_stat) };
+ */
+DUK_LOCAL const char DUX_IPK_EVENTS[] = DUX_IPK("evTbl");
+DUK_LOCAL const char DUX_IPK_COALESCE[] = DUX_IPK("evCoal");
+DUK_LOCAL const char DUX_IPK_EVENTS_PENDING[] = DUX_IPK("evPend");
+DUK_LOCAL const char DUX_IPK_EVENTS_STATS[] = DUX_IPK("evStat");
+DUK_LOCAL const char DUX_IPK_PROFILING[] = DUX_IPK("evProf");
 DUK_LOCAL const char DUX_KEY_MAXLISTENERS[] = "_maxListeners";
-DUK_LOCAL const char DUX_KEY_LISTENER[] = "listener";
 DUK_LOCAL const char DUX_IPK_DEFMAXLISTENERS[] = "evDefMax";
 
+#define EVENTS_WORD_BITS        (sizeof(duk_uint_t) * 8)
+#define EVENTS_WORDS(count)     (((count) + EVENTS_WORD_BITS - 1) / EVENTS_WORD_BITS)
+#define EVENTS_MIN_CAPACITY     4
+#define EVENTS_MAX_REF          0xfffffff0UL
+
+/**
+ * Header of listener list (at key 0 of list)
+ */
+typedef struct events_header
+{
+    duk_uint_t count;       /* Number of slots */
+    duk_uint_t capacity;    /* Number of allocated slots */
+    duk_uint_t once_count;  /* Number of "once" listeners not taken yet */
+    duk_uint_t dead_count;  /* Number of slots taken by running emit() */
+    duk_uint_t depth;       /* Nesting level of emit() running on this list */
+    duk_uarridx_t next_ref; /* Key of list for next listener */
+}
+events_header;
+
+/**
+ * Slot of listener
+ */
+typedef struct events_slot
+{
+    void *func;             /* Heap pointer of listener (NULL for lightfunc) */
+    duk_uarridx_t ref;      /* Key of list which keeps listener reachable */
+}
+events_slot;
+
+#define EVENTS_HEADER_SIZE \
+    ((sizeof(events_header) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+#define EVENTS_SLOTS(header) \
+    ((events_slot *)((duk_uint8_t *)(header) + EVENTS_HEADER_SIZE))
+#define EVENTS_ONCE(header) \
+    ((duk_uint_t *)(EVENTS_SLOTS(header) + (header)->capacity))
+#define EVENTS_DEAD(header) \
+    (EVENTS_ONCE(header) + EVENTS_WORDS((header)->capacity))
+
+/**
+ * Statistics of event (for profiling)
+ */
+typedef struct events_stat
+{
+    duk_uint_t count;       /* Number of dispatches */
+    duk_uint_t calls;       /* Number of listener calls */
+    duk_uint64_t time_ns;   /* Cumulative time of listeners */
+}
+events_stat;
+
+/**
+ * Get size of listener list header with the specified capacity
+ */
+DUK_LOCAL duk_size_t events_header_size(duk_uint_t capacity)
+{
+    return EVENTS_HEADER_SIZE + sizeof(events_slot) * capacity +
+        sizeof(duk_uint_t) * EVENTS_WORDS(capacity) * 2;
+}
+
+/**
+ * Test bit of listener
+ */
+DUK_LOCAL duk_bool_t events_test_bit(const duk_uint_t *bits, duk_uint_t index)
+{
+    return (bits[index / EVENTS_WORD_BITS] >> (index % EVENTS_WORD_BITS)) & 1;
+}
+
+/**
+ * Set or clear bit of listener
+ */
+DUK_LOCAL void events_put_bit(duk_uint_t *bits, duk_uint_t index, duk_bool_t value)
+{
+    duk_uint_t mask = ((duk_uint_t)1) << (index % EVENTS_WORD_BITS);
+
+    if (value) {
+        bits[index / EVENTS_WORD_BITS] |= mask;
+    } else {
+        bits[index / EVENTS_WORD_BITS] &= ~mask;
+    }
+}
+
+/**
+ * Move bits of listeners [from, from + count) to [to, to + count)
+ */
+DUK_LOCAL void events_move_bits(duk_uint_t *bits, duk_uint_t to, duk_uint_t from, duk_uint_t count)
+{
+    duk_uint_t index;
+
+    if (to < from) {
+        for (index = 0; index < count; ++index) {
+            events_put_bit(bits, to + index, events_test_bit(bits, from + index));
+        }
+    } else {
+        for (index = count; index > 0; --index) {
+            events_put_bit(bits, to + index - 1, events_test_bit(bits, from + index - 1));
+        }
+    }
+}
+
+/**
+ * Push new empty listener list
+ */
+DUK_LOCAL events_header *events_push_list(duk_context *ctx, duk_uint_t capacity)
+{
+    events_header *header;
+    duk_size_t size;
+
+    if (capacity < EVENTS_MIN_CAPACITY) {
+        capacity = EVENTS_MIN_CAPACITY;
+    }
+    /* [ ... ] */
+    duk_push_bare_object(ctx);
+    size = events_header_size(capacity);
+    header = (events_header *)duk_push_dynamic_buffer(ctx, size);
+    memset(header, 0, size);
+    header->capacity = capacity;
+    header->next_ref = 1;
+    duk_put_prop_index(ctx, -2, 0);
+    /* [ ... list ] */
+    return header;
+}
+
+/**
+ * Get header of listener list
+ */
+DUK_LOCAL events_header *events_get_header(duk_context *ctx, duk_idx_t list_idx)
+{
+    events_header *header;
+
+    /* [ ... list ... ] */
+    duk_get_prop_index(ctx, list_idx, 0);
+    header = (events_header *)duk_get_buffer(ctx, -1, NULL);
+    duk_pop(ctx);
+    return header;
+}
+
 /**
- * Update events count
+ * Push listener of slot
  */
-DUK_LOCAL void events_update_count(duk_context *ctx, duk_idx_t this_idx, duk_int_t diff)
+DUK_LOCAL void events_push_listener(duk_context *ctx, duk_idx_t list_idx, const events_slot *slot)
 {
-    /* [ ... this ... ] */
-    this_idx = duk_normalize_index(ctx, this_idx);
-    duk_get_prop_string(ctx, this_idx, DUX_KEY_EVENTSCOUNT);
-    duk_push_uint(ctx, duk_require_uint(ctx, -1) + diff);
-    duk_put_prop_string(ctx, this_idx, DUX_KEY_EVENTSCOUNT);
+    /* [ ... list ... ] */
+    if (slot->func) {
+        duk_push_heapptr(ctx, slot->func);
+    } else {
+        /* Lightfunc has no heap pointer */
+        duk_get_prop_index(ctx, list_idx, slot->ref);
+    }
+    /* [ ... list ... func ] */
+}
+
+/**
+ * Push listener table of this (Throws TypeError if this is not an EventEmitter)
+ */
+DUK_LOCAL void events_push_table(duk_context *ctx)
+{
+    /* [ ... ] */
+    duk_push_this(ctx);
+    if (!duk_get_prop_string(ctx, -1, DUX_IPK_EVENTS)) {
+        (void)duk_type_error(ctx, "not an EventEmitter");
+    }
+    duk_remove(ctx, -2);
+    /* [ ... table ] */
+}
+
+/**
+ * Replace listener list with a new one which has live slots only
+ * (Used when slots are moved while emit() is running on the list)
+ */
+DUK_LOCAL events_header *events_renew_list(duk_context *ctx, duk_idx_t table_idx, duk_idx_t key_idx, duk_idx_t list_idx)
+{
+    events_header *src;
+    events_header *dest;
+    events_slot *slot;
+    duk_uint_t index;
+
+    table_idx = duk_normalize_index(ctx, table_idx);
+    list_idx = duk_normalize_index(ctx, list_idx);
+    src = events_get_header(ctx, list_idx);
+    /* [ ... list ... ] */
+    dest = events_push_list(ctx, src->count - src->dead_count);
+    /* [ ... list ... new_list ] */
+    for (index = 0; index < src->count; ++index) {
+        if (events_test_bit(EVENTS_DEAD(src), index)) {
+            continue;
+        }
+        slot = &EVENTS_SLOTS(dest)[dest->count];
+        *slot = EVENTS_SLOTS(src)[index];
+        events_push_listener(ctx, list_idx, slot);
+        slot->ref = dest->next_ref++;
+        duk_put_prop_index(ctx, -2, slot->ref);
+        if (events_test_bit(EVENTS_ONCE(src), index)) {
+            events_put_bit(EVENTS_ONCE(dest), dest->count, 1);
+            ++dest->once_count;
+        }
+        ++dest->count;
+    }
+    duk_dup(ctx, key_idx);
+    duk_dup(ctx, -2);
+    duk_put_prop(ctx, table_idx);
+    duk_replace(ctx, list_idx);
+    /* [ ... new_list ... ] */
+    return dest;
+}
+
+/**
+ * Make room for one more slot
+ */
+DUK_LOCAL events_header *events_reserve_slot(duk_context *ctx, duk_idx_t table_idx, duk_idx_t key_idx, duk_idx_t list_idx, events_header *header)
+{
+    duk_uint_t capacity;
+    duk_uint_t old_words;
+    duk_uint_t new_words;
+    duk_uint_t *once;
+    duk_uint_t *dead;
+
+    if (header->next_ref >= EVENTS_MAX_REF) {
+        /* Renumber keys of listeners */
+        header = events_renew_list(ctx, table_idx, key_idx, list_idx);
+    }
+    if (header->count < header->capacity) {
+        return header;
+    }
+    capacity = header->capacity * 2;
+    old_words = EVENTS_WORDS(header->capacity);
+    new_words = EVENTS_WORDS(capacity);
+    /* [ ... list ... ] */
+    duk_get_prop_index(ctx, list_idx, 0);
+    header = (events_header *)duk_resize_buffer(ctx, -1, events_header_size(capacity));
     duk_pop(ctx);
+
+    /* Move bits after enlarged slots (dead bits first because they move further) */
+    once = EVENTS_ONCE(header);
+    dead = EVENTS_DEAD(header);
+    header->capacity = capacity;
+    memmove(EVENTS_DEAD(header), dead, sizeof(duk_uint_t) * old_words);
+    memset(EVENTS_DEAD(header) + old_words, 0, sizeof(duk_uint_t) * (new_words - old_words));
+    memmove(EVENTS_ONCE(header), once, sizeof(duk_uint_t) * old_words);
+    memset(EVENTS_ONCE(header) + old_words, 0, sizeof(duk_uint_t) * (new_words - old_words));
+    return header;
+}
+
+/**
+ * Remove slot from list (emit() must not be running on the list)
+ */
+DUK_LOCAL void events_remove_slot(duk_context *ctx, duk_idx_t list_idx, events_header *header, duk_uint_t index)
+{
+    duk_uarridx_t ref = EVENTS_SLOTS(header)[index].ref;
+    duk_uint_t moved = header->count - index - 1;
+
+    if (events_test_bit(EVENTS_ONCE(header), index)) {
+        --header->once_count;
+    }
+    memmove(&EVENTS_SLOTS(header)[index], &EVENTS_SLOTS(header)[index + 1], sizeof(events_slot) * moved);
+    events_move_bits(EVENTS_ONCE(header), index, index + 1, moved);
+    events_put_bit(EVENTS_ONCE(header), --header->count, 0);
+    duk_del_prop_index(ctx, list_idx, ref);
+}
+
+/**
+ * Sweep dead slots (Called when the outermost emit() on the list returns)
+ */
+DUK_LOCAL void events_sweep(duk_context *ctx, duk_idx_t list_idx, events_header *header)
+{
+    events_slot *slots = EVENTS_SLOTS(header);
+    duk_uint_t index;
+    duk_uint_t count = 0;
+
+    for (index = 0; index < header->count; ++index) {
+        if (events_test_bit(EVENTS_DEAD(header), index)) {
+            duk_del_prop_index(ctx, list_idx, slots[index].ref);
+            continue;
+        }
+        slots[count] = slots[index];
+        events_put_bit(EVENTS_ONCE(header), count, events_test_bit(EVENTS_ONCE(header), index));
+        ++count;
+    }
+    for (index = count; index < header->count; ++index) {
+        events_put_bit(EVENTS_ONCE(header), index, 0);
+    }
+    memset(EVENTS_DEAD(header), 0, sizeof(duk_uint_t) * EVENTS_WORDS(header->capacity));
+    header->count = count;
+    header->dead_count = 0;
 }
 
 /**
@@ -28,12 +323,16 @@ DUK_LOCAL duk_ret_t events_constructor(duk_context *ctx)
     /* [  ] */
     duk_push_this(ctx);
     /* [ this ] */
-    duk_push_object(ctx);
-    duk_put_prop_string(ctx, 0, DUX_KEY_EVENTS);
-    duk_push_uint(ctx, 0);
-    duk_put_prop_string(ctx, 0, DUX_KEY_EVENTSCOUNT);
+    duk_push_bare_object(ctx);
+    duk_put_prop_string(ctx, 0, DUX_IPK_EVENTS);
     duk_push_undefined(ctx);
     duk_put_prop_string(ctx, 0, DUX_KEY_MAXLISTENERS);
+    duk_push_current_function(ctx);
+    /* [ this constructor ] */
+    if (duk_get_prop_string(ctx, 1, DUX_IPK_PROFILING) && duk_get_boolean(ctx, 2)) {
+        duk_push_bare_object(ctx);
+        duk_put_prop_string(ctx, 0, DUX_IPK_EVENTS_STATS);
+    }
     return 0;
 }
 
@@ -42,288 +341,505 @@ DUK_LOCAL duk_ret_t events_constructor(duk_context *ctx)
  */
 DUK_LOCAL duk_ret_t events_proto_common_add(duk_context *ctx, int once, int prepend)
 {
+    events_header *header;
+    events_slot *slot;
+    duk_uint_t index;
+    duk_uint_t count;
+
     /* [ key func ] */
     duk_require_callable(ctx, 1);
-
-    if (once) {
-        /* Convert function to wrapped object if "once" event */
-        duk_push_object(ctx);
-        /* [ key func func_wrapper ] */
-        duk_swap(ctx, 1, 2);
-        /* [ key func_wrapper func ] */
-        duk_put_prop_string(ctx, 1, DUX_KEY_LISTENER);
-        /* [ key func_wrapper ] */
-    }
-
-    duk_push_this(ctx);
-    /* [ key listener this ] */
-    if (!duk_get_prop_string(ctx, 2, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ key listener this obj ] */
+    events_push_table(ctx);
+    /* [ key func table ] */
     duk_dup(ctx, 0);
-    if (!duk_get_prop(ctx, 3)) {
-        /* New event */
-
-        /* [ key listener this obj undefined:4 ] */
+    if (duk_get_prop(ctx, 2)) {
+        /* [ key func table list:3 ] */
+        header = events_get_header(ctx, 3);
+        if (prepend && (header->depth > 0)) {
+            /* Slots cannot be moved while emitting */
+            header = events_renew_list(ctx, 2, 0, 3);
+        }
+    } else {
+        /* [ key func table undefined:3 ] */
+        duk_pop(ctx);
+        header = events_push_list(ctx, 0);
         duk_dup(ctx, 0);
-        duk_dup(ctx, 1);
-        duk_put_prop(ctx, 3);
-        /* [ key listener this obj undefined:4 ] */
-        events_update_count(ctx, 2, 1);
-        duk_pop_2(ctx);
-        /* [ key listener this ] */
-        /* No maxListeners check */
-        return 1;
+        duk_dup(ctx, -2);
+        duk_put_prop(ctx, 2);
     }
-
-    duk_size_t length;
-    if (!duk_is_array(ctx, 4)) {
-        /* An existing event with one listener */
-
-        /* [ key listener this obj listener:4 ] */
-        duk_push_array(ctx);
-        duk_dup(ctx, 0);
-        /* [ key listener this obj listener:4 arr_new:5 key:6 ] */
-        duk_swap(ctx, 4, 6);
-        /* [ key listener this obj key:4 arr_new:5 listener:6 ] */
-        duk_put_prop_index(ctx, 5, prepend ? 1 : 0);
-        /* [ key listener this obj key:4 new_arr:5 ] */
-        duk_dup(ctx, 1);
-        duk_put_prop_index(ctx, 5, prepend ? 0 : 1);
-        /* [ key listener this obj key:4 arr_new:5 ] */
-        duk_put_prop(ctx, 3);
-        /* [ key listener this obj ] */
-        length = 2;
+    /* [ key func table list:3 ] */
+    header = events_reserve_slot(ctx, 2, 0, 3, header);
+    if (prepend) {
+        index = 0;
+        memmove(&EVENTS_SLOTS(header)[1], &EVENTS_SLOTS(header)[0], sizeof(events_slot) * header->count);
+        events_move_bits(EVENTS_ONCE(header), 1, 0, header->count);
     } else {
-        /* An existing event with two or more listeners */
-        duk_uarridx_t src_index, dest_index = 0;
-
-        /* [ key listener this obj arr_src:4 ] */
-        duk_push_array(ctx);
-        duk_dup(ctx, 0);
-        /* [ key listener this obj arr_src:4 arr_dest:5 key:6 ] */
-        duk_swap(ctx, 4, 6);
-        /* [ key listener this obj key:4 arr_dest:5 arr_src:6 ] */
-        if (prepend) {
-            duk_dup(ctx, 1);
-            duk_put_prop_index(ctx, 6, dest_index++);
-        }
-        length = duk_get_length(ctx, 6);
-        for (src_index = 0; src_index < length; ++src_index) {
-            duk_get_prop_index(ctx, 6, src_index);
-            duk_put_prop_index(ctx, 5, dest_index++);
-        }
-        if (!prepend) {
-            duk_dup(ctx, 1);
-            duk_put_prop_index(ctx, 5, dest_index++);
-        }
-        duk_pop(ctx);
-        /* [ key listener this obj key:4 arr_dest:5 ] */
-        duk_put_prop(ctx, 3);
-        /* [ key listener this obj ] */
-        ++length;
+        index = header->count;
     }
-    duk_pop(ctx);
-    /* [ key listener this ] */
+    slot = &EVENTS_SLOTS(header)[index];
+    slot->func = duk_get_heapptr(ctx, 1);
+    slot->ref = header->next_ref++;
+    events_put_bit(EVENTS_ONCE(header), index, once);
+    if (once) {
+        ++header->once_count;
+    }
+    ++header->count;
+    count = header->count - header->dead_count;
+    duk_dup(ctx, 1);
+    duk_put_prop_index(ctx, 3, slot->ref);
+    duk_pop_2(ctx);
+    /* [ key func ] */
 
     duk_uint_t max_listeners;
-    /* [ key listener this ] */
+    duk_push_this(ctx);
+    /* [ key func this ] */
     duk_get_prop_string(ctx, 2, DUX_KEY_MAXLISTENERS);
     if (duk_is_undefined(ctx, 3)) {
-        /* [ key listener this undefined ] */
+        /* [ key func this undefined ] */
         duk_get_prop_string(ctx, 2, "constructor");
-        /* [ key listener this undefined constructor:4 ] */
+        /* [ key func this undefined constructor:4 ] */
         duk_get_prop_string(ctx, 4, DUX_IPK_DEFMAXLISTENERS);
-        /* [ key listener this undefined constructor:4 uint:5 ] */
+        /* [ key func this undefined constructor:4 uint:5 ] */
         max_listeners = duk_get_uint(ctx, 5);
         duk_pop_3(ctx);
-        /* [ key listener this ] */
+        /* [ key func this ] */
     } else {
-        /* [ key listener this uint ] */
+        /* [ key func this uint ] */
         max_listeners = duk_get_uint(ctx, 3);
         duk_pop(ctx);
-        /* [ key listener this ] */
+        /* [ key func this ] */
     }
-    if (length > max_listeners) {
+    if (count > max_listeners) {
         duk_push_sprintf(ctx,
             "Possible EventEmitter memory leak detected (%d '%s' listeners)",
-            length, duk_safe_to_string(ctx, 0)
+            count, duk_safe_to_string(ctx, 0)
         );
-        /* [ key listener this str ] */
+        /* [ key func this str ] */
         dux_report_warning(ctx);
         duk_pop(ctx);
     }
     return 1;
 }
 
+/**
+ * Start dispatching on listener list
+ * (Pushes dead bits before this dispatch or undefined, and returns number of slots to call.
+ *  "once" listeners are taken here so that they are never called twice)
+ */
+DUK_LOCAL duk_uint_t events_enter(duk_context *ctx, duk_idx_t table_idx, duk_idx_t key_idx, events_header *header, duk_bool_t take_once)
+{
+    duk_uint_t index;
+    duk_size_t size;
+
+    /* [ ... ] */
+    if (header->dead_count > 0) {
+        /* Nested dispatch skips slots taken by outer ones */
+        size = sizeof(duk_uint_t) * EVENTS_WORDS(header->count);
+        memcpy(duk_push_fixed_buffer(ctx, size), EVENTS_DEAD(header), size);
+    } else {
+        duk_push_undefined(ctx);
+    }
+    /* [ ... dead_bits|undefined ] */
+    if (take_once && (header->once_count > 0)) {
+        for (index = 0; index < header->count; ++index) {
+            if (events_test_bit(EVENTS_ONCE(header), index)) {
+                events_put_bit(EVENTS_ONCE(header), index, 0);
+                events_put_bit(EVENTS_DEAD(header), index, 1);
+                ++header->dead_count;
+            }
+        }
+        header->once_count = 0;
+        if (header->dead_count == header->count) {
+            /* No listener left for following dispatches */
+            duk_dup(ctx, key_idx);
+            duk_del_prop(ctx, table_idx);
+        }
+    }
+    ++header->depth;
+    return header->count;
+}
+
+/**
+ * Finish dispatching on listener list
+ */
+DUK_LOCAL void events_leave(duk_context *ctx, duk_idx_t list_idx, duk_idx_t header_idx)
+{
+    events_header *header;
+
+    /* Header may be reallocated by listeners */
+    header = (events_header *)duk_get_buffer(ctx, header_idx, NULL);
+    if ((--header->depth == 0) && (header->dead_count > 0)) {
+        events_sweep(ctx, list_idx, header);
+    }
+}
+
+/**
+ * Queue arguments of emit() if coalescing is enabled for the event
+ * (Returns true with boolean pushed if queued)
+ */
+DUK_LOCAL duk_bool_t events_coalesce(duk_context *ctx, duk_idx_t nargs)
+{
+    duk_idx_t this_idx;
+    duk_idx_t arg_index;
+
+    /* [ key ... ] */
+    duk_push_this(ctx);
+    this_idx = duk_get_top_index(ctx);
+    if (!duk_get_prop_string(ctx, this_idx, DUX_IPK_COALESCE)) {
+        /* Coalescing is not used for this emitter */
+        duk_pop_2(ctx);
+        return 0;
+    }
+    /* [ key ... this coal ] */
+    duk_dup(ctx, 0);
+    if (!duk_get_prop(ctx, this_idx + 1)) {
+        /* Coalescing is not enabled for this event */
+        duk_pop_3(ctx);
+        return 0;
+    }
+    /* [ key ... this coal true/queue ] */
+    if (!duk_is_array(ctx, this_idx + 2)) {
+        /* First event in this tick */
+        duk_pop(ctx);
+        duk_push_array(ctx);
+        duk_dup(ctx, 0);
+        duk_dup(ctx, this_idx + 2);
+        duk_put_prop(ctx, this_idx + 1);
+        /* [ key ... this coal queue ] */
+        duk_push_heap_stash(ctx);
+        if (!duk_get_prop_string(ctx, -1, DUX_IPK_EVENTS_PENDING)) {
+            duk_pop(ctx);
+            duk_push_array(ctx);
+            duk_dup(ctx, -1);
+            duk_put_prop_string(ctx, -3, DUX_IPK_EVENTS_PENDING);
+        }
+        /* [ key ... this coal queue stash pending ] */
+        duk_push_array(ctx);
+        duk_dup(ctx, this_idx);
+        duk_put_prop_index(ctx, -2, 0);
+        duk_dup(ctx, 0);
+        duk_put_prop_index(ctx, -2, 1);
+        duk_dup(ctx, this_idx + 2);
+        duk_put_prop_index(ctx, -2, 2);
+        /* [ key ... this coal queue stash pending item ] */
+        duk_put_prop_index(ctx, -2, duk_get_length(ctx, -2));
+        duk_pop_2(ctx);
+        /* [ key ... this coal queue ] */
+        dux_wakeup_signal(ctx);
+    }
+
+    /* [ key ... this coal queue ] */
+    duk_push_array(ctx);
+    for (arg_index = 1; arg_index < nargs; ++arg_index) {
+        duk_dup(ctx, arg_index);
+        duk_put_prop_index(ctx, -2, arg_index - 1);
+    }
+    /* [ key ... this coal queue args ] */
+    duk_put_prop_index(ctx, this_idx + 2, duk_get_length(ctx, this_idx + 2));
+    /* [ key ... this coal queue ] */
+    events_push_table(ctx);
+    duk_dup(ctx, 0);
+    duk_push_boolean(ctx, duk_has_prop(ctx, -2));
+    /* [ key ... this coal queue table bool ] */
+    return 1;
+}
+
+/**
+ * Get current time for profiling (in nanoseconds)
+ */
+DUK_LOCAL duk_uint64_t events_current_ns(void)
+{
+#if !defined(DUX_OPT_NO_TIMER)
+    return dux_timer_arch_current_ns();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Push statistics of event (Returns NULL with undefined pushed if not profiled)
+ */
+DUK_LOCAL events_stat *events_push_stat(duk_context *ctx, duk_idx_t key_idx)
+{
+    events_stat *stat;
+
+    /* [ ... ] */
+    duk_push_this(ctx);
+    if (!duk_get_prop_string(ctx, -1, DUX_IPK_EVENTS_STATS)) {
+        /* [ ... this undefined ] */
+        duk_remove(ctx, -2);
+        return NULL;
+    }
+    /* [ ... this stats ] */
+    duk_dup(ctx, key_idx);
+    if (duk_get_prop(ctx, -2)) {
+        /* [ ... this stats buf ] */
+        stat = (events_stat *)duk_get_buffer(ctx, -1, NULL);
+    } else {
+        /* [ ... this stats undefined ] */
+        duk_pop(ctx);
+        stat = (events_stat *)duk_push_fixed_buffer(ctx, sizeof(*stat));
+        memset(stat, 0, sizeof(*stat));
+        duk_dup(ctx, key_idx);
+        duk_dup(ctx, -2);
+        duk_put_prop(ctx, -4);
+        /* [ ... this stats buf ] */
+    }
+    duk_remove(ctx, -2);
+    duk_remove(ctx, -2);
+    /* [ ... buf ] */
+    ++stat->count;
+    return stat;
+}
+
+/**
+ * Check if the event is "error"
+ */
+DUK_LOCAL duk_bool_t events_is_error_key(duk_context *ctx, duk_idx_t key_idx)
+{
+    const char *key = duk_get_string(ctx, key_idx);
+    return (key != NULL) && (strcmp(key, "error") == 0);
+}
+
+DUK_LOCAL duk_ret_t events_proto_emit(duk_context *ctx);
+
+/**
+ * Handle error thrown by listener
+ * (Emitted as "error" event if handled, otherwise reported by dux_report_error)
+ */
+DUK_LOCAL void events_handle_error(duk_context *ctx, duk_bool_t error_event)
+{
+    /* [ ... err ] */
+    if (!error_event) {
+        events_push_table(ctx);
+        duk_push_string(ctx, "error");
+        if (duk_has_prop(ctx, -2)) {
+            /* [ ... err table ] */
+            duk_push_c_function(ctx, events_proto_emit, DUK_VARARGS);
+            duk_push_this(ctx);
+            duk_push_string(ctx, "error");
+            duk_dup(ctx, -5);
+            /* [ ... err table func this "error" err ] */
+            if (duk_pcall_method(ctx, 2) == 0) {
+                duk_pop_2(ctx);
+                /* [ ... err ] */
+                return;
+            }
+            /* [ ... err table err2 ] */
+            duk_replace(ctx, -3);
+        }
+        duk_pop(ctx);
+    }
+    /* [ ... err ] */
+    dux_report_error(ctx);
+}
+
+/**
+ * Call listener with profiling and error handling
+ */
+DUK_LOCAL void events_call_listener(duk_context *ctx, duk_idx_t nargs, events_stat *stat, duk_bool_t error_event)
+{
+    duk_uint64_t start = 0;
+    duk_int_t result;
+
+    /* [ ... func this args... ] */
+    if (stat) {
+        ++stat->calls;
+        start = events_current_ns();
+    }
+    result = duk_pcall_method(ctx, nargs);
+    if (stat) {
+        stat->time_ns += events_current_ns() - start;
+    }
+    /* [ ... retval/err ] */
+    if (result != 0) {
+        events_handle_error(ctx, error_event);
+    }
+    duk_pop(ctx);
+    /* [ ... ] */
+}
+
 /**
  * Entry of emit()
  */
 DUK_LOCAL duk_ret_t events_proto_emit(duk_context *ctx)
 {
     duk_idx_t nargs = duk_get_top(ctx);
-    duk_bool_t emitted = 0;
+    events_header *header;
+    events_stat *stat;
+    const duk_uint_t *skip;
+    duk_bool_t error_event;
+    duk_uint_t count;
+    duk_uint_t index;
+    duk_idx_t arg_index;
+    duk_idx_t list_idx;
 
     /* [ key ... ] */
     if (nargs == 0) {
-        goto finish;
+        duk_push_false(ctx);
+        return 1;
     }
 
-    duk_push_this(ctx);
-    /* [ key ... this ] */
-    if (!duk_get_prop_string(ctx, -1, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
+    if (events_coalesce(ctx, nargs)) {
+        /* Queued to be emitted in next tick */
+        return 1;
     }
-    /* [ key ... this obj ] */
+
+    error_event = events_is_error_key(ctx, 0);
+    events_push_table(ctx);
+    /* [ key ... table ] */
     duk_dup(ctx, 0);
     if (!duk_get_prop(ctx, -2)) {
         /* No listener */
-        /* [ key ... this obj undefined ] */
-        goto finish;
+        /* [ key ... table undefined ] */
+        if (error_event) {
+            /* Unhandled "error" event */
+            if ((nargs > 1) && duk_is_error(ctx, 1)) {
+                duk_dup(ctx, 1);
+                (void)duk_throw(ctx);
+            }
+            (void)duk_generic_error(ctx, "Unhandled error. (%s)",
+                (nargs > 1) ? duk_safe_to_string(ctx, 1) : "undefined");
+        }
+        duk_push_false(ctx);
+        return 1;
     }
 
-    if (!duk_is_array(ctx, -1)) {
-        /* Single listener */
-        /* [ key ... this obj listener ] */
-        if (!duk_is_callable(ctx, -1)) {
-            /* Once listener */
-            duk_dup(ctx, 0);
-            /* [ key ... this obj func_wrapper key ] */
-            duk_del_prop(ctx, -3);
-            /* [ key ... this obj func_wrapper ] */
-            duk_get_prop_string(ctx, -1, DUX_KEY_LISTENER);
-            /* [ key ... this obj func_wrapper func ] */
-        }
-        /* [ key ... this ... func ] */
-        duk_swap(ctx, 0, -1);
-        /* [ func ... this ... key ] */
-        duk_set_top(ctx, nargs + 1);
-        /* [ func ... this ] */
-        duk_insert(ctx, 1);
-        /* [ func this ... ] */
-        emitted = 1;
-        if (duk_pcall_method(ctx, nargs - 1) != 0) {
-            /* [ err ] */
-            /* FIXME */
-        }
-        /* [ retval/err ] */
-        goto finish;
+    /* [ key ... table list ] */
+    list_idx = duk_get_top_index(ctx);
+    duk_get_prop_index(ctx, list_idx, 0);
+    header = (events_header *)duk_get_buffer(ctx, -1, NULL);
+    count = events_enter(ctx, list_idx - 1, 0, header, 1);
+    skip = (const duk_uint_t *)duk_get_buffer(ctx, -1, NULL);
+    stat = events_push_stat(ctx, 0);
+    /* [ key ... table list header skip stat ] */
+
+    if ((count == 1) && (!skip)) {
+        /* Single listener (Arguments are moved instead of copied) */
+        events_push_listener(ctx, list_idx, &EVENTS_SLOTS(header)[0]);
+        /* [ key ... table list header skip stat func ] */
+        duk_replace(ctx, 0);
+        /* [ func ... table list header skip stat ] */
+        duk_insert(ctx, 0);
+        duk_pop(ctx);
+        duk_insert(ctx, 0);
+        duk_insert(ctx, 0);
+        duk_pop(ctx);
+        /* [ list header stat func ... ] */
+        duk_push_this(ctx);
+        duk_insert(ctx, 4);
+        /* [ list header stat func this ... ] */
+        events_call_listener(ctx, nargs - 1, stat, error_event);
+        /* [ list header stat ] */
+        events_leave(ctx, 0, 1);
+        duk_push_true(ctx);
+        return 1;
     }
 
     /* Multiple listeners */
-    /* [ key ... this obj arr ] */
-    duk_size_t once_listeners;
-    duk_size_t length;
-    duk_uarridx_t src_index;
-    duk_uarridx_t dest_index;
-
-    once_listeners = 0;
-    length = duk_get_length(ctx, -1);
-    for (src_index = 0; src_index < length; ++src_index) {
-        duk_idx_t arg_index;
-
-        duk_get_prop_index(ctx, -1, src_index);
-        /* [ key ... this obj arr listener ] */
-        if (!duk_is_callable(ctx, -1)) {
-            /* Once listener */
-            if (!duk_get_prop_string(ctx, -1, DUX_KEY_LISTENER)) {
-                /* Already flag'd (listener is emitting event recursively!) */
-                /* [ key ... this obj arr func_wrapper undefined ] */
-                duk_pop_2(ctx);
-                /* [ key ... this obj arr ] */
-                continue;
-            }
-            ++once_listeners;
-            duk_del_prop_string(ctx, -2, DUX_KEY_LISTENER); /* Flag for delete */
-            duk_replace(ctx, -2);
+    duk_push_this(ctx);
+    /* [ key ... table list header:list_idx+1 skip stat this:list_idx+4 ] */
+    duk_require_stack(ctx, nargs + 1);
+    for (index = 0; index < count; ++index) {
+        if (skip && events_test_bit(skip, index)) {
+            continue;
         }
-        /* [ key ... this obj arr func ] */
-        duk_push_this(ctx);
+        /* Header may be reallocated by listeners */
+        header = (events_header *)duk_get_buffer(ctx, list_idx + 1, NULL);
+        events_push_listener(ctx, list_idx, &EVENTS_SLOTS(header)[index]);
+        duk_dup(ctx, list_idx + 4);
         for (arg_index = 1; arg_index < nargs; ++arg_index) {
             duk_dup(ctx, arg_index);
         }
-        /* [ key ... this obj arr func this ... ] */
-        emitted = 1;
-        if (duk_pcall_method(ctx, nargs - 1) != 0) {
-            /* [ key ... this obj arr err ] */
-            /* FIXME */
-            duk_pop(ctx);
-            break;
-        }
-        duk_pop(ctx);
+        /* [ key ... table list header skip stat this func this ... ] */
+        events_call_listener(ctx, nargs - 1, stat, error_event);
+        /* [ key ... table list header skip stat this ] */
     }
+    events_leave(ctx, list_idx, list_idx + 1);
 
-    if (once_listeners == 0) {
-        goto finish;
-    }
+    duk_push_true(ctx);
+    return 1;
+}
 
-    /* Clear finished once listeners */
-    duk_set_top(ctx, 1);
-    duk_push_this(ctx);
-    /* [ key this ] */
-    /* Re-get event obj */
-    if (!duk_get_prop_string(ctx, 1, DUX_KEY_EVENTS)) {
+/**
+ * Entry of emitBatch()
+ */
+DUK_LOCAL duk_ret_t events_proto_emitBatch(duk_context *ctx)
+{
+    events_header *header;
+    events_stat *stat;
+    const duk_uint_t *skip;
+    duk_bool_t error_event;
+    duk_uint_t count;
+    duk_uint_t index;
+    duk_size_t length;
+    duk_size_t item;
+    duk_idx_t nargs;
+    duk_idx_t arg_index;
+
+    /* [ key batch ] */
+    if (!duk_is_array(ctx, 1)) {
         return DUK_RET_TYPE_ERROR;
     }
-    /* [ key this obj ] */
+    length = duk_get_length(ctx, 1);
+    error_event = events_is_error_key(ctx, 0);
+    events_push_table(ctx);
+    /* [ key batch table ] */
     duk_dup(ctx, 0);
     if (!duk_get_prop(ctx, 2)) {
-        /* No event (All listeners maybe removed in callbacks) */
-        goto finish;
-    }
-
-    /* [ key this obj listener/arr ] */
-    if (!duk_is_array(ctx, 3)) {
-        /* Single listener */
-        goto finish;
-    }
-
-    /* [ key this obj arr ] */
-    length = duk_get_length(ctx, 3);
-    for (src_index = dest_index = 0; src_index < length; ++src_index) {
-        duk_get_prop_index(ctx, 3, src_index);
-        /* [ key this obj arr listener:4 ] */
-        if (!duk_is_callable(ctx, 4)) {
-            /* [ key this obj arr func_wrapper:4 ] */
-            if (!duk_has_prop_string(ctx, 4, DUX_KEY_LISTENER)) {
-                /* Remove finished once listener */
-                duk_pop(ctx);
-                /* [ key this obj arr ] */
+        /* No listener */
+        /* [ key batch table undefined ] */
+        duk_push_false(ctx);
+        return 1;
+    }
+
+    /* [ key batch table list:3 ] */
+    duk_get_prop_index(ctx, 3, 0);
+    header = (events_header *)duk_get_buffer(ctx, 4, NULL);
+    /* "once" listeners are called for the first arguments only */
+    count = events_enter(ctx, 2, 0, header, length > 0);
+    skip = (const duk_uint_t *)duk_get_buffer(ctx, 5, NULL);
+    stat = events_push_stat(ctx, 0);
+    duk_push_this(ctx);
+    /* [ key batch table list:3 header:4 skip:5 stat:6 this:7 ] */
+
+    for (item = 0; item < length; ++item) {
+        if (item >= duk_get_length(ctx, 1)) {
+            /* Batch truncated by listener */
+            break;
+        }
+        duk_get_prop_index(ctx, 1, item);
+        /* [ key batch table list:3 header:4 skip:5 stat:6 this:7 args:8 ] */
+        nargs = duk_is_array(ctx, 8) ? (duk_idx_t)duk_get_length(ctx, 8) : 1;
+        duk_require_stack(ctx, nargs + 2);
+        for (index = 0; index < count; ++index) {
+            if (skip && events_test_bit(skip, index)) {
                 continue;
             }
+            /* Header may be reallocated by listeners */
+            header = (events_header *)duk_get_buffer(ctx, 4, NULL);
+            if ((item > 0) && events_test_bit(EVENTS_DEAD(header), index)) {
+                /* "once" listener taken by this dispatch */
+                continue;
+            }
+            events_push_listener(ctx, 3, &EVENTS_SLOTS(header)[index]);
+            duk_dup(ctx, 7);
+            if (duk_is_array(ctx, 8)) {
+                for (arg_index = 0; arg_index < nargs; ++arg_index) {
+                    duk_get_prop_index(ctx, 8, arg_index);
+                }
+            } else {
+                duk_dup(ctx, 8);
+            }
+            /* [ key batch table list:3 header:4 skip:5 stat:6 this:7 args:8 func this ... ] */
+            events_call_listener(ctx, nargs, stat, error_event);
+            /* [ key batch table list:3 header:4 skip:5 stat:6 this:7 args:8 ] */
         }
-        if (dest_index < src_index) {
-            duk_put_prop_index(ctx, 3, dest_index++);
-        } else {
-            duk_pop(ctx);
-        }
-        /* [ key this obj arr ] */
-    }
-
-    if (dest_index == 0) {
-        /* No listener remaining */
-        duk_swap(ctx, 0, 3);
-        /* [ arr this obj key ] */
-        duk_del_prop(ctx, 2);
-        /* [ arr this obj ] */
-        events_update_count(ctx, 1, -1);
-    } else if (dest_index == 1) {
-        /* Only one listener remaining */
-        duk_get_prop_index(ctx, 3, 0);
-        /* [ key this obj arr listener:4 ] */
-        duk_swap(ctx, 0, 3);
-        /* [ arr this obj key listener:4 ] */
-        duk_put_prop(ctx, 2);
-        /* [ arr this obj ] */
-    } else if (dest_index < src_index) {
-        /* Some once listeners has been removed */
-        duk_set_length(ctx, 3, dest_index);
+        duk_pop(ctx);
+        /* [ key batch table list:3 header:4 skip:5 stat:6 this:7 ] */
     }
+    events_leave(ctx, 3, 4);
 
-finish:
-    /* [ ... ] */
-    duk_push_boolean(ctx, emitted);
+    duk_push_true(ctx);
     return 1;
 }
 
@@ -335,24 +851,20 @@ DUK_LOCAL duk_ret_t events_proto_eventNames(duk_context *ctx)
     duk_uarridx_t index;
 
     /* [  ] */
-    duk_push_this(ctx);
-    /* [ this ] */
-    if (!duk_get_prop_string(ctx, 0, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ this obj ] */
+    events_push_table(ctx);
+    /* [ table ] */
     duk_push_array(ctx);
-    /* [ this obj arr ] */
-    duk_enum(ctx, 1, DUK_ENUM_OWN_PROPERTIES_ONLY);
-    /* [ this obj arr enum ] */
+    /* [ table arr ] */
+    duk_enum(ctx, 0, DUK_ENUM_OWN_PROPERTIES_ONLY);
+    /* [ table arr enum ] */
     index = 0;
-    while (duk_next(ctx, 3, 0)) {
-        /* [ this obj arr enum key ] */
-        duk_put_prop_index(ctx, 2, index++);
-        /* [ this obj arr enum ] */
+    while (duk_next(ctx, 2, 0)) {
+        /* [ table arr enum key ] */
+        duk_put_prop_index(ctx, 1, index++);
+        /* [ table arr enum ] */
     }
     duk_pop(ctx);
-    /* [ this obj arr ] */
+    /* [ table arr ] */
     return 1;
 }
 
@@ -376,29 +888,21 @@ DUK_LOCAL duk_ret_t events_proto_getMaxListeners(duk_context *ctx)
  */
 DUK_LOCAL duk_ret_t events_proto_listenerCount(duk_context *ctx)
 {
+    const events_header *header;
+
     /* [ key ] */
-    duk_push_this(ctx);
-    /* [ key this ] */
-    if (!duk_get_prop_string(ctx, 1, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ key this obj ] */
-    duk_swap(ctx, 0, 2);
-    /* [ obj this key ] */
-    if (!duk_get_prop(ctx, 0)) {
-        /* [ obj this undefined ] */
+    events_push_table(ctx);
+    /* [ key table ] */
+    duk_dup(ctx, 0);
+    if (!duk_get_prop(ctx, 1)) {
+        /* [ key table undefined ] */
         duk_push_uint(ctx, 0);
-        /* [ obj this undefined uint ] */
-    } else if(!duk_is_array(ctx, 2)) {
-        /* [ obj this listener ] */
-        duk_push_uint(ctx, 1);
-        /* [ obj this listener uint ] */
-    } else {
-        /* [ obj this arr ] */
-        duk_push_uint(ctx, duk_get_length(ctx, 2));
-        /* [ obj this arr uint ] */
+        return 1;
     }
-    /* [ ... uint ] */
+    /* [ key table list ] */
+    header = events_get_header(ctx, 2);
+    duk_push_uint(ctx, header->count - header->dead_count);
+    /* [ key table list uint ] */
     return 1;
 }
 
@@ -407,64 +911,34 @@ DUK_LOCAL duk_ret_t events_proto_listenerCount(duk_context *ctx)
  */
 DUK_LOCAL duk_ret_t events_proto_listeners(duk_context *ctx)
 {
-    duk_uarridx_t index;
-    duk_size_t length;
+    const events_header *header;
+    duk_uint_t index;
+    duk_uarridx_t count = 0;
 
     /* [ key ] */
-    duk_push_this(ctx);
-    /* [ key this ] */
-    if (!duk_get_prop_string(ctx, 1, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ key this obj ] */
-    duk_swap(ctx, 0, 2);
-    /* [ obj this key ] */
-    if (!duk_get_prop(ctx, 0)) {
+    events_push_table(ctx);
+    /* [ key table ] */
+    duk_dup(ctx, 0);
+    if (!duk_get_prop(ctx, 1)) {
         /* No listener */
-
-        /* [ obj this undefined ] */
-        duk_push_array(ctx);
-        /* [ obj this undefined arr_copy ] */
-        return 1;
-    }
-
-    /* [ obj this listener/arr ] */
-    if (!duk_is_array(ctx, 2)) {
-        /* Single listener */
-
-        /* [ obj this listener ] */
+        /* [ key table undefined ] */
         duk_push_array(ctx);
-        /* [ obj this listener arr_copy ] */
-        duk_swap(ctx, 2, 3);
-        /* [ obj this arr_copy listener ] */
-        duk_put_prop_index(ctx, 2, 0);
-        /* [ obj this arr_copy ] */
+        /* [ key table undefined arr_copy ] */
         return 1;
     }
 
-    /* Multiple listeners */
-    /* [ obj this arr ] */
+    /* [ key table list ] */
+    header = events_get_header(ctx, 2);
     duk_push_array(ctx);
-    /* [ obj this arr arr_copy ] */
-    length = duk_get_length(ctx, 2);
-    for (index = 0; index < length; ++index) {
-        duk_get_prop_index(ctx, 2, index);
-        /* [ obj this arr arr_copy listener:4 ] */
-        if (!duk_is_callable(ctx, 4)) {
-            /* [ obj this arr arr_copy func_wrapper:4 ] */
-            duk_get_prop_string(ctx, 4, DUX_KEY_LISTENER);
-            /* [ obj this arr arr_copy func_wrapper:4 func:5 ] */
-            duk_put_prop_index(ctx, 3, index);
-            /* [ obj this arr arr_copy func_wrapper:4 ] */
-            duk_pop(ctx);
-            /* [ obj this arr arr_copy ] */
-        } else {
-            /* [ obj this arr arr_copy func:4 ] */
-            duk_put_prop_index(ctx, 3, index);
-            /* [ obj this arr arr_copy ] */
+    /* [ key table list arr_copy ] */
+    for (index = 0; index < header->count; ++index) {
+        if (events_test_bit(EVENTS_DEAD(header), index)) {
+            continue;
         }
+        events_push_listener(ctx, 2, &EVENTS_SLOTS(header)[index]);
+        duk_put_prop_index(ctx, 3, count++);
     }
-    /* [ obj this arr arr_copy ] */
+    /* [ key table list arr_copy ] */
     return 1;
 }
 
@@ -506,156 +980,139 @@ DUK_LOCAL duk_ret_t events_proto_prependOnceListener(duk_context *ctx)
 DUK_LOCAL duk_ret_t events_proto_removeAllListeners(duk_context *ctx)
 {
     /* [ undefined/key ] */
+    events_push_table(ctx);
+    /* [ undefined/key table ] */
     duk_push_this(ctx);
-    /* [ undefined/key this ] */
-    if (!duk_get_prop_string(ctx, 1, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ undefined/key this obj ] */
+    /* [ undefined/key table this ] */
 
     if (duk_is_undefined(ctx, 0)) {
         /* Remove all events */
-
-        /* [ undefined this obj ] */
-        duk_push_object(ctx);
-        duk_put_prop_string(ctx, 1, DUX_KEY_EVENTS);
-        duk_push_uint(ctx, 0);
-        duk_put_prop_string(ctx, 1, DUX_KEY_EVENTSCOUNT);
-        duk_pop(ctx);
-        /* [ undefined this ] */
+        duk_push_bare_object(ctx);
+        duk_put_prop_string(ctx, 2, DUX_IPK_EVENTS);
         return 1;
     }
 
     /* Remove listeners of specified event */
-    /* [ key this obj ] */
     duk_dup(ctx, 0);
-    /* [ key this obj key ] */
-    if (duk_has_prop(ctx, 2)) {
-        /* Remove one event */
-        /* [ key this obj ] */
-        duk_swap(ctx, 0, 2);
-        /* [ obj this key ] */
-        duk_del_prop(ctx, 0);
-        /* [ obj this ] */
-        events_update_count(ctx, 1, -1);
-        return 1;
-    }
-
-    /* No such event */
-    /* [ key this obj ] */
-    duk_pop(ctx);
-    /* [ key this ] */
+    duk_del_prop(ctx, 1);
+    /* [ key table this ] */
     return 1;
 }
 
+/**
+ * Find slot of listener (Returns count of slots if not found)
+ */
+DUK_LOCAL duk_uint_t events_find_slot(duk_context *ctx, duk_idx_t list_idx, const events_header *header, duk_idx_t func_idx)
+{
+    const events_slot *slot;
+    void *func = duk_get_heapptr(ctx, func_idx);
+    duk_uint_t index;
+    duk_bool_t equal;
+
+    for (index = 0; index < header->count; ++index) {
+        if (events_test_bit(EVENTS_DEAD(header), index)) {
+            continue;
+        }
+        slot = &EVENTS_SLOTS(header)[index];
+        if (slot->func) {
+            if (slot->func == func) {
+                break;
+            }
+        } else if (!func) {
+            /* Lightfuncs are compared by value */
+            duk_get_prop_index(ctx, list_idx, slot->ref);
+            equal = duk_strict_equals(ctx, func_idx, -1);
+            duk_pop(ctx);
+            if (equal) {
+                break;
+            }
+        }
+    }
+    return index;
+}
+
 /**
  * Entry of removeListener()
  */
 DUK_LOCAL duk_ret_t events_proto_removeListener(duk_context *ctx)
 {
-    duk_uarridx_t index, sub_index;
-    duk_size_t length;
+    events_header *header;
+    duk_uint_t found;
 
     /* [ key func ] */
-    duk_push_this(ctx);
-    /* [ key func this ] */
-    if (!duk_get_prop_string(ctx, 2, DUX_KEY_EVENTS)) {
-        return DUK_RET_TYPE_ERROR;
-    }
-    /* [ key func this obj ] */
+    events_push_table(ctx);
+    /* [ key func table ] */
     duk_dup(ctx, 0);
-    /* [ key func this obj key:4 ] */
-    if (!duk_get_prop(ctx, 3)) {
+    if (!duk_get_prop(ctx, 2)) {
         /* No such event */
-        /* [ key func this obj undefined:4 ] */
-        duk_pop_2(ctx);
+        /* [ key func table undefined:3 ] */
+        duk_push_this(ctx);
         return 1;
     }
 
-    if (duk_is_array(ctx, 4)) {
-        /* Multiple listeners */
-        /* [ key func this obj arr:4 ] */
-        length = duk_get_length(ctx, 4);
-        for (index = 0; index < length; ++index) {
-            duk_get_prop_index(ctx, 4, index);
-            /* [ key func this obj arr:4 listener:5 ] */
-            if (!duk_is_callable(ctx, 5)) {
-                duk_get_prop_string(ctx, 5, DUX_KEY_LISTENER);
-                /* [ key func this obj arr:4 func_wrapper:5 func:6 ] */
-                if (duk_strict_equals(ctx, 1, 6)) {
-                    /* Remove this */
-                    duk_pop_2(ctx);
-                    goto remove_from_array;
-                }
-            } else if (duk_strict_equals(ctx, 1, 5)) {
-                /* Remove this */
-                duk_pop(ctx);
-remove_from_array:
-                /* [ key func this obj arr:4 ] */
-                if (length == 2) {
-                    /* Convert to non-array */
-                    duk_dup(ctx, 0);
-                    /* [ key func this obj arr:4 key:5 ] */
-                    duk_get_prop_index(ctx, 4, 1 - index);
-                    /* [ key func this obj arr:4 key:5 listener:6 ] */
-                    duk_put_prop(ctx, 3);
-                    /* [ key func this obj arr:4 ] */
-                    break;
-                }
-
-                /* Update array */
-                duk_dup(ctx, 0);
-                duk_push_array(ctx);
-                /* [ key func this obj arr:4 key:5 arr_new:6 ] */
-                for (sub_index = 0; sub_index < index; ++sub_index) {
-                    duk_get_prop_index(ctx, 4, sub_index);
-                    duk_put_prop_index(ctx, 6, sub_index);
-                }
-                for (sub_index = index + 1; sub_index < length; ++sub_index) {
-                    duk_get_prop_index(ctx, 4, sub_index);
-                    duk_put_prop_index(ctx, 6, sub_index - 1);
-                }
-                duk_put_prop(ctx, 3);
-                /* [ key func this obj arr:4 ] */
-                break;
-            }
-            duk_pop(ctx);
-            /* [ key func this obj arr:4 ] */
-        }   // for (index)
-        duk_pop_2(ctx);
-        /* [ key func this ] */
-        return 1;
+    /* [ key func table list:3 ] */
+    header = events_get_header(ctx, 3);
+    found = events_find_slot(ctx, 3, header, 1);
+    if (found < header->count) {
+        if (header->depth > 0) {
+            /* Slots cannot be moved while emitting */
+            header = events_renew_list(ctx, 2, 0, 3);
+            found = events_find_slot(ctx, 3, header, 1);
+        }
+        if (header->count > 1) {
+            events_remove_slot(ctx, 3, header, found);
+        } else {
+            duk_dup(ctx, 0);
+            duk_del_prop(ctx, 2);
+        }
+        /* [ key func table list:3 ] */
     }
 
-    /* Single listener */
-    /* [ key func this obj listener:4 ] */
-    if (!duk_is_callable(ctx, 4)) {
-        if (duk_get_prop_string(ctx, 4, DUX_KEY_LISTENER)) {
-            /* [ key func this obj func_wrapper:4 func:5 ] */
-            if (duk_strict_equals(ctx, 1, 5)) {
-                duk_pop(ctx);
-                goto remove_single;
-            }
+    duk_push_this(ctx);
+    /* [ key func table list:3 this ] */
+    return 1;
+}
+
+/**
+ * Entry of setCoalescing()
+ */
+DUK_LOCAL duk_ret_t events_proto_setCoalescing(duk_context *ctx)
+{
+    duk_bool_t enabled;
+
+    /* [ key bool ] */
+    enabled = duk_to_boolean(ctx, 1);
+    events_push_table(ctx);
+    duk_push_this(ctx);
+    /* [ key bool table this ] */
+    if (!duk_get_prop_string(ctx, 3, DUX_IPK_COALESCE)) {
+        /* [ key bool table this undefined ] */
+        duk_pop(ctx);
+        if (!enabled) {
+            return 1;
         }
-        /* [ key func this obj func_wrapper:4 func/undefined:5 ] */
-        duk_pop_3(ctx);
-        /* [ key func this ] */
-        return 1;
+        duk_push_bare_object(ctx);
+        duk_dup(ctx, 4);
+        duk_put_prop_string(ctx, 3, DUX_IPK_COALESCE);
     }
 
-    /* [ key func this obj func:4 ] */
-    if (duk_strict_equals(ctx, 1, 4)) {
-        /* Remove this */
-remove_single:
-        /* [ key func this obj any:4 ] */
+    /* [ key bool table this coal:4 ] */
+    duk_dup(ctx, 0);
+    if (!enabled) {
+        /* Events already queued are still emitted in next tick */
+        duk_del_prop(ctx, 4);
+    } else if (!duk_get_prop(ctx, 4)) {
+        /* [ key bool table this coal:4 undefined ] */
+        duk_pop(ctx);
         duk_dup(ctx, 0);
-        /* [ key func this obj any:4 key:5 ] */
-        duk_del_prop(ctx, 3);
-        /* [ key func this obj any:4 ] */
-        events_update_count(ctx, 2, -1);
+        duk_push_true(ctx);
+        duk_put_prop(ctx, 4);
+    } else {
+        /* [ key bool table this coal:4 true/queue ] */
+        duk_pop(ctx);
     }
-    duk_pop_2(ctx);
-    /* [ key func this ] */
+    duk_pop(ctx);
+    /* [ key bool table this ] */
     return 1;
 }
 
@@ -711,23 +1168,113 @@ DUK_LOCAL duk_ret_t events_defaultMaxListeners_setter(duk_context *ctx)
     return 0;
 }
 
+/**
+ * Entry of setProfiling()
+ */
+DUK_LOCAL duk_ret_t events_proto_setProfiling(duk_context *ctx)
+{
+    /* [ bool ] */
+    events_push_table(ctx);
+    duk_push_this(ctx);
+    /* [ bool table this ] */
+    if (duk_to_boolean(ctx, 0)) {
+        /* Start (or restart) profiling */
+        duk_push_bare_object(ctx);
+        duk_put_prop_string(ctx, 2, DUX_IPK_EVENTS_STATS);
+    } else {
+        duk_del_prop_string(ctx, 2, DUX_IPK_EVENTS_STATS);
+    }
+    return 1;
+}
+
+/**
+ * Entry of stats()
+ */
+DUK_LOCAL duk_ret_t events_proto_stats(duk_context *ctx)
+{
+    const events_stat *stat;
+
+    /* [  ] */
+    events_push_table(ctx);
+    duk_push_this(ctx);
+    duk_push_object(ctx);
+    /* [ table this result ] */
+    if (!duk_get_prop_string(ctx, 1, DUX_IPK_EVENTS_STATS)) {
+        /* Not profiled */
+        duk_pop(ctx);
+        return 1;
+    }
+    /* [ table this result stats ] */
+    duk_enum(ctx, 3, DUK_ENUM_OWN_PROPERTIES_ONLY);
+    while (duk_next(ctx, 4, 1)) {
+        /* [ table this result stats enum key buf ] */
+        stat = (const events_stat *)duk_get_buffer(ctx, 6, NULL);
+        duk_push_object(ctx);
+        duk_push_uint(ctx, stat->count);
+        duk_put_prop_string(ctx, 7, "count");
+        duk_push_uint(ctx, stat->calls);
+        duk_put_prop_string(ctx, 7, "calls");
+        duk_push_number(ctx, (duk_double_t)stat->time_ns / 1000000.0);
+        duk_put_prop_string(ctx, 7, "time");
+        /* [ table this result stats enum key buf obj ] */
+        duk_remove(ctx, 6);
+        duk_put_prop(ctx, 2);
+        /* [ table this result stats enum ] */
+    }
+    duk_pop_2(ctx);
+    /* [ table this result ] */
+    return 1;
+}
+
+/**
+ * Getter of profiling
+ */
+DUK_LOCAL duk_ret_t events_profiling_getter(duk_context *ctx)
+{
+    /* [  ] */
+    duk_push_this(ctx);
+    /* [ constructor ] */
+    duk_push_boolean(ctx, duk_get_prop_string(ctx, 0, DUX_IPK_PROFILING) && duk_get_boolean(ctx, 1));
+    /* [ constructor bool/undefined bool ] */
+    return 1;
+}
+
+/**
+ * Setter of profiling
+ */
+DUK_LOCAL duk_ret_t events_profiling_setter(duk_context *ctx)
+{
+    /* [ bool ] */
+    duk_push_boolean(ctx, duk_to_boolean(ctx, 0));
+    duk_push_this(ctx);
+    /* [ bool bool constructor ] */
+    duk_swap_top(ctx, -2);
+    /* [ bool constructor bool ] */
+    duk_put_prop_string(ctx, 1, DUX_IPK_PROFILING);
+    return 0;
+}
+
 /**
  * List of methods for EventEmitter object
  */
 DUK_LOCAL duk_function_list_entry events_proto_funcs[] = {
     { "addListener", events_proto_on, 2 },
     { "emit", events_proto_emit, DUK_VARARGS },
+    { "emitBatch", events_proto_emitBatch, 2 },
     { "eventNames", events_proto_eventNames, 0 },
     { "getMaxListeners", events_proto_getMaxListeners, 0 },
     { "listenerCount", events_proto_listenerCount, 1 },
-    { "listeners", events_proto_listeners, 0 },
+    { "listeners", events_proto_listeners, 1 },
     { "on", events_proto_on, 2 },
     { "once", events_proto_once, 2 },
     { "prependListener", events_proto_prependListener, 2 },
     { "prependOnceListener", events_proto_prependOnceListener, 2 },
     { "removeAllListeners", events_proto_removeAllListeners, 1 },
     { "removeListener", events_proto_removeListener, 2 },
+    { "setCoalescing", events_proto_setCoalescing, 2 },
     { "setMaxListeners", events_proto_setMaxListeners, 1 },
+    { "setProfiling", events_proto_setProfiling, 1 },
+    { "stats", events_proto_stats, 0 },
     { NULL, NULL, 0 }
 };
 
@@ -736,6 +1283,7 @@ DUK_LOCAL duk_function_list_entry events_proto_funcs[] = {
  */
 DUK_LOCAL dux_property_list_entry events_props[] = {
     { "defaultMaxListeners", events_defaultMaxListeners_getter, events_defaultMaxListeners_setter },
+    { "profiling", events_profiling_getter, events_profiling_setter },
     { NULL, NULL, NULL }
 };
 
@@ -770,4 +1318,85 @@ DUK_INTERNAL duk_errcode_t dux_events_init(duk_context *ctx)
     return dux_modules_register(ctx, "events", events_entry);
 }
 
+/**
+ * Emit events queued by coalescing
+ */
+DUK_INTERNAL duk_int_t dux_events_tick(duk_context *ctx)
+{
+    duk_uint_t jobs = 0;
+    duk_size_t length;
+    duk_size_t index;
+
+    /* [ ... ] */
+    duk_push_heap_stash(ctx);
+    /* [ ... stash ] */
+    if (!duk_get_prop_string(ctx, -1, DUX_IPK_EVENTS_PENDING)) {
+        /* [ ... stash undefined ] */
+        duk_pop_2(ctx);
+        return DUX_TICK_RET_JOBLESS;
+    }
+    /* [ ... stash pending ] */
+    duk_del_prop_string(ctx, -2, DUX_IPK_EVENTS_PENDING);
+    length = duk_get_length(ctx, -1);
+    for (index = 0; index < length; ++index) {
+        duk_get_prop_index(ctx, -1, index);
+        duk_get_prop_index(ctx, -1, 0);
+        duk_get_prop_index(ctx, -2, 1);
+        duk_get_prop_index(ctx, -3, 2);
+        /* [ ... stash pending item this key queue ] */
+        if (duk_get_prop_string(ctx, -3, DUX_IPK_COALESCE)) {
+            /* [ ... stash pending item this key queue coal ] */
+            duk_dup(ctx, -3);
+            duk_get_prop(ctx, -2);
+            if (duk_strict_equals(ctx, -1, -3)) {
+                /* Following events are queued for next tick */
+                duk_dup(ctx, -4);
+                duk_push_true(ctx);
+                duk_put_prop(ctx, -4);
+            }
+            duk_pop(ctx);
+        }
+        duk_pop(ctx);
+        /* [ ... stash pending item this key queue ] */
+        duk_push_c_function(ctx, events_proto_emitBatch, 2);
+        duk_insert(ctx, -4);
+        /* [ ... stash pending item func this key queue ] */
+        if (duk_pcall_method(ctx, 2) != 0) {
+            /* [ ... stash pending item err ] */
+            dux_report_error(ctx);
+        }
+        duk_pop_2(ctx);
+        /* [ ... stash pending ] */
+        ++jobs;
+    }
+    duk_pop_2(ctx);
+    /* [ ... ] */
+    dux_loop_stats_add_jobs(ctx, jobs);
+    return (jobs > 0) ? DUX_TICK_RET_CONTINUE : DUX_TICK_RET_JOBLESS;
+}
+
+/**
+ * Emit event with multiple sets of arguments
+ * (Listeners are looked up once for all sets.
+ *  Truncating the batch array stops the rest of sets)
+ */
+DUK_INTERNAL duk_bool_t dux_events_emit_batch(duk_context *ctx, duk_idx_t obj_idx, const char *name)
+{
+    duk_bool_t result;
+
+    /* [ ... obj ... batch ] */
+    obj_idx = duk_normalize_index(ctx, obj_idx);
+    duk_push_c_function(ctx, events_proto_emitBatch, 2);
+    duk_dup(ctx, obj_idx);
+    duk_push_string(ctx, name);
+    duk_dup(ctx, -4);
+    /* [ ... obj ... batch func obj name batch ] */
+    duk_call_method(ctx, 2);
+    /* [ ... obj ... batch bool ] */
+    result = duk_get_boolean(ctx, -1);
+    duk_pop_2(ctx);
+    /* [ ... obj ... ] */
+    return result;
+}
+
 #endif  /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS */
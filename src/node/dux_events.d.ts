@@ -10,6 +10,11 @@ declare namespace Dux {
          */
         static defaultMaxListeners: number;
 
+        /**
+         * Start profiling of new EventEmitter objects (See setProfiling())
+         */
+        static profiling: boolean;
+
         /**
          * Adds the listener function to the end of the array of
          * listeners for the event. This is an alias of on().
@@ -19,12 +24,25 @@ declare namespace Dux {
         addListener(eventName: any, listener: Function): EventEmitter;
 
         /**
-         * Calls event listeners for the event
+         * Calls event listeners for the event.
+         * Error thrown by a listener is emitted as "error" event (or reported
+         * by dux_report_error if not handled), and remaining listeners are still called.
+         * "error" event without listeners throws the error.
          * @param eventName Name of the event
          * @return true if the event had listeners
          */
         emit(eventName: any, ...args: any[]): boolean;
 
+        /**
+         * Calls event listeners for each set of arguments
+         * (Listeners are looked up once, and "once" listeners are called for the first set only.
+         *  Truncating argsList in a listener stops the rest of sets)
+         * @param eventName Name of the event
+         * @param argsList Array of arguments (Non-array element is passed as a single argument)
+         * @return true if the event had listeners
+         */
+        emitBatch(eventName: any, argsList: any[]): boolean;
+
         /**
          * Get the list of event names
          */
@@ -94,6 +112,27 @@ declare namespace Dux {
          * @param n Max number of listeners
          */
         setMaxListeners(n: number): EventEmitter;
+
+        /**
+         * Enable/disable coalescing of the event.
+         * When enabled, emit() only queues arguments, and events queued
+         * in one tick are emitted in next tick by a single emitBatch().
+         * @param eventName Name of the event
+         * @param enabled true to enable coalescing
+         */
+        setCoalescing(eventName: any, enabled: boolean): EventEmitter;
+
+        /**
+         * Start (and reset) or stop recording statistics of events
+         * @param enabled true to start profiling
+         */
+        setProfiling(enabled: boolean): EventEmitter;
+
+        /**
+         * Get statistics recorded by profiling
+         * @return Number of dispatches, listener calls and cumulative time of listeners (in milliseconds) per event
+         */
+        stats(): { [eventName: string]: { count: number, calls: number, time: number } };
     }
 
     module EventEmitter {
@@ -8,8 +8,10 @@
  */
 
 DUK_INTERNAL_DECL duk_errcode_t dux_events_init(duk_context *ctx);
+DUK_INTERNAL_DECL duk_int_t dux_events_tick(duk_context *ctx);
+DUK_INTERNAL_DECL duk_bool_t dux_events_emit_batch(duk_context *ctx, duk_idx_t obj_idx, const char *name);
 #define DUX_INIT_EVENTS     dux_events_init,
-#define DUX_TICK_EVENTS
+#define DUX_TICK_EVENTS     DUX_TICK_HANDLER(dux_events_tick, "events")
 
 #else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS */
 
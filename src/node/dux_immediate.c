@@ -43,6 +43,7 @@ DUK_LOCAL duk_ret_t immed_set_immediate(duk_context *ctx)
     /* [ immed stash arr ] */
     duk_pop_2(ctx);
     /* [ immed ] */
+    dux_wakeup_signal(ctx);
     return 1;
 }
 
@@ -78,6 +79,7 @@ DUK_INTERNAL duk_errcode_t dux_immediate_init(duk_context *ctx)
 DUK_INTERNAL duk_int_t dux_immediate_tick(duk_context *ctx)
 {
 	duk_int_t result = DUX_TICK_RET_JOBLESS;
+    duk_uint_t jobs = 0;
 
     /* [ ... ] */
     duk_push_heap_stash(ctx);
@@ -93,6 +95,7 @@ DUK_INTERNAL duk_int_t dux_immediate_tick(duk_context *ctx)
                 /* [ ... stash arr enum key value func ] */
                 duk_del_prop_string(ctx, -2, DUX_IPK_IMMEDIATE_CB);
                 result = DUX_TICK_RET_CONTINUE;
+                ++jobs;
                 if (duk_pcall(ctx, 0) != 0) {
                     /* [ ... stash arr enum key value error ] */
                     dux_report_error(ctx);
@@ -106,6 +109,7 @@ DUK_INTERNAL duk_int_t dux_immediate_tick(duk_context *ctx)
     }
     duk_pop_2(ctx);
     /* [ ... ] */
+    dux_loop_stats_add_jobs(ctx, jobs);
     return result;
 }
 
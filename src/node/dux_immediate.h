@@ -10,7 +10,7 @@
 DUK_INTERNAL_DECL duk_errcode_t dux_immediate_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_immediate_tick(duk_context *ctx);
 #define DUX_INIT_IMMEDIATE  dux_immediate_init,
-#define DUX_TICK_IMMEDIATE  dux_immediate_tick,
+#define DUX_TICK_IMMEDIATE  DUX_TICK_HANDLER(dux_immediate_tick, "immediate")
 
 #else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_IMMEDIATE */
 
@@ -10,6 +10,9 @@ DUK_INTERNAL duk_errcode_t dux_node_init(duk_context *ctx)
         DUX_INIT_TIMER
         DUX_INIT_UTIL
         DUX_INIT_PATH
+        DUX_INIT_PERF_HOOKS
+        DUX_INIT_WORKER_THREADS
+        DUX_INIT_STREAM
         NULL
     );
 }
@@ -23,6 +26,9 @@ DUK_INTERNAL duk_int_t dux_node_tick(duk_context *ctx)
         DUX_TICK_TIMER
         DUX_TICK_UTIL
         DUX_TICK_PATH
+        DUX_TICK_PERF_HOOKS
+        DUX_TICK_WORKER_THREADS
+        DUX_TICK_STREAM
         NULL
     );
 }
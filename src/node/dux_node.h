@@ -1,19 +1,22 @@
 #ifndef DUX_NODE_H_INCLUDED
 #define DUX_NODE_H_INCLUDED
 
-#if !defined(DUX_OPT_NO_NODEJS_MODULES)
-
 #include "dux_events.h"
 #include "dux_console.h"
 #include "dux_process.h"
 #include "dux_timer.h"
 #include "dux_util.h"
 #include "dux_path.h"
+#include "dux_perf_hooks.h"
+#include "dux_worker_threads.h"
+#include "dux_stream.h"
+
+#if !defined(DUX_OPT_NO_NODEJS_MODULES)
 
 DUK_INTERNAL_DECL duk_errcode_t dux_node_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_node_tick(duk_context *ctx);
 #define DUX_INIT_NODE   dux_node_init,
-#define DUX_TICK_NODE   dux_node_tick,
+#define DUX_TICK_NODE   DUX_TICK_HANDLER(dux_node_tick, "node")
 
 #else   /* !DUX_OPT_NO_NODEJS_MODULES */
 
@@ -0,0 +1,543 @@
+/*
+ * ECMA objects:
+ *    perf_hooks = require("perf_hooks");
+ *
+ *    perf_hooks.monitorEventLoopDelay()
+ *      => Histogram of timer lateness (in nanoseconds)
+ *
+ *    perf_hooks.monitorTickDuration()
+ *      => Histogram of dux_tick() durations (in nanoseconds)
+ *
+ *    perf_hooks.setLongTaskCallback(<Number> threshold, <Function> callback)
+ *      => callback(duration) is called when a tick takes threshold (ms) or longer
+ *         (callback can be omitted to stop detection)
+ *
+ *    class Histogram {
+ *      enable() { return <Boolean>; }
+ *      disable() { return <Boolean>; }
+ *      reset() {}
+ *      percentile(<Number> p) { return <Number>; }
+ *      get count() { return <Number>; }
+ *      get min() { return <Number>; }
+ *      get max() { return <Number>; }
+ *      get mean() { return <Number>; }
+ *      get stddev() { return <Number>; }
+ *    }
+ *
+ * Internal data structure:
+ *    heap_stash[DUX_IPK_PERF_MONITOR] = new PlainBuffer(dux_perf_monitor);
+ *    heap_stash[DUX_IPK_PERF_HISTOGRAMS] = [ Histogram(delay), Histogram(tick) ];
+ *    heap_stash[DUX_IPK_PERF_LONG_TASK] = callback;
+ *    histogram[DUX_IPK_PERF_INDEX] = index of histogram;
+ */
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_TIMER) && !defined(DUX_OPT_NO_PERF_HOOKS)
+#include "../dux_internal.h"
+#include <math.h>
+
+DUK_LOCAL const char DUX_IPK_PERF_MONITOR[]     = DUX_IPK("phMon");
+DUK_LOCAL const char DUX_IPK_PERF_HISTOGRAMS[]  = DUX_IPK("phHist");
+DUK_LOCAL const char DUX_IPK_PERF_LONG_TASK[]   = DUX_IPK("phLong");
+DUK_LOCAL const char DUX_IPK_PERF_INDEX[]       = DUX_IPK("phIdx");
+
+#define DUX_PERF_HISTOGRAM_MAX_VALUE \
+	((((duk_uint64_t)1) << DUX_PERF_HISTOGRAM_MAX_BITS) - 1)
+
+enum
+{
+	DUX_PERF_HISTOGRAM_DELAY = 0,
+	DUX_PERF_HISTOGRAM_TICK,
+	DUX_PERF_HISTOGRAM_COUNT,
+};
+
+/*
+ * HDR style histogram
+ * (Buckets are linear within each power of two)
+ */
+typedef struct dux_perf_histogram
+{
+	duk_bool_t enabled;
+	duk_uint_t count;
+	duk_uint64_t min;
+	duk_uint64_t max;
+	duk_double_t sum;
+	duk_double_t sum_sq;
+	duk_uint_t buckets[DUX_PERF_HISTOGRAM_BUCKETS];
+}
+dux_perf_histogram;
+
+struct dux_perf_monitor
+{
+	dux_perf_histogram histograms[DUX_PERF_HISTOGRAM_COUNT];
+	duk_bool_t long_task_enabled;
+	duk_uint64_t long_task_threshold;
+};
+
+/*
+ * Get bucket index for value
+ */
+DUK_LOCAL duk_uint_t histogram_index(duk_uint64_t value)
+{
+	duk_uint_t shift = 0;
+
+	while ((value >> shift) >= (2 << DUX_PERF_HISTOGRAM_SUB_BITS))
+	{
+		++shift;
+	}
+	return (shift << DUX_PERF_HISTOGRAM_SUB_BITS) + (duk_uint_t)(value >> shift);
+}
+
+/*
+ * Get the highest value which is recorded into the bucket
+ */
+DUK_LOCAL duk_uint64_t histogram_bucket_max(duk_uint_t index)
+{
+	duk_uint_t shift;
+
+	if (index < (2 << DUX_PERF_HISTOGRAM_SUB_BITS))
+	{
+		return index;
+	}
+	shift = (index >> DUX_PERF_HISTOGRAM_SUB_BITS) - 1;
+	index -= (shift << DUX_PERF_HISTOGRAM_SUB_BITS);
+	return ((duk_uint64_t)(index + 1) << shift) - 1;
+}
+
+/*
+ * Record value into histogram
+ */
+DUK_LOCAL void histogram_record(dux_perf_histogram *hist, duk_uint64_t value)
+{
+	if (!hist->enabled)
+	{
+		return;
+	}
+	if (value > DUX_PERF_HISTOGRAM_MAX_VALUE)
+	{
+		value = DUX_PERF_HISTOGRAM_MAX_VALUE;
+	}
+	if ((hist->count == 0) || (value < hist->min))
+	{
+		hist->min = value;
+	}
+	if (value > hist->max)
+	{
+		hist->max = value;
+	}
+	hist->sum += (duk_double_t)value;
+	hist->sum_sq += (duk_double_t)value * (duk_double_t)value;
+	++hist->count;
+	++hist->buckets[histogram_index(value)];
+}
+
+/*
+ * Clear all records in histogram
+ */
+DUK_LOCAL void histogram_reset(dux_perf_histogram *hist)
+{
+	duk_bool_t enabled = hist->enabled;
+
+	memset(hist, 0, sizeof(*hist));
+	hist->enabled = enabled;
+}
+
+/*
+ * Get monitor of heap (Returns NULL if not used yet)
+ */
+DUK_INTERNAL dux_perf_monitor *dux_perf_get_monitor(duk_context *ctx)
+{
+	dux_perf_monitor *monitor;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	duk_get_prop_string(ctx, -1, DUX_IPK_PERF_MONITOR);
+	/* [ ... stash buf/undefined ] */
+	monitor = (dux_perf_monitor *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	return monitor;
+}
+
+/*
+ * Get monitor of heap (Created at the first call)
+ */
+DUK_LOCAL dux_perf_monitor *perf_require_monitor(duk_context *ctx)
+{
+	dux_perf_monitor *monitor;
+
+	monitor = dux_perf_get_monitor(ctx);
+	if (monitor)
+	{
+		return monitor;
+	}
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	monitor = (dux_perf_monitor *)duk_push_fixed_buffer(ctx, sizeof(dux_perf_monitor));
+	memset(monitor, 0, sizeof(dux_perf_monitor));
+	/* [ ... stash buf ] */
+	duk_put_prop_string(ctx, -2, DUX_IPK_PERF_MONITOR);
+	duk_push_array(ctx);
+	duk_put_prop_string(ctx, -2, DUX_IPK_PERF_HISTOGRAMS);
+	/* [ ... stash ] */
+	duk_pop(ctx);
+	/* [ ... ] */
+	return monitor;
+}
+
+/*
+ * Get histogram bound to this
+ */
+DUK_LOCAL dux_perf_histogram *perf_histogram_this(duk_context *ctx)
+{
+	dux_perf_monitor *monitor;
+	duk_uint_t index;
+
+	/* [ ... ] */
+	duk_push_this(ctx);
+	/* [ ... this ] */
+	duk_get_prop_string(ctx, -1, DUX_IPK_PERF_INDEX);
+	/* [ ... this uint ] */
+	index = duk_require_uint(ctx, -1);
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	monitor = perf_require_monitor(ctx);
+	if (index >= DUX_PERF_HISTOGRAM_COUNT)
+	{
+		(void)duk_type_error(ctx, "Invalid histogram");
+	}
+	return &monitor->histograms[index];
+}
+
+/*
+ * Start of tick (Returns start time if measurement is required)
+ */
+DUK_INTERNAL duk_uint64_t dux_perf_tick_start(duk_context *ctx)
+{
+	dux_perf_monitor *monitor;
+
+	monitor = dux_perf_get_monitor(ctx);
+	if ((!monitor) || ((!monitor->histograms[DUX_PERF_HISTOGRAM_TICK].enabled) &&
+			(!monitor->long_task_enabled)))
+	{
+		return 0;
+	}
+	return dux_timer_arch_current_ns();
+}
+
+/*
+ * End of tick (Returns true if long task callback has been invoked)
+ */
+DUK_INTERNAL duk_bool_t dux_perf_tick_end(duk_context *ctx, duk_uint64_t start)
+{
+	dux_perf_monitor *monitor;
+	duk_uint64_t elapsed;
+
+	if (start == 0)
+	{
+		return 0;
+	}
+	elapsed = dux_timer_arch_current_ns() - start;
+	monitor = dux_perf_get_monitor(ctx);
+	if (!monitor)
+	{
+		return 0;
+	}
+	histogram_record(&monitor->histograms[DUX_PERF_HISTOGRAM_TICK], elapsed);
+	if ((!monitor->long_task_enabled) || (elapsed < monitor->long_task_threshold))
+	{
+		return 0;
+	}
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_PERF_LONG_TASK);
+	/* [ ... stash func ] */
+	duk_push_number(ctx, (duk_double_t)elapsed / 1000000.0);
+	/* [ ... stash func number ] */
+	if (duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS)
+	{
+		/* [ ... stash err ] */
+		dux_report_error(ctx);
+	}
+	/* [ ... stash retval/err ] */
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	return 1;
+}
+
+/*
+ * Record lateness of timer
+ */
+DUK_INTERNAL void dux_perf_record_timer_delay(dux_perf_monitor *monitor, duk_uint64_t delay)
+{
+	if (monitor)
+	{
+		histogram_record(&monitor->histograms[DUX_PERF_HISTOGRAM_DELAY], delay);
+	}
+}
+
+/*
+ * Entry of Histogram.prototype.enable()
+ */
+DUK_LOCAL duk_ret_t perf_histogram_enable(duk_context *ctx)
+{
+	dux_perf_histogram *hist = perf_histogram_this(ctx);
+
+	duk_push_boolean(ctx, !hist->enabled);
+	hist->enabled = 1;
+	return 1; /* return bool */
+}
+
+/*
+ * Entry of Histogram.prototype.disable()
+ */
+DUK_LOCAL duk_ret_t perf_histogram_disable(duk_context *ctx)
+{
+	dux_perf_histogram *hist = perf_histogram_this(ctx);
+
+	duk_push_boolean(ctx, hist->enabled);
+	hist->enabled = 0;
+	return 1; /* return bool */
+}
+
+/*
+ * Entry of Histogram.prototype.reset()
+ */
+DUK_LOCAL duk_ret_t perf_histogram_reset(duk_context *ctx)
+{
+	histogram_reset(perf_histogram_this(ctx));
+	return 0; /* return undefined */
+}
+
+/*
+ * Entry of Histogram.prototype.percentile()
+ */
+DUK_LOCAL duk_ret_t perf_histogram_percentile(duk_context *ctx)
+{
+	dux_perf_histogram *hist = perf_histogram_this(ctx);
+	duk_double_t percentile;
+	duk_uint_t target;
+	duk_uint_t total;
+	duk_uint_t index;
+	duk_uint64_t value;
+
+	/* [ percentile ] */
+	percentile = duk_require_number(ctx, 0);
+	if (!((percentile > 0) && (percentile <= 100)))
+	{
+		return DUK_RET_RANGE_ERROR;
+	}
+	if (hist->count == 0)
+	{
+		duk_push_number(ctx, 0);
+		return 1; /* return number */
+	}
+	target = (duk_uint_t)ceil(percentile * hist->count / 100.0);
+	if (target == 0)
+	{
+		target = 1;
+	}
+	value = hist->max;
+	for (index = 0, total = 0; index < DUX_PERF_HISTOGRAM_BUCKETS; ++index)
+	{
+		total += hist->buckets[index];
+		if (total >= target)
+		{
+			value = histogram_bucket_max(index);
+			break;
+		}
+	}
+	if (value > hist->max)
+	{
+		value = hist->max;
+	}
+	duk_push_number(ctx, (duk_double_t)value);
+	return 1; /* return number */
+}
+
+/*
+ * Getter of Histogram.prototype.count
+ */
+DUK_LOCAL duk_ret_t perf_histogram_count_getter(duk_context *ctx)
+{
+	duk_push_uint(ctx, perf_histogram_this(ctx)->count);
+	return 1; /* return uint */
+}
+
+/*
+ * Getter of Histogram.prototype.min
+ */
+DUK_LOCAL duk_ret_t perf_histogram_min_getter(duk_context *ctx)
+{
+	duk_push_number(ctx, (duk_double_t)perf_histogram_this(ctx)->min);
+	return 1; /* return number */
+}
+
+/*
+ * Getter of Histogram.prototype.max
+ */
+DUK_LOCAL duk_ret_t perf_histogram_max_getter(duk_context *ctx)
+{
+	duk_push_number(ctx, (duk_double_t)perf_histogram_this(ctx)->max);
+	return 1; /* return number */
+}
+
+/*
+ * Getter of Histogram.prototype.mean
+ */
+DUK_LOCAL duk_ret_t perf_histogram_mean_getter(duk_context *ctx)
+{
+	dux_perf_histogram *hist = perf_histogram_this(ctx);
+
+	duk_push_number(ctx, (hist->count > 0) ? (hist->sum / hist->count) : 0);
+	return 1; /* return number */
+}
+
+/*
+ * Getter of Histogram.prototype.stddev
+ */
+DUK_LOCAL duk_ret_t perf_histogram_stddev_getter(duk_context *ctx)
+{
+	dux_perf_histogram *hist = perf_histogram_this(ctx);
+	duk_double_t mean;
+	duk_double_t variance = 0;
+
+	if (hist->count > 0)
+	{
+		mean = hist->sum / hist->count;
+		variance = (hist->sum_sq / hist->count) - (mean * mean);
+	}
+	duk_push_number(ctx, (variance > 0) ? sqrt(variance) : 0);
+	return 1; /* return number */
+}
+
+/*
+ * List of methods for Histogram object
+ */
+DUK_LOCAL const duk_function_list_entry perf_histogram_funcs[] = {
+	{ "enable", perf_histogram_enable, 0 },
+	{ "disable", perf_histogram_disable, 0 },
+	{ "reset", perf_histogram_reset, 0 },
+	{ "percentile", perf_histogram_percentile, 1 },
+	{ NULL, NULL, 0 }
+};
+
+/*
+ * List of properties for Histogram object
+ */
+DUK_LOCAL const dux_property_list_entry perf_histogram_props[] = {
+	{ "count", perf_histogram_count_getter, NULL },
+	{ "min", perf_histogram_min_getter, NULL },
+	{ "max", perf_histogram_max_getter, NULL },
+	{ "mean", perf_histogram_mean_getter, NULL },
+	{ "stddev", perf_histogram_stddev_getter, NULL },
+	{ NULL, NULL, NULL }
+};
+
+/*
+ * Push histogram object (Created at the first call)
+ */
+DUK_LOCAL void perf_push_histogram(duk_context *ctx, duk_uint_t index)
+{
+	(void)perf_require_monitor(ctx);
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_PERF_HISTOGRAMS);
+	/* [ ... stash arr ] */
+	if (!duk_get_prop_index(ctx, -1, index))
+	{
+		/* [ ... stash arr undefined ] */
+		duk_pop(ctx);
+		duk_push_object(ctx);
+		/* [ ... stash arr obj ] */
+		duk_put_function_list(ctx, -1, perf_histogram_funcs);
+		dux_put_property_list(ctx, -1, perf_histogram_props);
+		duk_push_uint(ctx, index);
+		duk_put_prop_string(ctx, -2, DUX_IPK_PERF_INDEX);
+		duk_dup_top(ctx);
+		duk_put_prop_index(ctx, -3, index);
+	}
+	/* [ ... stash arr obj ] */
+	duk_replace(ctx, -3);
+	duk_pop(ctx);
+	/* [ ... obj ] */
+}
+
+/*
+ * Entry of perf_hooks.monitorEventLoopDelay()
+ */
+DUK_LOCAL duk_ret_t perf_monitorEventLoopDelay(duk_context *ctx)
+{
+	perf_push_histogram(ctx, DUX_PERF_HISTOGRAM_DELAY);
+	return 1; /* return obj */
+}
+
+/*
+ * Entry of perf_hooks.monitorTickDuration()
+ */
+DUK_LOCAL duk_ret_t perf_monitorTickDuration(duk_context *ctx)
+{
+	perf_push_histogram(ctx, DUX_PERF_HISTOGRAM_TICK);
+	return 1; /* return obj */
+}
+
+/*
+ * Entry of perf_hooks.setLongTaskCallback()
+ */
+DUK_LOCAL duk_ret_t perf_setLongTaskCallback(duk_context *ctx)
+{
+	dux_perf_monitor *monitor;
+	duk_double_t threshold;
+
+	/* [ threshold callback ] */
+	threshold = duk_require_number(ctx, 0);
+	if (!(threshold >= 0))
+	{
+		return DUK_RET_RANGE_ERROR;
+	}
+	monitor = perf_require_monitor(ctx);
+	duk_push_heap_stash(ctx);
+	/* [ threshold callback stash ] */
+	if (duk_is_null_or_undefined(ctx, 1))
+	{
+		monitor->long_task_enabled = 0;
+		duk_del_prop_string(ctx, 2, DUX_IPK_PERF_LONG_TASK);
+		return 0; /* return undefined */
+	}
+	duk_require_callable(ctx, 1);
+	duk_dup(ctx, 1);
+	duk_put_prop_string(ctx, 2, DUX_IPK_PERF_LONG_TASK);
+	monitor->long_task_threshold = (duk_uint64_t)(threshold * 1000000.0);
+	monitor->long_task_enabled = 1;
+	return 0; /* return undefined */
+}
+
+/*
+ * List of methods for perf_hooks module
+ */
+DUK_LOCAL const duk_function_list_entry perf_funcs[] = {
+	{ "monitorEventLoopDelay", perf_monitorEventLoopDelay, 0 },
+	{ "monitorTickDuration", perf_monitorTickDuration, 0 },
+	{ "setLongTaskCallback", perf_setLongTaskCallback, 2 },
+	{ NULL, NULL, 0 }
+};
+
+DUK_LOCAL duk_errcode_t perf_entry(duk_context *ctx)
+{
+	/* [ require module exports ] */
+	duk_put_function_list(ctx, 2, perf_funcs);
+	return DUK_ERR_NONE;
+}
+
+/*
+ * Initialize perf_hooks module
+ */
+DUK_INTERNAL duk_errcode_t dux_perf_hooks_init(duk_context *ctx)
+{
+	return dux_modules_register(ctx, "perf_hooks", perf_entry);
+}
+
+#endif  /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_TIMER && !DUX_OPT_NO_PERF_HOOKS */
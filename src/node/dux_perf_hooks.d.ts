@@ -0,0 +1,72 @@
+declare namespace Dux {
+    interface Histogram {
+        /**
+         * Starts recording. Returns true if it was disabled.
+         */
+        enable(): boolean;
+
+        /**
+         * Stops recording. Returns true if it was enabled.
+         */
+        disable(): boolean;
+
+        /**
+         * Clears all recorded values.
+         */
+        reset(): void;
+
+        /**
+         * Returns the value at the given percentile (in nanoseconds).
+         * @param percentile A percentile value in the range (0, 100]
+         */
+        percentile(percentile: number): number;
+
+        /**
+         * Number of recorded values
+         */
+        readonly count: number;
+
+        /**
+         * Minimum recorded value (in nanoseconds)
+         */
+        readonly min: number;
+
+        /**
+         * Maximum recorded value (in nanoseconds)
+         */
+        readonly max: number;
+
+        /**
+         * Mean of recorded values (in nanoseconds)
+         */
+        readonly mean: number;
+
+        /**
+         * Standard deviation of recorded values (in nanoseconds)
+         */
+        readonly stddev: number;
+    }
+
+    module PerfHooks {
+        /**
+         * Returns the histogram of timer lateness (disabled by default).
+         */
+        function monitorEventLoopDelay(): Dux.Histogram;
+
+        /**
+         * Returns the histogram of tick durations (disabled by default).
+         */
+        function monitorTickDuration(): Dux.Histogram;
+
+        /**
+         * Sets a callback which is called after a tick taking threshold or longer.
+         * @param threshold Threshold in milliseconds
+         * @param callback A function to be called with tick duration (in milliseconds).
+         *                 Omit this to stop detection.
+         */
+        function setLongTaskCallback(threshold: number, callback?: (duration: number) => void): void;
+    }
+}
+declare module "perf_hooks" {
+    export = Dux.PerfHooks;
+}
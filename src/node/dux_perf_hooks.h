@@ -0,0 +1,42 @@
+#ifndef DUX_PERF_HOOKS_H_INCLUDED
+#define DUX_PERF_HOOKS_H_INCLUDED
+
+typedef struct dux_perf_monitor dux_perf_monitor;
+
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_TIMER) && !defined(DUX_OPT_NO_PERF_HOOKS)
+
+/*
+ * Histogram resolution
+ * (Values are recorded in nanoseconds with 2^-SUB_BITS relative precision
+ *  and clamped to 2^MAX_BITS-1)
+ */
+#define DUX_PERF_HISTOGRAM_SUB_BITS 3
+#define DUX_PERF_HISTOGRAM_MAX_BITS 36
+#define DUX_PERF_HISTOGRAM_BUCKETS \
+	((DUX_PERF_HISTOGRAM_MAX_BITS - DUX_PERF_HISTOGRAM_SUB_BITS + 1) << DUX_PERF_HISTOGRAM_SUB_BITS)
+
+/*
+ * Functions
+ */
+
+DUK_INTERNAL_DECL duk_errcode_t dux_perf_hooks_init(duk_context *ctx);
+#define DUX_INIT_PERF_HOOKS dux_perf_hooks_init,
+#define DUX_TICK_PERF_HOOKS
+
+DUK_INTERNAL_DECL dux_perf_monitor *dux_perf_get_monitor(duk_context *ctx);
+DUK_INTERNAL_DECL duk_uint64_t dux_perf_tick_start(duk_context *ctx);
+DUK_INTERNAL_DECL duk_bool_t dux_perf_tick_end(duk_context *ctx, duk_uint64_t start);
+DUK_INTERNAL_DECL void dux_perf_record_timer_delay(dux_perf_monitor *monitor, duk_uint64_t delay);
+
+#else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_TIMER && !DUX_OPT_NO_PERF_HOOKS */
+
+#define DUX_INIT_PERF_HOOKS
+#define DUX_TICK_PERF_HOOKS
+
+#define dux_perf_get_monitor(ctx)                   ((dux_perf_monitor *)NULL)
+#define dux_perf_tick_start(ctx)                    (0)
+#define dux_perf_tick_end(ctx, start)               ((void)(start), 0)
+#define dux_perf_record_timer_delay(monitor, delay) ((void)(monitor), (void)(delay))
+
+#endif  /* DUX_OPT_NO_NODEJS_MODULES || DUX_OPT_NO_TIMER || DUX_OPT_NO_PERF_HOOKS */
+#endif  /* !DUX_PERF_HOOKS_H_INCLUDED */
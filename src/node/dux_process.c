@@ -1,7 +1,11 @@
 /*
  * ECMA class methods:
  *    process.exit([exitCode])
+ *    process.hrtime([time])
+ *    process.hrtime.bigint()
+ *    process.loopStats()
  *    process.nextTick(function [, arg1, ..., argN])
+ *    process.promiseQueueDepth()
  *
  * ECMA class properties:
  *    process.arch
@@ -35,6 +39,7 @@ DUK_LOCAL duk_ret_t process_exit(duk_context *ctx)
 	data->exit_code = duk_get_int(ctx, 0);
 	data->exit_valid = 1;
 	data->force_exit = 1;
+	dux_wakeup_signal(ctx);
 	return 0; /* return undefined */
 }
 
@@ -73,9 +78,90 @@ DUK_LOCAL duk_ret_t process_nextTick(duk_context *ctx)
 		/* [ buf process func ] */
 	}
 	duk_xmove_top(data->tick_context, ctx, 1);
+	dux_wakeup_signal(ctx);
 	return 0; /* return undefined */
 }
 
+#if !defined(DUX_OPT_NO_TIMER)
+/*
+ * Entry of process.hrtime()
+ */
+DUK_LOCAL duk_ret_t process_hrtime(duk_context *ctx)
+{
+	duk_uint64_t now = dux_timer_arch_current_ns();
+	duk_uint64_t prev;
+
+	/* [ arr/undefined ] */
+	if (!duk_is_undefined(ctx, 0))
+	{
+		if (!duk_is_array(ctx, 0))
+		{
+			return DUK_RET_TYPE_ERROR;
+		}
+		duk_get_prop_index(ctx, 0, 0);
+		duk_get_prop_index(ctx, 0, 1);
+		/* [ arr sec nsec ] */
+		prev = ((duk_uint64_t)duk_require_uint(ctx, 1) * 1000000000ULL) +
+			(duk_uint64_t)duk_require_uint(ctx, 2);
+		now = (now > prev) ? (now - prev) : 0;
+	}
+	duk_push_array(ctx);
+	/* [ ... arr ] */
+	duk_push_number(ctx, (duk_double_t)(now / 1000000000ULL));
+	duk_put_prop_index(ctx, -2, 0);
+	duk_push_number(ctx, (duk_double_t)(now % 1000000000ULL));
+	duk_put_prop_index(ctx, -2, 1);
+	/* [ ... arr ] */
+	return 1; /* return arr */
+}
+
+/*
+ * Entry of process.hrtime.bigint()
+ * (Returns number because Duktape has no BigInt)
+ */
+DUK_LOCAL duk_ret_t process_hrtime_bigint(duk_context *ctx)
+{
+	duk_push_number(ctx, (duk_double_t)dux_timer_arch_current_ns());
+	return 1; /* return number */
+}
+#endif  /* !DUX_OPT_NO_TIMER */
+
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+/*
+ * Entry of process.loopStats()
+ */
+DUK_LOCAL duk_ret_t process_loopStats(duk_context *ctx)
+{
+	dux_loop_stats stats[DUX_LOOP_STATS_MAX];
+	duk_uint_t count;
+	duk_uint_t index;
+
+	count = dux_get_loop_stats(ctx, stats, DUX_LOOP_STATS_MAX);
+	if (count > DUX_LOOP_STATS_MAX)
+	{
+		count = DUX_LOOP_STATS_MAX;
+	}
+	duk_push_object(ctx);
+	/* [ obj ] */
+	for (index = 0; index < count; ++index)
+	{
+		duk_push_object(ctx);
+		/* [ obj entry ] */
+		duk_push_uint(ctx, stats[index].calls);
+		duk_put_prop_string(ctx, -2, "calls");
+		duk_push_uint(ctx, stats[index].jobs);
+		duk_put_prop_string(ctx, -2, "jobs");
+		duk_push_number(ctx, stats[index].total_time);
+		duk_put_prop_string(ctx, -2, "totalTime");
+		duk_push_number(ctx, stats[index].max_time);
+		duk_put_prop_string(ctx, -2, "maxTime");
+		duk_put_prop_string(ctx, -2, stats[index].name);
+		/* [ obj ] */
+	}
+	return 1; /* return obj */
+}
+#endif  /* !DUX_OPT_NO_LOOP_STATS */
+
 /*
  * Getter of process.arch
  */
@@ -235,12 +321,28 @@ DUK_LOCAL duk_ret_t process_versions_getter(duk_context *ctx)
 	return 1;
 }
 
+/*
+ * Entry of process.promiseQueueDepth()
+ */
+DUK_LOCAL duk_ret_t process_promiseQueueDepth(duk_context *ctx)
+{
+	duk_push_uint(ctx, dux_get_promise_queue_depth(ctx));
+	return 1; /* return uint */
+}
+
 /*
  * List of methods for Process object
  */
 DUK_LOCAL duk_function_list_entry process_funcs[] = {
 	{ "exit", process_exit, 1 },
+#if !defined(DUX_OPT_NO_TIMER)
+	{ "hrtime", process_hrtime, 1 },
+#endif
+#if !defined(DUX_OPT_NO_LOOP_STATS)
+	{ "loopStats", process_loopStats, 0 },
+#endif
 	{ "nextTick", process_nextTick, DUK_VARARGS },
+	{ "promiseQueueDepth", process_promiseQueueDepth, 0 },
 	{ NULL, NULL, 0 }
 };
 
@@ -272,6 +374,14 @@ DUK_INTERNAL duk_errcode_t dux_process_init(duk_context *ctx)
 	/* [ ... stash obj ] */
 	duk_put_function_list(ctx, -1, process_funcs);
 	dux_put_property_list(ctx, -1, process_props);
+#if !defined(DUX_OPT_NO_TIMER)
+	duk_get_prop_string(ctx, -1, "hrtime");
+	/* [ ... stash obj hrtime ] */
+	duk_push_c_function(ctx, process_hrtime_bigint, 0);
+	duk_put_prop_string(ctx, -2, "bigint");
+	duk_pop(ctx);
+	/* [ ... stash obj ] */
+#endif
 	duk_push_fixed_buffer(ctx, sizeof(dux_process_data));
 	/* [ ... stash obj buf ] */
 	data = (dux_process_data *)duk_get_buffer(ctx, -1, NULL);
@@ -294,6 +404,16 @@ DUK_INTERNAL duk_errcode_t dux_process_init(duk_context *ctx)
 	return DUK_ERR_NONE;
 }
 
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+/*
+ * Initialize Process module on first access to global.process
+ */
+DUK_INTERNAL duk_errcode_t dux_process_init_lazy(duk_context *ctx)
+{
+	return dux_define_lazy_global(ctx, "process", dux_process_init);
+}
+#endif  /* DUX_ENABLE_LAZY_GLOBALS */
+
 /*
  * Tick handler for Process module
  */
@@ -352,6 +472,7 @@ DUK_INTERNAL duk_int_t dux_process_tick(duk_context *ctx)
 	/* [ ... stash process buf thr ] */
 	duk_pop_n(ctx, 4);
 	/* [ ... ] */
+	dux_loop_stats_add_jobs(ctx, (duk_uint_t)index);
 	return force ? DUX_TICK_RET_ABORT : DUX_TICK_RET_CONTINUE;
 }
 
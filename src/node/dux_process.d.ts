@@ -7,6 +7,20 @@ declare namespace Dux {
         dux: string;
     }
 
+    interface LoopStats {
+        /** Number of invocations */
+        calls: number;
+
+        /** Number of jobs (callbacks) run */
+        jobs: number;
+
+        /** Cumulative time in milliseconds */
+        totalTime: number;
+
+        /** Maximum time of single invocation in milliseconds */
+        maxTime: number;
+    }
+
     interface Process {
         /** Running architecture */
         readonly arch: string;
@@ -17,6 +31,28 @@ declare namespace Dux {
         /** Current exit code */
         exitCode: number;
 
+        /**
+         * Get high-resolution time as [seconds, nanoseconds]
+         * @param time Previous result to calculate difference
+         */
+        hrtime: {
+            (time?: [number, number]): [number, number];
+
+            /** Get high-resolution time in nanoseconds (number, not bigint) */
+            bigint(): number;
+        };
+
+        /**
+         * Get statistics of event loop per tick handler
+         * (Time values are in milliseconds)
+         */
+        loopStats(): { [handler: string]: LoopStats };
+
+        /**
+         * Get number of promise jobs waiting to be run
+         */
+        promiseQueueDepth(): number;
+
         /**
          * Add callback to next tick queue
          * @param callback Callback function to be called in next tick
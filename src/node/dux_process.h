@@ -22,8 +22,13 @@ dux_process_data;
 
 DUK_INTERNAL_DECL duk_errcode_t dux_process_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_process_tick(duk_context *ctx);
+#if defined(DUX_ENABLE_LAZY_GLOBALS)
+DUK_INTERNAL_DECL duk_errcode_t dux_process_init_lazy(duk_context *ctx);
+#define DUX_INIT_PROCESS    dux_process_init_lazy,
+#else   /* !DUX_ENABLE_LAZY_GLOBALS */
 #define DUX_INIT_PROCESS    dux_process_init,
-#define DUX_TICK_PROCESS    dux_process_tick,
+#endif  /* !DUX_ENABLE_LAZY_GLOBALS */
+#define DUX_TICK_PROCESS    DUX_TICK_HANDLER(dux_process_tick, "process")
 
 #else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_PROCESS */
 
@@ -1,120 +1,1971 @@
-#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_STREAM)
+/*
+ * ECMA objects:
+ *    Stream = require("stream");
+ *
+ *    class Stream extends EventEmitter {
+ *      destroy(<Error> err) {}
+ *      // Event: 'close'
+ *    }
+ *
+ *    class Writable extends Stream {
+ *      constructor({ highWaterMark, objectMode, decodeStrings, write, writev, final }) {}
+ *      write(<String|Buffer|Any> chunk, <String> encoding, <Function> callback) {} => boolean
+ *      end(<String|Buffer|Any> chunk, <String> encoding, <Function> callback) {}
+ *      cork() {}
+ *      uncork() {}
+ *      setDefaultEncoding(<String> encoding) {}
+ *      get writableLength() {}
+ *      get writableHighWaterMark() {}
+ *      // Event: 'drain', 'finish', 'error'
+ *    }
+ *
+ *    class Readable extends Stream {
+ *      constructor({ highWaterMark, objectMode, encoding, read }) {}
+ *      push(<String|Buffer|Any|null> chunk) {} => boolean
+ *      pipe(<Writable> destination, { end }) {} => destination
+ *      unpipe(<Writable> destination) {}
+ *      read(<Number> size) {}
+ *      unshift(<String|Buffer|Any> chunk) {}
+ *      pause() {}
+ *      resume() {}
+ *      isPaused() {}
+ *      setEncoding(<String> encoding) {}
+ *      get readableLength() {}
+ *      get readableHighWaterMark() {}
+ *      // Event: 'data', 'end', 'error'
+ *    }
+ *    (Chunks are passed as Buffer, and only UTF-8 is supported as encoding)
+ *
+ *    class Duplex extends Readable {}  (with methods of Writable)
+ *    class Transform extends Duplex {
+ *      constructor({ transform, flush, ... }) {}
+ *    }
+ *
+ * Internal data structure:
+ *    stream[DUX_IPK_WRITABLE_STATE] = new PlainBuffer(dux_stream_writable_data);
+ *    stream[DUX_IPK_WRITABLE_QUEUE] = [ chunk1, encoding1, callback1, chunk2, ... ];
+ *    stream[DUX_IPK_WRITABLE_INFLIGHT] = [ callback1, ... ]; (callbacks of chunks being written)
+ *    stream[DUX_IPK_WRITABLE_ONWRITE] = function (err) {}; (reused for all writes)
+ *    stream[DUX_IPK_WRITABLE_NATIVE] = function (chunk, encoding, callback) {}; (wraps native _write)
+ *    stream[DUX_IPK_WRITABLE_NATIVEV] = function (chunks, callback) {}; (wraps native _writev)
+ *    stream[DUX_IPK_READABLE_STATE] = new PlainBuffer(dux_stream_readable_data);
+ *    stream[DUX_IPK_READABLE_QUEUE] = [ chunk1, chunk2, ... ];
+ *    stream[DUX_IPK_READABLE_NATIVE] = function (size) {}; (wraps native _read)
+ *    stream[DUX_IPK_READABLE_PIPES] = [ destination1, end1, destination2, ... ];
+ *    stream[DUX_IPK_WRITABLE_SOURCES] = [ source1, ... ]; (streams piped to this stream)
+ *    stream[DUX_IPK_WRITABLE_WAITING] = [ source1, ... ]; (sources waiting for 'drain')
+ *    heap_stash[DUX_IPK_STREAM_PENDING] = [ stream, ... ]; (streams waiting for tick)
+ *
+ * Queues are indexed by head/tail in native state, and rewound when they become empty.
+ * Callbacks and events after writes completed synchronously are deferred to the tick.
+ *
+ * pipe() hands chunks (the same buffer objects, or strings decoded by setEncoding())
+ * from readable queue to writable queue in C without 'data' events, and pauses/resumes
+ * source by backpressure of destination.
+ * With native _read (dux_stream_push) and native _write/_writev, no JavaScript code
+ * runs for each chunk.
+ */
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_EVENTS) && !defined(DUX_OPT_NO_STREAM)
 #include "../dux_internal.h"
 
-DUK_LOCAL const char DUX_IPK_WRITABLE_STATE[] = DUX_IPK("stWs");
-DUK_LOCAL const char DUX_IPK_READABLE_STATE[] = DUX_IPK("stRs");
+DUK_LOCAL const char DUX_IPK_WRITABLE_STATE[] = DUX_IPK("stWs");
+DUK_LOCAL const char DUX_IPK_WRITABLE_QUEUE[] = DUX_IPK("stWq");
+DUK_LOCAL const char DUX_IPK_WRITABLE_INFLIGHT[] = DUX_IPK("stWf");
+DUK_LOCAL const char DUX_IPK_WRITABLE_ERROR[] = DUX_IPK("stWe");
+DUK_LOCAL const char DUX_IPK_WRITABLE_ONWRITE[] = DUX_IPK("stWo");
+DUK_LOCAL const char DUX_IPK_WRITABLE_ENCODING[] = DUX_IPK("stWd");
+DUK_LOCAL const char DUX_IPK_WRITABLE_NATIVE[] = DUX_IPK("stWn");
+DUK_LOCAL const char DUX_IPK_WRITABLE_NATIVEV[] = DUX_IPK("stWv");
+DUK_LOCAL const char DUX_IPK_READABLE_STATE[] = DUX_IPK("stRs");
+DUK_LOCAL const char DUX_IPK_READABLE_QUEUE[] = DUX_IPK("stRq");
+DUK_LOCAL const char DUX_IPK_READABLE_ENCODING[] = DUX_IPK("stRe");
+DUK_LOCAL const char DUX_IPK_READABLE_NATIVE[] = DUX_IPK("stRn");
+DUK_LOCAL const char DUX_IPK_READABLE_ON[] = DUX_IPK("stOn");
+DUK_LOCAL const char DUX_IPK_READABLE_PIPES[] = DUX_IPK("stRp");
+DUK_LOCAL const char DUX_IPK_WRITABLE_SOURCES[] = DUX_IPK("stWp");
+DUK_LOCAL const char DUX_IPK_WRITABLE_WAITING[] = DUX_IPK("stWw");
+DUK_LOCAL const char DUX_IPK_TRANSFORM_CALLBACK[] = DUX_IPK("stTc");
+DUK_LOCAL const char DUX_IPK_TRANSFORM_AFTER[] = DUX_IPK("stTa");
+DUK_LOCAL const char DUX_IPK_STREAM_OWNER[] = DUX_IPK("stOwn");
+DUK_LOCAL const char DUX_IPK_STREAM_PENDING[] = DUX_IPK("stPend");
+
+#define WRITABLE_ENTRY_SIZE     3   /* chunk, encoding, callback */
+#define PIPE_ENTRY_SIZE         2   /* destination, end */
+
+/*
+ * Push C function bound to stream
+ */
+DUK_LOCAL void stream_push_bound_function(duk_context *ctx, duk_idx_t this_idx, duk_c_function func, duk_idx_t nargs)
+{
+	/* [ ... this ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	duk_push_c_function(ctx, func, nargs);
+	duk_dup(ctx, this_idx);
+	duk_put_prop_string(ctx, -2, DUX_IPK_STREAM_OWNER);
+	/* [ ... this ... func ] */
+}
+
+/*
+ * Push function which wraps native method
+ * (Cached in stream, and created again only if the native method has been replaced)
+ */
+DUK_LOCAL void stream_push_native(duk_context *ctx, duk_idx_t this_idx, const char *key, duk_c_function func, duk_idx_t nargs)
+{
+	/* [ ... this ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	duk_get_prop_string(ctx, this_idx, key);
+	if (duk_get_c_function(ctx, -1) != func) {
+		duk_pop(ctx);
+		duk_push_c_function(ctx, func, nargs);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, this_idx, key);
+	}
+	/* [ ... this ... func ] */
+}
+
+/*
+ * Push stream bound to current function
+ */
+DUK_LOCAL void stream_push_owner(duk_context *ctx)
+{
+	/* [ ... ] */
+	duk_push_current_function(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_STREAM_OWNER);
+	duk_remove(ctx, -2);
+	/* [ ... stream ] */
+}
+
+/*
+ * Get native state of stream (NULL if the stream does not have it)
+ */
+DUK_LOCAL void *stream_get_state(duk_context *ctx, duk_idx_t this_idx, const char *key)
+{
+	void *state;
+
+	/* [ ... this ... ] */
+	duk_get_prop_string(ctx, this_idx, key);
+	state = duk_get_buffer(ctx, -1, NULL);
+	duk_pop(ctx);
+	return state;
+}
+
+/*
+ * Push option value (Returns false with undefined pushed if not specified)
+ */
+DUK_LOCAL duk_bool_t stream_get_option(duk_context *ctx, duk_idx_t opt_idx, const char *name)
+{
+	/* [ ... options ... ] */
+	if (!duk_is_object(ctx, opt_idx)) {
+		duk_push_undefined(ctx);
+		return 0;
+	}
+	duk_get_prop_string(ctx, opt_idx, name);
+	/* [ ... options ... value ] */
+	return !duk_is_undefined(ctx, -1);
+}
+
+/*
+ * Copy function in options as method of stream (e.g. options.write => this._write)
+ */
+DUK_LOCAL void stream_copy_method(duk_context *ctx, duk_idx_t this_idx, duk_idx_t opt_idx, const char *name, const char *method)
+{
+	/* [ ... ] */
+	if (stream_get_option(ctx, opt_idx, name) && duk_is_callable(ctx, -1)) {
+		duk_put_prop_string(ctx, this_idx, method);
+		return;
+	}
+	duk_pop(ctx);
+}
+
+/*
+ * Get object mode in options (objectMode or {readable|writable}ObjectMode)
+ */
+DUK_LOCAL duk_bool_t stream_get_object_mode(duk_context *ctx, duk_idx_t opt_idx, const char *name)
+{
+	duk_bool_t result;
+
+	/* [ ... ] */
+	if (!stream_get_option(ctx, opt_idx, name)) {
+		duk_pop(ctx);
+		(void)stream_get_option(ctx, opt_idx, "objectMode");
+	}
+	result = duk_to_boolean(ctx, -1);
+	duk_pop(ctx);
+	return result;
+}
+
+/*
+ * Get high water mark in options
+ */
+DUK_LOCAL duk_uint_t stream_get_hwm(duk_context *ctx, duk_idx_t opt_idx, const char *name, duk_uint_t flags)
+{
+	duk_uint_t hwm;
+
+	/* [ ... ] */
+	if (!(stream_get_option(ctx, opt_idx, name) && duk_is_number(ctx, -1))) {
+		duk_pop(ctx);
+		(void)stream_get_option(ctx, opt_idx, "highWaterMark");
+	}
+	if (duk_is_number(ctx, -1)) {
+		hwm = duk_require_uint(ctx, -1);
+	} else if (flags & DUX_STREAM_FLAG_OBJECT_MODE) {
+		hwm = DUX_STREAM_DEFAULT_OBJECT_HIGH_WATER_MARK;
+	} else {
+		hwm = DUX_STREAM_DEFAULT_HIGH_WATER_MARK;
+	}
+	duk_pop(ctx);
+	return hwm;
+}
+
+/*
+ * Register stream to be processed in next tick
+ */
+DUK_LOCAL void stream_schedule(duk_context *ctx, duk_idx_t this_idx, duk_uint_t *flags)
+{
+	if (*flags & DUX_STREAM_FLAG_SCHEDULED) {
+		return;
+	}
+	*flags |= DUX_STREAM_FLAG_SCHEDULED;
+
+	/* [ ... this ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	duk_push_heap_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_STREAM_PENDING)) {
+		duk_pop(ctx);
+		duk_push_array(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, -3, DUX_IPK_STREAM_PENDING);
+	}
+	/* [ ... this ... stash pending ] */
+	duk_dup(ctx, this_idx);
+	duk_put_prop_index(ctx, -2, duk_get_length(ctx, -2));
+	duk_pop_2(ctx);
+	/* [ ... this ... ] */
+	dux_wakeup_signal(ctx);
+}
+
+/*
+ * Emit event with arguments at stack top (Errors are reported)
+ */
+DUK_LOCAL void stream_emit(duk_context *ctx, duk_idx_t this_idx, const char *event, duk_idx_t nargs)
+{
+	/* [ ... this ... args ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	duk_push_string(ctx, event);
+	duk_insert(ctx, -(nargs + 1));
+	duk_push_string(ctx, "emit");
+	duk_insert(ctx, -(nargs + 2));
+	/* [ ... this ... "emit" event args ] */
+	if (duk_pcall_prop(ctx, this_idx, nargs + 1) != 0) {
+		dux_report_error(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... this ... ] */
+}
+
+/*
+ * Call function with arguments at stack top (Errors are reported)
+ */
+DUK_LOCAL void stream_call(duk_context *ctx, duk_idx_t nargs)
+{
+	/* [ ... func args ] */
+	if (duk_pcall(ctx, nargs) != 0) {
+		dux_report_error(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Get length of chunk
+ */
+DUK_LOCAL duk_uint_t stream_chunk_length(duk_context *ctx, duk_idx_t idx, duk_uint_t flags)
+{
+	duk_size_t len = 0;
+
+	if (flags & DUX_STREAM_FLAG_OBJECT_MODE) {
+		return 1;
+	}
+	if (!duk_get_lstring(ctx, idx, &len)) {
+		(void)duk_get_buffer_data(ctx, idx, &len);
+	}
+	return (duk_uint_t)len;
+}
+
+/*
+ * Check encoding name (Only UTF-8 is supported)
+ */
+DUK_LOCAL void stream_check_encoding(duk_context *ctx, duk_idx_t idx)
+{
+	const char *encoding = duk_require_string(ctx, idx);
+
+	if ((strcmp(encoding, "utf8") != 0) && (strcmp(encoding, "utf-8") != 0) &&
+			(strcmp(encoding, "UTF8") != 0) && (strcmp(encoding, "UTF-8") != 0)) {
+		(void)duk_type_error(ctx, "unknown encoding: %s", encoding);
+	}
+}
+
+/*
+ * Push new Buffer (Returns pointer to its data)
+ */
+DUK_LOCAL void *stream_push_buffer(duk_context *ctx, duk_size_t size)
+{
+	void *buf;
+
+	/* [ ... ] */
+	buf = duk_push_fixed_buffer(ctx, size);
+	duk_push_buffer_object(ctx, -1, 0, size, DUK_BUFOBJ_NODEJS_BUFFER);
+	duk_remove(ctx, -2);
+	/* [ ... buffer ] */
+	return buf;
+}
+
+/*
+ * Check chunk for non-object mode
+ * (Strings are converted to Buffer if decode is true, and plain buffers are always converted)
+ */
+DUK_LOCAL void stream_check_chunk(duk_context *ctx, duk_idx_t idx, duk_bool_t decode)
+{
+	duk_size_t len;
+
+	idx = duk_normalize_index(ctx, idx);
+	if (duk_is_string(ctx, idx)) {
+		if (!decode) {
+			return;
+		}
+		(void)duk_to_buffer(ctx, idx, NULL);
+	} else if (!duk_is_buffer_data(ctx, idx)) {
+		(void)duk_type_error(ctx, "invalid chunk");
+	}
+	if (duk_is_buffer(ctx, idx)) {
+		(void)duk_get_buffer(ctx, idx, &len);
+		duk_push_buffer_object(ctx, idx, 0, len, DUK_BUFOBJ_NODEJS_BUFFER);
+		duk_replace(ctx, idx);
+	}
+}
+
+/*
+ * Clear entries of queue
+ */
+DUK_LOCAL void stream_clear_queue(duk_context *ctx, duk_idx_t this_idx, const char *key, duk_uarridx_t *head, duk_uarridx_t *tail)
+{
+	/* [ ... this ... ] */
+	duk_get_prop_string(ctx, this_idx, key);
+	duk_set_length(ctx, -1, 0);
+	duk_pop(ctx);
+	*head = 0;
+	*tail = 0;
+}
+
+/*
+ * Append value at stack top to array property (The value is popped)
+ */
+DUK_LOCAL void stream_array_append(duk_context *ctx, duk_idx_t this_idx, const char *key)
+{
+	/* [ ... value ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	if (!duk_get_prop_string(ctx, this_idx, key)) {
+		duk_pop(ctx);
+		duk_push_array(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, this_idx, key);
+	}
+	/* [ ... value array ] */
+	duk_swap_top(ctx, -2);
+	duk_put_prop_index(ctx, -2, duk_get_length(ctx, -2));
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Remove value from array property (Returns false if not found)
+ */
+DUK_LOCAL duk_bool_t stream_array_remove(duk_context *ctx, duk_idx_t this_idx, const char *key, duk_idx_t value_idx)
+{
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+	duk_bool_t found = 0;
+
+	/* [ ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	value_idx = duk_normalize_index(ctx, value_idx);
+	duk_get_prop_string(ctx, this_idx, key);
+	length = (duk_uarridx_t)duk_get_length(ctx, -1);
+	for (index = 0; index < length; ++index) {
+		duk_get_prop_index(ctx, -1, index);
+		if (found) {
+			duk_put_prop_index(ctx, -2, index - 1);
+			continue;
+		}
+		found = duk_strict_equals(ctx, -1, value_idx);
+		duk_pop(ctx);
+	}
+	if (found) {
+		duk_set_length(ctx, -1, length - 1);
+		if (length == 1) {
+			duk_del_prop_string(ctx, this_idx, key);
+		}
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+	return found;
+}
+
+/*
+ * Entry of Stream.prototype.destroy()
+ */
+DUK_LOCAL duk_ret_t stream_proto_destroy(duk_context *ctx)
+{
+	dux_stream_writable_data *wdata;
+	dux_stream_readable_data *rdata;
+
+	/* [ err ] */
+	duk_push_this(ctx);
+	/* [ err this ] */
+	wdata = (dux_stream_writable_data *)stream_get_state(ctx, 1, DUX_IPK_WRITABLE_STATE);
+	rdata = (dux_stream_readable_data *)stream_get_state(ctx, 1, DUX_IPK_READABLE_STATE);
+	if (wdata) {
+		if (wdata->flags & DUX_STREAM_FLAG_DESTROYED) {
+			return 1;
+		}
+		wdata->flags |= DUX_STREAM_FLAG_DESTROYED;
+		wdata->length = 0;
+		stream_clear_queue(ctx, 1, DUX_IPK_WRITABLE_QUEUE, &wdata->head, &wdata->tail);
+	}
+	if (rdata) {
+		if (rdata->flags & DUX_STREAM_FLAG_DESTROYED) {
+			return 1;
+		}
+		rdata->flags |= DUX_STREAM_FLAG_DESTROYED;
+		rdata->length = 0;
+		stream_clear_queue(ctx, 1, DUX_IPK_READABLE_QUEUE, &rdata->head, &rdata->tail);
+	}
+	if (!duk_is_null_or_undefined(ctx, 0)) {
+		duk_dup(ctx, 0);
+		stream_emit(ctx, 1, "error", 1);
+	}
+	stream_emit(ctx, 1, "close", 0);
+	return 1;
+}
+
+/*
+ * Constructor of Stream
+ */
+DUK_LOCAL duk_ret_t stream_constructor(duk_context *ctx)
+{
+	/* [  ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	/* [ super this ] */
+	duk_call_method(ctx, 0);
+	return 0;
+}
+
+/**
+ * List of methods for Stream object
+ */
+DUK_LOCAL duk_function_list_entry stream_proto_funcs[] = {
+	{ "destroy", stream_proto_destroy, 1 },
+	{ NULL, NULL, 0 }
+};
+
+/*
+ * Writable
+ */
+
+DUK_LOCAL void writable_after_write(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data);
+DUK_LOCAL void readable_unpipe(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data, duk_idx_t dest_idx);
+
+/*
+ * Get state of Writable (this)
+ */
+DUK_LOCAL dux_stream_writable_data *writable_get_data(duk_context *ctx, duk_idx_t *this_idx)
+{
+	dux_stream_writable_data *data;
+
+	/* [ ... ] */
+	duk_push_this(ctx);
+	*this_idx = duk_get_top_index(ctx);
+	/* [ ... this ] */
+	data = (dux_stream_writable_data *)stream_get_state(ctx, *this_idx, DUX_IPK_WRITABLE_STATE);
+	if (!data) {
+		(void)duk_type_error(ctx, "not a writable stream");
+	}
+	return data;
+}
+
+/*
+ * Push _write (or _writev) method (Returns false if not available)
+ */
+DUK_LOCAL duk_bool_t writable_push_method(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data, duk_bool_t vectored)
+{
+	duk_c_function func = vectored ? data->writev : data->write;
+
+	/* [ ... ] */
+	if (func) {
+		if (vectored) {
+			stream_push_native(ctx, this_idx, DUX_IPK_WRITABLE_NATIVEV, func, 2);
+		} else {
+			stream_push_native(ctx, this_idx, DUX_IPK_WRITABLE_NATIVE, func, 3);
+		}
+		return 1;
+	}
+	duk_get_prop_string(ctx, this_idx, vectored ? "_writev" : "_write");
+	if (duk_is_callable(ctx, -1)) {
+		/* [ ... func ] */
+		return 1;
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+	return 0;
+}
+
+/*
+ * Complete current write (or final) with error at stack top
+ */
+DUK_LOCAL void writable_complete(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	/* [ ... err ] */
+	if (!(data->flags & DUX_STREAM_FLAG_BUSY)) {
+		/* Callback has been called twice */
+		duk_pop(ctx);
+		return;
+	}
+	data->flags &= ~DUX_STREAM_FLAG_BUSY;
+	data->length -= data->writing;
+	data->writing = 0;
+	if (duk_is_null_or_undefined(ctx, -1)) {
+		duk_pop(ctx);
+	} else {
+		duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ERROR);
+	}
+	/* [ ... ] */
+	if (data->flags & DUX_STREAM_FLAG_SYNC) {
+		/* Callbacks are called by the caller of writable_start() */
+		data->flags |= DUX_STREAM_FLAG_COMPLETED;
+		return;
+	}
+	writable_after_write(ctx, this_idx, data);
+}
+
+/*
+ * Callback passed to _write/_writev/_final
+ */
+DUK_LOCAL duk_ret_t writable_onwrite(duk_context *ctx)
+{
+	dux_stream_writable_data *data;
+
+	/* [ err ] */
+	stream_push_owner(ctx);
+	/* [ err this ] */
+	data = (dux_stream_writable_data *)stream_get_state(ctx, 1, DUX_IPK_WRITABLE_STATE);
+	duk_swap(ctx, 0, 1);
+	/* [ this err ] */
+	writable_complete(ctx, 0, data);
+	return 0;
+}
+
+/*
+ * Call _write (or _writev with gathered chunks if two or more chunks are queued)
+ * (Returns true if the write has been completed synchronously)
+ */
+DUK_LOCAL duk_bool_t writable_start(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	duk_uarridx_t count = data->tail - data->head;
+	duk_uarridx_t index;
+	duk_uarridx_t entry;
+	duk_uint_t length = 0;
+	duk_idx_t queue_idx;
+	duk_idx_t nargs;
+	duk_bool_t callable = 1;
+
+	/* [ ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_QUEUE);
+	queue_idx = duk_get_top_index(ctx);
+	duk_push_array(ctx);
+	duk_dup_top(ctx);
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_INFLIGHT);
+	/* [ ... queue inflight ] */
+
+	if ((count > 1) && writable_push_method(ctx, this_idx, data, 1)) {
+		/* Gathered write */
+		duk_dup(ctx, this_idx);
+		duk_push_array(ctx);
+		/* [ ... queue inflight func this chunks ] */
+		for (index = 0; index < count; ++index) {
+			entry = (data->head + index) * WRITABLE_ENTRY_SIZE;
+			duk_push_object(ctx);
+			duk_get_prop_index(ctx, queue_idx, entry + 0);
+			length += stream_chunk_length(ctx, -1, data->flags);
+			duk_put_prop_string(ctx, -2, "chunk");
+			duk_get_prop_index(ctx, queue_idx, entry + 1);
+			duk_put_prop_string(ctx, -2, "encoding");
+			duk_put_prop_index(ctx, -2, index);
+			duk_get_prop_index(ctx, queue_idx, entry + 2);
+			duk_put_prop_index(ctx, queue_idx + 1, index);
+		}
+		nargs = 1;
+	} else {
+		/* Single write */
+		count = 1;
+		entry = data->head * WRITABLE_ENTRY_SIZE;
+		if (!writable_push_method(ctx, this_idx, data, 0)) {
+			/* _write has been replaced with non-callable value */
+			callable = 0;
+			duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "_write() is not implemented");
+		}
+		duk_dup(ctx, this_idx);
+		duk_get_prop_index(ctx, queue_idx, entry + 0);
+		length = stream_chunk_length(ctx, -1, data->flags);
+		duk_get_prop_index(ctx, queue_idx, entry + 1);
+		duk_get_prop_index(ctx, queue_idx, entry + 2);
+		duk_put_prop_index(ctx, queue_idx + 1, 0);
+		/* [ ... queue inflight func|err this chunk encoding ] */
+		nargs = 2;
+	}
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ONWRITE);
+	++nargs;
+	/* [ ... queue inflight func this args onwrite ] */
+
+	/* Release entries (chunks are kept alive by arguments) */
+	data->head += count;
+	if (data->head == data->tail) {
+		duk_set_length(ctx, queue_idx, 0);
+		data->head = 0;
+		data->tail = 0;
+	} else {
+		for (index = (data->head - count) * WRITABLE_ENTRY_SIZE;
+				index < data->head * WRITABLE_ENTRY_SIZE; ++index) {
+			duk_push_undefined(ctx);
+			duk_put_prop_index(ctx, queue_idx, index);
+		}
+	}
+
+	data->writing = length;
+	data->flags |= DUX_STREAM_FLAG_BUSY | DUX_STREAM_FLAG_SYNC;
+	if (!callable) {
+		/* Fail without calling (as if the function threw err) */
+		duk_pop_n(ctx, nargs + 1);
+		/* [ ... queue inflight err ] */
+		duk_dup_top(ctx);
+		writable_complete(ctx, this_idx, data);
+	} else if (duk_pcall_method(ctx, nargs) != 0) {
+		/* [ ... queue inflight err ] */
+		duk_dup_top(ctx);
+		writable_complete(ctx, this_idx, data);
+	}
+	data->flags &= ~DUX_STREAM_FLAG_SYNC;
+	duk_pop_3(ctx);
+	/* [ ... ] */
+	return !(data->flags & DUX_STREAM_FLAG_BUSY);
+}
+
+/*
+ * Call _final and emit 'finish'
+ */
+DUK_LOCAL void writable_finish(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	/* [ ... ] */
+	if (!(data->flags & DUX_STREAM_FLAG_FINAL_CALLED)) {
+		data->flags |= DUX_STREAM_FLAG_FINAL_CALLED;
+		duk_get_prop_string(ctx, this_idx, "_final");
+		if (duk_is_callable(ctx, -1)) {
+			duk_dup(ctx, this_idx);
+			duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ONWRITE);
+			/* [ ... func this onwrite ] */
+			data->flags |= DUX_STREAM_FLAG_BUSY | DUX_STREAM_FLAG_SYNC;
+			if (duk_pcall_method(ctx, 1) != 0) {
+				/* [ ... err ] */
+				duk_dup_top(ctx);
+				writable_complete(ctx, this_idx, data);
+			}
+			data->flags &= ~DUX_STREAM_FLAG_SYNC;
+			duk_pop(ctx);
+			/* [ ... ] */
+			if (!(data->flags & DUX_STREAM_FLAG_BUSY)) {
+				/* Completed synchronously */
+				writable_after_write(ctx, this_idx, data);
+			}
+			return;
+		}
+		duk_pop(ctx);
+	}
+	if (data->flags & (DUX_STREAM_FLAG_FINISHED | DUX_STREAM_FLAG_ERRORED)) {
+		return;
+	}
+	data->flags |= DUX_STREAM_FLAG_FINISHED;
+	stream_emit(ctx, this_idx, "finish", 0);
+}
+
+/*
+ * Resume sources which have been paused by backpressure
+ */
+DUK_LOCAL void writable_resume_sources(duk_context *ctx, duk_idx_t this_idx)
+{
+	dux_stream_readable_data *rdata;
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+
+	/* [ ... ] */
+	if (!duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_WAITING)) {
+		duk_pop(ctx);
+		return;
+	}
+	duk_del_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_WAITING);
+	/* [ ... waiting ] */
+	length = (duk_uarridx_t)duk_get_length(ctx, -1);
+	for (index = 0; index < length; ++index) {
+		duk_get_prop_index(ctx, -1, index);
+		/* [ ... waiting source ] */
+		rdata = (dux_stream_readable_data *)stream_get_state(ctx, -1, DUX_IPK_READABLE_STATE);
+		if (rdata && (rdata->awaitDrain > 0) && (--rdata->awaitDrain == 0) &&
+				!(rdata->flags & DUX_STREAM_FLAG_PAUSED)) {
+			rdata->flags |= DUX_STREAM_FLAG_FLOWING;
+			stream_schedule(ctx, -1, &rdata->flags);
+		}
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Detach all sources piped to this stream
+ */
+DUK_LOCAL void writable_unpipe_sources(duk_context *ctx, duk_idx_t this_idx)
+{
+	dux_stream_readable_data *rdata;
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+
+	/* [ ... ] */
+	if (!duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_SOURCES)) {
+		duk_pop(ctx);
+		return;
+	}
+	duk_del_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_SOURCES);
+	/* [ ... sources ] */
+	length = (duk_uarridx_t)duk_get_length(ctx, -1);
+	for (index = 0; index < length; ++index) {
+		duk_get_prop_index(ctx, -1, index);
+		/* [ ... sources source ] */
+		rdata = (dux_stream_readable_data *)stream_get_state(ctx, -1, DUX_IPK_READABLE_STATE);
+		readable_unpipe(ctx, -1, rdata, this_idx);
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Call callbacks of completed write and start next write
+ */
+DUK_LOCAL void writable_after_write(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	duk_uarridx_t index;
+	duk_uarridx_t count;
+
+	this_idx = duk_normalize_index(ctx, this_idx);
+	for (;;) {
+		data->flags &= ~DUX_STREAM_FLAG_COMPLETED;
+		/* [ ... ] */
+		duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ERROR);
+		duk_del_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ERROR);
+		if (duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_INFLIGHT)) {
+			/* [ ... err inflight ] */
+			duk_del_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_INFLIGHT);
+			count = (duk_uarridx_t)duk_get_length(ctx, -1);
+			for (index = 0; index < count; ++index) {
+				duk_get_prop_index(ctx, -1, index);
+				if (duk_is_callable(ctx, -1)) {
+					duk_dup(ctx, -3);
+					/* [ ... err inflight callback err ] */
+					stream_call(ctx, 1);
+				} else {
+					duk_pop(ctx);
+				}
+			}
+		}
+		duk_pop(ctx);
+		/* [ ... err ] */
+		if (!duk_is_undefined(ctx, -1)) {
+			data->flags |= DUX_STREAM_FLAG_ERRORED;
+			stream_emit(ctx, this_idx, "error", 1);
+			writable_unpipe_sources(ctx, this_idx);
+		} else {
+			duk_pop(ctx);
+		}
+		/* [ ... ] */
+		if (data->flags & DUX_STREAM_FLAG_DESTROYED) {
+			return;
+		}
+		if ((data->flags & DUX_STREAM_FLAG_BUSY) || (data->corked > 0) ||
+				(data->head == data->tail)) {
+			break;
+		}
+		if (!writable_start(ctx, this_idx, data)) {
+			/* Callbacks will be called by onwrite */
+			return;
+		}
+	}
+
+	if (data->flags & DUX_STREAM_FLAG_BUSY) {
+		return;
+	}
+	if ((data->head == data->tail) && (data->flags & DUX_STREAM_FLAG_NEED_DRAIN)) {
+		data->flags &= ~DUX_STREAM_FLAG_NEED_DRAIN;
+		if (!(data->flags & DUX_STREAM_FLAG_ENDED)) {
+			writable_resume_sources(ctx, this_idx);
+			stream_emit(ctx, this_idx, "drain", 0);
+		}
+	}
+	if ((data->head == data->tail) && (data->flags & DUX_STREAM_FLAG_ENDED) &&
+			!(data->flags & (DUX_STREAM_FLAG_BUSY | DUX_STREAM_FLAG_COMPLETED))) {
+		writable_finish(ctx, this_idx, data);
+	}
+}
+
+/*
+ * Start write if possible (Callbacks of synchronous write are deferred to tick)
+ */
+DUK_LOCAL void writable_kick(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	if ((data->flags & (DUX_STREAM_FLAG_BUSY | DUX_STREAM_FLAG_COMPLETED)) ||
+			(data->corked > 0) || (data->head == data->tail)) {
+		return;
+	}
+	if (writable_start(ctx, this_idx, data)) {
+		stream_schedule(ctx, this_idx, &data->flags);
+	}
+}
+
+/*
+ * Common implementation of write(), end() and pipe()
+ */
+DUK_LOCAL duk_bool_t writable_write_chunk(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data, duk_idx_t chunk_idx)
+{
+	duk_idx_t enc_idx;
+	duk_idx_t cb_idx;
+	duk_bool_t result;
+
+	/* [ ... chunk encoding callback ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	chunk_idx = duk_normalize_index(ctx, chunk_idx);
+	enc_idx = chunk_idx + 1;
+	cb_idx = chunk_idx + 2;
+	if (data->flags & (DUX_STREAM_FLAG_ENDED | DUX_STREAM_FLAG_DESTROYED)) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "write after end");
+		if (duk_is_callable(ctx, cb_idx)) {
+			duk_dup(ctx, cb_idx);
+			duk_dup(ctx, -2);
+			stream_call(ctx, 1);
+		}
+		stream_emit(ctx, this_idx, "error", 1);
+		return 0;
+	}
+
+	if (!(data->flags & DUX_STREAM_FLAG_OBJECT_MODE)) {
+		if (duk_is_null_or_undefined(ctx, chunk_idx)) {
+			(void)duk_type_error(ctx, "invalid chunk");
+		}
+		if (duk_is_string(ctx, chunk_idx) && !duk_is_null_or_undefined(ctx, enc_idx)) {
+			stream_check_encoding(ctx, enc_idx);
+		}
+		stream_check_chunk(ctx, chunk_idx, data->flags & DUX_STREAM_FLAG_DECODE_STRINGS);
+		if (!duk_is_string(ctx, chunk_idx)) {
+			duk_push_string(ctx, "buffer");
+			duk_replace(ctx, enc_idx);
+		} else if (duk_is_null_or_undefined(ctx, enc_idx)) {
+			if (!duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ENCODING)) {
+				duk_pop(ctx);
+				duk_push_string(ctx, "utf8");
+			}
+			duk_replace(ctx, enc_idx);
+		}
+	}
+
+	data->length += stream_chunk_length(ctx, chunk_idx, data->flags);
+	result = (data->length < data->highWaterMark);
+	if (!result) {
+		data->flags |= DUX_STREAM_FLAG_NEED_DRAIN;
+	}
+
+	/* Enqueue */
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_QUEUE);
+	duk_dup(ctx, chunk_idx);
+	duk_put_prop_index(ctx, -2, data->tail * WRITABLE_ENTRY_SIZE + 0);
+	duk_dup(ctx, enc_idx);
+	duk_put_prop_index(ctx, -2, data->tail * WRITABLE_ENTRY_SIZE + 1);
+	duk_dup(ctx, cb_idx);
+	duk_put_prop_index(ctx, -2, data->tail * WRITABLE_ENTRY_SIZE + 2);
+	duk_pop(ctx);
+	++data->tail;
+
+	writable_kick(ctx, this_idx, data);
+	return result;
+}
+
+/*
+ * Mark end of writes (Buffered chunks are flushed even if corked)
+ */
+DUK_LOCAL void writable_end(duk_context *ctx, duk_idx_t this_idx, dux_stream_writable_data *data)
+{
+	data->corked = 0;
+	data->flags |= DUX_STREAM_FLAG_ENDED;
+	stream_schedule(ctx, this_idx, &data->flags);
+}
+
+/*
+ * Entry of Writable.prototype.cork()
+ */
+DUK_LOCAL duk_ret_t writable_proto_cork(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_writable_data *data = writable_get_data(ctx, &this_idx);
+
+	++data->corked;
+	return 0;
+}
+
+/*
+ * Entry of Writable.prototype.end()
+ */
+DUK_LOCAL duk_ret_t writable_proto_end(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_writable_data *data;
+
+	/* [ chunk encoding callback ] */
+	if (duk_is_callable(ctx, 0)) {
+		duk_swap(ctx, 0, 2);
+	} else if (duk_is_callable(ctx, 1)) {
+		duk_swap(ctx, 1, 2);
+	}
+	duk_dup(ctx, 2);
+	duk_push_undefined(ctx);
+	duk_replace(ctx, 2);
+	/* [ chunk encoding undefined callback ] */
+	data = writable_get_data(ctx, &this_idx);
+	/* [ chunk encoding undefined callback this ] */
+
+	if (!duk_is_null_or_undefined(ctx, 0) && !(data->flags & DUX_STREAM_FLAG_ENDED)) {
+		(void)writable_write_chunk(ctx, this_idx, data, 0);
+	}
+	if (duk_is_callable(ctx, 3)) {
+		duk_push_string(ctx, "once");
+		duk_push_string(ctx, "finish");
+		duk_dup(ctx, 3);
+		duk_call_prop(ctx, this_idx, 2);
+		duk_pop(ctx);
+	}
+	writable_end(ctx, this_idx, data);
+	return 1;   /* return this */
+}
+
+/*
+ * Entry of Writable.prototype.setDefaultEncoding()
+ */
+DUK_LOCAL duk_ret_t writable_proto_setDefaultEncoding(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	/* [ encoding ] */
+	(void)writable_get_data(ctx, &this_idx);
+	/* [ encoding this ] */
+	stream_check_encoding(ctx, 0);
+	duk_dup(ctx, 0);
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ENCODING);
+	return 1;   /* return this */
+}
+
+/*
+ * Entry of Writable.prototype.uncork()
+ */
+DUK_LOCAL duk_ret_t writable_proto_uncork(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_writable_data *data = writable_get_data(ctx, &this_idx);
+
+	if ((data->corked > 0) && (--data->corked == 0)) {
+		writable_kick(ctx, this_idx, data);
+	}
+	return 0;
+}
+
+/*
+ * Entry of Writable.prototype.write()
+ */
+DUK_LOCAL duk_ret_t writable_proto_write(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_writable_data *data;
+
+	/* [ chunk encoding callback ] */
+	if (duk_is_callable(ctx, 1)) {
+		duk_swap(ctx, 1, 2);
+	}
+	data = writable_get_data(ctx, &this_idx);
+	duk_push_boolean(ctx, writable_write_chunk(ctx, this_idx, data, 0));
+	return 1;
+}
+
+/*
+ * Default implementation of Writable.prototype._write()
+ */
+DUK_LOCAL duk_ret_t writable_proto_write_impl(duk_context *ctx)
+{
+	return duk_error(ctx, DUK_ERR_ERROR, "_write() is not implemented");
+}
+
+/*
+ * Getter of Writable.prototype.writableLength
+ */
+DUK_LOCAL duk_ret_t writable_proto_writableLength_getter(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	duk_push_uint(ctx, writable_get_data(ctx, &this_idx)->length);
+	return 1;
+}
+
+/*
+ * Getter of Writable.prototype.writableHighWaterMark
+ */
+DUK_LOCAL duk_ret_t writable_proto_writableHighWaterMark_getter(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	duk_push_uint(ctx, writable_get_data(ctx, &this_idx)->highWaterMark);
+	return 1;
+}
+
+/**
+ * List of methods for Writable object
+ */
+DUK_LOCAL duk_function_list_entry writable_proto_funcs[] = {
+	{ "_write", writable_proto_write_impl, 3 },
+	{ "cork", writable_proto_cork, 0 },
+	{ "end", writable_proto_end, 3 },
+	{ "setDefaultEncoding", writable_proto_setDefaultEncoding, 1 },
+	{ "uncork", writable_proto_uncork, 0 },
+	{ "write", writable_proto_write, 3 },
+	{ NULL, NULL, 0 }
+};
+
+/**
+ * List of properties for Writable object
+ */
+DUK_LOCAL dux_property_list_entry writable_proto_props[] = {
+	{ "writableLength", writable_proto_writableLength_getter, NULL },
+	{ "writableHighWaterMark", writable_proto_writableHighWaterMark_getter, NULL },
+	{ NULL, NULL, NULL }
+};
+
+/*
+ * Initialize writable side of stream
+ */
+DUK_LOCAL void writable_init(duk_context *ctx, duk_idx_t this_idx, duk_idx_t opt_idx)
+{
+	dux_stream_writable_data *data;
+
+	/* [ ... ] */
+	data = (dux_stream_writable_data *)duk_push_fixed_buffer(ctx, sizeof(*data));
+	memset(data, 0, sizeof(*data));
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_STATE);
+
+	data->flags = DUX_STREAM_FLAG_DECODE_STRINGS;
+	if (stream_get_object_mode(ctx, opt_idx, "writableObjectMode")) {
+		data->flags |= DUX_STREAM_FLAG_OBJECT_MODE;
+	}
+	if (stream_get_option(ctx, opt_idx, "decodeStrings") && !duk_to_boolean(ctx, -1)) {
+		data->flags &= ~DUX_STREAM_FLAG_DECODE_STRINGS;
+	}
+	duk_pop(ctx);
+	data->highWaterMark = stream_get_hwm(ctx, opt_idx, "writableHighWaterMark", data->flags);
+
+	duk_push_array(ctx);
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_QUEUE);
+	stream_push_bound_function(ctx, this_idx, writable_onwrite, 1);
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_WRITABLE_ONWRITE);
+
+	stream_copy_method(ctx, this_idx, opt_idx, "write", "_write");
+	stream_copy_method(ctx, this_idx, opt_idx, "writev", "_writev");
+	stream_copy_method(ctx, this_idx, opt_idx, "final", "_final");
+}
+
+/*
+ * Constructor of Writable
+ */
+DUK_LOCAL duk_ret_t writable_constructor(duk_context *ctx)
+{
+	/* [ options ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	/* [ options super this ] */
+	duk_call_method(ctx, 0);
+	duk_pop(ctx);
+	duk_push_this(ctx);
+	/* [ options this ] */
+	writable_init(ctx, 1, 0);
+	return 0;
+}
+
+/*
+ * Readable
+ */
+
+/*
+ * Get state of Readable (this)
+ */
+DUK_LOCAL dux_stream_readable_data *readable_get_data(duk_context *ctx, duk_idx_t *this_idx)
+{
+	dux_stream_readable_data *data;
 
-DUK_LOCAL duk_ret_t stream_constructor(duk_context *ctx)
+	/* [ ... ] */
+	duk_push_this(ctx);
+	*this_idx = duk_get_top_index(ctx);
+	/* [ ... this ] */
+	data = (dux_stream_readable_data *)stream_get_state(ctx, *this_idx, DUX_IPK_READABLE_STATE);
+	if (!data) {
+		(void)duk_type_error(ctx, "not a readable stream");
+	}
+	return data;
+}
+
+/*
+ * Convert chunk at stack top to string if encoding is set
+ * (UTF-8 is the only encoding accepted by setEncoding())
+ */
+DUK_LOCAL void readable_decode(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data)
 {
-	/* [  ] */
-	return 0;
+	/* [ ... chunk ] */
+	if (data->flags & DUX_STREAM_FLAG_OBJECT_MODE) {
+		return;
+	}
+	if (duk_has_prop_string(ctx, this_idx, DUX_IPK_READABLE_ENCODING)) {
+		(void)duk_buffer_to_string(ctx, -1);
+	}
 }
 
-DUK_LOCAL dux_stream_writable_data *writable_get_data(duk_context *ctx)
+/*
+ * Dequeue first chunk (whole)
+ */
+DUK_LOCAL void readable_shift(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data)
 {
-	dux_stream_writable_data *data;
 	/* [ ... ] */
-	duk_push_this(ctx);
-	duk_get_prop_string(ctx, -1, DUX_IPK_WRITABLE_STATE);
-	data = (dux_stream_writable_data *)duk_require_buffer(ctx, -1, NULL);
-	duk_pop_2(ctx);
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_QUEUE);
+	duk_get_prop_index(ctx, -1, data->head);
+	/* [ ... queue chunk ] */
+	data->length -= stream_chunk_length(ctx, -1, data->flags);
+	if (++data->head == data->tail) {
+		duk_set_length(ctx, -2, 0);
+		data->head = 0;
+		data->tail = 0;
+	} else {
+		duk_push_undefined(ctx);
+		duk_put_prop_index(ctx, -3, data->head - 1);
+	}
+	duk_remove(ctx, -2);
+	/* [ ... chunk ] */
+}
+
+/*
+ * Dequeue specified bytes (Chunks are joined only if needed)
+ */
+DUK_LOCAL void readable_take(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data, duk_uint_t size)
+{
+	duk_uint8_t *dest;
+	const duk_uint8_t *src;
+	duk_size_t len;
+	duk_uint_t copied;
+	duk_uint_t part;
+	void *rest;
+
 	/* [ ... ] */
-	return data;
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_QUEUE);
+	duk_get_prop_index(ctx, -1, data->head);
+	len = stream_chunk_length(ctx, -1, data->flags);
+	duk_pop_2(ctx);
+	if (len == size) {
+		/* Fast path (no copy) */
+		readable_shift(ctx, this_idx, data);
+		return;
+	}
+
+	dest = (duk_uint8_t *)stream_push_buffer(ctx, size);
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_QUEUE);
+	/* [ ... buf queue ] */
+	for (copied = 0; copied < size; copied += part) {
+		duk_get_prop_index(ctx, -1, data->head);
+		src = (const duk_uint8_t *)duk_get_buffer_data(ctx, -1, &len);
+		/* [ ... buf queue chunk ] */
+		part = (len < (size - copied)) ? (duk_uint_t)len : (size - copied);
+		memcpy(dest + copied, src, part);
+		if (part == len) {
+			duk_pop(ctx);
+			readable_shift(ctx, this_idx, data);
+		} else {
+			/* Keep rest of chunk in queue */
+			rest = stream_push_buffer(ctx, len - part);
+			memcpy(rest, src + part, len - part);
+			duk_put_prop_index(ctx, -3, data->head);
+			data->length -= part;
+		}
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... buf ] */
 }
 
-DUK_LOCAL duk_ret_t writable_proto_write_body(duk_context *ctx, duk_bool_t end)
+/*
+ * Common implementation of push() and unshift()
+ */
+DUK_LOCAL duk_bool_t readable_add_chunk(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data, duk_idx_t chunk_idx, duk_bool_t unshift)
 {
-	/* [ chunk encoding callback ] */
-	dux_stream_writable_data *data = writable_get_data(ctx);
-	if (duk_is_callable(ctx, 1)) {
+	/* [ ... chunk ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	chunk_idx = duk_normalize_index(ctx, chunk_idx);
+	if (!unshift) {
+		data->flags &= ~DUX_STREAM_FLAG_BUSY;
+		if (duk_is_null(ctx, chunk_idx)) {
+			/* EOF */
+			data->flags |= DUX_STREAM_FLAG_ENDED;
+			stream_schedule(ctx, this_idx, &data->flags);
+			return 0;
+		}
+		if (data->flags & DUX_STREAM_FLAG_ENDED) {
+			duk_push_error_object(ctx, DUK_ERR_ERROR, "stream.push() after EOF");
+			stream_emit(ctx, this_idx, "error", 1);
+			return 0;
+		}
+	}
+	if (data->flags & DUX_STREAM_FLAG_DESTROYED) {
+		return 0;
+	}
+	if (!(data->flags & DUX_STREAM_FLAG_OBJECT_MODE)) {
+		stream_check_chunk(ctx, chunk_idx, 1);
+	}
+	data->length += stream_chunk_length(ctx, chunk_idx, data->flags);
+
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_QUEUE);
+	/* [ ... chunk ... queue ] */
+	if (!unshift) {
+		duk_dup(ctx, chunk_idx);
+		duk_put_prop_index(ctx, -2, data->tail++);
+	} else if (data->head > 0) {
+		duk_dup(ctx, chunk_idx);
+		duk_put_prop_index(ctx, -2, --data->head);
+	} else {
+		duk_push_string(ctx, "unshift");
+		duk_dup(ctx, chunk_idx);
+		duk_call_prop(ctx, -3, 1);
+		duk_pop(ctx);
+		++data->tail;
+	}
+	duk_pop(ctx);
+	/* [ ... chunk ... ] */
+
+	if (data->flags & DUX_STREAM_FLAG_FLOWING) {
+		stream_schedule(ctx, this_idx, &data->flags);
+	}
+	return data->length < data->highWaterMark;
+}
+
+/*
+ * Write chunk at stack top to all pipe destinations
+ * (Flowing is stopped if any destination needs 'drain')
+ */
+DUK_LOCAL void readable_pipe_chunk(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data)
+{
+	dux_stream_writable_data *wdata;
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+
+	/* [ ... chunk ] */
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	/* [ ... chunk pipes ] */
+	length = (duk_uarridx_t)duk_get_length(ctx, -1);
+	for (index = 0; index < length; index += PIPE_ENTRY_SIZE) {
+		duk_get_prop_index(ctx, -1, index);
+		wdata = (dux_stream_writable_data *)stream_get_state(ctx, -1, DUX_IPK_WRITABLE_STATE);
+		/* [ ... chunk pipes dest ] */
+		if (wdata->flags & (DUX_STREAM_FLAG_ENDED | DUX_STREAM_FLAG_DESTROYED)) {
+			duk_pop(ctx);
+			continue;
+		}
+		if (!(wdata->flags & DUX_STREAM_FLAG_OBJECT_MODE) &&
+				!duk_is_string(ctx, -3) && !duk_is_buffer_data(ctx, -3)) {
+			duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "invalid chunk");
+			stream_emit(ctx, -2, "error", 1);
+			duk_pop(ctx);
+			continue;
+		}
+		duk_dup(ctx, -3);
+		duk_push_undefined(ctx);
 		duk_push_undefined(ctx);
-		duk_insert(ctx, 1);
-		duk_set_top(ctx, 3);
+		/* [ ... chunk pipes dest chunk undefined undefined ] */
+		if (!writable_write_chunk(ctx, -4, wdata, -3)) {
+			duk_dup(ctx, this_idx);
+			stream_array_append(ctx, -5, DUX_IPK_WRITABLE_WAITING);
+			++data->awaitDrain;
+		}
+		duk_pop_n(ctx, 4);
+		/* [ ... chunk pipes ] */
+	}
+	duk_pop(ctx);
+	/* [ ... chunk ] */
+	if (data->awaitDrain > 0) {
+		data->flags &= ~DUX_STREAM_FLAG_FLOWING;
 	}
-	// FIXME: encoding
-	
 }
 
-DUK_LOCAL duk_ret_t writable_proto_cork(duk_context *ctx)
+/*
+ * End pipe destinations (except for { end: false })
+ */
+DUK_LOCAL void readable_pipe_end(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data)
 {
-	dux_stream_writable_data *data = writable_get_data(ctx);
-	if (++data->corked == 0) {
-		return DUK_RET_ERROR;
+	dux_stream_writable_data *wdata;
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+
+	/* [ ... ] */
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	/* [ ... pipes ] */
+	length = (duk_uarridx_t)duk_get_length(ctx, -1);
+	for (index = 0; index < length; index += PIPE_ENTRY_SIZE) {
+		duk_get_prop_index(ctx, -1, index + 1);
+		if (duk_get_boolean(ctx, -1)) {
+			duk_get_prop_index(ctx, -2, index);
+			/* [ ... pipes end dest ] */
+			wdata = (dux_stream_writable_data *)stream_get_state(ctx, -1, DUX_IPK_WRITABLE_STATE);
+			writable_end(ctx, -1, wdata);
+			duk_pop(ctx);
+		}
+		duk_pop(ctx);
 	}
-	return 0;
+	duk_pop(ctx);
+	/* [ ... ] */
+	readable_unpipe(ctx, this_idx, data, DUK_INVALID_INDEX);
 }
 
-DUK_LOCAL duk_ret_t writable_proto_end(duk_context *ctx)
+/*
+ * Detach pipe destination (or all destinations if dest_idx is DUK_INVALID_INDEX)
+ */
+DUK_LOCAL void readable_unpipe(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data, duk_idx_t dest_idx)
 {
-	/* [ chunk encoding callback ] */
-	return writable_proto_write_body(ctx, 1);
+	duk_uarridx_t length;
+	duk_uarridx_t index;
+	duk_uarridx_t kept = 0;
+
+	if (!(data->flags & DUX_STREAM_FLAG_PIPED)) {
+		return;
+	}
+	/* [ ... ] */
+	this_idx = duk_normalize_index(ctx, this_idx);
+	if (dest_idx != DUK_INVALID_INDEX) {
+		dest_idx = duk_normalize_index(ctx, dest_idx);
+	}
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	duk_push_array(ctx);
+	/* [ ... pipes new_pipes ] */
+	length = (duk_uarridx_t)duk_get_length(ctx, -2);
+	for (index = 0; index < length; index += PIPE_ENTRY_SIZE) {
+		duk_get_prop_index(ctx, -2, index);
+		/* [ ... pipes new_pipes dest ] */
+		if ((dest_idx != DUK_INVALID_INDEX) && !duk_strict_equals(ctx, -1, dest_idx)) {
+			duk_put_prop_index(ctx, -2, kept++);
+			duk_get_prop_index(ctx, -2, index + 1);
+			duk_put_prop_index(ctx, -2, kept++);
+			continue;
+		}
+		duk_dup(ctx, this_idx);
+		/* [ ... pipes new_pipes dest this ] */
+		(void)stream_array_remove(ctx, -2, DUX_IPK_WRITABLE_SOURCES, -1);
+		if (stream_array_remove(ctx, -2, DUX_IPK_WRITABLE_WAITING, -1) && (data->awaitDrain > 0)) {
+			--data->awaitDrain;
+		}
+		stream_emit(ctx, -2, "unpipe", 1);
+		duk_pop(ctx);
+		/* [ ... pipes new_pipes ] */
+	}
+	if (kept > 0) {
+		duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	} else {
+		duk_pop(ctx);
+		duk_del_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+		data->flags &= ~DUX_STREAM_FLAG_PIPED;
+		data->awaitDrain = 0;
+		if (!(data->flags & DUX_STREAM_FLAG_DATA_LISTENED)) {
+			data->flags &= ~DUX_STREAM_FLAG_FLOWING;
+		}
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+	if ((data->awaitDrain == 0) && (data->flags & DUX_STREAM_FLAG_PIPED) &&
+			!(data->flags & DUX_STREAM_FLAG_PAUSED)) {
+		data->flags |= DUX_STREAM_FLAG_FLOWING;
+		stream_schedule(ctx, this_idx, &data->flags);
+	}
 }
 
-DUK_LOCAL duk_ret_t writable_proto_setDefaultEncoding(duk_context *ctx)
+/*
+ * Emit 'data'/'end' and call _read() to fill buffer
+ */
+DUK_LOCAL void readable_process(duk_context *ctx, duk_idx_t this_idx, dux_stream_readable_data *data)
 {
+	duk_uint_t delivered = 0;
+
+	this_idx = duk_normalize_index(ctx, this_idx);
+	for (;;) {
+		/* [ ... ] */
+		while ((data->flags & DUX_STREAM_FLAG_FLOWING) && (data->head != data->tail)) {
+			readable_shift(ctx, this_idx, data);
+			delivered += stream_chunk_length(ctx, -1, data->flags);
+			/* Destinations receive the same chunk as 'data' listeners */
+			readable_decode(ctx, this_idx, data);
+			if (data->flags & DUX_STREAM_FLAG_PIPED) {
+				readable_pipe_chunk(ctx, this_idx, data);
+				if (!(data->flags & DUX_STREAM_FLAG_DATA_LISTENED)) {
+					/* No need to emit 'data' */
+					duk_pop(ctx);
+					continue;
+				}
+			}
+			stream_emit(ctx, this_idx, "data", 1);
+		}
+		if (data->flags & DUX_STREAM_FLAG_DESTROYED) {
+			return;
+		}
+		if (data->flags & DUX_STREAM_FLAG_ENDED) {
+			if ((data->head == data->tail) && !(data->flags & DUX_STREAM_FLAG_FINISHED)) {
+				data->flags |= DUX_STREAM_FLAG_FINISHED;
+				stream_emit(ctx, this_idx, "end", 0);
+				if (data->flags & DUX_STREAM_FLAG_PIPED) {
+					readable_pipe_end(ctx, this_idx, data);
+				}
+			}
+			return;
+		}
+		if ((data->flags & DUX_STREAM_FLAG_BUSY) ||
+				(data->length >= data->highWaterMark) ||
+				(delivered >= data->highWaterMark)) {
+			return;
+		}
+
+		/* Request more data */
+		data->flags |= DUX_STREAM_FLAG_BUSY;
+		if (data->read) {
+			stream_push_native(ctx, this_idx, DUX_IPK_READABLE_NATIVE, data->read, 1);
+		} else {
+			duk_get_prop_string(ctx, this_idx, "_read");
+		}
+		duk_dup(ctx, this_idx);
+		duk_push_uint(ctx, data->highWaterMark);
+		/* [ ... func this uint ] */
+		if (duk_pcall_method(ctx, 1) != 0) {
+			/* [ ... err ] */
+			data->flags &= ~DUX_STREAM_FLAG_BUSY;
+			stream_emit(ctx, this_idx, "error", 1);
+			return;
+		}
+		duk_pop(ctx);
+		if ((data->flags & DUX_STREAM_FLAG_BUSY) ||
+				((data->head == data->tail) && !(data->flags & DUX_STREAM_FLAG_ENDED))) {
+			/* Data will be pushed asynchronously (or nothing was pushed) */
+			return;
+		}
+	}
 }
 
-DUK_LOCAL duk_ret_t writable_proto_uncork(duk_context *ctx)
+/*
+ * Entry of Readable.prototype.isPaused()
+ */
+DUK_LOCAL duk_ret_t readable_proto_isPaused(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data = readable_get_data(ctx, &this_idx);
+
+	duk_push_boolean(ctx, data->flags & DUX_STREAM_FLAG_PAUSED);
+	return 1;
+}
+
+/*
+ * Entry of Readable.prototype.on()
+ */
+DUK_LOCAL duk_ret_t readable_proto_on(duk_context *ctx)
 {
-	dux_stream_writable_data *data = writable_get_data(ctx);
-	if (data->corked > 0) {
-		--data->corked;
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
+
+	/* [ event listener ] */
+	data = readable_get_data(ctx, &this_idx);
+	/* [ event listener this ] */
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_ON);
+	duk_dup(ctx, this_idx);
+	duk_dup(ctx, 0);
+	duk_dup(ctx, 1);
+	/* [ event listener this func this event listener ] */
+	duk_call_method(ctx, 2);
+	duk_pop(ctx);
+	if (duk_is_string(ctx, 0) && (strcmp(duk_get_string(ctx, 0), "data") == 0)) {
+		data->flags |= DUX_STREAM_FLAG_DATA_LISTENED;
+		if (!(data->flags & DUX_STREAM_FLAG_PAUSED)) {
+			/* Switch to flowing mode */
+			data->flags |= DUX_STREAM_FLAG_FLOWING;
+			stream_schedule(ctx, this_idx, &data->flags);
+		}
 	}
-	return 0;
+	return 1;   /* return this */
 }
 
-DUK_LOCAL duk_ret_t writable_proto_write(duk_context *ctx)
+/*
+ * Entry of Readable.prototype.pause()
+ */
+DUK_LOCAL duk_ret_t readable_proto_pause(duk_context *ctx)
 {
-	/* [ chunk encoding callback ] */
-	return writable_proto_write_body(ctx, 0);
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data = readable_get_data(ctx, &this_idx);
+
+	data->flags = (data->flags & ~DUX_STREAM_FLAG_FLOWING) | DUX_STREAM_FLAG_PAUSED;
+	return 1;   /* return this */
 }
 
-/**
- * List of methods for Writable object
+/*
+ * Entry of Readable.prototype.pipe()
  */
-DUK_LOCAL duk_function_list_entry writable_proto_funcs[] = {
-    { "cork", writable_proto_cork, 0 },
-    { "end", writable_proto_end, 3 },
-    { "setDefaultEncoding", writable_proto_setDefaultEncoding, 1 },
-    { "uncork", writable_proto_uncork, 0 },
-    { "write", writable_proto_write, 3 },
-    { NULL, NULL, 0 }
-};
+DUK_LOCAL duk_ret_t readable_proto_pipe(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
 
-/**
- * Constructor of Writable
+	/* [ dest options ] */
+	data = readable_get_data(ctx, &this_idx);
+	/* [ dest options this ] */
+	if (!duk_is_object(ctx, 0) || !stream_get_state(ctx, 0, DUX_IPK_WRITABLE_STATE)) {
+		return duk_type_error(ctx, "not a writable stream");
+	}
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	if (!duk_is_array(ctx, -1)) {
+		duk_pop(ctx);
+		duk_push_array(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_PIPES);
+	}
+	/* [ dest options this pipes ] */
+	duk_dup(ctx, 0);
+	duk_put_prop_index(ctx, -2, duk_get_length(ctx, -2));
+	(void)stream_get_option(ctx, 1, "end");
+	duk_push_boolean(ctx, duk_is_undefined(ctx, -1) || duk_to_boolean(ctx, -1));
+	duk_remove(ctx, -2);
+	duk_put_prop_index(ctx, -2, duk_get_length(ctx, -2));
+	duk_pop(ctx);
+	/* [ dest options this ] */
+	duk_dup(ctx, this_idx);
+	stream_array_append(ctx, 0, DUX_IPK_WRITABLE_SOURCES);
+	duk_dup(ctx, this_idx);
+	stream_emit(ctx, 0, "pipe", 1);
+
+	data->flags |= DUX_STREAM_FLAG_PIPED;
+	if (!(data->flags & DUX_STREAM_FLAG_FLOWING) && (data->awaitDrain == 0)) {
+		data->flags = (data->flags & ~DUX_STREAM_FLAG_PAUSED) | DUX_STREAM_FLAG_FLOWING;
+		stream_schedule(ctx, this_idx, &data->flags);
+	}
+	duk_dup(ctx, 0);
+	return 1;   /* return dest */
+}
+
+/*
+ * Entry of Readable.prototype.push()
  */
-DUK_LOCAL duk_ret_t writable_constructor(duk_context *ctx)
+DUK_LOCAL duk_ret_t readable_proto_push(duk_context *ctx)
 {
-	/* [ obj/undefined ] */
-	if (!duk_is_null_or_undefined(ctx, 0)) {
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
+
+	/* [ chunk encoding ] */
+	data = readable_get_data(ctx, &this_idx);
+	if (duk_is_string(ctx, 0) && !duk_is_null_or_undefined(ctx, 1)) {
+		stream_check_encoding(ctx, 1);
+	}
+	duk_push_boolean(ctx, readable_add_chunk(ctx, this_idx, data, 0, 0));
+	return 1;
+}
+
+/*
+ * Entry of Readable.prototype.read()
+ */
+DUK_LOCAL duk_ret_t readable_proto_read(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
+	duk_uint_t size;
+
+	/* [ size ] */
+	data = readable_get_data(ctx, &this_idx);
+	/* [ size this ] */
+	stream_schedule(ctx, this_idx, &data->flags);
+	if (data->head == data->tail) {
+		duk_push_null(ctx);
+		return 1;
+	}
+	if (data->flags & DUX_STREAM_FLAG_OBJECT_MODE) {
+		readable_shift(ctx, this_idx, data);
+		return 1;
+	}
+	size = duk_is_undefined(ctx, 0) ? data->length : duk_require_uint(ctx, 0);
+	if (size > data->length) {
+		if (!(data->flags & DUX_STREAM_FLAG_ENDED)) {
+			duk_push_null(ctx);
+			return 1;
+		}
+		size = data->length;
+	}
+	if (size == 0) {
+		duk_push_null(ctx);
+		return 1;
+	}
+	readable_take(ctx, this_idx, data, size);
+	readable_decode(ctx, this_idx, data);
+	return 1;
+}
+
+/*
+ * Default implementation of Readable.prototype._read()
+ */
+DUK_LOCAL duk_ret_t readable_proto_read_impl(duk_context *ctx)
+{
+	return duk_error(ctx, DUK_ERR_ERROR, "_read() is not implemented");
+}
+
+/*
+ * Entry of Readable.prototype.resume()
+ */
+DUK_LOCAL duk_ret_t readable_proto_resume(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data = readable_get_data(ctx, &this_idx);
+
+	data->flags = (data->flags & ~DUX_STREAM_FLAG_PAUSED) | DUX_STREAM_FLAG_FLOWING;
+	stream_schedule(ctx, this_idx, &data->flags);
+	return 1;   /* return this */
+}
+
+/*
+ * Entry of Readable.prototype.setEncoding()
+ */
+DUK_LOCAL duk_ret_t readable_proto_setEncoding(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	/* [ encoding ] */
+	(void)readable_get_data(ctx, &this_idx);
+	/* [ encoding this ] */
+	if (duk_is_null_or_undefined(ctx, 0)) {
+		duk_push_string(ctx, "utf8");
+	} else {
+		stream_check_encoding(ctx, 0);
+		duk_dup(ctx, 0);
 	}
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_ENCODING);
+	return 1;   /* return this */
+}
+
+/*
+ * Entry of Readable.prototype.unshift()
+ */
+DUK_LOCAL duk_ret_t readable_proto_unshift(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
+
+	/* [ chunk ] */
+	data = readable_get_data(ctx, &this_idx);
+	(void)readable_add_chunk(ctx, this_idx, data, 0, 1);
 	return 0;
 }
 
+/*
+ * Entry of Readable.prototype.unpipe()
+ */
+DUK_LOCAL duk_ret_t readable_proto_unpipe(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+	dux_stream_readable_data *data;
+
+	/* [ dest ] */
+	data = readable_get_data(ctx, &this_idx);
+	/* [ dest this ] */
+	readable_unpipe(ctx, this_idx, data, duk_is_undefined(ctx, 0) ? DUK_INVALID_INDEX : 0);
+	return 1;   /* return this */
+}
+
+/*
+ * Getter of Readable.prototype.readableLength
+ */
+DUK_LOCAL duk_ret_t readable_proto_readableLength_getter(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	duk_push_uint(ctx, readable_get_data(ctx, &this_idx)->length);
+	return 1;
+}
+
+/*
+ * Getter of Readable.prototype.readableHighWaterMark
+ */
+DUK_LOCAL duk_ret_t readable_proto_readableHighWaterMark_getter(duk_context *ctx)
+{
+	duk_idx_t this_idx;
+
+	duk_push_uint(ctx, readable_get_data(ctx, &this_idx)->highWaterMark);
+	return 1;
+}
+
 /**
  * List of methods for Readable object
  */
 DUK_LOCAL duk_function_list_entry readable_proto_funcs[] = {
-    { "isPaused", readable_proto_isPaused, 0 },
-    { "pause", readable_proto_pause, 0 },
-    { "pipe", readable_proto_pipe, 2 },
-    { "read", readable_proto_read, 1 },
-    { "resume", readable_proto_resume, 0 },
-    { "setEncoding", readable_proto_setEncoding, 1 },
-    { "unpipe", readable_proto_unpipe, 1 },
-    { "unshift", readable_proto_unshift, 1 },
-    { NULL, NULL, 0 }
+	{ "_read", readable_proto_read_impl, 1 },
+	{ "addListener", readable_proto_on, 2 },
+	{ "isPaused", readable_proto_isPaused, 0 },
+	{ "on", readable_proto_on, 2 },
+	{ "pause", readable_proto_pause, 0 },
+	{ "pipe", readable_proto_pipe, 2 },
+	{ "push", readable_proto_push, 2 },
+	{ "read", readable_proto_read, 1 },
+	{ "resume", readable_proto_resume, 0 },
+	{ "setEncoding", readable_proto_setEncoding, 1 },
+	{ "unpipe", readable_proto_unpipe, 1 },
+	{ "unshift", readable_proto_unshift, 1 },
+	{ NULL, NULL, 0 }
 };
 
 /**
+ * List of properties for Readable object
+ */
+DUK_LOCAL dux_property_list_entry readable_proto_props[] = {
+	{ "readableLength", readable_proto_readableLength_getter, NULL },
+	{ "readableHighWaterMark", readable_proto_readableHighWaterMark_getter, NULL },
+	{ NULL, NULL, NULL }
+};
+
+/*
+ * Initialize readable side of stream
+ */
+DUK_LOCAL void readable_init(duk_context *ctx, duk_idx_t this_idx, duk_idx_t opt_idx)
+{
+	dux_stream_readable_data *data;
+
+	/* [ ... ] */
+	data = (dux_stream_readable_data *)duk_push_fixed_buffer(ctx, sizeof(*data));
+	memset(data, 0, sizeof(*data));
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_STATE);
+
+	if (stream_get_object_mode(ctx, opt_idx, "readableObjectMode")) {
+		data->flags |= DUX_STREAM_FLAG_OBJECT_MODE;
+	}
+	data->highWaterMark = stream_get_hwm(ctx, opt_idx, "readableHighWaterMark", data->flags);
+	if (stream_get_option(ctx, opt_idx, "encoding") && !duk_is_null(ctx, -1)) {
+		stream_check_encoding(ctx, -1);
+		duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_ENCODING);
+	} else {
+		duk_pop(ctx);
+	}
+
+	duk_push_array(ctx);
+	duk_put_prop_string(ctx, this_idx, DUX_IPK_READABLE_QUEUE);
+
+	stream_copy_method(ctx, this_idx, opt_idx, "read", "_read");
+}
+
+/*
  * Constructor of Readable
  */
 DUK_LOCAL duk_ret_t readable_constructor(duk_context *ctx)
 {
-	/* [ obj/undefined ] */
-	if (!duk_is_null_or_undefined(ctx, 0)) {
+	/* [ options ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	/* [ options super this ] */
+	duk_call_method(ctx, 0);
+	duk_pop(ctx);
+	duk_push_this(ctx);
+	/* [ options this ] */
+	readable_init(ctx, 1, 0);
+	return 0;
+}
+
+/*
+ * Duplex
+ */
+
+/*
+ * Constructor of Duplex
+ */
+DUK_LOCAL duk_ret_t duplex_constructor(duk_context *ctx)
+{
+	/* [ options ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	duk_dup(ctx, 0);
+	/* [ options super this options ] */
+	duk_call_method(ctx, 1);
+	duk_pop(ctx);
+	duk_push_this(ctx);
+	/* [ options this ] */
+	writable_init(ctx, 1, 0);
+	return 0;
+}
+
+/*
+ * Transform
+ */
+
+/*
+ * Push data (if given) to readable side and call callback of _write/_final
+ */
+DUK_LOCAL void transform_complete(duk_context *ctx, duk_idx_t this_idx, duk_idx_t err_idx, duk_idx_t data_idx, duk_bool_t flush)
+{
+	/* [ ... ] */
+	if (!duk_is_null_or_undefined(ctx, data_idx)) {
+		duk_push_c_function(ctx, readable_proto_push, 2);
+		duk_dup(ctx, this_idx);
+		duk_dup(ctx, data_idx);
+		duk_call_method(ctx, 1);
+		duk_pop(ctx);
+	}
+	if (flush) {
+		duk_push_c_function(ctx, readable_proto_push, 2);
+		duk_dup(ctx, this_idx);
+		duk_push_null(ctx);
+		duk_call_method(ctx, 1);
+		duk_pop(ctx);
+	}
+	duk_get_prop_string(ctx, this_idx, DUX_IPK_TRANSFORM_CALLBACK);
+	duk_del_prop_string(ctx, this_idx, DUX_IPK_TRANSFORM_CALLBACK);
+	/* [ ... callback ] */
+	if (duk_is_callable(ctx, -1)) {
+		duk_dup(ctx, err_idx);
+		duk_call(ctx, 1);
+	}
+	duk_pop(ctx);
+	/* [ ... ] */
+}
+
+/*
+ * Callback passed to _transform
+ */
+DUK_LOCAL duk_ret_t transform_after_transform(duk_context *ctx)
+{
+	/* [ err data ] */
+	stream_push_owner(ctx);
+	/* [ err data this ] */
+	transform_complete(ctx, 2, 0, 1, 0);
+	return 0;
+}
+
+/*
+ * Callback passed to _flush
+ */
+DUK_LOCAL duk_ret_t transform_after_flush(duk_context *ctx)
+{
+	/* [ err data ] */
+	stream_push_owner(ctx);
+	/* [ err data this ] */
+	transform_complete(ctx, 2, 0, 1, 1);
+	return 0;
+}
+
+/*
+ * Entry of Transform.prototype._write()
+ */
+DUK_LOCAL duk_ret_t transform_proto_write(duk_context *ctx)
+{
+	/* [ chunk encoding callback ] */
+	duk_push_this(ctx);
+	duk_dup(ctx, 2);
+	duk_put_prop_string(ctx, 3, DUX_IPK_TRANSFORM_CALLBACK);
+	/* [ chunk encoding callback this ] */
+	duk_get_prop_string(ctx, 3, "_transform");
+	duk_dup(ctx, 3);
+	duk_dup(ctx, 0);
+	duk_dup(ctx, 1);
+	duk_get_prop_string(ctx, 3, DUX_IPK_TRANSFORM_AFTER);
+	/* [ chunk encoding callback this func this chunk encoding after ] */
+	duk_call_method(ctx, 3);
+	return 0;
+}
+
+/*
+ * Entry of Transform.prototype._final()
+ */
+DUK_LOCAL duk_ret_t transform_proto_final(duk_context *ctx)
+{
+	/* [ callback ] */
+	duk_push_this(ctx);
+	duk_dup(ctx, 0);
+	duk_put_prop_string(ctx, 1, DUX_IPK_TRANSFORM_CALLBACK);
+	/* [ callback this ] */
+	duk_get_prop_string(ctx, 1, "_flush");
+	if (!duk_is_callable(ctx, 2)) {
+		/* [ callback this undefined ] */
+		transform_complete(ctx, 1, 2, 2, 1);
+		return 0;
 	}
+	duk_dup(ctx, 1);
+	stream_push_bound_function(ctx, 1, transform_after_flush, 2);
+	/* [ callback this func this after ] */
+	duk_call_method(ctx, 1);
+	return 0;
+}
+
+/*
+ * Default implementation of Transform.prototype._transform()
+ */
+DUK_LOCAL duk_ret_t transform_proto_transform_impl(duk_context *ctx)
+{
+	return duk_error(ctx, DUK_ERR_ERROR, "_transform() is not implemented");
+}
+
+/*
+ * Entry of Transform.prototype._read()
+ */
+DUK_LOCAL duk_ret_t transform_proto_read(duk_context *ctx)
+{
+	/* Data is pushed by _transform */
+	return 0;
+}
+
+/**
+ * List of methods for Transform object
+ */
+DUK_LOCAL duk_function_list_entry transform_proto_funcs[] = {
+	{ "_final", transform_proto_final, 1 },
+	{ "_read", transform_proto_read, 1 },
+	{ "_transform", transform_proto_transform_impl, 3 },
+	{ "_write", transform_proto_write, 3 },
+	{ NULL, NULL, 0 }
+};
+
+/*
+ * Constructor of Transform
+ */
+DUK_LOCAL duk_ret_t transform_constructor(duk_context *ctx)
+{
+	/* [ options ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	duk_dup(ctx, 0);
+	/* [ options super this options ] */
+	duk_call_method(ctx, 1);
+	duk_pop(ctx);
+	duk_push_this(ctx);
+	/* [ options this ] */
+	stream_push_bound_function(ctx, 1, transform_after_transform, 2);
+	duk_put_prop_string(ctx, 1, DUX_IPK_TRANSFORM_AFTER);
+	stream_copy_method(ctx, 1, 0, "transform", "_transform");
+	stream_copy_method(ctx, 1, 0, "flush", "_flush");
 	return 0;
 }
 
@@ -124,33 +1975,43 @@ DUK_LOCAL duk_ret_t readable_constructor(duk_context *ctx)
 DUK_LOCAL duk_errcode_t stream_entry(duk_context *ctx)
 {
 	/* [ require module exports ] */
-	duk_swap(ctx, 0, 2);
-	/* [ exports module require ] */
+	duk_dup(ctx, 0);
 	duk_push_string(ctx, "events");
 	duk_call(ctx, 1);
-	/* [ exports module EventEmitter ] */
+	/* [ require module exports EventEmitter ] */
 	dux_push_inherited_named_c_constructor(
-		ctx, 2, "Stream", stream_constructor, 0,
-		NULL, NULL, NULL, NULL
-	);
-	/* [ exports module EventEmitter constructor ] */
-	duk_dup(ctx, 3);
-	duk_put_prop_string(ctx, 3, "Stream");
-	/* [ exports module EventEmitter constructor ] */
+			ctx, 3, "Stream", stream_constructor, 0,
+			NULL, stream_proto_funcs, NULL, NULL);
+	/* [ require module exports EventEmitter Stream ] */
+	duk_dup(ctx, 4);
+	duk_put_prop_string(ctx, 4, "Stream");
+	dux_push_inherited_named_c_constructor(
+			ctx, 4, "Writable", writable_constructor, 1,
+			NULL, writable_proto_funcs, NULL, writable_proto_props);
+	duk_put_prop_string(ctx, 4, "Writable");
+	dux_push_inherited_named_c_constructor(
+			ctx, 4, "Readable", readable_constructor, 1,
+			NULL, readable_proto_funcs, NULL, readable_proto_props);
+	/* [ require module exports EventEmitter Stream Readable ] */
+	duk_get_prop_string(ctx, 5, DUX_KEY_PROTOTYPE);
+	duk_get_prop_string(ctx, 3, DUX_KEY_PROTOTYPE);
+	duk_get_prop_string(ctx, -1, "on");
+	/* [ require module exports EventEmitter Stream Readable proto super_proto on ] */
+	duk_put_prop_string(ctx, -3, DUX_IPK_READABLE_ON);
+	duk_pop_2(ctx);
 	dux_push_inherited_named_c_constructor(
-		ctx, 3, "Writable", writable_constructor, 1,
-		NULL, writable_proto_funcs, NULL, NULL
-	);
-	duk_put_prop_string(ctx, 3, "Writable");
-	/* [ exports module EventEmitter constructor ] */
+			ctx, 5, "Duplex", duplex_constructor, 1,
+			NULL, writable_proto_funcs, NULL, writable_proto_props);
+	/* [ require module exports EventEmitter Stream Readable Duplex ] */
 	dux_push_inherited_named_c_constructor(
-		ctx, 3, "Readable", readable_constructor, 1,
-		NULL, readable_proto_funcs, NULL, NULL
-	);
-	duk_put_prop_string(ctx, 3, "Readable");
-	/* [ exports module EventEmitter constructor ] */
+			ctx, 6, "Transform", transform_constructor, 1,
+			NULL, transform_proto_funcs, NULL, NULL);
+	duk_put_prop_string(ctx, 4, "Transform");
+	duk_put_prop_string(ctx, 4, "Duplex");
+	duk_put_prop_string(ctx, 4, "Readable");
+	/* [ require module exports EventEmitter Stream ] */
 	duk_put_prop_string(ctx, 1, "exports");
-	/* [ exports module EventEmitter ] */
+	/* [ require module exports EventEmitter ] */
 	return DUK_ERR_NONE;
 }
 
@@ -162,4 +2023,87 @@ DUK_INTERNAL duk_errcode_t dux_stream_init(duk_context *ctx)
 	return dux_modules_register(ctx, "stream", stream_entry);
 }
 
-#endif  /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_STREAM */
+/**
+ * Process streams waiting for tick
+ */
+DUK_INTERNAL duk_int_t dux_stream_tick(duk_context *ctx)
+{
+	dux_stream_writable_data *wdata;
+	dux_stream_readable_data *rdata;
+	duk_uint_t jobs = 0;
+	duk_size_t length;
+	duk_size_t index;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	/* [ ... stash ] */
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_STREAM_PENDING)) {
+		/* [ ... stash undefined ] */
+		duk_pop_2(ctx);
+		return DUX_TICK_RET_JOBLESS;
+	}
+	/* [ ... stash pending ] */
+	duk_del_prop_string(ctx, -2, DUX_IPK_STREAM_PENDING);
+	length = duk_get_length(ctx, -1);
+	for (index = 0; index < length; ++index) {
+		duk_get_prop_index(ctx, -1, index);
+		/* [ ... stash pending stream ] */
+		wdata = (dux_stream_writable_data *)stream_get_state(ctx, -1, DUX_IPK_WRITABLE_STATE);
+		if (wdata && (wdata->flags & DUX_STREAM_FLAG_SCHEDULED)) {
+			wdata->flags &= ~DUX_STREAM_FLAG_SCHEDULED;
+			if (!(wdata->flags & (DUX_STREAM_FLAG_BUSY | DUX_STREAM_FLAG_DESTROYED))) {
+				writable_after_write(ctx, -1, wdata);
+				++jobs;
+			}
+		}
+		rdata = (dux_stream_readable_data *)stream_get_state(ctx, -1, DUX_IPK_READABLE_STATE);
+		if (rdata && (rdata->flags & DUX_STREAM_FLAG_SCHEDULED)) {
+			rdata->flags &= ~DUX_STREAM_FLAG_SCHEDULED;
+			if (!(rdata->flags & DUX_STREAM_FLAG_DESTROYED)) {
+				readable_process(ctx, -1, rdata);
+				++jobs;
+			}
+		}
+		duk_pop(ctx);
+		/* [ ... stash pending ] */
+	}
+	duk_pop_2(ctx);
+	/* [ ... ] */
+	dux_loop_stats_add_jobs(ctx, jobs);
+	return (jobs > 0) ? DUX_TICK_RET_CONTINUE : DUX_TICK_RET_JOBLESS;
+}
+
+/**
+ * Get writable state of stream (for native _write/_writev)
+ */
+DUK_INTERNAL dux_stream_writable_data *dux_stream_get_writable(duk_context *ctx, duk_idx_t obj_idx)
+{
+	return (dux_stream_writable_data *)stream_get_state(ctx, obj_idx, DUX_IPK_WRITABLE_STATE);
+}
+
+/**
+ * Get readable state of stream (for native _read)
+ */
+DUK_INTERNAL dux_stream_readable_data *dux_stream_get_readable(duk_context *ctx, duk_idx_t obj_idx)
+{
+	return (dux_stream_readable_data *)stream_get_state(ctx, obj_idx, DUX_IPK_READABLE_STATE);
+}
+
+/**
+ * Push chunk at stack top (or null for EOF) to readable stream
+ * (Same as readable.push(). The chunk is popped)
+ */
+DUK_INTERNAL duk_bool_t dux_stream_push(duk_context *ctx, duk_idx_t obj_idx)
+{
+	dux_stream_readable_data *data;
+	duk_bool_t result;
+
+	/* [ ... stream ... chunk ] */
+	data = (dux_stream_readable_data *)stream_get_state(ctx, obj_idx, DUX_IPK_READABLE_STATE);
+	result = readable_add_chunk(ctx, obj_idx, data, -1, 0);
+	duk_pop(ctx);
+	/* [ ... stream ... ] */
+	return result;
+}
+
+#endif  /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS && !DUX_OPT_NO_STREAM */
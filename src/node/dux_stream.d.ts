@@ -4,83 +4,123 @@ declare namespace Dux {
          * Circular reference to Stream
          */
         static "Stream": typeof Stream;
+
+        /**
+         * Destroys the stream (Buffered data is discarded).
+         * 'error' (if err is given) and 'close' events are emitted.
+         * @param err An error to emit
+         */
+        destroy(err?: Error): void;
     }
 
     interface WritableStreamOptions {
         highWaterMark?: number;
-        decodeStrings?: string;
+        writableHighWaterMark?: number;
+        decodeStrings?: boolean;
         objectMode?: boolean;
+        writableObjectMode?: boolean;
         write?: Function;
+        /** Called with gathered chunks ({ chunk, encoding }[]) when two or more chunks are buffered */
         writev?: Function;
-        destroy?: Function;
         final?: Function;
     }
 
+    /** Chunks are passed as Buffer (Only "utf8" is supported as encoding of strings) */
     type StreamChunk = string | Buffer | Uint8Array | any;
 
     interface WritableStream {
         cork(): void;
-        end(chunk?: StreamChunk, encoding?: string, callback?: Function): void;
+        end(chunk?: StreamChunk, encoding?: string, callback?: Function): Stream.Writable;
         setDefaultEncoding(encoding: string): Stream.Writable;
         uncork(): void;
         write(chunk: StreamChunk, encoding?: string, callback?: Function): boolean;
+        readonly writableLength: number;
+        readonly writableHighWaterMark: number;
     }
 
     interface ReadableStreamOptions {
+        highWaterMark?: number;
+        readableHighWaterMark?: number;
+        encoding?: string;
+        objectMode?: boolean;
+        readableObjectMode?: boolean;
+        read?: Function;
+    }
+
+    interface TransformStreamOptions extends WritableStreamOptions, ReadableStreamOptions {
+        transform?: Function;
+        flush?: Function;
     }
 
     interface PipeOptions {
+        /** End destination when source ends (default: true) */
         end?: boolean;
     }
 
     interface ReadableStream {
         isPaused(): boolean;
         pause(): Stream.Readable;
-        pipe(destination: Stream.Writable, options?: PipeOptions): void;
-        read(size?: number): string | Buffer;
+        pipe<T extends Stream.Writable>(destination: T, options?: PipeOptions): T;
+        push(chunk: StreamChunk | null, encoding?: string): boolean;
+        read(size?: number): string | Buffer | any;
         resume(): Stream.Readable;
         setEncoding(encoding: string): Stream.Readable;
-        unpipe(destination?: Stream.Writable): void;
+        unpipe(destination?: Stream.Writable): Stream.Readable;
         unshift(chunk: StreamChunk): void;
+        readonly readableLength: number;
+        readonly readableHighWaterMark: number;
     }
 
     module Stream {
         class Writable extends Stream implements WritableStream {
+            constructor(options?: WritableStreamOptions);
             cork(): void;
-            end(chunk?: StreamChunk, encoding?: string, callback?: Function): void;
+            end(chunk?: StreamChunk, encoding?: string, callback?: Function): Writable;
             setDefaultEncoding(encoding: string): Writable;
             uncork(): void;
             write(chunk: StreamChunk, encoding?: string, callback?: Function): boolean;
+            readonly writableLength: number;
+            readonly writableHighWaterMark: number;
         }
 
         class Readable extends Stream implements ReadableStream {
+            constructor(options?: ReadableStreamOptions);
             isPaused(): boolean;
             pause(): Readable;
-            pipe(destination: Writable, options?: PipeOptions): void;
-            read(size?: number): string | Buffer;
+            /**
+             * Writes all data to destination with backpressure.
+             * Chunks are handed to destination without 'data' events
+             * (unless 'data' listeners are added).
+             * @param destination A writable stream
+             * @param options Options
+             * @return destination
+             */
+            pipe<T extends Writable>(destination: T, options?: PipeOptions): T;
+            push(chunk: StreamChunk | null, encoding?: string): boolean;
+            read(size?: number): string | Buffer | any;
             resume(): Readable;
             setEncoding(encoding: string): Readable;
-            unpipe(destination?: Writable): void;
+            unpipe(destination?: Writable): Readable;
             unshift(chunk: StreamChunk): void;
+            readonly readableLength: number;
+            readonly readableHighWaterMark: number;
         }
 
-        class Duplex extends Stream
+        class Duplex extends Readable
             implements WritableStream, ReadableStream {
 
+            constructor(options?: WritableStreamOptions & ReadableStreamOptions);
             cork(): void;
-            end(chunk?: StreamChunk, encoding?: string, callback?: Function): void;
+            end(chunk?: StreamChunk, encoding?: string, callback?: Function): Writable;
             setDefaultEncoding(encoding: string): Writable;
             uncork(): void;
             write(chunk: StreamChunk, encoding?: string, callback?: Function): boolean;
+            readonly writableLength: number;
+            readonly writableHighWaterMark: number;
+        }
 
-            isPaused(): boolean;
-            pause(): Readable;
-            pipe(destination: Writable, options?: PipeOptions): void;
-            read(size?: number): string | Buffer;
-            resume(): Readable;
-            setEncoding(encoding: string): Readable;
-            unpipe(destination?: Writable): void;
-            unshift(chunk: StreamChunk): void;
+        class Transform extends Duplex {
+            constructor(options?: TransformStreamOptions);
         }
     }
 }
@@ -1,33 +1,81 @@
-#ifndef DUX_STREAM_H_
-#define DUX_STREAM_H_
+#ifndef DUX_STREAM_H_INCLUDED
+#define DUX_STREAM_H_INCLUDED
 
-#include "duktape.h"
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_EVENTS) && !defined(DUX_OPT_NO_STREAM)
 
-#ifdef __cplusplus
-extern "C" {
+/*
+ * Constants
+ */
+
+#if !defined(DUX_STREAM_DEFAULT_HIGH_WATER_MARK)
+#define DUX_STREAM_DEFAULT_HIGH_WATER_MARK          16384   /* in bytes */
+#endif
+
+#if !defined(DUX_STREAM_DEFAULT_OBJECT_HIGH_WATER_MARK)
+#define DUX_STREAM_DEFAULT_OBJECT_HIGH_WATER_MARK   16      /* in objects */
 #endif
 
 enum {
-    DUX_STREAM_FLAG_OBJECT_MODE = (1 << 0),
-    DUX_STREAM_FLAG_ENDED       = (1 << 1),
+	DUX_STREAM_FLAG_OBJECT_MODE     = (1 << 0),
+	DUX_STREAM_FLAG_ENDED           = (1 << 1),     /* end() or push(null) has been called */
+	DUX_STREAM_FLAG_FINISHED        = (1 << 2),     /* 'finish' or 'end' has been emitted */
+	DUX_STREAM_FLAG_BUSY            = (1 << 3),     /* _write/_writev/_final/_read is running */
+	DUX_STREAM_FLAG_SYNC            = (1 << 4),     /* _write/_writev/_final is being called */
+	DUX_STREAM_FLAG_COMPLETED       = (1 << 5),     /* Write completed but callbacks are not called yet */
+	DUX_STREAM_FLAG_NEED_DRAIN      = (1 << 6),
+	DUX_STREAM_FLAG_FLOWING         = (1 << 7),
+	DUX_STREAM_FLAG_PAUSED          = (1 << 8),     /* pause() has been called */
+	DUX_STREAM_FLAG_SCHEDULED       = (1 << 9),     /* Waiting for tick */
+	DUX_STREAM_FLAG_DESTROYED       = (1 << 10),
+	DUX_STREAM_FLAG_ERRORED         = (1 << 11),
+	DUX_STREAM_FLAG_DECODE_STRINGS  = (1 << 12),
+	DUX_STREAM_FLAG_FINAL_CALLED    = (1 << 13),
+	DUX_STREAM_FLAG_PIPED           = (1 << 14),    /* pipe() has been called */
+	DUX_STREAM_FLAG_DATA_LISTENED   = (1 << 15),    /* on('data') has been called */
 };
 
+/*
+ * Structures
+ */
+
 typedef struct dux_stream_writable_data_s {
-    duk_uint_t corked;
-    duk_uint_t flags;
-    duk_uint_t highWaterMark;
-    duk_uint_t length;
-    duk_ret_t (*write)(duk_context *ctx);
-    duk_ret_t (*writev)(duk_context *ctx);
+	duk_uint_t corked;
+	duk_uint_t flags;
+	duk_uint_t highWaterMark;
+	duk_uint_t length;          /* Buffered length (including chunks being written) */
+	duk_uint_t writing;         /* Length of chunks being written */
+	duk_uarridx_t head;         /* Index of first entry in queue */
+	duk_uarridx_t tail;         /* Index of next entry in queue */
+	duk_ret_t (*write)(duk_context *ctx);   /* Native _write (Overrides JavaScript one if not NULL) */
+	duk_ret_t (*writev)(duk_context *ctx);  /* Native _writev (Overrides JavaScript one if not NULL) */
 } dux_stream_writable_data;
 
 typedef struct dux_stream_readable_data_s {
+	duk_uint_t flags;
+	duk_uint_t highWaterMark;
+	duk_uint_t length;          /* Buffered length */
+	duk_uarridx_t head;         /* Index of first chunk in queue */
+	duk_uarridx_t tail;         /* Index of next chunk in queue */
+	duk_uint_t awaitDrain;      /* Number of pipe destinations waiting for 'drain' */
+	duk_ret_t (*read)(duk_context *ctx);    /* Native _read (Overrides JavaScript one if not NULL) */
 } dux_stream_readable_data;
 
-extern void dux_push_stream_constructor(duk_context *ctx);
+/*
+ * Functions
+ */
 
-#ifdef __cplusplus
-}	/* extern "C" */
-#endif
+DUK_INTERNAL_DECL duk_errcode_t dux_stream_init(duk_context *ctx);
+DUK_INTERNAL_DECL duk_int_t dux_stream_tick(duk_context *ctx);
+DUK_INTERNAL_DECL dux_stream_writable_data *dux_stream_get_writable(duk_context *ctx, duk_idx_t obj_idx);
+DUK_INTERNAL_DECL dux_stream_readable_data *dux_stream_get_readable(duk_context *ctx, duk_idx_t obj_idx);
+DUK_INTERNAL_DECL duk_bool_t dux_stream_push(duk_context *ctx, duk_idx_t obj_idx);
+#define DUX_INIT_STREAM     dux_stream_init,
+#define DUX_TICK_STREAM     DUX_TICK_HANDLER(dux_stream_tick, "stream")
+
+#else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS && !DUX_OPT_NO_STREAM */
+
+#define DUX_INIT_STREAM
+#define DUX_TICK_STREAM
 
-#endif /* DUX_STREAM_H_ */
+#endif  /* DUX_OPT_NO_NODEJS_MODULES || DUX_OPT_NO_EVENTS || DUX_OPT_NO_STREAM */
+#endif  /* !DUX_STREAM_H_INCLUDED */
@@ -4,14 +4,263 @@
 DUK_LOCAL const char DUX_IPK_TIMER[] = DUX_IPK("Timer");
 DUK_LOCAL const char DUX_IPK_TIMER_ID[] = DUX_IPK("tId");
 DUK_LOCAL const char DUX_IPK_TIMER_CB[] = DUX_IPK("tCb");
+DUK_LOCAL const char DUX_IPK_TIMER_QUEUE[] = DUX_IPK("tQue");
 
-#define MAX_ID(len)     ((len)>>1)
 #define FREE_IDX        (0)
 #define CONSTRUCTOR_IDX (1)
 #define DESC_IDX(id)    ((id)*2+0)
 #define TOUT_IDX(id)    ((id)*2+1)
 
+/*
+ * Timer queue
+ *   heap:    Started timers (binary min-heap ordered by time_next)
+ *   pending: Timers which are not started yet
+ *            (They are moved to heap at the end of next tick)
+ */
+typedef struct
+{
+	dux_timer_desc **items;
+	duk_uint_t count;
+	duk_uint_t size;
+}
+dux_timer_list;
+
+typedef struct
+{
+	dux_timer_list heap;
+	dux_timer_list pending;
+	duk_uint_t total;
+	duk_uint_t refs;
+	duk_uint_t seq;
+}
+dux_timer_queue;
+
 DUK_LOCAL_DECL void timer_push_array(duk_context *ctx);
+DUK_LOCAL_DECL dux_timer_queue *timer_get_queue(duk_context *ctx, duk_idx_t arr_idx);
+
+/*
+ * Get remaining time until expiration (0 means expired)
+ */
+DUK_LOCAL duk_uint64_t timer_remaining(const dux_timer_desc *desc, duk_uint64_t now)
+{
+	return (desc->time_next > now) ? (desc->time_next - now) : 0;
+}
+
+/*
+ * Find the latest time to wake up for timers in subtree
+ * (Subtrees which start after current result are skipped)
+ */
+DUK_LOCAL void timer_heap_wakeup(const dux_timer_list *heap, duk_uint_t index, duk_uint64_t *wakeup)
+{
+	const dux_timer_desc *desc;
+
+	if (index >= heap->count)
+	{
+		return;
+	}
+	desc = heap->items[index];
+	if (desc->time_next >= *wakeup)
+	{
+		return;
+	}
+	if (desc->time_next + desc->slack < *wakeup)
+	{
+		*wakeup = desc->time_next + desc->slack;
+	}
+	timer_heap_wakeup(heap, index * 2 + 1, wakeup);
+	timer_heap_wakeup(heap, index * 2 + 2, wakeup);
+}
+
+/*
+ * Compare timers in heap order
+ */
+DUK_LOCAL duk_bool_t timer_less(const dux_timer_desc *a, const dux_timer_desc *b)
+{
+	if (a->time_next != b->time_next)
+	{
+		return (a->time_next < b->time_next);
+	}
+	return ((duk_int_t)(a->seq - b->seq) < 0);
+}
+
+/*
+ * Reserve space of timer list
+ */
+DUK_LOCAL duk_bool_t timer_list_reserve(duk_context *ctx, dux_timer_list *list, duk_uint_t size)
+{
+	dux_timer_desc **items;
+
+	if (size <= list->size)
+	{
+		return 1;
+	}
+	if (size < list->size * 2)
+	{
+		size = list->size * 2;
+	}
+	items = (dux_timer_desc **)duk_realloc(ctx, list->items, sizeof(*items) * size);
+	if (!items)
+	{
+		return 0;
+	}
+	list->items = items;
+	list->size = size;
+	return 1;
+}
+
+/*
+ * Place timer into the list
+ */
+DUK_LOCAL void timer_list_place(dux_timer_list *list, duk_uint_t index, dux_timer_desc *desc)
+{
+	list->items[index] = desc;
+	desc->index = index;
+}
+
+/*
+ * Move timer towards the root of heap
+ */
+DUK_LOCAL void timer_heap_sift_up(dux_timer_list *heap, duk_uint_t index)
+{
+	dux_timer_desc *desc = heap->items[index];
+	duk_uint_t parent;
+
+	while (index > 0)
+	{
+		parent = (index - 1) / 2;
+		if (!timer_less(desc, heap->items[parent]))
+		{
+			break;
+		}
+		timer_list_place(heap, index, heap->items[parent]);
+		index = parent;
+	}
+	timer_list_place(heap, index, desc);
+}
+
+/*
+ * Move timer towards the leaves of heap
+ */
+DUK_LOCAL void timer_heap_sift_down(dux_timer_list *heap, duk_uint_t index)
+{
+	dux_timer_desc *desc = heap->items[index];
+	duk_uint_t child;
+
+	for (;;)
+	{
+		child = index * 2 + 1;
+		if (child >= heap->count)
+		{
+			break;
+		}
+		if ((child + 1 < heap->count) &&
+			timer_less(heap->items[child + 1], heap->items[child]))
+		{
+			++child;
+		}
+		if (!timer_less(heap->items[child], desc))
+		{
+			break;
+		}
+		timer_list_place(heap, index, heap->items[child]);
+		index = child;
+	}
+	timer_list_place(heap, index, desc);
+}
+
+/*
+ * Remove timer from the heap
+ */
+DUK_LOCAL void timer_heap_remove(dux_timer_list *heap, duk_uint_t index)
+{
+	dux_timer_desc *last = heap->items[--heap->count];
+
+	if (index == heap->count)
+	{
+		return;
+	}
+	timer_list_place(heap, index, last);
+	if ((index > 0) && timer_less(last, heap->items[(index - 1) / 2]))
+	{
+		timer_heap_sift_up(heap, index);
+	}
+	else
+	{
+		timer_heap_sift_down(heap, index);
+	}
+}
+
+/*
+ * Add timer to pending list (Space must be reserved)
+ */
+DUK_LOCAL void timer_queue_add(dux_timer_queue *queue, dux_timer_desc *desc)
+{
+	desc->seq = queue->seq++;
+	desc->flags |= DUX_TIMER_PENDING;
+	timer_list_place(&queue->pending, queue->pending.count++, desc);
+}
+
+/*
+ * Detach timer from heap or pending list
+ */
+DUK_LOCAL void timer_queue_detach(dux_timer_queue *queue, dux_timer_desc *desc)
+{
+	dux_timer_list *pending = &queue->pending;
+
+	if (desc->flags & DUX_TIMER_STARTED)
+	{
+		timer_heap_remove(&queue->heap, desc->index);
+	}
+	else if (desc->flags & DUX_TIMER_PENDING)
+	{
+		if (desc->index != --pending->count)
+		{
+			timer_list_place(pending, desc->index, pending->items[pending->count]);
+		}
+	}
+	desc->flags &= ~(DUX_TIMER_STARTED | DUX_TIMER_PENDING);
+}
+
+/*
+ * Move pending timers to heap
+ */
+DUK_LOCAL void timer_queue_start(dux_timer_queue *queue)
+{
+	dux_timer_list *heap = &queue->heap;
+	dux_timer_list *pending = &queue->pending;
+	duk_uint_t index;
+	dux_timer_desc *desc;
+
+	for (index = 0; index < pending->count; ++index)
+	{
+		desc = pending->items[index];
+		desc->flags = (desc->flags & ~DUX_TIMER_PENDING) | DUX_TIMER_STARTED;
+		heap->items[heap->count] = desc;
+		timer_heap_sift_up(heap, heap->count++);
+	}
+	pending->count = 0;
+}
+
+/*
+ * Finalizer of timer array (Frees timer queue)
+ */
+DUK_LOCAL duk_ret_t timer_queue_finalizer(duk_context *ctx)
+{
+	dux_timer_queue *queue;
+
+	/* [ arr ] */
+	duk_get_prop_string(ctx, 0, DUX_IPK_TIMER_QUEUE);
+	/* [ arr ptr ] */
+	queue = (dux_timer_queue *)duk_get_pointer(ctx, 1);
+	if (queue)
+	{
+		duk_del_prop_string(ctx, 0, DUX_IPK_TIMER_QUEUE);
+		duk_free(ctx, queue->heap.items);
+		duk_free(ctx, queue->pending.items);
+		duk_free(ctx, queue);
+	}
+	return 0;
+}
 
 /**
  * Constructor of Timeout class
@@ -28,33 +277,49 @@ DUK_LOCAL duk_ret_t timeout_constructor(duk_context *ctx)
 	return 0;
 }
 
+/**
+ * Get descriptor of this timer (NULL if timer is dead)
+ */
+DUK_LOCAL dux_timer_desc *timeout_get_desc(duk_context *ctx)
+{
+	duk_uarridx_t id;
+
+	/* [ ... ] */
+	duk_push_this(ctx);
+	/* [ ... this ] */
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_TIMER_ID)) {
+		/* Dead timer */
+		return NULL;
+	}
+	/* [ ... this uint ] */
+	id = duk_require_uint(ctx, -1);
+	timer_push_array(ctx);
+	/* [ ... this uint arr ] */
+	duk_get_prop_index(ctx, -1, DESC_IDX(id));
+	/* [ ... this uint arr buf ] */
+	return (dux_timer_desc *)duk_require_buffer(ctx, -1, NULL);
+}
+
 /**
  * Change reference setting
  */
 DUK_LOCAL duk_ret_t timeout_proto_change_ref(duk_context *ctx, int ref)
 {
-	duk_uarridx_t id;
 	dux_timer_desc *desc;
 
 	/* [  ] */
-	duk_push_this(ctx);
-	/* [ this ] */
-	if (!duk_get_prop_string(ctx, 0, DUX_IPK_TIMER_ID)) {
-		/* Dead timer */
+	desc = timeout_get_desc(ctx);
+	if (!desc) {
 		return DUK_RET_RANGE_ERROR;
 	}
-	/* [ this uint ] */
-	id = duk_require_uint(ctx, 1);
-	timer_push_array(ctx);
-	/* [ this uint arr ] */
-	duk_get_prop_index(ctx, 2, DESC_IDX(id));
 	/* [ this uint arr buf ] */
-	desc = (dux_timer_desc *)duk_require_buffer(ctx, 3, NULL);
 
-	if (ref) {
+	if (ref && (desc->flags & DUX_TIMER_UNREF)) {
 		desc->flags &= ~DUX_TIMER_UNREF;
-	} else {
+		++timer_get_queue(ctx, 2)->refs;
+	} else if ((!ref) && !(desc->flags & DUX_TIMER_UNREF)) {
 		desc->flags |= DUX_TIMER_UNREF;
+		--timer_get_queue(ctx, 2)->refs;
 	}
 	return 0;	/* return undefined */
 }
@@ -75,11 +340,69 @@ DUK_LOCAL duk_ret_t timeout_proto_unref(duk_context *ctx)
 	return timeout_proto_change_ref(ctx, 0);
 }
 
+/**
+ * Entry of timeout.setMissPolicy()
+ */
+DUK_LOCAL duk_ret_t timeout_proto_setMissPolicy(duk_context *ctx)
+{
+	const char *policy;
+	duk_uint_t flags;
+	dux_timer_desc *desc;
+
+	/* [ string ] */
+	policy = duk_require_string(ctx, 0);
+	if (strcmp(policy, "burst") == 0) {
+		flags = 0;
+	} else if (strcmp(policy, "skip") == 0) {
+		flags = DUX_TIMER_SKIP;
+	} else if (strcmp(policy, "coalesce") == 0) {
+		flags = DUX_TIMER_SKIP | DUX_TIMER_COALESCE;
+	} else {
+		return DUK_RET_RANGE_ERROR;
+	}
+	desc = timeout_get_desc(ctx);
+	if (!desc) {
+		return DUK_RET_RANGE_ERROR;
+	}
+	/* [ string this uint arr buf ] */
+	desc->flags = (desc->flags & ~(DUX_TIMER_SKIP | DUX_TIMER_COALESCE)) | flags;
+	duk_dup(ctx, 1);
+	return 1;	/* return this */
+}
+
+/**
+ * Entry of timeout.setSlack()
+ */
+DUK_LOCAL duk_ret_t timeout_proto_setSlack(duk_context *ctx)
+{
+	duk_double_t slack;
+	dux_timer_desc *desc;
+
+	/* [ number ] */
+	slack = duk_require_number(ctx, 0);
+	if (!(slack >= 0)) {
+		return DUK_RET_RANGE_ERROR;
+	}
+	if (slack > (duk_double_t)DUK_UINT_MAX) {
+		slack = (duk_double_t)DUK_UINT_MAX;
+	}
+	desc = timeout_get_desc(ctx);
+	if (!desc) {
+		return DUK_RET_RANGE_ERROR;
+	}
+	/* [ number this uint arr buf ] */
+	desc->slack = (duk_uint64_t)(slack * 1000000.0);
+	duk_dup(ctx, 1);
+	return 1;	/* return this */
+}
+
 /**
  * List of prototype methods of Timeout class
  */
 DUK_LOCAL const duk_function_list_entry timeout_proto_funcs[] = {
 	{ "ref", timeout_proto_ref, 0 },
+	{ "setMissPolicy", timeout_proto_setMissPolicy, 1 },
+	{ "setSlack", timeout_proto_setSlack, 1 },
 	{ "unref", timeout_proto_unref, 0 },
 	{ NULL, NULL, 0 }
 };
@@ -93,11 +416,24 @@ DUK_LOCAL void timer_push_array(duk_context *ctx)
 	/* [ ... stash ] */
 	if (!duk_get_prop_string(ctx, -1, DUX_IPK_TIMER))
 	{
+		dux_timer_queue *queue;
+
 		duk_pop(ctx);
 		/* [ ... stash ] */
+		queue = (dux_timer_queue *)duk_alloc(ctx, sizeof(*queue));
+		if (!queue)
+		{
+			(void)duk_generic_error(ctx, "Cannot allocate memory for timer queue");
+			return;
+		}
+		memset(queue, 0, sizeof(*queue));
 		duk_push_array(ctx);
 		duk_push_uint(ctx, 1);
 		duk_put_prop_index(ctx, -2, FREE_IDX);
+		duk_push_pointer(ctx, queue);
+		duk_put_prop_string(ctx, -2, DUX_IPK_TIMER_QUEUE);
+		duk_push_c_function(ctx, timer_queue_finalizer, 1);
+		duk_set_finalizer(ctx, -2);
 		/* [ ... stash arr ] */
 		duk_dup_top(ctx);
 		/* [ ... stash arr arr ] */
@@ -113,19 +449,48 @@ DUK_LOCAL void timer_push_array(duk_context *ctx)
 	/* [ ... arr ] */
 }
 
+/*
+ * Get timer queue
+ */
+DUK_LOCAL dux_timer_queue *timer_get_queue(duk_context *ctx, duk_idx_t arr_idx)
+{
+	/* [ ... arr ... ] */
+	dux_timer_queue *queue;
+
+	duk_get_prop_string(ctx, arr_idx, DUX_IPK_TIMER_QUEUE);
+	/* [ ... arr ... ptr ] */
+	queue = (dux_timer_queue *)duk_get_pointer(ctx, -1);
+	duk_pop(ctx);
+	/* [ ... arr ... ] */
+	return queue;
+}
+
 /*
  * Common implementation of setInterval/setTimeout
  */
 DUK_LOCAL duk_ret_t timer_set(duk_context *ctx, duk_uint_t flags)
 {
-	duk_uint_t interval;
+	duk_double_t delay;
+	duk_uint64_t interval;
 	duk_idx_t nargs;
 	dux_timer_desc *desc;
+	dux_timer_queue *queue;
 	duk_uarridx_t id, nextId;
 
 	/* [ func uint arg1 ... argN ] */
 	duk_require_callable(ctx, 0);
-	interval = duk_require_uint(ctx, 1);
+	delay = duk_require_number(ctx, 1);
+	if (!(delay > 0))
+	{
+		/* Negative or NaN */
+		delay = 0;
+	}
+	else if (delay > (duk_double_t)DUK_UINT_MAX)
+	{
+		delay = (duk_double_t)DUK_UINT_MAX;
+	}
+	/* Fractional milliseconds are allowed */
+	interval = (duk_uint64_t)(delay * 1000000.0);
 	duk_remove(ctx, 1);
 	/* [ func arg1 ... argN ] */
 	nargs = duk_get_top(ctx) - 1;
@@ -140,6 +505,12 @@ DUK_LOCAL duk_ret_t timer_set(duk_context *ctx, duk_uint_t flags)
 	desc = (dux_timer_desc *)duk_get_buffer(ctx, 1, NULL);
 	timer_push_array(ctx);
 	/* [ func buf arr ] */
+	queue = timer_get_queue(ctx, 2);
+	if ((!timer_list_reserve(ctx, &queue->heap, queue->total + 1)) ||
+		(!timer_list_reserve(ctx, &queue->pending, queue->total + 1)))
+	{
+		return duk_generic_error(ctx, "Cannot allocate memory for timer queue");
+	}
 	duk_swap(ctx, 0, 2);
 	/* [ arr buf func ] */
 	duk_get_prop_index(ctx, 0, FREE_IDX);
@@ -151,9 +522,15 @@ DUK_LOCAL duk_ret_t timer_set(duk_context *ctx, duk_uint_t flags)
 	/* Construct timer handle */
 	desc->id = id;
 	desc->flags = flags;
-	desc->time_start = desc->time_prev = dux_timer_arch_current();
+	desc->time_start = dux_timer_arch_current_ns();
 	desc->time_next = desc->time_start + interval;
 	desc->interval = interval;
+	timer_queue_add(queue, desc);
+	++queue->total;
+	if (!(flags & DUX_TIMER_UNREF))
+	{
+		++queue->refs;
+	}
 
 	for (nextId = id + 1;; ++nextId)
 	{
@@ -206,8 +583,27 @@ DUK_LOCAL duk_ret_t timer_setTimeout(duk_context *ctx)
 DUK_LOCAL duk_ret_t timer_clear_exec(duk_context *ctx, duk_idx_t arr_idx, duk_idx_t tout_idx, duk_uarridx_t id)
 {
 	duk_uarridx_t free_id;
+	dux_timer_queue *queue;
+	dux_timer_desc *desc;
 
 	/* [ ... arr/timeout ... timeout/arr ... ] */
+	duk_get_prop_index(ctx, arr_idx, DESC_IDX(id));
+	/* [ ... arr/timeout ... timeout/arr ... buf ] */
+	desc = (dux_timer_desc *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop(ctx);
+	/* [ ... arr/timeout ... timeout/arr ... ] */
+	queue = timer_get_queue(ctx, arr_idx);
+	if (desc && queue && !(desc->flags & DUX_TIMER_CLEARED))
+	{
+		timer_queue_detach(queue, desc);
+		desc->flags |= DUX_TIMER_CLEARED;
+		--queue->total;
+		if (!(desc->flags & DUX_TIMER_UNREF))
+		{
+			--queue->refs;
+		}
+	}
+
 	duk_del_prop_index(ctx, arr_idx, DESC_IDX(id));
 	duk_del_prop_index(ctx, arr_idx, TOUT_IDX(id));
 	duk_del_prop_string(ctx, tout_idx, DUX_IPK_TIMER_ID);
@@ -322,108 +718,132 @@ DUK_INTERNAL duk_errcode_t dux_timer_init(duk_context *ctx)
 DUK_INTERNAL duk_int_t dux_timer_tick(duk_context *ctx)
 {
 	/* [ ... ] */
-	duk_uint_t tick = dux_timer_arch_current();
+	duk_uint64_t now = dux_timer_arch_current_ns();
 	duk_int_t result = DUX_TICK_RET_JOBLESS;
+	dux_timer_queue *queue;
 	dux_timer_desc *desc;
 	duk_idx_t arr_idx;
 	duk_uarridx_t id;
-	duk_size_t max_id;
+	duk_uint64_t missed;
+	duk_uint_t jobs = 0;
+	dux_perf_monitor *monitor = dux_perf_get_monitor(ctx);
 
 	timer_push_array(ctx);
 	/* [ ... arr ] */
 	arr_idx = duk_normalize_index(ctx, -1);
+	queue = timer_get_queue(ctx, arr_idx);
 
-	max_id = MAX_ID(duk_get_length(ctx, -1));
-	for (id = 1; id <= max_id; ++id)
+	/* Only expired timers are touched */
+	while (queue->heap.count > 0)
 	{
-		/* [ ... arr ] */
-		desc = NULL;
-		if (duk_get_prop_index(ctx, arr_idx, DESC_IDX(id)))
+		desc = queue->heap.items[0];
+		if (timer_remaining(desc, now) > 0)
 		{
-			/* [ ... arr buffer ] */
-			desc = (dux_timer_desc *)duk_get_buffer(ctx, -1, NULL);
-		}
-		duk_pop(ctx);
-		/* [ ... arr ] */
-		if (!desc)
-		{
-			continue;
-		}
-
-		if (!(desc->flags & DUX_TIMER_UNREF)) {
-			result = DUX_TICK_RET_CONTINUE;
-		}
-		if (!(desc->flags & DUX_TIMER_STARTED)) {
-			desc->flags |= DUX_TIMER_STARTED;
-			continue;
-		}
-		if (desc->time_prev <= desc->time_next)
-		{
-			/*
-			 * No roll-over (P<N)
-			 *
-			 *            <------>             (continue)
-			 * [0.........P.......N.........M] (P=prev,N=next,M=max)
-			 *  --------->        <----------  (expire)
-			 *
-			 * --- or ---
-			 *
-			 * No interval (P==N)
-			 * 
-			 * [ 0..........P==N...........M ] (P=prev,N=next,M=max)
-			 *   <------------------------->   (expire)
-			 */
-			if ((desc->time_prev <= tick) && (tick < desc->time_next))
-			{
-				continue;
-			}
+			break;
 		}
-		else
+		timer_heap_remove(&queue->heap, 0);
+		desc->flags &= ~DUX_TIMER_STARTED;
+		result = DUX_TICK_RET_CONTINUE;
+		++jobs;
+		dux_perf_record_timer_delay(monitor, now - desc->time_next);
+
+		/* Expires (All timers already due are fired regardless of slack) */
+		id = desc->id;
+		missed = 0;
+		if ((desc->interval > 0) && (now - desc->time_next >= desc->interval))
 		{
-			/*
-			 * With roll-over (N<P)
-			 *
-			 *  --->                    <----  (continue)
-			 * [0...N...................P...M] (P=prev,N=next,M=max)
-			 *      <------------------>       (expire)
-			 */
-			if ((tick < desc->time_next) || (desc->time_prev <= tick))
-			{
-				continue;
-			}
+			missed = (now - desc->time_next) / desc->interval;
 		}
-
-		/* Expires */
+		duk_get_prop_index(ctx, arr_idx, DESC_IDX(id));
+		/* [ ... arr buf ] (Keeps descriptor alive during callback) */
 		duk_get_prop_index(ctx, arr_idx, TOUT_IDX(id));
-		/* [ ... arr timeout ] */
+		/* [ ... arr buf timeout ] */
 		duk_get_prop_string(ctx, -1, DUX_IPK_TIMER_CB);
-		/* [ ... arr timeout func ] */
-		if (duk_pcall(ctx, 0) != DUK_EXEC_SUCCESS)
+		/* [ ... arr buf timeout func ] */
+		if (desc->flags & DUX_TIMER_COALESCE)
+		{
+			/* Pass number of missed expirations */
+			duk_push_number(ctx, (duk_double_t)missed);
+			/* [ ... arr buf timeout func number ] */
+		}
+		if (duk_pcall(ctx, (desc->flags & DUX_TIMER_COALESCE) ? 1 : 0) != DUK_EXEC_SUCCESS)
 		{
-			/* [ ... arr timeout err ] */
+			/* [ ... arr buf timeout err ] */
 			dux_report_error(ctx);
 		}
 		duk_pop(ctx);
-		/* [ ... arr timeout ] */
+		/* [ ... arr buf timeout ] */
 
-		if (desc->flags & DUX_TIMER_ONESHOT)
+		if (desc->flags & DUX_TIMER_CLEARED)
+		{
+			/* Cleared in callback */
+		}
+		else if (desc->flags & DUX_TIMER_ONESHOT)
 		{
-			timer_clear_exec(ctx, arr_idx, arr_idx + 1, id);
+			timer_clear_exec(ctx, arr_idx, arr_idx + 2, id);
 		}
 		else
 		{
-			desc->time_next += desc->interval;
+			/* Advance on the original grid (No drift) */
+			if (desc->flags & DUX_TIMER_SKIP)
+			{
+				desc->time_next += desc->interval * (missed + 1);
+			}
+			else
+			{
+				desc->time_next += desc->interval;
+			}
+			timer_queue_add(queue, desc);
 		}
-		duk_pop(ctx);
+		duk_pop_2(ctx);
 		/* [ ... arr ] */
 	}
 
+	/* Start new timers and restart intervals */
+	timer_queue_start(queue);
+
 	duk_pop(ctx);
 	/* [ ... ] */
+	dux_loop_stats_add_jobs(ctx, jobs);
+	if (queue->refs > 0)
+	{
+		result = DUX_TICK_RET_CONTINUE;
+	}
 	return result;
 }
 
-#undef MAX_ID
+/*
+ * Get time until the earliest timer expiration including slack
+ * (in nanoseconds, -1 if no timer is active)
+ */
+DUK_INTERNAL duk_int64_t dux_timer_next_expiry(duk_context *ctx)
+{
+	/* [ ... ] */
+	dux_timer_queue *queue;
+	duk_uint64_t wakeup;
+	duk_uint64_t now;
+
+	timer_push_array(ctx);
+	/* [ ... arr ] */
+	queue = timer_get_queue(ctx, -1);
+	duk_pop(ctx);
+	/* [ ... ] */
+
+	if (queue->pending.count > 0)
+	{
+		/* Not started yet (Next tick is required) */
+		return 0;
+	}
+	if (queue->heap.count == 0)
+	{
+		return -1;
+	}
+	wakeup = queue->heap.items[0]->time_next + queue->heap.items[0]->slack;
+	timer_heap_wakeup(&queue->heap, 0, &wakeup);
+	now = dux_timer_arch_current_ns();
+	return (wakeup > now) ? (duk_int64_t)(wakeup - now) : 0;
+}
+
 #undef FREE_IDX
 #undef CONSTRUCTOR_IDX
 #undef DESC_IDX
@@ -2,6 +2,23 @@ declare namespace Dux {
     interface Timeout {
         ref(): void;
         unref(): void;
+
+        /**
+         * Set policy for missed expirations of periodic timer
+         *   "burst":    Invoke callback for each missed expiration (default)
+         *   "skip":     Skip missed expirations
+         *   "coalesce": Skip missed expirations and pass the number of them
+         *               to callback as the last argument
+         * @param policy Policy name
+         */
+        setMissPolicy(policy: "burst" | "skip" | "coalesce"): this;
+
+        /**
+         * Allow the timer to be delayed so that it can be fired together
+         * with other timers (Reduces the number of wakeups)
+         * @param slack Maximum delay in milliseconds
+         */
+        setSlack(slack: number): this;
     }
 }
 
@@ -20,7 +37,7 @@ declare function clearTimeout(id: Dux.Timeout): void;
 /**
  * Start a new periodic timer
  * @param callback Callback function
- * @param delay Delay (Unit is usually "milliseconds" but it is dependent on running platform)
+ * @param delay Delay in milliseconds (Fractional value is allowed)
  * @param args Arguments to be passed to callback function
  */
 declare function setInterval(callback: Function, delay: number, ...args): Dux.Timeout;
@@ -28,7 +45,7 @@ declare function setInterval(callback: Function, delay: number, ...args): Dux.Ti
 /**
  * Start a new oneshot timer
  * @param callback Callback function
- * @param delay Delay (Unit is usually "milliseconds" but it is dependent on running platform)
+ * @param delay Delay in milliseconds (Fractional value is allowed)
  * @param args Arguments to be passed to callback function
  */
 declare function setTimeout(callback: Function, delay: number, ...args): Dux.Timeout;
@@ -9,9 +9,13 @@
 
 enum
 {
-	DUX_TIMER_STARTED = (1 << 0),
-	DUX_TIMER_ONESHOT = (1 << 1),
-	DUX_TIMER_UNREF   = (1 << 2),
+	DUX_TIMER_STARTED  = (1 << 0),
+	DUX_TIMER_ONESHOT  = (1 << 1),
+	DUX_TIMER_UNREF    = (1 << 2),
+	DUX_TIMER_PENDING  = (1 << 3),
+	DUX_TIMER_CLEARED  = (1 << 4),
+	DUX_TIMER_SKIP     = (1 << 5),
+	DUX_TIMER_COALESCE = (1 << 6),
 };
 
 /*
@@ -23,10 +27,13 @@ typedef struct dux_timer_desc
 	duk_uint_t id;
 	duk_uint_t flags;
 
-	duk_uint_t interval;
-	duk_uint_t time_start;
-	duk_uint_t time_prev;
-	duk_uint_t time_next;
+	duk_uint64_t interval;		/* in nanoseconds */
+	duk_uint64_t time_start;	/* in nanoseconds */
+	duk_uint64_t time_next;		/* in nanoseconds */
+	duk_uint64_t slack;			/* in nanoseconds */
+
+	duk_uint_t index;	/* Position in timer queue */
+	duk_uint_t seq;		/* Order of insertion (for same time_next) */
 }
 dux_timer_desc;
 
@@ -36,16 +43,18 @@ dux_timer_desc;
 
 DUK_INTERNAL_DECL duk_errcode_t dux_timer_init(duk_context *ctx);
 DUK_INTERNAL_DECL duk_int_t dux_timer_tick(duk_context *ctx);
+DUK_INTERNAL_DECL duk_int64_t dux_timer_next_expiry(duk_context *ctx);
 #define DUX_INIT_TIMER  dux_timer_init,
-#define DUX_TICK_TIMER  dux_timer_tick,
+#define DUX_TICK_TIMER  DUX_TICK_HANDLER(dux_timer_tick, "timer")
 
 DUK_INTERNAL_DECL void dux_timer_arch_init(void);
-DUK_INTERNAL_DECL duk_uint_t dux_timer_arch_current(void);
+DUK_INTERNAL_DECL duk_uint64_t dux_timer_arch_current_ns(void);
 
 #else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_TIMER */
 
 #define DUX_INIT_TIMER
 #define DUX_TICK_TIMER
+#define dux_timer_next_expiry(ctx)  (-1)
 
 #endif  /* DUX_OPT_NO_NODEJS_MODULES || DUX_OPT_NO_TIMER */
 #endif  /* !DUX_TIMER_H_INCLUDED */
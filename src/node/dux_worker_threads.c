@@ -0,0 +1,1854 @@
+/*
+ * ECMA objects:
+ *    worker_threads = require("worker_threads");
+ *
+ *    worker_threads.isMainThread   => false if the host attached a port named "parent"
+ *    worker_threads.parentPort     => MessagePort named "parent" (or null)
+ *    worker_threads.ports          => { <name>: MessagePort } (attached by dux_channel_attach())
+ *    worker_threads.offload(<Function> func, ...args)
+ *      => Promise resolved with func(...args) run in a secondary heap on worker thread
+ *
+ *    class MessageChannel {
+ *      constructor() {
+ *        this.port1 = new MessagePort(); // connected to each other
+ *        this.port2 = new MessagePort();
+ *      }
+ *    }
+ *
+ *    class MessagePort extends EventEmitter {
+ *      postMessage(<Any> value, <ArrayBuffer[]> transferList) {}
+ *      close() {}
+ *      ref() {}
+ *      unref() {}
+ *      start() {}
+ *      // Event: 'message' (value)
+ *      // Event: 'close'
+ *    }
+ *
+ * Internal data structure:
+ *    heap_stash[DUX_IPK_WORKER_CLASS] = MessagePort;
+ *    heap_stash[DUX_IPK_WORKER_OPEN] = { <pointer>: MessagePort }; (open ports)
+ *    heap_stash[DUX_IPK_WORKER_NAMED] = { <name>: MessagePort };
+ *    port[DUX_IPK_WORKER_PORT] = new PlainBuffer(worker_port);
+ *    arraybuffer[DUX_IPK_WORKER_OWNED] = pointer (malloc'ed memory received from channel);
+ *    arraybuffer[DUX_IPK_WORKER_PLAIN] = external plain buffer which refers the memory above;
+ *    heap_stash[DUX_IPK_WORKER_HEAPS] = { DUX_IPK_WORKER_HEAPS: pointer (worker_heap_pool) };
+ *    port[DUX_IPK_WORKER_BATCH] = [ [value], ... ]; (messages being delivered)
+ *
+ * Messages are serialized into a native binary format (same process only)
+ * and passed through lock-free lists in dux_channel, which can connect
+ * ports in different heaps (each heap must be driven by one thread).
+ */
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_EVENTS) && !defined(DUX_OPT_NO_WORKER_THREADS)
+#include "../dux_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#if !defined(DUX_OPT_NO_WAIT) || !defined(DUX_OPT_NO_WORK)
+#include <pthread.h>
+#endif
+
+DUK_LOCAL const char DUX_IPK_WORKER_CLASS[] = DUX_IPK("wtClass");
+DUK_LOCAL const char DUX_IPK_WORKER_OPEN[]  = DUX_IPK("wtOpen");
+DUK_LOCAL const char DUX_IPK_WORKER_NAMED[] = DUX_IPK("wtNamed");
+DUK_LOCAL const char DUX_IPK_WORKER_PORT[]  = DUX_IPK("wtPort");
+DUK_LOCAL const char DUX_IPK_WORKER_OWNED[] = DUX_IPK("wtOwn");
+DUK_LOCAL const char DUX_IPK_WORKER_PLAIN[] = DUX_IPK("wtBuf");
+DUK_LOCAL const char DUX_IPK_WORKER_HEAPS[] = DUX_IPK("wtHeaps");
+DUK_LOCAL const char DUX_IPK_WORKER_BATCH[] = DUX_IPK("wtBatch");
+
+DUK_LOCAL const char DUX_WORKER_PARENT_NAME[] = "parent";
+
+/*
+ * Tags of serialized values
+ */
+enum
+{
+	WORKER_TAG_UNDEFINED = 0,
+	WORKER_TAG_NULL,
+	WORKER_TAG_FALSE,
+	WORKER_TAG_TRUE,
+	WORKER_TAG_INT,         /* duk_int_t */
+	WORKER_TAG_NUMBER,      /* duk_double_t */
+	WORKER_TAG_STRING,      /* length, bytes */
+	WORKER_TAG_ARRAY,       /* length, values */
+	WORKER_TAG_OBJECT,      /* count, (key, value) pairs */
+	WORKER_TAG_BUFFER,      /* kind, length, bytes */
+	WORKER_TAG_TRANSFER,    /* kind, index, offset, length */
+};
+
+/*
+ * Memory block moved to receiver
+ */
+typedef struct worker_transfer
+{
+	void *data;
+	duk_size_t len;
+}
+worker_transfer;
+
+/*
+ * Message in inbox
+ */
+typedef struct worker_message
+{
+	struct worker_message *next;
+	duk_uint8_t *data;
+	duk_size_t len;
+	duk_uint_t ntransfers;
+	worker_transfer transfers[1];
+}
+worker_message;
+
+/*
+ * Channel (Shared by two sides, each side may be in different heap)
+ */
+struct dux_channel
+{
+	duk_uint_t refs;
+#if !defined(DUX_OPT_NO_WAIT)
+	pthread_mutex_t lock;   /* Protects wakeup */
+#endif
+	struct
+	{
+		worker_message *inbox;
+		dux_wakeup *wakeup;
+		duk_bool_t attached;
+		duk_bool_t closed;
+	}
+	sides[2];
+};
+
+#if !defined(DUX_OPT_NO_WAIT)
+#define channel_lock(channel)   pthread_mutex_lock(&(channel)->lock)
+#define channel_unlock(channel) pthread_mutex_unlock(&(channel)->lock)
+#else
+#define channel_lock(channel)   ((void)0)
+#define channel_unlock(channel) ((void)0)
+#endif
+
+/*
+ * Port data
+ */
+typedef struct worker_port
+{
+	dux_channel *channel;   /* NULL after close */
+	duk_uint_t side;
+	duk_bool_t refed;
+}
+worker_port;
+
+/*
+ * Encoder/decoder state
+ */
+typedef struct worker_encoder
+{
+	duk_uint8_t *data;
+	duk_size_t len;
+	duk_size_t size;
+	duk_idx_t list_idx;
+	duk_uint_t ntransfers;
+	worker_transfer transfers[DUX_WORKER_MAX_TRANSFERS];
+	duk_bool_t moved[DUX_WORKER_MAX_TRANSFERS];
+}
+worker_encoder;
+
+typedef struct worker_decoder
+{
+	const duk_uint8_t *ptr;
+	const duk_uint8_t *end;
+	worker_message *msg;
+	duk_idx_t cache_idx;
+}
+worker_decoder;
+
+/*
+ * Constructors which make buffer objects (kind is passed to duk_push_buffer_object)
+ */
+DUK_LOCAL const struct
+{
+	const char *name;
+	duk_uint_t kind;
+}
+worker_buffer_kinds[] = {
+	{ "ArrayBuffer", DUK_BUFOBJ_ARRAYBUFFER },
+	{ "Buffer", DUK_BUFOBJ_NODEJS_BUFFER },
+	{ "DataView", DUK_BUFOBJ_DATAVIEW },
+	{ "Int8Array", DUK_BUFOBJ_INT8ARRAY },
+	{ "Uint8Array", DUK_BUFOBJ_UINT8ARRAY },
+	{ "Uint8ClampedArray", DUK_BUFOBJ_UINT8CLAMPEDARRAY },
+	{ "Int16Array", DUK_BUFOBJ_INT16ARRAY },
+	{ "Uint16Array", DUK_BUFOBJ_UINT16ARRAY },
+	{ "Int32Array", DUK_BUFOBJ_INT32ARRAY },
+	{ "Uint32Array", DUK_BUFOBJ_UINT32ARRAY },
+	{ "Float32Array", DUK_BUFOBJ_FLOAT32ARRAY },
+	{ "Float64Array", DUK_BUFOBJ_FLOAT64ARRAY },
+	{ NULL, 0 }
+};
+
+/*
+ * Free message (with memory blocks not taken by receiver)
+ */
+DUK_LOCAL void channel_free_message(worker_message *msg)
+{
+	duk_uint_t index;
+
+	for (index = 0; index < msg->ntransfers; ++index)
+	{
+		free(msg->transfers[index].data);
+	}
+	free(msg->data);
+	free(msg);
+}
+
+/*
+ * Push message to inbox (Multiple producers)
+ */
+DUK_LOCAL void channel_push(dux_channel *channel, duk_uint_t side, worker_message *msg)
+{
+	worker_message *head = __atomic_load_n(&channel->sides[side].inbox, __ATOMIC_RELAXED);
+
+	do
+	{
+		msg->next = head;
+	}
+	while (!__atomic_compare_exchange_n(&channel->sides[side].inbox, &head, msg,
+				1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Take all messages in posted order (Single consumer)
+ */
+DUK_LOCAL worker_message *channel_take(dux_channel *channel, duk_uint_t side)
+{
+	worker_message *list;
+	worker_message *ordered = NULL;
+
+	if (!__atomic_load_n(&channel->sides[side].inbox, __ATOMIC_RELAXED))
+	{
+		return NULL;
+	}
+	list = __atomic_exchange_n(&channel->sides[side].inbox, NULL, __ATOMIC_ACQUIRE);
+
+	/* Reverse LIFO list into FIFO order */
+	while (list)
+	{
+		worker_message *next = list->next;
+		list->next = ordered;
+		ordered = list;
+		list = next;
+	}
+	return ordered;
+}
+
+/*
+ * Free list of messages
+ */
+DUK_LOCAL void channel_free_messages(worker_message *msg)
+{
+	worker_message *next;
+
+	for (; msg; msg = next)
+	{
+		next = msg->next;
+		channel_free_message(msg);
+	}
+}
+
+/*
+ * Drop reference to channel (Channel is freed by the last one)
+ */
+DUK_LOCAL void channel_unref(dux_channel *channel)
+{
+	if (__atomic_sub_fetch(&channel->refs, 1, __ATOMIC_ACQ_REL) > 0)
+	{
+		return;
+	}
+	channel_free_messages(channel_take(channel, 0));
+	channel_free_messages(channel_take(channel, 1));
+#if !defined(DUX_OPT_NO_WAIT)
+	pthread_mutex_destroy(&channel->lock);
+#endif
+	free(channel);
+}
+
+/*
+ * Post message to the peer of side (Returns false if peer has been closed)
+ */
+DUK_LOCAL duk_bool_t channel_post(dux_channel *channel, duk_uint_t side, worker_message *msg)
+{
+	duk_uint_t peer = side ^ 1;
+
+	if (__atomic_load_n(&channel->sides[peer].closed, __ATOMIC_ACQUIRE))
+	{
+		return 0;
+	}
+	channel_push(channel, peer, msg);
+	channel_lock(channel);
+	dux_wakeup_post(channel->sides[peer].wakeup);
+	channel_unlock(channel);
+	return 1;
+}
+
+/*
+ * Attach side of channel to heap (Called in the thread which drives ctx)
+ */
+DUK_LOCAL void channel_attach_side(duk_context *ctx, dux_channel *channel, duk_uint_t side)
+{
+	__atomic_add_fetch(&channel->refs, 1, __ATOMIC_RELAXED);
+	channel_lock(channel);
+	channel->sides[side].wakeup = dux_wakeup_ref(dux_get_wakeup(ctx));
+	channel->sides[side].attached = 1;
+	channel_unlock(channel);
+}
+
+/*
+ * Detach side of channel from heap and notify the peer
+ */
+DUK_LOCAL void channel_detach_side(duk_context *ctx, dux_channel *channel, duk_uint_t side)
+{
+	dux_wakeup *wakeup;
+
+	channel_lock(channel);
+	wakeup = channel->sides[side].wakeup;
+	channel->sides[side].wakeup = NULL;
+	__atomic_store_n(&channel->sides[side].closed, 1, __ATOMIC_RELEASE);
+	dux_wakeup_post(channel->sides[side ^ 1].wakeup);
+	channel_unlock(channel);
+	dux_wakeup_release(ctx, wakeup);
+	channel_free_messages(channel_take(channel, side));
+	channel_unref(channel);
+}
+
+/*
+ * Create channel (Host must call dux_channel_release() after attaching it)
+ */
+DUK_EXTERNAL dux_channel *dux_channel_create(void)
+{
+	dux_channel *channel;
+
+	channel = (dux_channel *)calloc(1, sizeof(*channel));
+	if (!channel)
+	{
+		return NULL;
+	}
+#if !defined(DUX_OPT_NO_WAIT)
+	if (pthread_mutex_init(&channel->lock, NULL) != 0)
+	{
+		free(channel);
+		return NULL;
+	}
+#endif
+	channel->refs = 1;
+	return channel;
+}
+
+/*
+ * Release host's reference to channel
+ */
+DUK_EXTERNAL void dux_channel_release(dux_channel *channel)
+{
+	if (channel)
+	{
+		channel_unref(channel);
+	}
+}
+
+/*
+ * Get port data of object at index (NULL if not a MessagePort)
+ */
+DUK_LOCAL worker_port *worker_get_port(duk_context *ctx, duk_idx_t index)
+{
+	worker_port *port;
+
+	/* [ ... obj ... ] */
+	duk_get_prop_string(ctx, index, DUX_IPK_WORKER_PORT);
+	port = (worker_port *)duk_get_buffer(ctx, -1, NULL);
+	duk_pop(ctx);
+	return port;
+}
+
+/*
+ * Get port data of this (Throws TypeError if this is not a MessagePort)
+ */
+DUK_LOCAL worker_port *worker_port_this(duk_context *ctx)
+{
+	worker_port *port;
+
+	duk_push_this(ctx);
+	port = worker_get_port(ctx, -1);
+	duk_pop(ctx);
+	if (!port)
+	{
+		(void)duk_type_error(ctx, "not a MessagePort");
+	}
+	return port;
+}
+
+/*
+ * Get kind of buffer object at index (Returns false if not a buffer)
+ */
+DUK_LOCAL duk_bool_t worker_get_buffer_kind(duk_context *ctx, duk_idx_t index, duk_uint_t *kind)
+{
+	duk_uint_t entry;
+	duk_bool_t found = 0;
+
+	if (!duk_is_buffer_data(ctx, index))
+	{
+		return 0;
+	}
+	index = duk_normalize_index(ctx, index);
+	*kind = DUK_BUFOBJ_UINT8ARRAY;  /* Plain buffers behave like Uint8Array */
+	for (entry = 0; worker_buffer_kinds[entry].name && !found; ++entry)
+	{
+		/* [ ... obj ... ] */
+		if (duk_get_global_string(ctx, worker_buffer_kinds[entry].name) &&
+			duk_instanceof(ctx, index, -1))
+		{
+			*kind = worker_buffer_kinds[entry].kind;
+			found = 1;
+		}
+		duk_pop(ctx);
+	}
+	return 1;
+}
+
+/*
+ * Append bytes to message
+ */
+DUK_LOCAL void worker_encode_bytes(duk_context *ctx, worker_encoder *enc, const void *data, duk_size_t len)
+{
+	duk_uint8_t *grown;
+	duk_size_t size;
+
+	if ((enc->len + len) > enc->size)
+	{
+		size = (enc->size > 0) ? enc->size : 64;
+		while (size < (enc->len + len))
+		{
+			size *= 2;
+		}
+		grown = (duk_uint8_t *)realloc(enc->data, size);
+		if (!grown)
+		{
+			(void)duk_error(ctx, DUK_ERR_ERROR, "cannot allocate memory for message");
+		}
+		enc->data = grown;
+		enc->size = size;
+	}
+	if (len > 0)
+	{
+		memcpy(enc->data + enc->len, data, len);
+		enc->len += len;
+	}
+}
+
+DUK_LOCAL void worker_encode_tag(duk_context *ctx, worker_encoder *enc, duk_uint8_t tag)
+{
+	worker_encode_bytes(ctx, enc, &tag, sizeof(tag));
+}
+
+DUK_LOCAL void worker_encode_size(duk_context *ctx, worker_encoder *enc, duk_size_t value)
+{
+	worker_encode_bytes(ctx, enc, &value, sizeof(value));
+}
+
+/*
+ * Find ArrayBuffer at index in transferList (Returns -1 if not listed)
+ */
+DUK_LOCAL duk_int_t worker_find_transfer(duk_context *ctx, worker_encoder *enc, duk_idx_t index)
+{
+	duk_uint_t entry;
+	duk_bool_t equal;
+
+	for (entry = 0; entry < enc->ntransfers; ++entry)
+	{
+		/* [ ... ] */
+		duk_get_prop_index(ctx, enc->list_idx, entry);
+		equal = duk_strict_equals(ctx, index, -1);
+		duk_pop(ctx);
+		if (equal)
+		{
+			return (duk_int_t)entry;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Serialize buffer object
+ */
+DUK_LOCAL void worker_encode_buffer(duk_context *ctx, worker_encoder *enc, duk_idx_t index, duk_uint_t kind)
+{
+	void *data;
+	duk_size_t len;
+	duk_size_t offset = 0;
+	duk_int_t transfer;
+
+	/* [ ... ] */
+	data = duk_get_buffer_data(ctx, index, &len);
+	if (kind == DUK_BUFOBJ_ARRAYBUFFER)
+	{
+		duk_dup(ctx, index);
+	}
+	else if (enc->ntransfers > 0)
+	{
+		duk_get_prop_string(ctx, index, "byteOffset");
+		offset = (duk_size_t)duk_get_uint(ctx, -1);
+		duk_pop(ctx);
+		duk_get_prop_string(ctx, index, "buffer");
+	}
+	else
+	{
+		duk_push_undefined(ctx);
+	}
+	/* [ ... arraybuffer/undefined ] */
+	transfer = duk_is_object(ctx, -1) ? worker_find_transfer(ctx, enc, -1) : -1;
+	duk_pop(ctx);
+	/* [ ... ] */
+
+	if (transfer >= 0)
+	{
+		worker_encode_tag(ctx, enc, WORKER_TAG_TRANSFER);
+		worker_encode_size(ctx, enc, kind);
+		worker_encode_size(ctx, enc, (duk_size_t)transfer);
+		worker_encode_size(ctx, enc, offset);
+		worker_encode_size(ctx, enc, len);
+		return;
+	}
+	worker_encode_tag(ctx, enc, WORKER_TAG_BUFFER);
+	worker_encode_size(ctx, enc, kind);
+	worker_encode_size(ctx, enc, len);
+	worker_encode_bytes(ctx, enc, data, len);
+}
+
+/*
+ * Serialize value at index
+ */
+DUK_LOCAL void worker_encode_value(duk_context *ctx, worker_encoder *enc, duk_idx_t index, duk_uint_t depth)
+{
+	duk_double_t number;
+	duk_int_t integer;
+	const char *str;
+	duk_size_t len;
+	duk_size_t offset;
+	duk_size_t count;
+	duk_uint_t kind;
+
+	/* [ ... value ... ] */
+	index = duk_normalize_index(ctx, index);
+	switch (duk_get_type(ctx, index))
+	{
+	case DUK_TYPE_UNDEFINED:
+		worker_encode_tag(ctx, enc, WORKER_TAG_UNDEFINED);
+		return;
+	case DUK_TYPE_NULL:
+		worker_encode_tag(ctx, enc, WORKER_TAG_NULL);
+		return;
+	case DUK_TYPE_BOOLEAN:
+		worker_encode_tag(ctx, enc, duk_get_boolean(ctx, index) ? WORKER_TAG_TRUE : WORKER_TAG_FALSE);
+		return;
+	case DUK_TYPE_NUMBER:
+		number = duk_get_number(ctx, index);
+		if ((number >= -2147483648.0) && (number <= 2147483647.0) &&
+			(number == (duk_double_t)(duk_int_t)number) &&
+			((number != 0) || ((1.0 / number) > 0)))
+		{
+			integer = (duk_int_t)number;
+			worker_encode_tag(ctx, enc, WORKER_TAG_INT);
+			worker_encode_bytes(ctx, enc, &integer, sizeof(integer));
+			return;
+		}
+		worker_encode_tag(ctx, enc, WORKER_TAG_NUMBER);
+		worker_encode_bytes(ctx, enc, &number, sizeof(number));
+		return;
+	case DUK_TYPE_STRING:
+		str = duk_get_lstring(ctx, index, &len);
+		worker_encode_tag(ctx, enc, WORKER_TAG_STRING);
+		worker_encode_size(ctx, enc, len);
+		worker_encode_bytes(ctx, enc, str, len);
+		return;
+	case DUK_TYPE_BUFFER:
+	case DUK_TYPE_OBJECT:
+		break;
+	default:
+		(void)duk_type_error(ctx, "cannot clone value");
+		return;
+	}
+
+	if (depth >= DUX_WORKER_MAX_DEPTH)
+	{
+		(void)duk_range_error(ctx, "message too deep (or circular)");
+	}
+	/* Room for enum, key and value (or item) in this level */
+	duk_require_stack(ctx, 3);
+	if (worker_get_buffer_kind(ctx, index, &kind))
+	{
+		worker_encode_buffer(ctx, enc, index, kind);
+		return;
+	}
+	if (duk_is_callable(ctx, index))
+	{
+		(void)duk_type_error(ctx, "cannot clone function");
+	}
+	if (duk_is_array(ctx, index))
+	{
+		count = duk_get_length(ctx, index);
+		worker_encode_tag(ctx, enc, WORKER_TAG_ARRAY);
+		worker_encode_size(ctx, enc, count);
+		for (offset = 0; offset < count; ++offset)
+		{
+			duk_get_prop_index(ctx, index, (duk_uarridx_t)offset);
+			/* [ ... value ... item ] */
+			worker_encode_value(ctx, enc, -1, depth + 1);
+			duk_pop(ctx);
+		}
+		return;
+	}
+
+	worker_encode_tag(ctx, enc, WORKER_TAG_OBJECT);
+	offset = enc->len;
+	worker_encode_size(ctx, enc, 0);    /* Patched after enumeration */
+	count = 0;
+	duk_enum(ctx, index, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	/* [ ... value ... enum ] */
+	while (duk_next(ctx, -1, 1))
+	{
+		/* [ ... value ... enum key value ] */
+		str = duk_to_lstring(ctx, -2, &len);
+		worker_encode_size(ctx, enc, len);
+		worker_encode_bytes(ctx, enc, str, len);
+		worker_encode_value(ctx, enc, -1, depth + 1);
+		duk_pop_2(ctx);
+		++count;
+	}
+	duk_pop(ctx);
+	/* [ ... value ... ] */
+	memcpy(enc->data + offset, &count, sizeof(count));
+}
+
+/*
+ * Take memory blocks of ArrayBuffers in transferList
+ * (Blocks received from channel are moved, others are copied)
+ */
+DUK_LOCAL void worker_encode_transfers(duk_context *ctx, worker_encoder *enc)
+{
+	duk_size_t count;
+	duk_uint_t entry;
+	duk_uint_t kind;
+	void *data;
+	void *owned;
+	duk_size_t len;
+
+	/* [ ... ] */
+	count = duk_is_undefined(ctx, enc->list_idx) ? 0 : duk_get_length(ctx, enc->list_idx);
+	if (count > DUX_WORKER_MAX_TRANSFERS)
+	{
+		(void)duk_range_error(ctx, "too many transfers");
+	}
+	for (entry = 0; entry < count; ++entry)
+	{
+		duk_get_prop_index(ctx, enc->list_idx, entry);
+		/* [ ... arraybuffer ] */
+		if ((!worker_get_buffer_kind(ctx, -1, &kind)) ||
+			(kind != DUK_BUFOBJ_ARRAYBUFFER) || (!duk_is_object(ctx, -1)))
+		{
+			(void)duk_type_error(ctx, "only ArrayBuffer can be transferred");
+		}
+		if (worker_find_transfer(ctx, enc, -1) >= 0)
+		{
+			(void)duk_type_error(ctx, "ArrayBuffer listed twice");
+		}
+		data = duk_get_buffer_data(ctx, -1, &len);
+		duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_OWNED);
+		owned = duk_get_pointer(ctx, -1);
+		duk_pop_2(ctx);
+		/* [ ... ] */
+		if (data && (data == owned))
+		{
+			enc->moved[entry] = 1;
+		}
+		else
+		{
+			owned = malloc((len > 0) ? len : 1);
+			if (!owned)
+			{
+				(void)duk_error(ctx, DUK_ERR_ERROR, "cannot allocate memory for message");
+			}
+			if (len > 0)
+			{
+				memcpy(owned, data, len);
+			}
+			enc->moved[entry] = 0;
+		}
+		enc->transfers[entry].data = owned;
+		enc->transfers[entry].len = len;
+		enc->ntransfers = entry + 1;
+	}
+}
+
+/*
+ * Serialize message (in safe call)
+ */
+DUK_LOCAL duk_ret_t worker_encode_safe(duk_context *ctx, void *udata)
+{
+	worker_encoder *enc = (worker_encoder *)udata;
+	duk_idx_t value_idx;
+
+	/* [ ... value transferList ] */
+	value_idx = duk_normalize_index(ctx, -2);
+	enc->list_idx = duk_normalize_index(ctx, -1);
+	worker_encode_transfers(ctx, enc);
+	worker_encode_value(ctx, enc, value_idx, 0);
+	return 0;
+}
+
+/*
+ * Free memory held by failed encoder
+ */
+DUK_LOCAL void worker_encoder_cleanup(worker_encoder *enc)
+{
+	duk_uint_t entry;
+
+	for (entry = 0; entry < enc->ntransfers; ++entry)
+	{
+		if (!enc->moved[entry])
+		{
+			free(enc->transfers[entry].data);
+		}
+	}
+	free(enc->data);
+}
+
+/*
+ * Finalizer of ArrayBuffer received from channel
+ */
+DUK_LOCAL duk_ret_t worker_arraybuffer_finalizer(duk_context *ctx)
+{
+	/* [ arraybuffer ] */
+	duk_get_prop_string(ctx, 0, DUX_IPK_WORKER_OWNED);
+	free(duk_get_pointer(ctx, 1));
+	return 0;
+}
+
+/*
+ * Push ArrayBuffer which owns memory block allocated by malloc
+ */
+DUK_LOCAL void worker_push_owned_arraybuffer(duk_context *ctx, void *data, duk_size_t len)
+{
+	/* [ ... ] */
+	duk_push_external_buffer(ctx);
+	duk_config_buffer(ctx, -1, data, len);
+	duk_push_buffer_object(ctx, -1, 0, len, DUK_BUFOBJ_ARRAYBUFFER);
+	/* [ ... plain arraybuffer ] */
+	duk_swap_top(ctx, -2);
+	duk_put_prop_string(ctx, -2, DUX_IPK_WORKER_PLAIN);
+	duk_push_pointer(ctx, data);
+	duk_put_prop_string(ctx, -2, DUX_IPK_WORKER_OWNED);
+	duk_push_c_function(ctx, worker_arraybuffer_finalizer, 1);
+	duk_set_finalizer(ctx, -2);
+	/* [ ... arraybuffer ] */
+}
+
+/*
+ * Detach ArrayBuffers whose memory blocks have been moved to message
+ */
+DUK_LOCAL void worker_detach_moved(duk_context *ctx, worker_encoder *enc)
+{
+	duk_uint_t entry;
+
+	for (entry = 0; entry < enc->ntransfers; ++entry)
+	{
+		if (!enc->moved[entry])
+		{
+			continue;
+		}
+		/* [ ... ] */
+		duk_get_prop_index(ctx, enc->list_idx, entry);
+		duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_PLAIN);
+		/* [ ... arraybuffer plain ] */
+		duk_config_buffer(ctx, -1, NULL, 0);
+		duk_pop(ctx);
+		duk_del_prop_string(ctx, -1, DUX_IPK_WORKER_OWNED);
+		duk_pop(ctx);
+		/* [ ... ] */
+	}
+}
+
+/*
+ * Read bytes from message
+ */
+DUK_LOCAL void worker_decode_bytes(duk_context *ctx, worker_decoder *dec, void *data, duk_size_t len)
+{
+	if ((duk_size_t)(dec->end - dec->ptr) < len)
+	{
+		(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+	}
+	memcpy(data, dec->ptr, len);
+	dec->ptr += len;
+}
+
+DUK_LOCAL duk_size_t worker_decode_size(duk_context *ctx, worker_decoder *dec)
+{
+	duk_size_t value;
+
+	worker_decode_bytes(ctx, dec, &value, sizeof(value));
+	return value;
+}
+
+/*
+ * Push string from message
+ */
+DUK_LOCAL void worker_decode_string(duk_context *ctx, worker_decoder *dec)
+{
+	duk_size_t len;
+
+	len = worker_decode_size(ctx, dec);
+	if ((duk_size_t)(dec->end - dec->ptr) < len)
+	{
+		(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+	}
+	duk_push_lstring(ctx, (const char *)dec->ptr, len);
+	dec->ptr += len;
+}
+
+/*
+ * Push transferred ArrayBuffer (Memory block is taken from message at first use)
+ */
+DUK_LOCAL void worker_decode_transfer(duk_context *ctx, worker_decoder *dec, duk_size_t index)
+{
+	worker_transfer *transfer;
+
+	if ((!dec->msg) || (index >= dec->msg->ntransfers))
+	{
+		(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+	}
+	/* [ ... ] */
+	if (duk_get_prop_index(ctx, dec->cache_idx, (duk_uarridx_t)index))
+	{
+		return;
+	}
+	duk_pop(ctx);
+	transfer = &dec->msg->transfers[index];
+	worker_push_owned_arraybuffer(ctx, transfer->data, transfer->len);
+	transfer->data = NULL;
+	duk_dup_top(ctx);
+	duk_put_prop_index(ctx, dec->cache_idx, (duk_uarridx_t)index);
+	/* [ ... arraybuffer ] */
+}
+
+/*
+ * Push value from message
+ */
+DUK_LOCAL void worker_decode_value(duk_context *ctx, worker_decoder *dec, duk_uint_t depth)
+{
+	duk_uint8_t tag;
+	duk_int_t integer;
+	duk_double_t number;
+	duk_size_t count;
+	duk_size_t index;
+	duk_size_t kind;
+	duk_size_t offset;
+	duk_size_t len;
+	void *data;
+
+	worker_decode_bytes(ctx, dec, &tag, sizeof(tag));
+	if ((tag == WORKER_TAG_ARRAY) || (tag == WORKER_TAG_OBJECT))
+	{
+		if (depth >= DUX_WORKER_MAX_DEPTH)
+		{
+			(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+		}
+		/* Room for container, key and value in this level */
+		duk_require_stack(ctx, 3);
+	}
+	/* [ ... ] */
+	switch (tag)
+	{
+	case WORKER_TAG_UNDEFINED:
+		duk_push_undefined(ctx);
+		break;
+	case WORKER_TAG_NULL:
+		duk_push_null(ctx);
+		break;
+	case WORKER_TAG_FALSE:
+	case WORKER_TAG_TRUE:
+		duk_push_boolean(ctx, tag == WORKER_TAG_TRUE);
+		break;
+	case WORKER_TAG_INT:
+		worker_decode_bytes(ctx, dec, &integer, sizeof(integer));
+		duk_push_int(ctx, integer);
+		break;
+	case WORKER_TAG_NUMBER:
+		worker_decode_bytes(ctx, dec, &number, sizeof(number));
+		duk_push_number(ctx, number);
+		break;
+	case WORKER_TAG_STRING:
+		worker_decode_string(ctx, dec);
+		break;
+	case WORKER_TAG_ARRAY:
+		count = worker_decode_size(ctx, dec);
+		duk_push_array(ctx);
+		for (index = 0; index < count; ++index)
+		{
+			worker_decode_value(ctx, dec, depth + 1);
+			duk_put_prop_index(ctx, -2, (duk_uarridx_t)index);
+		}
+		break;
+	case WORKER_TAG_OBJECT:
+		count = worker_decode_size(ctx, dec);
+		duk_push_object(ctx);
+		for (index = 0; index < count; ++index)
+		{
+			worker_decode_string(ctx, dec);
+			worker_decode_value(ctx, dec, depth + 1);
+			/* [ ... obj key value ] */
+			duk_put_prop(ctx, -3);
+		}
+		break;
+	case WORKER_TAG_BUFFER:
+		kind = worker_decode_size(ctx, dec);
+		len = worker_decode_size(ctx, dec);
+		if ((duk_size_t)(dec->end - dec->ptr) < len)
+		{
+			(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+		}
+		data = duk_push_fixed_buffer(ctx, len);
+		worker_decode_bytes(ctx, dec, data, len);
+		/* [ ... plain ] */
+		duk_push_buffer_object(ctx, -1, 0, len, (duk_uint_t)kind);
+		duk_remove(ctx, -2);
+		break;
+	case WORKER_TAG_TRANSFER:
+		kind = worker_decode_size(ctx, dec);
+		index = worker_decode_size(ctx, dec);
+		offset = worker_decode_size(ctx, dec);
+		len = worker_decode_size(ctx, dec);
+		worker_decode_transfer(ctx, dec, index);
+		/* [ ... arraybuffer ] */
+		if ((kind == DUK_BUFOBJ_ARRAYBUFFER) && (offset == 0))
+		{
+			break;
+		}
+		duk_push_buffer_object(ctx, -1, offset, len, (duk_uint_t)kind);
+		duk_remove(ctx, -2);
+		break;
+	default:
+		(void)duk_error(ctx, DUK_ERR_ERROR, "broken message");
+		break;
+	}
+	/* [ ... value ] */
+}
+
+/*
+ * Deserialize message (in safe call)
+ */
+DUK_LOCAL duk_ret_t worker_decode_safe(duk_context *ctx, void *udata)
+{
+	worker_decoder *dec = (worker_decoder *)udata;
+
+	/* [ ... ] */
+	dec->cache_idx = duk_push_array(ctx);
+	/* [ ... cache ] */
+	worker_decode_value(ctx, dec, 0);
+	/* [ ... cache value ] */
+	return 2;
+}
+
+/*
+ * Emit event with no argument or the value at stack top
+ */
+DUK_LOCAL void worker_emit(duk_context *ctx, duk_idx_t port_idx, const char *event, duk_idx_t nargs)
+{
+	/* [ ... port ... args ] */
+	duk_push_string(ctx, "emit");
+	duk_push_string(ctx, event);
+	/* [ ... port ... args "emit" event ] */
+	duk_insert(ctx, -2 - nargs);
+	duk_insert(ctx, -2 - nargs);
+	/* [ ... port ... "emit" event args ] */
+	if (duk_pcall_prop(ctx, port_idx, nargs + 1) != DUK_EXEC_SUCCESS)
+	{
+		/* [ ... port ... err ] */
+		dux_report_error(ctx);
+	}
+	duk_pop(ctx);
+	/* [ ... port ... ] */
+}
+
+/*
+ * Close port (emits 'close' event)
+ */
+DUK_LOCAL void worker_port_close(duk_context *ctx, duk_idx_t port_idx)
+{
+	worker_port *port;
+	dux_channel *channel;
+
+	port_idx = duk_normalize_index(ctx, port_idx);
+	port = worker_get_port(ctx, port_idx);
+	if ((!port) || (!port->channel))
+	{
+		return;
+	}
+	channel = port->channel;
+	port->channel = NULL;
+	channel_detach_side(ctx, channel, port->side);
+
+	/* [ ... port ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_OPEN);
+	duk_push_pointer(ctx, port);
+	duk_del_prop(ctx, -2);
+	duk_pop_2(ctx);
+	/* [ ... port ... ] */
+	if (duk_get_prop_string(ctx, port_idx, DUX_IPK_WORKER_BATCH))
+	{
+		/* Drop messages not yet delivered */
+		duk_set_length(ctx, -1, 0);
+	}
+	duk_pop(ctx);
+	worker_emit(ctx, port_idx, "close", 0);
+}
+
+/*
+ * Deliver messages to port (Returns true if port keeps event loop alive)
+ */
+DUK_LOCAL duk_bool_t worker_port_receive(duk_context *ctx, duk_idx_t port_idx)
+{
+	worker_port *port;
+	worker_message *msg;
+	worker_message *next;
+	worker_decoder dec;
+	duk_uint_t jobs = 0;
+
+	port_idx = duk_normalize_index(ctx, port_idx);
+	port = worker_get_port(ctx, port_idx);
+	if ((!port) || (!port->channel))
+	{
+		return 0;
+	}
+	msg = channel_take(port->channel, port->side);
+	if (msg)
+	{
+		/* [ ... port ... ] */
+		duk_push_array(ctx);
+		/* [ ... port ... batch ] */
+		for (; msg; msg = next)
+		{
+			next = msg->next;
+			dec.ptr = msg->data;
+			dec.end = msg->data + msg->len;
+			dec.msg = msg;
+			if (duk_safe_call(ctx, worker_decode_safe, &dec, 0, 2) != DUK_EXEC_SUCCESS)
+			{
+				/* [ ... port ... batch err undefined ] */
+				duk_pop(ctx);
+				dux_report_error(ctx);
+				duk_pop(ctx);
+			}
+			else
+			{
+				/* [ ... port ... batch cache value ] */
+				duk_remove(ctx, -2);
+				duk_push_array(ctx);
+				duk_swap_top(ctx, -2);
+				duk_put_prop_index(ctx, -2, 0);
+				/* [ ... port ... batch [value] ] */
+				duk_put_prop_index(ctx, -2, (duk_uarridx_t)duk_get_length(ctx, -2));
+			}
+			/* [ ... port ... batch ] */
+			channel_free_message(msg);
+			++jobs;
+		}
+
+		/*
+		 * Listeners are looked up once for all messages.
+		 * close() by a listener truncates the batch so that
+		 * the rest of messages are not delivered.
+		 */
+		if (duk_get_length(ctx, -1) > 0)
+		{
+			duk_dup_top(ctx);
+			duk_put_prop_string(ctx, port_idx, DUX_IPK_WORKER_BATCH);
+			dux_events_emit_batch(ctx, port_idx, "message");
+			duk_del_prop_string(ctx, port_idx, DUX_IPK_WORKER_BATCH);
+		}
+		else
+		{
+			duk_pop(ctx);
+		}
+	}
+	/* [ ... port ... ] */
+	dux_loop_stats_add_jobs(ctx, jobs);
+
+	if (port->channel &&
+		__atomic_load_n(&port->channel->sides[port->side ^ 1].closed, __ATOMIC_ACQUIRE) &&
+		(!__atomic_load_n(&port->channel->sides[port->side].inbox, __ATOMIC_ACQUIRE)))
+	{
+		/* Peer has been closed and all messages have been delivered */
+		worker_port_close(ctx, port_idx);
+	}
+	return (port->channel != NULL) && port->refed;
+}
+
+/*
+ * Finalizer of MessagePort
+ */
+DUK_LOCAL duk_ret_t worker_port_finalizer(duk_context *ctx)
+{
+	worker_port *port;
+	dux_channel *channel;
+
+	/* [ port ] */
+	port = worker_get_port(ctx, 0);
+	if (port && port->channel)
+	{
+		channel = port->channel;
+		port->channel = NULL;
+		channel_detach_side(ctx, channel, port->side);
+	}
+	return 0;
+}
+
+/*
+ * Push new MessagePort connected to side of channel
+ */
+DUK_LOCAL void worker_push_port(duk_context *ctx, dux_channel *channel, duk_uint_t side)
+{
+	worker_port *port;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_CLASS);
+	duk_new(ctx, 0);
+	/* [ ... stash port ] */
+	port = (worker_port *)duk_push_fixed_buffer(ctx, sizeof(worker_port));
+	duk_put_prop_string(ctx, -2, DUX_IPK_WORKER_PORT);
+	duk_push_c_function(ctx, worker_port_finalizer, 1);
+	duk_set_finalizer(ctx, -2);
+	port->side = side;
+	port->refed = 1;
+	port->channel = channel;
+	channel_attach_side(ctx, channel, side);
+
+	if (!duk_get_prop_string(ctx, -2, DUX_IPK_WORKER_OPEN))
+	{
+		duk_pop(ctx);
+		duk_push_bare_object(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, -4, DUX_IPK_WORKER_OPEN);
+	}
+	/* [ ... stash port open ] */
+	duk_push_pointer(ctx, port);
+	duk_dup(ctx, -3);
+	duk_put_prop(ctx, -3);
+	duk_pop(ctx);
+	duk_remove(ctx, -2);
+	/* [ ... port ] */
+}
+
+/*
+ * Push registry of named ports
+ */
+DUK_LOCAL void worker_push_named(duk_context *ctx)
+{
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_NAMED))
+	{
+		duk_pop(ctx);
+		duk_push_object(ctx);
+		duk_dup_top(ctx);
+		duk_put_prop_string(ctx, -3, DUX_IPK_WORKER_NAMED);
+	}
+	duk_remove(ctx, -2);
+	/* [ ... named ] */
+}
+
+/*
+ * Attach side of channel to heap (in safe call)
+ */
+typedef struct worker_attach_args
+{
+	dux_channel *channel;
+	duk_uint_t side;
+	const char *name;
+}
+worker_attach_args;
+
+DUK_LOCAL duk_ret_t worker_attach_safe(duk_context *ctx, void *udata)
+{
+	worker_attach_args *args = (worker_attach_args *)udata;
+
+	/* [ ... ] */
+	duk_get_global_string(ctx, "require");
+	duk_push_string(ctx, "worker_threads");
+	duk_call(ctx, 1);
+	duk_pop(ctx);
+	worker_push_port(ctx, args->channel, args->side);
+	/* [ ... port ] */
+	if (args->name)
+	{
+		worker_push_named(ctx);
+		duk_dup(ctx, -2);
+		duk_put_prop_string(ctx, -2, args->name);
+		duk_pop(ctx);
+	}
+	return 1;
+}
+
+/*
+ * Attach side (0 or 1) of channel to heap as a MessagePort
+ * (Must be called in the thread which drives ctx.
+ *  Named port is available as require("worker_threads").ports[name])
+ */
+DUK_EXTERNAL duk_errcode_t dux_channel_attach(duk_context *ctx, dux_channel *channel, duk_uint_t side, const char *name)
+{
+	worker_attach_args args;
+	duk_int_t result;
+
+	if ((!channel) || (side > 1))
+	{
+		return DUK_ERR_RANGE_ERROR;
+	}
+	if (channel->sides[side].attached)
+	{
+		return DUK_ERR_ERROR;
+	}
+	args.channel = channel;
+	args.side = side;
+	args.name = name;
+	/* [ ... ] */
+	result = duk_safe_call(ctx, worker_attach_safe, &args, 0, 1);
+	/* [ ... port/err ] */
+	duk_pop(ctx);
+	return (result == DUK_EXEC_SUCCESS) ? DUK_ERR_NONE : DUK_ERR_ERROR;
+}
+
+/*
+ * Constructor of MessagePort
+ */
+DUK_LOCAL duk_ret_t worker_port_constructor(duk_context *ctx)
+{
+	if (!duk_is_constructor_call(ctx))
+	{
+		return DUK_RET_TYPE_ERROR;
+	}
+
+	/* [  ] */
+	dux_push_super_constructor(ctx);
+	duk_push_this(ctx);
+	/* [ super this ] */
+	duk_call_method(ctx, 0);
+	return 0; /* return this */
+}
+
+/*
+ * Entry of MessagePort.prototype.postMessage()
+ */
+DUK_LOCAL duk_ret_t worker_port_postMessage(duk_context *ctx)
+{
+	worker_port *port = worker_port_this(ctx);
+	worker_encoder enc;
+	worker_message *msg;
+
+	/* [ value transferList ] */
+	if ((!duk_is_undefined(ctx, 1)) && (!duk_is_array(ctx, 1)))
+	{
+		return DUK_RET_TYPE_ERROR;
+	}
+	if (!port->channel)
+	{
+		return 0; /* return undefined (dropped) */
+	}
+	memset(&enc, 0, sizeof(enc));
+	duk_dup(ctx, 0);
+	duk_dup(ctx, 1);
+	/* [ value transferList value transferList ] */
+	if (duk_safe_call(ctx, worker_encode_safe, &enc, 2, 1) != DUK_EXEC_SUCCESS)
+	{
+		/* [ value transferList err ] */
+		worker_encoder_cleanup(&enc);
+		return duk_throw(ctx);
+	}
+	duk_pop(ctx);
+	/* [ value transferList ] */
+
+	msg = (worker_message *)malloc(sizeof(*msg) + sizeof(worker_transfer) * enc.ntransfers);
+	if (!msg)
+	{
+		worker_encoder_cleanup(&enc);
+		return duk_error(ctx, DUK_ERR_ERROR, "cannot allocate memory for message");
+	}
+	msg->data = enc.data;
+	msg->len = enc.len;
+	msg->ntransfers = enc.ntransfers;
+	memcpy(msg->transfers, enc.transfers, sizeof(worker_transfer) * enc.ntransfers);
+	enc.list_idx = 1;
+	worker_detach_moved(ctx, &enc);
+
+	if (!channel_post(port->channel, port->side, msg))
+	{
+		channel_free_message(msg);
+	}
+	return 0; /* return undefined */
+}
+
+/*
+ * Entry of MessagePort.prototype.close()
+ */
+DUK_LOCAL duk_ret_t worker_port_close_method(duk_context *ctx)
+{
+	(void)worker_port_this(ctx);
+	duk_push_this(ctx);
+	/* [ this ] */
+	worker_port_close(ctx, 0);
+	return 0; /* return undefined */
+}
+
+/*
+ * Entry of MessagePort.prototype.ref()
+ */
+DUK_LOCAL duk_ret_t worker_port_ref(duk_context *ctx)
+{
+	worker_port_this(ctx)->refed = 1;
+	return 0; /* return undefined */
+}
+
+/*
+ * Entry of MessagePort.prototype.unref()
+ */
+DUK_LOCAL duk_ret_t worker_port_unref(duk_context *ctx)
+{
+	worker_port_this(ctx)->refed = 0;
+	return 0; /* return undefined */
+}
+
+/*
+ * Entry of MessagePort.prototype.start()
+ * (Messages are always delivered by tick)
+ */
+DUK_LOCAL duk_ret_t worker_port_start(duk_context *ctx)
+{
+	(void)worker_port_this(ctx);
+	return 0; /* return undefined */
+}
+
+/*
+ * List of methods for MessagePort object
+ */
+DUK_LOCAL const duk_function_list_entry worker_port_funcs[] = {
+	{ "postMessage", worker_port_postMessage, 2 },
+	{ "close", worker_port_close_method, 0 },
+	{ "ref", worker_port_ref, 0 },
+	{ "unref", worker_port_unref, 0 },
+	{ "start", worker_port_start, 0 },
+	{ NULL, NULL, 0 }
+};
+
+/*
+ * Constructor of MessageChannel
+ */
+DUK_LOCAL duk_ret_t worker_channel_constructor(duk_context *ctx)
+{
+	dux_channel *channel;
+
+	if (!duk_is_constructor_call(ctx))
+	{
+		return DUK_RET_TYPE_ERROR;
+	}
+
+	channel = dux_channel_create();
+	if (!channel)
+	{
+		return duk_error(ctx, DUK_ERR_ERROR, "cannot allocate channel");
+	}
+
+	/* [  ] */
+	duk_push_this(ctx);
+	/* [ this ] */
+	worker_push_port(ctx, channel, 0);
+	duk_put_prop_string(ctx, 0, "port1");
+	worker_push_port(ctx, channel, 1);
+	duk_put_prop_string(ctx, 0, "port2");
+	dux_channel_release(channel);
+	return 0; /* return this */
+}
+
+#if !defined(DUX_OPT_NO_WORK) && !defined(DUX_OPT_NO_PROMISE) && !defined(DUX_OPT_STANDARD_PROMISE)
+/*
+ * Pool of secondary heaps for offloaded functions
+ * (Heaps are used by worker threads of dux_work, one request at a time)
+ */
+typedef struct worker_heap_pool
+{
+	duk_uint_t refs;    /* Holder object and requests (main thread only) */
+	pthread_mutex_t lock;
+	duk_uint_t count;
+	duk_context *heaps[DUX_WORK_THREADS];
+}
+worker_heap_pool;
+
+/*
+ * Offload request (Passed to dux_queue_work)
+ */
+typedef struct worker_offload_req
+{
+	worker_heap_pool *pool;
+	duk_uint8_t *bytecode;
+	duk_size_t bytecode_len;
+	duk_uint8_t *args;
+	duk_size_t args_len;
+	duk_uint8_t *result;
+	duk_size_t result_len;
+	duk_bool_t failed;
+}
+worker_offload_req;
+
+/*
+ * Drop reference to heap pool (Heaps are destroyed by the last one)
+ */
+DUK_LOCAL void worker_heap_pool_unref(worker_heap_pool *pool)
+{
+	duk_uint_t index;
+
+	if (--pool->refs > 0)
+	{
+		return;
+	}
+	for (index = 0; index < pool->count; ++index)
+	{
+		duk_destroy_heap(pool->heaps[index]);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	free(pool);
+}
+
+/*
+ * Take idle heap from pool (Called in worker thread)
+ */
+DUK_LOCAL duk_context *worker_heap_pool_acquire(worker_heap_pool *pool)
+{
+	duk_context *heap = NULL;
+
+	pthread_mutex_lock(&pool->lock);
+	if (pool->count > 0)
+	{
+		heap = pool->heaps[--pool->count];
+	}
+	pthread_mutex_unlock(&pool->lock);
+	if (!heap)
+	{
+		heap = duk_create_heap_default();
+	}
+	return heap;
+}
+
+/*
+ * Return heap to pool (Called in worker thread)
+ */
+DUK_LOCAL void worker_heap_pool_release(worker_heap_pool *pool, duk_context *heap)
+{
+	duk_set_top(heap, 0);
+	pthread_mutex_lock(&pool->lock);
+	if (pool->count < DUX_WORK_THREADS)
+	{
+		pool->heaps[pool->count++] = heap;
+		heap = NULL;
+	}
+	pthread_mutex_unlock(&pool->lock);
+	if (heap)
+	{
+		duk_destroy_heap(heap);
+	}
+}
+
+/*
+ * Finalizer of heap pool holder
+ */
+DUK_LOCAL duk_ret_t worker_heap_pool_finalizer(duk_context *ctx)
+{
+	worker_heap_pool *pool;
+
+	/* [ obj ] */
+	duk_get_prop_string(ctx, 0, DUX_IPK_WORKER_HEAPS);
+	pool = (worker_heap_pool *)duk_get_pointer(ctx, 1);
+	if (pool)
+	{
+		duk_del_prop_string(ctx, 0, DUX_IPK_WORKER_HEAPS);
+		worker_heap_pool_unref(pool);
+	}
+	return 0;
+}
+
+/*
+ * Get heap pool (Created at the first call)
+ */
+DUK_LOCAL worker_heap_pool *worker_get_heap_pool(duk_context *ctx)
+{
+	worker_heap_pool *pool;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	if (duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_HEAPS))
+	{
+		/* [ ... stash obj ] */
+		duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_HEAPS);
+		pool = (worker_heap_pool *)duk_get_pointer(ctx, -1);
+		duk_pop_3(ctx);
+		/* [ ... ] */
+		return pool;
+	}
+	duk_pop(ctx);
+	/* [ ... stash ] */
+
+	pool = (worker_heap_pool *)calloc(1, sizeof(*pool));
+	if ((!pool) || (pthread_mutex_init(&pool->lock, NULL) != 0))
+	{
+		free(pool);
+		(void)duk_error(ctx, DUK_ERR_ERROR, "cannot allocate heap pool");
+	}
+	pool->refs = 1;
+	duk_push_object(ctx);
+	duk_push_pointer(ctx, pool);
+	duk_put_prop_string(ctx, -2, DUX_IPK_WORKER_HEAPS);
+	duk_push_c_function(ctx, worker_heap_pool_finalizer, 1);
+	duk_set_finalizer(ctx, -2);
+	/* [ ... stash obj ] */
+	duk_put_prop_string(ctx, -2, DUX_IPK_WORKER_HEAPS);
+	duk_pop(ctx);
+	/* [ ... ] */
+	return pool;
+}
+
+/*
+ * Run offloaded function in secondary heap (in safe call)
+ */
+DUK_LOCAL duk_ret_t worker_offload_safe(duk_context *ctx, void *udata)
+{
+	worker_offload_req *req = (worker_offload_req *)udata;
+	worker_encoder enc;
+	worker_decoder dec;
+	duk_idx_t nargs;
+	duk_idx_t index;
+	void *buf;
+
+	/* [  ] */
+	buf = duk_push_fixed_buffer(ctx, req->bytecode_len);
+	memcpy(buf, req->bytecode, req->bytecode_len);
+	duk_load_function(ctx);
+	/* [ func ] */
+	dec.ptr = req->args;
+	dec.end = req->args + req->args_len;
+	dec.msg = NULL;
+	(void)worker_decode_safe(ctx, &dec);
+	/* [ func cache args ] */
+	duk_remove(ctx, 1);
+	/* [ func args ] */
+	nargs = (duk_idx_t)duk_get_length(ctx, 1);
+	duk_require_stack(ctx, nargs);
+	for (index = 0; index < nargs; ++index)
+	{
+		duk_get_prop_index(ctx, 1, (duk_uarridx_t)index);
+	}
+	duk_remove(ctx, 1);
+	/* [ func arg1 ... argN ] */
+	duk_call(ctx, nargs);
+	/* [ retval ] */
+	duk_push_undefined(ctx);
+	/* [ retval undefined ] */
+	memset(&enc, 0, sizeof(enc));
+	if (duk_safe_call(ctx, worker_encode_safe, &enc, 2, 1) != DUK_EXEC_SUCCESS)
+	{
+		worker_encoder_cleanup(&enc);
+		return duk_throw(ctx);
+	}
+	req->result = enc.data;
+	req->result_len = enc.len;
+	return 0;
+}
+
+/*
+ * Worker for offloaded function (Called in worker thread)
+ */
+DUK_LOCAL duk_int_t worker_offload_work_cb(worker_offload_req *req)
+{
+	duk_context *heap;
+	worker_encoder enc;
+
+	heap = worker_heap_pool_acquire(req->pool);
+	if (!heap)
+	{
+		return -1;
+	}
+	if (duk_safe_call(heap, worker_offload_safe, req, 0, 1) != DUK_EXEC_SUCCESS)
+	{
+		/* Pass error as string */
+		req->failed = 1;
+		duk_safe_to_string(heap, -1);
+		duk_push_undefined(heap);
+		memset(&enc, 0, sizeof(enc));
+		if (duk_safe_call(heap, worker_encode_safe, &enc, 2, 1) != DUK_EXEC_SUCCESS)
+		{
+			worker_encoder_cleanup(&enc);
+			enc.data = NULL;
+			enc.len = 0;
+		}
+		req->result = enc.data;
+		req->result_len = enc.len;
+	}
+	worker_heap_pool_release(req->pool, heap);
+	return 0;
+}
+
+/*
+ * After worker for offloaded function
+ */
+DUK_LOCAL duk_ret_t worker_offload_after_work_cb(duk_context *ctx, worker_offload_req *req)
+{
+	worker_decoder dec;
+
+	/* [ int resolve reject ] */
+	if ((duk_get_int_default(ctx, 0, -1) != 0) || (!req->result))
+	{
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "cannot run function in worker");
+		duk_call(ctx, 1);
+		return 0;
+	}
+	dec.ptr = req->result;
+	dec.end = req->result + req->result_len;
+	dec.msg = NULL;
+	(void)worker_decode_safe(ctx, &dec);
+	/* [ int resolve reject cache value ] */
+	if (req->failed)
+	{
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "%s", duk_get_string(ctx, -1));
+		/* [ int resolve reject cache string err ] */
+		duk_dup(ctx, 2);
+	}
+	else
+	{
+		duk_dup(ctx, 1);
+	}
+	/* [ int resolve reject cache value/err resolve/reject ] */
+	duk_insert(ctx, -2);
+	duk_call(ctx, 1);
+	return 0;
+}
+
+/*
+ * Finalizer of offload request
+ */
+DUK_LOCAL void worker_offload_finalize(duk_context *ctx, worker_offload_req *req)
+{
+	free(req->bytecode);
+	free(req->args);
+	free(req->result);
+	worker_heap_pool_unref(req->pool);
+}
+
+/*
+ * Queue offload request (in safe call)
+ */
+DUK_LOCAL duk_ret_t worker_offload_queue_safe(duk_context *ctx, void *udata)
+{
+	/* [ ... resolve reject ] */
+	dux_queue_work(ctx,
+			(dux_work_t *)udata, sizeof(worker_offload_req),
+			(dux_work_cb)worker_offload_work_cb,
+			(dux_after_work_cb)worker_offload_after_work_cb, 2,
+			(dux_work_finalizer)worker_offload_finalize);
+	return 0;
+}
+
+/*
+ * Entry of worker_threads.offload()
+ */
+DUK_LOCAL duk_ret_t worker_offload(duk_context *ctx)
+{
+	worker_offload_req req;
+	worker_encoder enc;
+	const void *bytecode;
+	duk_idx_t nargs;
+	duk_idx_t index;
+
+	/* [ func arg1 ... argN ] */
+	nargs = duk_get_top(ctx) - 1;
+	if (nargs < 0)
+	{
+		return DUK_RET_TYPE_ERROR;
+	}
+	/* Bytecode is never accepted from script (duk_load_function() does not validate it) */
+	duk_require_function(ctx, 0);
+	duk_dup(ctx, 0);
+	duk_dump_function(ctx);
+	duk_replace(ctx, 0);
+	duk_push_array(ctx);
+	for (index = 0; index < nargs; ++index)
+	{
+		duk_dup(ctx, index + 1);
+		duk_put_prop_index(ctx, -2, (duk_uarridx_t)index);
+	}
+	duk_push_undefined(ctx);
+	/* [ bytecode arg1 ... argN args undefined ] */
+	memset(&enc, 0, sizeof(enc));
+	if (duk_safe_call(ctx, worker_encode_safe, &enc, 2, 1) != DUK_EXEC_SUCCESS)
+	{
+		worker_encoder_cleanup(&enc);
+		return duk_throw(ctx);
+	}
+	duk_pop(ctx);
+	/* [ bytecode arg1 ... argN ] */
+
+	memset(&req, 0, sizeof(req));
+	req.args = enc.data;
+	req.args_len = enc.len;
+	bytecode = duk_get_buffer_data(ctx, 0, &req.bytecode_len);
+	req.bytecode = (duk_uint8_t *)malloc((req.bytecode_len > 0) ? req.bytecode_len : 1);
+	if (!req.bytecode)
+	{
+		free(req.args);
+		return duk_error(ctx, DUK_ERR_ERROR, "cannot allocate memory for bytecode");
+	}
+	memcpy(req.bytecode, bytecode, req.bytecode_len);
+	req.pool = worker_get_heap_pool(ctx);
+	++req.pool->refs;
+
+	dux_promise_new(ctx);
+	/* [ bytecode arg1 ... argN promise resolve reject ] */
+	if (duk_safe_call(ctx, worker_offload_queue_safe, &req, 2, 1) != DUK_EXEC_SUCCESS)
+	{
+		/* [ bytecode arg1 ... argN promise err ] */
+		worker_offload_finalize(ctx, &req);
+		return duk_throw(ctx);
+	}
+	duk_pop(ctx);
+	/* [ bytecode arg1 ... argN promise ] */
+	return 1; /* return promise */
+}
+
+/*
+ * List of methods for worker_threads module
+ */
+DUK_LOCAL const duk_function_list_entry worker_funcs[] = {
+	{ "offload", worker_offload, DUK_VARARGS },
+	{ NULL, NULL, 0 }
+};
+#endif  /* !DUX_OPT_NO_WORK && !DUX_OPT_NO_PROMISE && !DUX_OPT_STANDARD_PROMISE */
+
+/*
+ * Getter of worker_threads.parentPort
+ */
+DUK_LOCAL duk_ret_t worker_parentPort_getter(duk_context *ctx)
+{
+	/* [  ] */
+	worker_push_named(ctx);
+	/* [ named ] */
+	if (!duk_get_prop_string(ctx, 0, DUX_WORKER_PARENT_NAME))
+	{
+		duk_push_null(ctx);
+	}
+	return 1; /* return port/null */
+}
+
+/*
+ * Getter of worker_threads.isMainThread
+ */
+DUK_LOCAL duk_ret_t worker_isMainThread_getter(duk_context *ctx)
+{
+	/* [  ] */
+	worker_push_named(ctx);
+	/* [ named ] */
+	duk_push_boolean(ctx, !duk_has_prop_string(ctx, 0, DUX_WORKER_PARENT_NAME));
+	return 1; /* return bool */
+}
+
+/*
+ * Getter of worker_threads.ports
+ */
+DUK_LOCAL duk_ret_t worker_ports_getter(duk_context *ctx)
+{
+	worker_push_named(ctx);
+	return 1; /* return named */
+}
+
+/*
+ * List of properties for worker_threads module
+ */
+DUK_LOCAL const dux_property_list_entry worker_props[] = {
+	{ "isMainThread", worker_isMainThread_getter, NULL },
+	{ "parentPort", worker_parentPort_getter, NULL },
+	{ "ports", worker_ports_getter, NULL },
+	{ NULL, NULL, NULL }
+};
+
+/*
+ * Entry of worker_threads module
+ */
+DUK_LOCAL duk_errcode_t worker_entry(duk_context *ctx)
+{
+	/* [ require module exports ] */
+	duk_dup(ctx, 0);
+	duk_push_string(ctx, "events");
+	duk_call(ctx, 1);
+	/* [ require module exports EventEmitter ] */
+	dux_push_inherited_named_c_constructor(
+			ctx, 3, "MessagePort", worker_port_constructor, 0,
+			NULL, worker_port_funcs, NULL, NULL);
+	/* [ require module exports EventEmitter MessagePort ] */
+	duk_push_heap_stash(ctx);
+	duk_dup(ctx, 4);
+	duk_put_prop_string(ctx, 5, DUX_IPK_WORKER_CLASS);
+	duk_pop(ctx);
+	duk_put_prop_string(ctx, 2, "MessagePort");
+	/* [ require module exports EventEmitter ] */
+	dux_push_named_c_constructor(
+			ctx, "MessageChannel", worker_channel_constructor, 0,
+			NULL, NULL, NULL, NULL);
+	duk_put_prop_string(ctx, 2, "MessageChannel");
+#if !defined(DUX_OPT_NO_WORK) && !defined(DUX_OPT_NO_PROMISE) && !defined(DUX_OPT_STANDARD_PROMISE)
+	duk_put_function_list(ctx, 2, worker_funcs);
+#endif
+	dux_put_property_list(ctx, 2, worker_props);
+	return DUK_ERR_NONE;
+}
+
+/*
+ * Initialize worker_threads module
+ */
+DUK_INTERNAL duk_errcode_t dux_worker_threads_init(duk_context *ctx)
+{
+	return dux_modules_register(ctx, "worker_threads", worker_entry);
+}
+
+/*
+ * Tick handler for worker_threads module
+ */
+DUK_INTERNAL duk_int_t dux_worker_threads_tick(duk_context *ctx)
+{
+	duk_int_t result = DUX_TICK_RET_JOBLESS;
+
+	/* [ ... ] */
+	duk_push_heap_stash(ctx);
+	if (!duk_get_prop_string(ctx, -1, DUX_IPK_WORKER_OPEN))
+	{
+		duk_pop_2(ctx);
+		return DUX_TICK_RET_JOBLESS;
+	}
+	/* [ ... stash open ] */
+	duk_enum(ctx, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+	/* [ ... stash open enum ] */
+	while (duk_next(ctx, -1, 1))
+	{
+		/* [ ... stash open enum key port ] */
+		if (worker_port_receive(ctx, -1))
+		{
+			result = DUX_TICK_RET_CONTINUE;
+		}
+		duk_pop_2(ctx);
+	}
+	duk_pop_3(ctx);
+	/* [ ... ] */
+	return result;
+}
+
+#endif  /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS && !DUX_OPT_NO_WORKER_THREADS */
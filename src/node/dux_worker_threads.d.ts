@@ -0,0 +1,73 @@
+declare namespace Dux {
+    class MessagePort extends Dux.EventEmitter {
+        /**
+         * Sends a value to the other port.
+         * Values are cloned (functions cannot be sent).
+         * @param value A value to send
+         * @param transferList ArrayBuffers to be moved to the receiver.
+         *                     They become empty (zero length) after sending.
+         */
+        postMessage(value: any, transferList?: ArrayBuffer[]): void;
+
+        /**
+         * Disconnects the port. 'close' event is emitted on both ports.
+         */
+        close(): void;
+
+        /**
+         * Keeps event loop alive while the port is open (default).
+         */
+        ref(): void;
+
+        /**
+         * Allows event loop to finish even if the port is open.
+         */
+        unref(): void;
+
+        /**
+         * Starts receiving messages (Messages are always delivered, provided for compatibility).
+         */
+        start(): void;
+    }
+
+    class MessageChannel {
+        /**
+         * Pair of ports connected to each other
+         */
+        readonly port1: Dux.MessagePort;
+        readonly port2: Dux.MessagePort;
+    }
+
+    module WorkerThreads {
+        /**
+         * false if the host attached a port named "parent"
+         */
+        const isMainThread: boolean;
+
+        /**
+         * Port named "parent" (or null)
+         */
+        const parentPort: Dux.MessagePort | null;
+
+        /**
+         * Ports attached by host (dux_channel_attach)
+         */
+        const ports: { [name: string]: Dux.MessagePort };
+
+        /**
+         * Runs function in a secondary heap on worker thread.
+         * The function is passed as bytecode, so it cannot refer variables outside of it.
+         * Arguments and return value are cloned like postMessage().
+         * @param func An ECMAScript function
+         * @param args Arguments for func
+         * @return A promise resolved with the return value of func
+         */
+        function offload(func: Function, ...args: any[]): Promise<any>;
+
+        const MessageChannel: typeof Dux.MessageChannel;
+        const MessagePort: typeof Dux.MessagePort;
+    }
+}
+declare module "worker_threads" {
+    export = Dux.WorkerThreads;
+}
@@ -0,0 +1,33 @@
+#ifndef DUX_WORKER_THREADS_H_INCLUDED
+#define DUX_WORKER_THREADS_H_INCLUDED
+
+#if !defined(DUX_OPT_NO_NODEJS_MODULES) && !defined(DUX_OPT_NO_EVENTS) && !defined(DUX_OPT_NO_WORKER_THREADS)
+
+/*
+ * Constants
+ */
+
+#if !defined(DUX_WORKER_MAX_DEPTH)
+#define DUX_WORKER_MAX_DEPTH        32  /* Nesting of objects in one message */
+#endif
+
+#if !defined(DUX_WORKER_MAX_TRANSFERS)
+#define DUX_WORKER_MAX_TRANSFERS    8   /* Length of transferList */
+#endif
+
+/*
+ * Functions
+ */
+
+DUK_INTERNAL_DECL duk_errcode_t dux_worker_threads_init(duk_context *ctx);
+DUK_INTERNAL_DECL duk_int_t dux_worker_threads_tick(duk_context *ctx);
+#define DUX_INIT_WORKER_THREADS dux_worker_threads_init,
+#define DUX_TICK_WORKER_THREADS DUX_TICK_HANDLER(dux_worker_threads_tick, "worker_threads")
+
+#else   /* !DUX_OPT_NO_NODEJS_MODULES && !DUX_OPT_NO_EVENTS && !DUX_OPT_NO_WORKER_THREADS */
+
+#define DUX_INIT_WORKER_THREADS
+#define DUX_TICK_WORKER_THREADS
+
+#endif  /* DUX_OPT_NO_NODEJS_MODULES || DUX_OPT_NO_EVENTS || DUX_OPT_NO_WORKER_THREADS */
+#endif  /* !DUX_WORKER_THREADS_H_INCLUDED */
@@ -3,14 +3,33 @@
 #include "../dux_internal.h"
 #include <windows.h>
 
+DUK_LOCAL duk_uint64_t g_counter_freq;
+
 DUK_INTERNAL void dux_timer_arch_init(void)
 {
+    LARGE_INTEGER freq;
+
     timeBeginPeriod(1);
+    if (QueryPerformanceFrequency(&freq))
+    {
+        g_counter_freq = (duk_uint64_t)freq.QuadPart;
+    }
 }
 
-DUK_INTERNAL duk_uint_t dux_timer_arch_current(void)
+DUK_INTERNAL duk_uint64_t dux_timer_arch_current_ns(void)
 {
-    return timeGetTime();
+    LARGE_INTEGER counter;
+    duk_uint64_t value;
+
+    if ((g_counter_freq == 0) || (!QueryPerformanceCounter(&counter)))
+    {
+        return (duk_uint64_t)timeGetTime() * 1000000ULL;
+    }
+    value = (duk_uint64_t)counter.QuadPart;
+
+    /* Split to avoid overflow of (counter * 1e9) */
+    return ((value / g_counter_freq) * 1000000000ULL) +
+        (((value % g_counter_freq) * 1000000000ULL) / g_counter_freq);
 }
 
 #endif  /* !DUX_OPT_NO_TIMER && __WIN32__ */
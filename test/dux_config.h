@@ -4,4 +4,7 @@
 #undef DUK_INTERNAL_DECL
 #define DUK_INTERNAL_DECL extern
 
+// Test deferred initialization of process and Promise
+#define DUX_ENABLE_LAZY_GLOBALS
+
 #include "../dist/dux_config.h"
@@ -0,0 +1,2 @@
+exports.self = "bundle1.js";
+exports.sub = require("./sub/bundle2");
@@ -0,0 +1,8 @@
+var global = (function(){ return this; })();
+global.__hot1_evals = (global.__hot1_evals || 0) + 1;
+module.hot.accept();
+module.hot.dispose(function(data){
+    data.evals = global.__hot1_evals;
+});
+exports.dep = require("./hot2");
+exports.data = module.hot.data;
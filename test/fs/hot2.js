@@ -0,0 +1,3 @@
+var global = (function(){ return this; })();
+global.__hot2_evals = (global.__hot2_evals || 0) + 1;
+exports.evals = global.__hot2_evals;
@@ -0,0 +1 @@
+exports.dep = require("./hot2");
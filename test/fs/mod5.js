@@ -0,0 +1,2 @@
+exports.self = "mod5.js";
+return exports.self;
@@ -0,0 +1,2 @@
+exports.self = "bundle2.js";
+exports.core = require("path");
@@ -22,6 +22,36 @@ describe("Modules", () => {
         let obj = require("/mod1.json");
         assert.deepEqual(obj, {self: "mod1.json"});
     });
+    it("can load JSON object in chunks", () => {
+        let obj = require("/json2.json");
+        assert.equal(obj.name, "streaming parser test with a string longer than one chunk");
+        assert.equal(obj.escaped, "quote\" backslash\\ slash/ \b\f\n\r\t A\u00e9\u3042");
+        assert.equal(obj.utf8, "\u65e5\u672c\u8a9e\u30c6\u30ad\u30b9\u30c8");
+        assert.deepEqual(obj.numbers, [0, -1, 12345678, 3.25, -0.5e-3, 100]);
+        assert.deepEqual(obj.mixed, [1, 2, "three", [4, [5]], {six: 6}]);
+        assert.deepEqual(obj.literals, {t: true, f: false, n: null});
+        assert.deepEqual(obj.empty, {object: {}, array: []});
+        assert.isTrue(Object.prototype.hasOwnProperty.call(obj, "__proto__"));
+        assert.strictEqual(Object.getPrototypeOf(obj), Object.prototype);
+    });
+    it("caches JSON object", () => {
+        let obj_a = require("/json2.json");
+        let obj_b = require("/json2");
+        assert.strictEqual(obj_a, obj_b);
+    });
+    it("throws SyntaxError when JSON is invalid", () => {
+        assert.throws(() => require("/json3.json"), SyntaxError);
+    });
+    it("can load numeric arrays in JSON as Float64Array", () => {
+        let read_json: (path: string, typed_array_min: number) => any;
+        read_json = (function(){return this})().__read_json;
+        let obj = read_json("/json2.json", 3);
+        assert.instanceOf(obj.numbers, Float64Array);
+        assert.deepEqual(Array.prototype.slice.call(obj.numbers), [0, -1, 12345678, 3.25, -0.5e-3, 100]);
+        assert.isArray(obj.mixed);
+        assert.isArray(obj.mixed[3][1]);
+        assert.isArray(obj.empty.array);
+    });
     it("can load module (without .js extension)", () => {
         let mod = require("/mod1");
         assert.equal(mod.self, "mod1");
@@ -51,6 +81,38 @@ describe("Modules", () => {
     it("throws Error when module not found", () => {
         assert.throws(() => require("/not_exists"), Error);
     });
+    it("throws Error when module not found again", () => {
+        assert.throws(() => require("/not_exists"), Error);
+    });
+    it("caches module resolved with .js fallback", () => {
+        let mod_a = require("/mod2");
+        let mod_b = require("/mod2");
+        assert.strictEqual(mod_a, mod_b);
+        assert.strictEqual(mod_a, require("/mod2.js"));
+    });
+    let memory_stats: () => {[name: string]: number};
+    memory_stats = (function(){return this})().__memory_stats;
+    it("records heap usage of core module instantiation", () => {
+        require("path");
+        let stats = memory_stats();
+        assert.isAbove(stats["(initialize)"], 0);
+        assert.isAbove(stats["path"], 0);
+    });
+    it("records heap usage of lazy globals on first access", () => {
+        let global = (function(){return this})();
+        assert.isObject(process);
+        assert.isFunction(Promise);
+        let stats = memory_stats();
+        assert.isAbove(stats["process"], 0);
+        assert.isAbove(stats["Promise"], 0);
+        assert.strictEqual(Object.getOwnPropertyDescriptor(global, "process").value, process);
+    });
+    it("can load bundled module", () => {
+        let mod = require("/bundle1");
+        assert.equal(mod.self, "bundle1.js");
+        assert.equal(mod.sub.self, "bundle2.js");
+        assert.strictEqual(mod.sub.core, require("path"));
+    });
 
     const DUK_EXEC_SUCCESS = 0;
     const DUK_EXEC_ERROR = 1;
@@ -77,6 +139,36 @@ describe("Modules", () => {
             assert.notInstanceOf(o.retval, Error);
         });
     });
+    describe("bytecode cache", () => {
+        interface BytecodeCacheStat {
+            writes: number; // number of stored bytecode
+            hits: number;   // number of loaded bytecode
+        }
+        let bytecode_cache_stat: () => BytecodeCacheStat;
+        bytecode_cache_stat = (function(){return this})().__bytecode_cache_stat;
+
+        it("is stored when .js module is compiled", () => {
+            let before = bytecode_cache_stat();
+            let o = eval_mod_caller({}, 0, "/mod5.js");
+            assert.equal(o.retval, "mod5.js");
+            let after = bytecode_cache_stat();
+            assert.equal(after.writes, before.writes + 1);
+            assert.equal(after.hits, before.hits);
+        });
+        it("is used instead of source", () => {
+            let before = bytecode_cache_stat();
+            let o = eval_mod_caller({}, 0, "/mod5.js");
+            assert.equal(o.retval, "mod5.js");
+            let after = bytecode_cache_stat();
+            assert.equal(after.writes, before.writes);
+            assert.equal(after.hits, before.hits + 1);
+        });
+        it("is not stored for module with syntax error", () => {
+            let before = bytecode_cache_stat();
+            assert.throws(() => require("/mod4.js"), SyntaxError);
+            assert.equal(bytecode_cache_stat().writes, before.writes);
+        });
+    });
     describe("dux_eval_module_file_noresult()", () => {
         it("succeeds for existing file", () => {
             let o = eval_mod_caller({}, 1, "/dummy/../mod1.js");
@@ -112,4 +204,39 @@ describe("Modules", () => {
             assert.equal(o.pushed, 0);
         });
     });
+    describe("hot reload", () => {
+        let global: any = (function(){ return this; })();
+        let reload_module: (filename: string) => number = global.__reload_module;
+        it("has module.hot object", () => {
+            assert.isFunction(module.hot.accept);
+            assert.isFunction(module.hot.dispose);
+        });
+        it("re-evaluates changed module and accepting dependent", () => {
+            let old_hot1 = require("/hot1");
+            assert.equal(global.__hot1_evals, 1);
+            assert.equal(old_hot1.dep.evals, 1);
+            assert.isUndefined(old_hot1.data);
+            assert.equal(reload_module("/hot2.js"), DUK_EXEC_SUCCESS);
+            assert.equal(global.__hot1_evals, 2);
+            assert.equal(global.__hot2_evals, 2);
+            let new_hot1 = require("/hot1");
+            assert.notStrictEqual(new_hot1, old_hot1);
+            assert.equal(new_hot1.dep.evals, 2);
+            assert.deepEqual(new_hot1.data, {evals: 1});
+        });
+        it("reports update which is not accepted", () => {
+            let old_hot3 = require("/hot3");
+            assert.strictEqual(require.cache["/hot3.js"].exports, old_hot3);
+            assert.equal(reload_module("/hot2.js"), DUK_EXEC_ERROR);
+            assert.isUndefined(require.cache["/hot3.js"]);
+            assert.notStrictEqual(require("/hot3"), old_hot3);
+        });
+        it("reloads module after deletion from require.cache", () => {
+            let old_hot2 = require("/hot2");
+            delete require.cache["/hot2.js"];
+            let new_hot2 = require("/hot2");
+            assert.notStrictEqual(new_hot2, old_hot2);
+            assert.equal(new_hot2.evals, old_hot2.evals + 1);
+        });
+    });
 });
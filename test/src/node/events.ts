@@ -146,5 +146,160 @@ describe("Events", () => {
             assert.isTrue(e.emit("bar"));
             assert.strictEqual(seq, 2);
         });
+        it("calls once listener only once", () => {
+            let e = new EventEmitter();
+            let count = 0;
+            e.once("bar", () => {
+                ++count;
+                e.emit("bar");
+            });
+            e.on("bar", () => {});
+            assert.isTrue(e.emit("bar"));
+            assert.strictEqual(count, 1);
+            assert.strictEqual(e.listenerCount("bar"), 1);
+        });
+        it("keeps order after adding and removing many listeners", () => {
+            let e = new EventEmitter();
+            let calls = [];
+            let listeners = [];
+            e.setMaxListeners(100);
+            for (let i = 0; i < 40; ++i) {
+                listeners.push(() => calls.push(i));
+                e.on("bar", listeners[i]);
+            }
+            for (let i = 0; i < 40; i += 2) {
+                e.removeListener("bar", listeners[i]);
+            }
+            e.prependOnceListener("bar", () => calls.push(-1));
+            assert.strictEqual(e.listenerCount("bar"), 21);
+            assert.isTrue(e.emit("bar"));
+            assert.strictEqual(e.listenerCount("bar"), 20);
+            assert.deepEqual(calls, [-1].concat(listeners.map((f, i) => i).filter((i) => i % 2)));
+        });
+        it("is not affected by prepending listener in callback", () => {
+            let e = new EventEmitter();
+            let calls = [];
+            e.once("bar", () => {
+                calls.push(1);
+                e.prependListener("bar", () => calls.push(0));
+            });
+            e.on("bar", () => calls.push(2));
+            assert.isTrue(e.emit("bar"));
+            assert.deepEqual(calls, [1, 2]);
+            assert.isTrue(e.emit("bar"));
+            assert.deepEqual(calls, [1, 2, 0, 2]);
+        });
+        it("returns unwrapped once listeners by listeners()", () => {
+            let e = new EventEmitter();
+            let listener = () => {};
+            e.once("bar", listener);
+            assert.deepEqual(e.listeners("bar"), [listener]);
+            e.removeListener("bar", listener);
+            assert.isFalse(e.emit("bar"));
+        });
+    });
+    describe("emitBatch()", () => {
+        it("calls listeners for each set of arguments", () => {
+            let e = new EventEmitter();
+            let received = [];
+            let once = [];
+            e.on("data", (a, b) => { received.push([a, b]); });
+            e.once("data", (a) => { once.push(a); });
+            assert.isTrue(e.emitBatch("data", [[1, 2], [3, 4], 5]));
+            assert.deepEqual(received, [[1, 2], [3, 4], [5, undefined]]);
+            assert.deepEqual(once, [1]);
+            assert.strictEqual(e.listenerCount("data"), 1);
+        });
+        it("returns false when event has no listener", () => {
+            let e = new EventEmitter();
+            assert.isFalse(e.emitBatch("data", [[1]]));
+        });
+        it("throws TypeError for non-array", () => {
+            let e = new EventEmitter();
+            assert.throws(() => e.emitBatch("data", <any>1), TypeError);
+        });
+    });
+    describe("setCoalescing()", () => {
+        it("emits events queued in one tick by single batch", (done) => {
+            let e = new EventEmitter();
+            let received = [];
+            assert.strictEqual(e.setCoalescing("data", true), e);
+            e.on("data", (value) => { received.push(value); });
+            assert.isTrue(e.emit("data", 1));
+            assert.isTrue(e.emit("data", 2));
+            assert.deepEqual(received, []);
+            setTimeout(() => {
+                try {
+                    assert.deepEqual(received, [1, 2]);
+                } catch (reason) {
+                    return done(reason);
+                }
+                done();
+            }, 0);
+        });
+        it("does not affect other events", () => {
+            let e = new EventEmitter();
+            let count = 0;
+            e.setCoalescing("data", true);
+            e.on("end", () => { ++count; });
+            assert.isTrue(e.emit("end"));
+            assert.strictEqual(count, 1);
+        });
+        it("emits synchronously after disabled", () => {
+            let e = new EventEmitter();
+            let count = 0;
+            e.setCoalescing("data", true).setCoalescing("data", false);
+            e.on("data", () => { ++count; });
+            e.emit("data");
+            assert.strictEqual(count, 1);
+        });
+    });
+    describe("emit() with throwing listener", () => {
+        it("calls remaining listeners and emits error event", () => {
+            let e = new EventEmitter();
+            let error = new Error("foo");
+            let seq = 0;
+            let caught;
+            e.on("error", (reason) => { caught = reason; });
+            e.on("bar", () => { ++seq; throw error; });
+            e.on("bar", () => { ++seq; });
+            assert.isTrue(e.emit("bar"));
+            assert.strictEqual(seq, 2);
+            assert.strictEqual(caught, error);
+        });
+        it("throws error event without listener", () => {
+            let e = new EventEmitter();
+            let error = new Error("foo");
+            assert.throws(() => e.emit("error", error), error);
+            assert.throws(() => e.emit("error", "bar"), Error);
+        });
+    });
+    describe("setProfiling()", () => {
+        it("records dispatches and listener calls per event", () => {
+            let e = new EventEmitter();
+            assert.deepEqual(e.stats(), {});
+            assert.strictEqual(e.setProfiling(true), e);
+            e.on("bar", () => {});
+            e.on("bar", () => {});
+            e.emit("bar");
+            e.emitBatch("bar", [[1], [2]]);
+            e.emit("baz");
+            let stats = e.stats();
+            assert.deepEqual(Object.keys(stats), ["bar"]);
+            assert.strictEqual(stats.bar.count, 2);
+            assert.strictEqual(stats.bar.calls, 6);
+            assert.isAtLeast(stats.bar.time, 0);
+            e.setProfiling(false);
+            assert.deepEqual(e.stats(), {});
+        });
+        it("is enabled for new emitters by EventEmitter.profiling", () => {
+            EventEmitter.profiling = true;
+            let e = new EventEmitter();
+            EventEmitter.profiling = false;
+            e.on("bar", () => {});
+            e.emit("bar");
+            assert.strictEqual(e.stats().bar.count, 1);
+            assert.deepEqual(new EventEmitter().stats(), {});
+        });
     });
 });
@@ -0,0 +1,84 @@
+import * as perf_hooks from "perf_hooks";
+
+describe("PerfHooks", () => {
+    describe("monitorEventLoopDelay()", () => {
+        it("is a function with no argument", () => {
+            assert.isFunction(perf_hooks.monitorEventLoopDelay);
+            assert.equal(perf_hooks.monitorEventLoopDelay.length, 0);
+        });
+        it("returns the same histogram", () => {
+            assert.strictEqual(perf_hooks.monitorEventLoopDelay(), perf_hooks.monitorEventLoopDelay());
+        });
+        it("records timer lateness while enabled", (done) => {
+            let h = perf_hooks.monitorEventLoopDelay();
+            h.reset();
+            assert.isTrue(h.enable());
+            setTimeout(() => {
+                assert.isTrue(h.disable());
+                assert.equal(h.count, 1);
+                assert.isAtLeast(h.max, h.min);
+                assert.isAtLeast(h.percentile(100), h.min);
+                done();
+            }, 1);
+        });
+    });
+    describe("monitorTickDuration()", () => {
+        it("is a function with no argument", () => {
+            assert.isFunction(perf_hooks.monitorTickDuration);
+            assert.equal(perf_hooks.monitorTickDuration.length, 0);
+        });
+        it("returns a histogram different from event loop delay", () => {
+            assert.notStrictEqual(perf_hooks.monitorTickDuration(), perf_hooks.monitorEventLoopDelay());
+        });
+        it("records nothing while disabled", (done) => {
+            let h = perf_hooks.monitorTickDuration();
+            h.reset();
+            setImmediate(() => {
+                assert.equal(h.count, 0);
+                assert.equal(h.mean, 0);
+                assert.equal(h.stddev, 0);
+                done();
+            });
+        });
+        it("records tick durations while enabled", (done) => {
+            let h = perf_hooks.monitorTickDuration();
+            h.reset();
+            h.enable();
+            setImmediate(() => {
+                setImmediate(() => {
+                    h.disable();
+                    assert.isAtLeast(h.count, 1);
+                    done();
+                });
+            });
+        });
+    });
+    describe("Histogram", () => {
+        it("throws RangeError for invalid percentile", () => {
+            let h = perf_hooks.monitorTickDuration();
+            assert.throws(() => h.percentile(0), RangeError);
+            assert.throws(() => h.percentile(101), RangeError);
+        });
+    });
+    describe("setLongTaskCallback()", () => {
+        it("is a function with 2 arguments", () => {
+            assert.isFunction(perf_hooks.setLongTaskCallback);
+            assert.equal(perf_hooks.setLongTaskCallback.length, 2);
+        });
+        it("throws TypeError when called with non-function callback", () => {
+            assert.throws(() => perf_hooks.setLongTaskCallback(1, <any>123), TypeError);
+        });
+        it("calls callback after a long tick", (done) => {
+            perf_hooks.setLongTaskCallback(1, (duration) => {
+                perf_hooks.setLongTaskCallback(1);
+                assert.isAtLeast(duration, 1);
+                done();
+            });
+            setImmediate(() => {
+                let start = Date.now();
+                while ((Date.now() - start) < 5) {
+                }
+            });
+        });
+    });
+});
@@ -22,6 +22,67 @@ describe("process", () => {
         it("is a number", () => assert.isNumber(process.exitCode));
     });
 
+    describe("hrtime()", () => {
+        it("is a function", () => assert.isFunction(process.hrtime));
+        it("returns [seconds, nanoseconds]", () => {
+            let time = process.hrtime();
+            assert.equal(time.length, 2);
+            assert.isNumber(time[0]);
+            assert.isNumber(time[1]);
+            assert.isTrue(time[1] < 1000000000);
+        });
+        it("returns difference from previous time", () => {
+            let prev = process.hrtime();
+            let diff = process.hrtime(prev);
+            assert.isTrue(diff[0] * 1000000000 + diff[1] >= 0);
+            assert.isTrue(diff[0] < 1);
+        });
+        it("has bigint() which returns nanoseconds", () => {
+            let a = process.hrtime.bigint();
+            let b = process.hrtime.bigint();
+            assert.isNumber(a);
+            assert.isTrue(b >= a);
+        });
+    });
+
+    describe("loopStats()", () => {
+        it("is a function", () => assert.isFunction(process.loopStats));
+        it("returns statistics of tick handlers", (done) => {
+            process.nextTick(() => {
+                process.nextTick(() => {
+                    let stats = process.loopStats();
+                    try {
+                        assert.property(stats, "process");
+                        assert.isTrue(stats.process.calls > 0);
+                        assert.isTrue(stats.process.jobs > 0);
+                        assert.isTrue(stats.process.maxTime <= stats.process.totalTime);
+                        done();
+                    } catch (error) {
+                        done(error);
+                    }
+                });
+            });
+        });
+    });
+
+    describe("promiseQueueDepth()", () => {
+        it("is a function", () => assert.isFunction(process.promiseQueueDepth));
+        it("counts queued promise jobs", (done) => {
+            let base = process.promiseQueueDepth();
+            Promise.resolve().then(() => {});
+            Promise.resolve().then(() => {});
+            assert.strictEqual(process.promiseQueueDepth(), base + 2);
+            setTimeout(() => {
+                try {
+                    assert.strictEqual(process.promiseQueueDepth(), 0);
+                    done();
+                } catch (error) {
+                    done(error);
+                }
+            }, 0);
+        });
+    });
+
     describe("nextTick()", () => {
         it("is a function", () => assert.isFunction(process.nextTick));
         it("invokes callback with correct arguments", (done) => {
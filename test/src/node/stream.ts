@@ -1,4 +1,4 @@
-/*import * as stream from "stream";
+import * as stream from "stream";
 
 describe("stream", () => {
     it("exists", () => {
@@ -7,5 +7,319 @@ describe("stream", () => {
     it("has circular reference", () => {
         assert.strictEqual(stream, stream.Stream);
     });
+    describe("Writable", () => {
+        it("calls _write for each chunk in order", (done) => {
+            let written: string[] = [];
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    written.push(chunk.toString());
+                    callback();
+                }
+            });
+            w.write("foo");
+            w.write("bar");
+            w.end("baz", () => {
+                assert.deepEqual(written, ["foo", "bar", "baz"]);
+                done();
+            });
+        });
+        it("returns false and emits 'drain' when highWaterMark is reached", (done) => {
+            let pending: Function[] = [];
+            let w = new stream.Writable({
+                highWaterMark: 4,
+                write(chunk, encoding, callback) {
+                    pending.push(callback);
+                }
+            });
+            assert.isTrue(w.write("ab"));
+            assert.isFalse(w.write("cd"));
+            assert.strictEqual(w.writableLength, 4);
+            w.on("drain", () => {
+                assert.strictEqual(w.writableLength, 0);
+                done();
+            });
+            setTimeout(() => {
+                pending.shift()();
+                setTimeout(() => pending.shift()(), 0);
+            }, 0);
+        });
+        it("calls _writev with gathered chunks after uncork()", (done) => {
+            let batches: number[] = [];
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    batches.push(1);
+                    callback();
+                },
+                writev(chunks, callback) {
+                    batches.push(chunks.length);
+                    callback();
+                }
+            });
+            w.cork();
+            w.write("a");
+            w.write("b");
+            w.write("c");
+            assert.deepEqual(batches, []);
+            w.uncork();
+            w.end(() => {
+                assert.deepEqual(batches, [3]);
+                done();
+            });
+        });
+        it("passes strings as Buffer", (done) => {
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    assert.instanceOf(chunk, Buffer);
+                    assert.strictEqual(encoding, "buffer");
+                    assert.strictEqual(chunk.toString(), "foo");
+                    callback();
+                    done();
+                }
+            });
+            w.write("foo", "utf8");
+        });
+        it("emits 'error' when _write is not a function", (done) => {
+            let w: any = new stream.Writable({
+                write(chunk, encoding, callback) { callback(); }
+            });
+            w._write = null;
+            w.on("error", (err) => {
+                assert.instanceOf(err, TypeError);
+                assert.strictEqual(w.writableLength, 0);
+                done();
+            });
+            w.write("x");
+        });
+        it("throws TypeError for unsupported encoding", () => {
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) { callback(); }
+            });
+            assert.throws(() => w.write("deadbeef", "hex"), TypeError);
+            assert.throws(() => w.setDefaultEncoding("base64"), TypeError);
+            assert.strictEqual(w.writableLength, 0);
+        });
+        it("emits 'error' when _write fails", (done) => {
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    callback(new Error("failed"));
+                }
+            });
+            w.on("error", (err) => {
+                assert.strictEqual(err.message, "failed");
+                done();
+            });
+            w.write("x");
+        });
+    });
+    describe("Readable", () => {
+        it("emits 'data' and 'end' in flowing mode", (done) => {
+            let source = ["foo", "bar"];
+            let received: string[] = [];
+            let r = new stream.Readable({
+                read() {
+                    this.push(source.length > 0 ? source.shift() : null);
+                }
+            });
+            r.setEncoding("utf8");
+            r.on("data", (chunk) => received.push(chunk));
+            r.on("end", () => {
+                assert.deepEqual(received, ["foo", "bar"]);
+                done();
+            });
+        });
+        it("returns buffered data by read()", () => {
+            let r = new stream.Readable({ read() {} });
+            r.push("abc");
+            r.push("def");
+            assert.strictEqual(r.readableLength, 6);
+            assert.strictEqual(r.read(4).toString(), "abcd");
+            assert.strictEqual(r.read(4), null);
+            assert.strictEqual(r.read().toString(), "ef");
+        });
+        it("returns Buffer by read()", () => {
+            let r = new stream.Readable({ read() {} });
+            r.push("abc");
+            r.push("def");
+            let chunk = r.read(4);
+            assert.instanceOf(chunk, Buffer);
+            assert.instanceOf(r.read(2), Buffer);
+        });
+        it("throws TypeError for unsupported encoding", () => {
+            let r = new stream.Readable({ read() {} });
+            assert.throws(() => r.setEncoding("hex"), TypeError);
+            assert.throws(() => r.push("deadbeef", "hex"), TypeError);
+            assert.throws(() => new stream.Readable({ encoding: "latin1", read() {} }), TypeError);
+            assert.strictEqual(r.readableLength, 0);
+        });
+        it("does not emit 'data' while paused", (done) => {
+            let r = new stream.Readable({ read() {} });
+            r.pause();
+            r.on("data", () => assert.fail());
+            r.push("abc");
+            setTimeout(() => {
+                assert.isTrue(r.isPaused());
+                assert.strictEqual(r.readableLength, 3);
+                done();
+            }, 0);
+        });
+    });
+    describe("pipe()", () => {
+        it("writes all chunks to destination and ends it", (done) => {
+            let source = ["foo", "bar", "baz"];
+            let written: string[] = [];
+            let r = new stream.Readable({
+                read() {
+                    this.push(source.length > 0 ? source.shift() : null);
+                }
+            });
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    written.push(chunk.toString());
+                    callback();
+                }
+            });
+            assert.strictEqual(r.pipe(w), w);
+            w.on("finish", () => {
+                assert.deepEqual(written, ["foo", "bar", "baz"]);
+                done();
+            });
+        });
+        it("pauses source while destination is full", (done) => {
+            let count = 0;
+            let written = 0;
+            let r = new stream.Readable({
+                highWaterMark: 2,
+                read() {
+                    this.push(count < 8 ? Buffer.from("ab") : null);
+                    ++count;
+                }
+            });
+            let w = new stream.Writable({
+                highWaterMark: 2,
+                write(chunk, encoding, callback) {
+                    assert.isAtMost(r.readableLength + w.writableLength, 6);
+                    written += chunk.length;
+                    setTimeout(callback, 0);
+                }
+            });
+            r.pipe(w);
+            w.on("finish", () => {
+                assert.strictEqual(written, 16);
+                done();
+            });
+        });
+        it("does not end destination with { end: false }", (done) => {
+            let r = new stream.Readable({ read() {} });
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) { callback(); }
+            });
+            r.pipe(w, { end: false });
+            r.push("abc");
+            r.push(null);
+            r.on("end", () => {
+                setTimeout(() => {
+                    assert.isTrue(w.write("def"));
+                    done();
+                }, 0);
+            });
+        });
+        it("writes strings decoded by setEncoding() of source", (done) => {
+            let chunks: any[] = [];
+            let r = new stream.Readable({ read() {} });
+            let w = new stream.Writable({
+                decodeStrings: false,
+                write(chunk, encoding, callback) {
+                    chunks.push(chunk);
+                    callback();
+                }
+            });
+            r.setEncoding("utf8");
+            r.pipe(w);
+            r.push("abc");
+            r.push(null);
+            w.on("finish", () => {
+                assert.deepEqual(chunks, ["abc"]);
+                done();
+            });
+        });
+        it("stops writing after unpipe()", (done) => {
+            let written: string[] = [];
+            let r = new stream.Readable({ read() {} });
+            let w = new stream.Writable({
+                write(chunk, encoding, callback) {
+                    written.push(chunk.toString());
+                    callback();
+                }
+            });
+            r.pipe(w);
+            r.push("foo");
+            setTimeout(() => {
+                r.unpipe(w);
+                r.push("bar");
+                setTimeout(() => {
+                    assert.deepEqual(written, ["foo"]);
+                    assert.strictEqual(r.readableLength, 3);
+                    done();
+                }, 0);
+            }, 0);
+        });
+    });
+    describe("native hooks", () => {
+        let attach: (stream: any, count?: number) => void = new Function("return this")().__attach_native_stream;
+        it("pipes chunks pushed by native _read to native _write", (done) => {
+            let r: any = new stream.Readable();
+            let w: any = new stream.Writable();
+            attach(r, 3);
+            attach(w);
+            r.pipe(w);
+            w.on("finish", () => {
+                assert.strictEqual(w.received, "000300020001");
+                assert.strictEqual(w.writes, 3);
+                done();
+            });
+        });
+        it("emits Buffer pushed by native _read", (done) => {
+            let r: any = new stream.Readable();
+            attach(r, 1);
+            r.on("data", (chunk) => {
+                assert.instanceOf(chunk, Buffer);
+                assert.strictEqual(chunk.toString(), "0001");
+            });
+            r.on("end", done);
+        });
+        it("gathers corked chunks to native _writev", (done) => {
+            let w: any = new stream.Writable();
+            attach(w);
+            w.cork();
+            w.write("a");
+            w.write("b");
+            w.uncork();
+            w.end("c", () => {
+                assert.strictEqual(w.received, "abc");
+                assert.strictEqual(w.writevs, 1);
+                assert.strictEqual(w.writes, 1);
+                done();
+            });
+        });
+    });
+    describe("Transform", () => {
+        it("pushes transformed chunks", (done) => {
+            let received = "";
+            let t = new stream.Transform({
+                transform(chunk, encoding, callback) {
+                    callback(null, chunk.toString().toUpperCase());
+                },
+                flush(callback) {
+                    callback(null, "!");
+                }
+            });
+            t.on("data", (chunk) => received += chunk.toString());
+            t.on("end", () => {
+                assert.strictEqual(received, "HELLO!");
+                done();
+            });
+            t.write("hel");
+            t.end("lo");
+        });
+    });
 });
-*/
\ No newline at end of file
@@ -22,6 +22,18 @@ describe("timers", () => {
             assert.isFunction(timeout.ref);
             assert.isFunction(timeout.unref);
         });
+        it("accepts fractional delay", (done) => {
+            let start = process.hrtime();
+            setTimeout(() => {
+                let diff = process.hrtime(start);
+                try {
+                    assert.isTrue(diff[0] > 0 || diff[1] >= 1500000);
+                    done();
+                } catch (error) {
+                    done(error);
+                }
+            }, 1.5);
+        });
         it("invokes callbacks in expiration order", (done) => {
             let i = 0;
             setTimeout(() => {
@@ -139,6 +151,37 @@ describe("timers", () => {
                 }, 100);
             }, 350);
         });
+        it("throws RangeError if unknown miss policy is specified", () => {
+            let timeout = setInterval(() => {}, 100);
+            try {
+                assert.throws(() => timeout.setMissPolicy(<any>"foo"), RangeError);
+            } finally {
+                clearInterval(timeout);
+            }
+        });
+        it("passes number of missed expirations with coalesce policy", (done) => {
+            let timeout = setInterval((missed) => {
+                clearInterval(timeout);
+                try {
+                    assert.isNumber(missed);
+                    assert.isTrue(missed >= 3);
+                    done();
+                } catch (error) {
+                    done(error);
+                }
+            }, 10).setMissPolicy("coalesce");
+            let start = process.hrtime.bigint();
+            while (process.hrtime.bigint() - start < 55000000) {
+                // Block event loop
+            }
+        });
+        it("accepts slack and returns itself", (done) => {
+            let timeout = setInterval(() => {
+                clearInterval(timeout);
+                done();
+            }, 10);
+            assert.strictEqual(timeout.setSlack(5), timeout);
+        });
     });
     describe("setImmediate", () => {
         let getTick = function() { return this.espresso_tick; };
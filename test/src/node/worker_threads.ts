@@ -0,0 +1,191 @@
+import * as worker_threads from "worker_threads";
+
+describe("WorkerThreads", () => {
+    it("is main thread without parent port", () => {
+        assert.isTrue(worker_threads.isMainThread);
+        assert.isNull(worker_threads.parentPort);
+    });
+    describe("MessageChannel", () => {
+        it("has two ports", () => {
+            let ch = new worker_threads.MessageChannel();
+            assert.instanceOf(ch.port1, worker_threads.MessagePort);
+            assert.instanceOf(ch.port2, worker_threads.MessagePort);
+            ch.port1.close();
+        });
+        it("clones structured values", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let value = { a: 1, b: -0.5, c: "str", d: [true, null, undefined], e: { f: [] } };
+            ch.port2.on("message", (received) => {
+                assert.notStrictEqual(received, value);
+                assert.deepEqual(received, value);
+                ch.port2.close();
+                done();
+            });
+            ch.port1.postMessage(value);
+        });
+        it("delivers messages in posted order", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let received = [];
+            ch.port2.on("message", (value) => {
+                received.push(value);
+                if (received.length === 3) {
+                    assert.deepEqual(received, [1, 2, 3]);
+                    ch.port1.close();
+                    done();
+                }
+            });
+            ch.port1.postMessage(1);
+            ch.port1.postMessage(2);
+            ch.port1.postMessage(3);
+        });
+        it("stops delivering messages after close() by listener", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let received = [];
+            ch.port2.on("message", (value) => {
+                received.push(value);
+                ch.port2.close();
+            });
+            ch.port2.on("close", () => {
+                setTimeout(() => {
+                    assert.deepEqual(received, [1]);
+                    done();
+                }, 0);
+            });
+            ch.port1.postMessage(1);
+            ch.port1.postMessage(2);
+            ch.port1.postMessage(3);
+        });
+        it("copies typed arrays", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let array = new Float64Array([1.5, 2.5]);
+            ch.port2.on("message", (received) => {
+                assert.instanceOf(received, Float64Array);
+                assert.equal(received.length, 2);
+                assert.equal(received[1], 2.5);
+                assert.equal(array.length, 2);
+                ch.port2.close();
+                done();
+            });
+            ch.port1.postMessage(array);
+        });
+        it("moves transferred ArrayBuffer", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let buf = new ArrayBuffer(4);
+            new Uint8Array(buf)[3] = 7;
+            ch.port2.once("message", (received) => {
+                assert.instanceOf(received.buffer, ArrayBuffer);
+                assert.equal(received.view[3], 7);
+                assert.strictEqual(received.view.buffer, received.buffer);
+                // Send it back without copy
+                ch.port2.postMessage(received.buffer, [received.buffer]);
+            });
+            ch.port1.on("message", (returned) => {
+                assert.equal(returned.byteLength, 4);
+                assert.equal(new Uint8Array(returned)[3], 7);
+                ch.port1.close();
+                done();
+            });
+            ch.port1.postMessage({ buffer: buf, view: new Uint8Array(buf) }, [buf]);
+        });
+        it("throws TypeError for functions", () => {
+            let ch = new worker_threads.MessageChannel();
+            assert.throws(() => ch.port1.postMessage({ f: () => 0 }), TypeError);
+            ch.port1.close();
+        });
+        it("emits close on both ports", (done) => {
+            let ch = new worker_threads.MessageChannel();
+            let closed = 0;
+            let listener = () => {
+                if (++closed === 2) {
+                    done();
+                }
+            };
+            ch.port1.on("close", listener);
+            ch.port2.on("close", listener);
+            ch.port1.close();
+        });
+    });
+    describe("ports", () => {
+        it("echoes nested values through heap in another thread", (done) => {
+            new Function("return this")().__start_echo_heap();
+            let port = worker_threads.ports["echo"];
+            assert.instanceOf(port, worker_threads.MessagePort);
+            let value: any = "leaf";
+            for (let i = 0; i < 32; ++i) {
+                value = (i % 2) ? [value, i] : { v: value, i: i };
+            }
+            let received = [];
+            port.on("message", (echoed) => received.push(echoed));
+            port.on("close", () => {
+                assert.deepEqual(received, [value, null]);
+                done();
+            });
+            port.postMessage(value);
+            port.postMessage(null);
+        });
+        it("throws RangeError for too deep value", () => {
+            let ch = new worker_threads.MessageChannel();
+            let value: any = [];
+            for (let i = 0; i < 32; ++i) {
+                value = [value];
+            }
+            assert.throws(() => ch.port1.postMessage(value), RangeError);
+            ch.port1.close();
+        });
+    });
+    describe("offload()", () => {
+        it("resolves with return value of function run in worker", (done) => {
+            worker_threads.offload((values: number[], scale: number) => {
+                let sum = 0;
+                for (let i = 0; i < values.length; ++i) {
+                    sum += values[i] * scale;
+                }
+                return { sum: sum };
+            }, [1, 2, 3], 10)
+            .then((result) => {
+                try {
+                    assert.deepEqual(result, { sum: 60 });
+                } catch (reason) {
+                    return done(reason);
+                }
+                done();
+            }, (reason) => {
+                done(reason);
+            });
+        });
+        it("runs in isolated heap", (done) => {
+            new Function("return this")().__offload_marker = 1;
+            worker_threads.offload(() => typeof new Function("return this")().__offload_marker)
+            .then((result) => {
+                try {
+                    assert.equal(result, "undefined");
+                } catch (reason) {
+                    return done(reason);
+                }
+                done();
+            }, (reason) => {
+                done(reason);
+            });
+        });
+        it("rejects when function throws", (done) => {
+            worker_threads.offload(() => { throw new RangeError("oops"); })
+            .then(() => {
+                done("incorrect fulfillment");
+            }, (reason) => {
+                try {
+                    assert.instanceOf(reason, Error);
+                    assert.include(reason.message, "oops");
+                } catch (reason) {
+                    return done(reason);
+                }
+                done();
+            });
+        });
+        it("throws TypeError for native function", () => {
+            assert.throws(() => worker_threads.offload(Math.max, 1, 2), TypeError);
+        });
+        it("throws TypeError for bytecode buffer", () => {
+            assert.throws(() => worker_threads.offload(<any>new Uint8Array(16)), TypeError);
+        });
+    });
+});
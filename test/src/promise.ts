@@ -67,6 +67,51 @@ describe("Promise", () => {
         tick = 1;
     });
 
+    it("ignores reject() after resolved with a pending promise", (done) => {
+        let resolveInner: Function;
+        let inner = new Promise((resolve) => { resolveInner = resolve; });
+        new Promise((resolve, reject) => {
+            resolve(inner);
+            reject("ignored");
+        })
+        .then((result) => {
+            if (result !== "inner") {
+                return done("incorrect value");
+            }
+            done();
+        }, (reason) => {
+            done("incorrect rejection");
+        });
+        resolveInner("inner");
+    });
+
+    it("adopts the state of thenable returned from handler", (done) => {
+        Promise.resolve(1)
+        .then((value) => {
+            return { then: (resolve: Function) => resolve(value + 1) };
+        })
+        .then((result) => {
+            if (result !== 2) {
+                return done("incorrect value");
+            }
+            done();
+        });
+    });
+
+    it("runs reactions queued by reactions before immediates", (done) => {
+        let chained = false;
+        setImmediate(() => {
+            if (!chained) {
+                return done("immediate runs before chained reactions");
+            }
+            done();
+        });
+        Promise.resolve()
+        .then(() => {})
+        .then(() => {})
+        .then(() => { chained = true; });
+    });
+
     it("has all() method which has one argument", () => {
         assert.isFunction(Promise.all);
         assert.equal(Promise.all.length, 1);
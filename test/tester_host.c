@@ -3,8 +3,10 @@
 #include "../src/dux_internal.h"
 #include "espresso.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <pthread.h>
 
 static const char CJS_PROLOGUE[] = "(function(require,module,exports){";
 static const int CJS_PROLOGUE_LEN = sizeof(CJS_PROLOGUE) - 1;
@@ -13,6 +15,8 @@ static const int CJS_EPILOGUE_LEN = sizeof(CJS_EPILOGUE) - 1;
 
 static duk_context *g_ctx;
 
+extern const dux_bundle_entry test_bundle[];
+
 static duk_ret_t eval_mod_caller(duk_context *ctx)
 {
 	int result = -1;
@@ -92,6 +96,38 @@ static duk_int_t test_after_work_cb(duk_context *ctx, dux_work_t *req)
 	return duk_pcall(ctx, duk_get_top(ctx) - 1);
 }
 
+static dux_memory_usage memory_usage;
+
+static duk_ret_t memory_stats_caller(duk_context *ctx)
+{
+	dux_memory_stats stats[32];
+	duk_uint_t count, index;
+
+	count = dux_get_memory_stats(ctx, stats, 32);
+	duk_push_object(ctx);
+	for (index = 0; (index < count) && (index < 32); ++index) {
+		duk_push_int(ctx, stats[index].bytes);
+		duk_put_prop_string(ctx, -2, stats[index].name);
+	}
+	return 1;
+}
+
+static duk_ret_t read_json_caller(duk_context *ctx)
+{
+	/* [ path typed_array_min ] */
+	if (dux_read_json_file(ctx, duk_require_string(ctx, 0), duk_get_uint(ctx, 1)) != DUK_EXEC_SUCCESS) {
+		return duk_throw(ctx);
+	}
+	return 1;
+}
+
+static duk_ret_t reload_module_caller(duk_context *ctx)
+{
+	/* [ filename ] */
+	duk_push_int(ctx, dux_reload_module(ctx, duk_require_string(ctx, 0)));
+	return 1;
+}
+
 static duk_ret_t queue_work_caller(duk_context *ctx)
 {
 	/* [ buf arg1 ... argN ] */
@@ -104,52 +140,308 @@ static duk_ret_t queue_work_caller(duk_context *ctx)
 	return 0;
 }
 
-static duk_ret_t test_file_reader(duk_context *ctx, const char *path)
+#define BYTECODE_CACHE_MAX	16
+
+static struct {
+	char path[64];
+	void *data;
+	size_t len;
+} bytecode_cache[BYTECODE_CACHE_MAX];
+static int bytecode_cache_writes;
+static int bytecode_cache_hits;
+
+static duk_ret_t bytecode_cache_stat(duk_context *ctx)
+{
+	duk_push_object(ctx);
+	duk_push_int(ctx, bytecode_cache_writes);
+	duk_put_prop_string(ctx, -2, "writes");
+	duk_push_int(ctx, bytecode_cache_hits);
+	duk_put_prop_string(ctx, -2, "hits");
+	return 1;
+}
+
+static duk_ret_t test_file_writer(duk_context *ctx, const char *path, const void *data, duk_size_t len)
+{
+	int i;
+
+	for (i = 0; i < BYTECODE_CACHE_MAX; ++i) {
+		if ((!bytecode_cache[i].data) || (strcmp(bytecode_cache[i].path, path) == 0)) {
+			break;
+		}
+	}
+	if ((i >= BYTECODE_CACHE_MAX) || (strlen(path) >= sizeof(bytecode_cache[i].path))) {
+		return DUK_EXEC_ERROR;
+	}
+	free(bytecode_cache[i].data);
+	bytecode_cache[i].data = malloc(len);
+	if (!bytecode_cache[i].data) {
+		return DUK_EXEC_ERROR;
+	}
+	strcpy(bytecode_cache[i].path, path);
+	memcpy(bytecode_cache[i].data, data, len);
+	bytecode_cache[i].len = len;
+	++bytecode_cache_writes;
+	return DUK_EXEC_SUCCESS;
+}
+
+static duk_ret_t test_file_map(duk_context *ctx, const char *path, const void **data, duk_size_t *len, void **handle)
+{
+	int i;
+
+	for (i = 0; i < BYTECODE_CACHE_MAX; ++i) {
+		if (bytecode_cache[i].data && (strcmp(bytecode_cache[i].path, path) == 0)) {
+			*data = bytecode_cache[i].data;
+			*len = bytecode_cache[i].len;
+			*handle = NULL;
+			++bytecode_cache_hits;
+			return DUK_EXEC_SUCCESS;
+		}
+	}
+	return DUK_EXEC_ERROR;
+}
+
+static void test_file_unmap(duk_context *ctx, const void *data, duk_size_t len, void *handle)
+{
+}
+
+static void *test_file_open(duk_context *ctx, const char *path, duk_size_t *size)
 {
 	static const char *maps[] = {
 		"/mod1",
 		"/mod1.js",
 		"/mod1.json",
 		"/json1.json",
+		"/json2.json",
+		"/json3.json",
+		"/hot1.js",
+		"/hot2.js",
+		"/hot3.js",
 		"/mod2.js",
 		"/sub/mod3.js",
 		"/mod4.js",
+		"/mod5.js",
 		NULL,
 	};
 	char name[256];
 	FILE *fp;
 	const char **item;
-	void *buf;
-	size_t len;
 
 	for (item = maps; *item; ++item) {
 		if (strcmp(*item, path) == 0) {
 			goto found;
 		}
 	}
-	duk_push_error_object(ctx, DUK_ERR_ERROR, "File not found: %s", path);
-	return DUK_EXEC_ERROR;
+	return NULL;
 
 found:
 	strcpy(name, "fs");
 	strcat(name, path);
 	fp = fopen(name, "rb");
 	if (!fp) {
-		return duk_error(ctx, DUK_ERR_ERROR, "TEST PANIC: not found: %s", name);
+		duk_error(ctx, DUK_ERR_ERROR, "TEST PANIC: not found: %s", name);
+		return NULL;
 	}
 	fseek(fp, 0, SEEK_END);
-	len = ftell(fp);
-	buf = duk_push_fixed_buffer(ctx, len);
+	*size = ftell(fp);
 	fseek(fp, 0, SEEK_SET);
-	fread(buf, 1, len, fp);
-	duk_buffer_to_string(ctx, -1);
-	return DUK_EXEC_SUCCESS;
+	return fp;
+}
+
+static duk_int_t test_file_read(duk_context *ctx, void *handle, void *buf, duk_size_t len)
+{
+	/* Read in small chunks to test chunked reading */
+	if (len > 16) {
+		len = 16;
+	}
+	return fread(buf, 1, len, (FILE *)handle);
+}
+
+static void test_file_close(duk_context *ctx, void *handle)
+{
+	fclose((FILE *)handle);
+}
+
+static duk_ret_t test_file_reader(duk_context *ctx, const char *path)
+{
+	duk_push_error_object(ctx, DUK_ERR_ERROR, "File not found: %s", path);
+	return DUK_EXEC_ERROR;
 }
 
 static const dux_file_accessor file_accessor = {
 	.reader = test_file_reader,
+	.writer = test_file_writer,
+	.map = test_file_map,
+	.unmap = test_file_unmap,
+	.open = test_file_open,
+	.read = test_file_read,
+	.close = test_file_close,
+};
+
+/* Accessor for echo heap (Shares nothing with main heap) */
+static const dux_file_accessor echo_file_accessor = {
+	.reader = test_file_reader,
 };
 
+static const char ECHO_SOURCE[] =
+	"var port = require('worker_threads').parentPort;"
+	"port.on('message', function (value) {"
+	"  port.postMessage(value);"
+	"  if (value === null) port.close();"
+	"});";
+
+static void *echo_thread(void *arg)
+{
+	dux_channel *channel = (dux_channel *)arg;
+	duk_context *ctx;
+
+	ctx = duk_create_heap_default();
+	if (!ctx) {
+		fprintf(stderr, "ERROR: cannot create echo heap\n");
+		dux_channel_release(channel);
+		return NULL;
+	}
+	dux_initialize(ctx, &echo_file_accessor);
+	dux_channel_attach(ctx, channel, 1, "parent");
+	dux_channel_release(channel);
+	dux_eval_module_string_noresult(ctx, ECHO_SOURCE);
+	while (dux_tick_wait(ctx, -1)) {
+		/* Echo messages until port is closed */
+	}
+	duk_destroy_heap(ctx);
+	return NULL;
+}
+
+static duk_ret_t start_echo_heap(duk_context *ctx)
+{
+	dux_channel *channel;
+	pthread_t thread;
+
+	/* [  ] */
+	channel = dux_channel_create();
+	if (!channel) {
+		return duk_generic_error(ctx, "cannot create channel");
+	}
+	if (dux_channel_attach(ctx, channel, 0, "echo") != DUK_ERR_NONE) {
+		dux_channel_release(channel);
+		return duk_generic_error(ctx, "cannot attach channel");
+	}
+	/* Channel is released by echo thread after attaching another side */
+	if (pthread_create(&thread, NULL, echo_thread, channel) != 0) {
+		dux_channel_release(channel);
+		return duk_generic_error(ctx, "cannot start echo thread");
+	}
+	pthread_detach(thread);
+	return 0;
+}
+
+/* Native _read: pushes this.remaining chunks ("0003", "0002", ...) and EOF */
+static duk_ret_t native_source_read(duk_context *ctx)
+{
+	char text[16];
+	void *buf;
+	int remaining;
+
+	/* [ size ] */
+	duk_push_this(ctx);
+	duk_get_prop_string(ctx, 1, "remaining");
+	remaining = duk_get_int(ctx, -1);
+	duk_pop(ctx);
+	/* [ size this ] */
+	if (remaining > 0) {
+		snprintf(text, sizeof(text), "%04d", remaining);
+		buf = duk_push_fixed_buffer(ctx, 4);
+		memcpy(buf, text, 4);
+		duk_push_int(ctx, remaining - 1);
+		duk_put_prop_string(ctx, 1, "remaining");
+	} else {
+		duk_push_null(ctx);
+	}
+	/* [ size this chunk|null ] */
+	dux_stream_push(ctx, 1);
+	return 0;
+}
+
+/* Append chunk to this.received and count calls in this[key] */
+static void native_sink_append(duk_context *ctx, duk_idx_t this_idx, duk_idx_t chunk_idx)
+{
+	const void *data;
+	duk_size_t len;
+
+	/* [ ... this ... chunk ... ] */
+	data = duk_require_buffer_data(ctx, chunk_idx, &len);
+	duk_get_prop_string(ctx, this_idx, "received");
+	duk_push_lstring(ctx, (const char *)data, len);
+	duk_concat(ctx, 2);
+	duk_put_prop_string(ctx, this_idx, "received");
+}
+
+static void native_sink_count(duk_context *ctx, duk_idx_t this_idx, const char *key)
+{
+	duk_get_prop_string(ctx, this_idx, key);
+	duk_push_int(ctx, duk_get_int(ctx, -1) + 1);
+	duk_put_prop_string(ctx, this_idx, key);
+	duk_pop(ctx);
+}
+
+/* Native _write */
+static duk_ret_t native_sink_write(duk_context *ctx)
+{
+	/* [ chunk encoding callback ] */
+	duk_push_this(ctx);
+	native_sink_append(ctx, 3, 0);
+	native_sink_count(ctx, 3, "writes");
+	duk_dup(ctx, 2);
+	duk_call(ctx, 0);
+	return 0;
+}
+
+/* Native _writev */
+static duk_ret_t native_sink_writev(duk_context *ctx)
+{
+	duk_uarridx_t index, length;
+
+	/* [ chunks callback ] */
+	duk_push_this(ctx);
+	length = (duk_uarridx_t)duk_get_length(ctx, 0);
+	for (index = 0; index < length; ++index) {
+		duk_get_prop_index(ctx, 0, index);
+		duk_get_prop_string(ctx, -1, "chunk");
+		/* [ chunks callback this entry chunk ] */
+		native_sink_append(ctx, 2, 4);
+		duk_pop_2(ctx);
+	}
+	native_sink_count(ctx, 2, "writevs");
+	duk_dup(ctx, 1);
+	duk_call(ctx, 0);
+	return 0;
+}
+
+/* Replace _read/_write/_writev of stream with native ones */
+static duk_ret_t attach_native_stream(duk_context *ctx)
+{
+	dux_stream_readable_data *rdata;
+	dux_stream_writable_data *wdata;
+
+	/* [ stream count ] */
+	rdata = dux_stream_get_readable(ctx, 0);
+	wdata = dux_stream_get_writable(ctx, 0);
+	if ((!rdata) && (!wdata)) {
+		return duk_type_error(ctx, "not a stream");
+	}
+	if (rdata) {
+		duk_push_int(ctx, duk_get_int(ctx, 1));
+		duk_put_prop_string(ctx, 0, "remaining");
+		rdata->read = native_source_read;
+	}
+	if (wdata) {
+		duk_push_string(ctx, "");
+		duk_put_prop_string(ctx, 0, "received");
+		wdata->write = native_sink_write;
+		wdata->writev = native_sink_writev;
+	}
+	return 0;
+}
+
 static void my_fatal(void *udata, const char *msg)
 {
 	fprintf(stderr, "**** Duktape Fatal Error (%p, %s) ****\n", udata, msg);
@@ -168,11 +460,12 @@ int main(int argc, char *argv[])
 	int test_done;
 	int failed = 0;
 
-	ctx = duk_create_heap(NULL, NULL, NULL, NULL, my_fatal);
+	ctx = duk_create_heap(dux_memory_alloc, dux_memory_realloc, dux_memory_free, &memory_usage, my_fatal);
 	g_ctx = ctx;
 	fprintf(stderr, "INFO: heap created\n");
 
 	dux_initialize(ctx, &file_accessor);
+	dux_set_bundle(ctx, test_bundle);
 	fprintf(stderr, "INFO: dux initialized\n");
 
 	espresso_init(ctx);
@@ -181,9 +474,27 @@ int main(int argc, char *argv[])
 	duk_push_c_function(ctx, eval_mod_caller, 4);
 	duk_put_global_string(ctx, "__eval_mod_caller");
 
+	duk_push_c_function(ctx, memory_stats_caller, 0);
+	duk_put_global_string(ctx, "__memory_stats");
+
+	duk_push_c_function(ctx, read_json_caller, 2);
+	duk_put_global_string(ctx, "__read_json");
+
+	duk_push_c_function(ctx, reload_module_caller, 1);
+	duk_put_global_string(ctx, "__reload_module");
+
+	duk_push_c_function(ctx, bytecode_cache_stat, 0);
+	duk_put_global_string(ctx, "__bytecode_cache_stat");
+
 	duk_push_c_function(ctx, queue_work_caller, DUK_VARARGS);
 	duk_put_global_string(ctx, "__queue_work_caller");
 
+	duk_push_c_function(ctx, start_echo_heap, 0);
+	duk_put_global_string(ctx, "__start_echo_heap");
+
+	duk_push_c_function(ctx, attach_native_stream, 2);
+	duk_put_global_string(ctx, "__attach_native_stream");
+
 	for (i = 1; i < argc; ++i) {
 		fp = fopen(argv[i], "rb");
 		if(!fp) {
@@ -218,7 +529,7 @@ int main(int argc, char *argv[])
 		int stack_before, stack_after, tick_result;
 		test_done = espresso_tick(ctx, NULL, NULL, &failed);
 		stack_before = duk_get_top(ctx);
-		tick_result = dux_tick(ctx);
+		tick_result = dux_tick_wait(ctx, -1);
 		stack_after = duk_get_top(ctx);
 		if (stack_before != stack_after) {
 			fprintf(stderr, "ERROR: stack length changed in tick handler (%d -> %d)\n",
@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+import argparse
+import re
+import os
+import posixpath
+import subprocess
+import sys
+import tempfile
+
+parser = argparse.ArgumentParser()
+parser.add_argument("entries", nargs="+", help="entry module path (absolute path in bundle)")
+parser.add_argument("-r", "--root", default=".", help="directory mapped to / of bundle")
+parser.add_argument("-n", "--name", default="dux_bundle", help="name of generated array")
+parser.add_argument("-b", "--bytecode", action="store_true", help="embed X.jsc (duk_dump_function output) if exists")
+parser.add_argument("-c", "--compiler", help="compile modules into bytecode by this command (tools/dux_compile.c built for target)")
+parser.add_argument("--no-source", action="store_true", help="omit source of module whose bytecode is embedded")
+parser.add_argument("-o", "--output", help="output file")
+parser.add_argument("--dep", help="dependency list file")
+args = parser.parse_args()
+
+REQUIRE = re.compile(r"\brequire\s*\(\s*([\"'])([^\"']+)\1\s*\)")
+
+def local_path(path):
+    return os.path.join(args.root, *path.lstrip("/").split("/"))
+
+def resolve(name, parent):
+    # Same order as modules_require_file (X, X.js, X.json)
+    if name.startswith("/"):
+        path = posixpath.normpath(name)
+    elif name.startswith("."):
+        path = posixpath.normpath(posixpath.join(posixpath.dirname(parent), name))
+    else:
+        # Core module
+        return None
+    for candidate in (path, path + ".js", path + ".json"):
+        if os.path.isfile(local_path(candidate)):
+            return candidate
+    sys.stderr.write("warning: cannot resolve '%s' in %s\n" % (name, parent))
+    return None
+
+def read(path):
+    f = open(local_path(path), "rb")
+    data = f.read()
+    f.close()
+    args.deps.append(local_path(path))
+    return data
+
+def compile_module(path):
+    # Output of dux_compile is the same as bytecode cache (X.jsc)
+    fd, out = tempfile.mkstemp(suffix=".jsc")
+    os.close(fd)
+    try:
+        subprocess.check_call([args.compiler, path, local_path(path), out])
+        f = open(out, "rb")
+        data = f.read()
+        f.close()
+    finally:
+        os.remove(out)
+    return data
+
+def c_string(text):
+    # Escape path for C string literal
+    result = ""
+    for ch in bytearray(text.encode("utf-8")):
+        if ch in (0x22, 0x5c):
+            result += "\\" + chr(ch)
+        elif 0x20 <= ch < 0x7f:
+            result += chr(ch)
+        else:
+            result += "\\%03o" % ch
+    return "\"" + result + "\""
+
+args.deps = []
+entries = {}
+queue = [posixpath.normpath("/" + e.lstrip("/")) for e in args.entries]
+while queue:
+    path = queue.pop(0)
+    if path in entries:
+        continue
+    data = read(path)
+    entries[path] = data
+    if path.endswith(".json"):
+        continue
+    if args.compiler and path.endswith(".js"):
+        entries[path + "c"] = compile_module(path)
+        if args.no_source:
+            entries[path] = None
+    elif args.bytecode and path.endswith(".js") and os.path.isfile(local_path(path + "c")):
+        entries[path + "c"] = read(path + "c")
+        if args.no_source:
+            entries[path] = None
+    for m in REQUIRE.finditer(data.decode("utf-8", "replace")):
+        child = resolve(m.group(2), path)
+        if child and not child in entries:
+            queue.append(child)
+
+if args.output:
+    outf = open(args.output, "w")
+else:
+    outf = sys.stdout
+
+outf.write("/* Generated by bundle_modules.py (DO NOT EDIT) */\n")
+outf.write("#include \"duktape.h\"\n")
+outf.write("#include \"dukext.h\"\n\n")
+
+# dux_read_file looks up entries by binary search
+paths = sorted(p for p in entries if entries[p] is not None)
+for i, path in enumerate(paths):
+    data = bytearray(entries[path])
+    outf.write("/* %s */\n" % path.replace("*/", "* /"))
+    outf.write("static const unsigned char %s_%d[%d] = {" % (args.name, i, max(len(data), 1)))
+    for j in range(0, len(data), 16):
+        outf.write("\n\t" + ",".join("0x%02x" % b for b in data[j:j + 16]) + ",")
+    if not data:
+        outf.write(" 0")
+    outf.write("\n};\n\n")
+
+outf.write("const dux_bundle_entry %s[] = {\n" % args.name)
+for i, path in enumerate(paths):
+    outf.write("\t{ %s, %s_%d, %d },\n" % (c_string(path), args.name, i, len(entries[path])))
+outf.write("\t{ NULL, NULL, 0 }\n")
+outf.write("};\n")
+
+if args.output:
+    outf.close()
+
+if args.dep:
+    f = open(args.dep, "w")
+    if args.output:
+        f.write(args.output + ":")
+    else:
+        f.write("(stdout):")
+    for h in args.deps:
+        f.write(" \\\n\t" + h)
+    f.write("\n")
+    f.close()
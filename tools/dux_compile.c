@@ -0,0 +1,77 @@
+/*
+ * Compile JavaScript modules into bytecode for tools/bundle_modules.py
+ *
+ * Usage: dux_compile <filename> <input.js> <output.jsc>
+ *   filename : Absolute path of module in bundle (Used in stack traces)
+ *
+ * Duktape bytecode is not portable between builds, so this tool must be built
+ * with the same Duktape source and configuration as the target:
+ *   gcc -o dux_compile -I<duktape> -I<dist> dux_compile.c duktape.c dukext.c -lm -pthread
+ */
+#include "duktape.h"
+#include "dukext.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static duk_ret_t compile_safe(duk_context *ctx, void *udata)
+{
+	const char **argv = (const char **)udata;
+	FILE *fp;
+	long length;
+	void *buf;
+	duk_size_t len;
+
+	/* [  ] */
+	fp = fopen(argv[2], "rb");
+	if (!fp) {
+		return duk_generic_error(ctx, "cannot open %s", argv[2]);
+	}
+	fseek(fp, 0, SEEK_END);
+	length = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = duk_push_fixed_buffer(ctx, (duk_size_t)length);
+	if (fread(buf, 1, (size_t)length, fp) != (size_t)length) {
+		fclose(fp);
+		return duk_generic_error(ctx, "cannot read %s", argv[2]);
+	}
+	fclose(fp);
+	duk_buffer_to_string(ctx, -1);
+	/* [ source ] */
+	dux_dump_module(ctx, argv[1]);
+	/* [ bytecode ] */
+	buf = duk_get_buffer(ctx, -1, &len);
+
+	fp = fopen(argv[3], "wb");
+	if (!fp) {
+		return duk_generic_error(ctx, "cannot open %s", argv[3]);
+	}
+	if (fwrite(buf, 1, len, fp) != len) {
+		fclose(fp);
+		return duk_generic_error(ctx, "cannot write %s", argv[3]);
+	}
+	fclose(fp);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	duk_context *ctx;
+	int result = 0;
+
+	if (argc != 4) {
+		fprintf(stderr, "usage: %s <filename> <input.js> <output.jsc>\n", argv[0]);
+		return 2;
+	}
+
+	ctx = duk_create_heap_default();
+	if (!ctx) {
+		fprintf(stderr, "error: cannot create heap\n");
+		return 1;
+	}
+	if (duk_safe_call(ctx, compile_safe, (void *)argv, 0, 1) != DUK_EXEC_SUCCESS) {
+		fprintf(stderr, "error: %s\n", duk_safe_to_string(ctx, -1));
+		result = 1;
+	}
+	duk_destroy_heap(ctx);
+	return result;
+}